@@ -37,6 +37,7 @@
 #include <boost/bind.hpp>
 #include <boost/thread/thread.hpp>
 #include <boost/thread/mutex.hpp>
+#include <boost/atomic.hpp>
 //includes for the commandline options
 #include <boost/program_options.hpp>
 #include <boost/program_options/cmdline.hpp>
@@ -46,6 +47,11 @@
 #include <boost/lexical_cast.hpp>
 #include <boost/filesystem.hpp>
 namespace bpo = boost::program_options;
+//includes for waking up the processing thread
+#include <poll.h>
+#if defined linux
+#include <sys/eventfd.h>
+#endif
 //includes for setting the IO-priority
 #include <sys/types.h>
 #include <sys/syscall.h> /* For SYS_xxx definitions */
@@ -137,7 +143,65 @@ frames in 200MHz mode (default)
             <tr>
             <td>-B [--bufferSize] arg</td>
             <td> Size of the input buffer (in frames) when reading from a socket. The default is 
-            50000, which is about 100MByte. </td>
+            50000, which is about 100MByte. The buffer is split evenly over the ports, each
+            of which gets its own ring buffer. </td>
+            </tr>
+            <tr>
+            <td>--recvBatch arg</td>
+            <td> Maximum number of datagrams fetched from a socket with a single system call
+            (using recvmmsg, where available). The default is 32; 1 reads one datagram per call. </td>
+            </tr>
+            <tr>
+            <td>--socketBuffer arg</td>
+            <td> Size of the receive buffer of each socket (SO_RCVBUF), [MByte]. By default the
+            system default is kept; the kernel limits the size to net.core.rmem_max. </td>
+            </tr>
+            <tr>
+            <td>--workers arg</td>
+            <td> Number of worker threads decoding the frames and collecting the data of
+            the dipoles, while the main thread only routes the frames to them. The
+            default (0) processes the frames on the main thread. </td>
+            </tr>
+            <tr>
+            <td>--storage arg</td>
+            <td> Storage preset for the dipole datasets: "default" (small chunks, no
+            compression), "fast" (large chunks, shuffle and LZF -- or deflate at level 1
+            if LZF is not available -- tuned for ingest) or "compact" (large chunks,
+            shuffle and deflate at level 6). The options below override the preset. </td>
+            </tr>
+            <tr>
+            <td>--chunkSize arg</td>
+            <td> Chunk size of the dipole datasets, [samples]. </td>
+            </tr>
+            <tr>
+            <td>--compression arg</td>
+            <td> Compression of the dipole datasets: "none", "deflate", "lzf" or "szip". If
+            the filter is not available in the HDF5 library, deflate is used instead. </td>
+            </tr>
+            <tr>
+            <td>--compressionLevel arg</td>
+            <td> Compression level (1-9) of the deflate filter. </td>
+            </tr>
+            <tr>
+            <td>--shuffle arg</td>
+            <td> Apply (1) or do not apply (0) the shuffle filter before compressing. </td>
+            </tr>
+            <tr>
+            <td>--access arg</td>
+            <td> HDF5 file access preset for the output files: "default" (settings of the
+            HDF5 library), "ingest" (64 MB chunk cache, objects aligned to 1 MB stripes,
+            aggregated metadata, latest file format), "sequential-read" or
+            "random-read". </td>
+            </tr>
+            <tr>
+            <td>--stripeSize arg</td>
+            <td> Align large objects in the output files to this stripe size of the file
+            system, [MByte] (overrides --access). </td>
+            </tr>
+            <tr>
+            <td>--driver arg</td>
+            <td> HDF5 file driver: "sec2" (default), "core" (keep the file in memory
+            until it is closed) or "direct" (bypass the page cache, if available). </td>
             </tr>
             <tr>
             <td>-K [--keepRunning]</td>
@@ -163,11 +227,17 @@ frames in 200MHz mode (default)
             // (the vBuf of the system on the storage nodes can store ca. 800 frames)
             //#define INPUT_BUFFER_SIZE 50000
             int input_buffer_size;
+            //!maximum number of datagrams fetched with a single system call
+            int recv_batch_size;
+            //!requested size of the socket receive buffers (SO_RCVBUF), [Bytes]
+            int socket_buffer_size;
+            //!number of worker threads processing the frames (0: no pipeline)
+            int nof_worker_threads;
+            //!chunking and compression of the dipole datasets
+            DAL::HDF5StoragePolicy storage_policy;
+            //!file access settings of the output files
+            DAL::HDF5AccessProfile access_profile;
 
-            //!pointers (array indices) for the last buffer processed and the last buffer written
-            int inBufProcessID,inBufStorID;
-            //!the Input Buffer
-            char * inputBuffer_p;
             //!end all running reader threads
             bool terminateThreads;
             //!maximum number of frames waiting in the vBuf while reading
@@ -178,9 +248,45 @@ frames in 200MHz mode (default)
             int noFramesDropped;
             //!number of running reader-threads
             int noRunning;
-            //!mutex for writing into the buffer
+            //!mutex for updating the shared reader-thread statistics
             boost::mutex writeMutex;
 
+            /*!
+              \brief Ring buffer of frames received on a single UDP port
+
+              Each reader thread is the only one storing frames in its ring, and the
+              processing thread is the only one taking them out, so no locking is
+              required: \t head and \t tail are running frame counters, which are each
+              written by one side only.
+            */
+            struct FrameRing
+            {
+              //! UDP port the ring is filled from
+              int port;
+              //! Storage for the frame slots
+              char *slots;
+              //! Number of bytes received into each of the frame slots
+              int *lengths;
+              //! Number of frame slots in the ring
+              unsigned int size;
+              //! Number of frames stored so far (written by the reader thread)
+              boost::atomic<unsigned int> head;
+              //! Number of frames processed so far (written by the processing thread)
+              boost::atomic<unsigned int> tail;
+              //! Number of frames dropped because the ring was full
+              boost::atomic<unsigned int> nofDropped;
+              //! Maximum number of frames waiting in the ring
+              unsigned int maxOccupancy;
+            };
+            //!the input ring buffers, one per port
+            std::vector<FrameRing*> inputRings;
+            //!ring to look at first when searching for frames to process
+            unsigned int nextRing;
+            //!file descriptor used to wake up the processing thread
+            int wakeupFD[2];
+            //!is the processing thread waiting for data?
+            boost::atomic<bool> processingWaiting;
+
             //_______________________________________________________________________________
             // Handling of IO-Priority settings
 
@@ -562,13 +668,225 @@ std::string stationIdToName(int n)
   return s;
 }
 
+//_______________________________________________________________________________
+//                                                                    setupRings
+
+/*!
+  \brief Allocate the input ring buffers and the wake-up channel
+
+  \param ports -- Vector with UDP port numbers to read data from
+
+  \return \t true if successful
+
+  The \t input_buffer_size frames are split evenly over the ports.
+ */
+bool setupRings (std::vector<int> const &ports)
+{
+  unsigned int ringSize = input_buffer_size/ports.size();
+  if (ringSize < 2) {
+    ringSize = 2;
+  };
+
+  inputRings.resize(ports.size());
+  for (unsigned int i=0; i<ports.size(); i++) {
+    inputRings[i]               = new FrameRing;
+    inputRings[i]->port         = ports[i];
+    inputRings[i]->size         = ringSize;
+    inputRings[i]->slots        = new char[ringSize*UDP_PACKET_BUFFER_SIZE];
+    inputRings[i]->lengths      = new int[ringSize];
+    inputRings[i]->head         = 0;
+    inputRings[i]->tail         = 0;
+    inputRings[i]->nofDropped   = 0;
+    inputRings[i]->maxOccupancy = 0;
+  };
+  nextRing          = 0;
+  processingWaiting = false;
+
+#if defined linux
+  wakeupFD[0] = wakeupFD[1] = eventfd(0, EFD_NONBLOCK);
+  if (wakeupFD[0] < 0) {
+#else
+  if (pipe(wakeupFD) != 0) {
+#endif
+    perror("TBBraw2h5::setupRings");
+    return false;
+  };
+#if !defined linux
+  fcntl(wakeupFD[0], F_SETFL, O_NONBLOCK);
+  fcntl(wakeupFD[1], F_SETFL, O_NONBLOCK);
+#endif
+
+  return true;
+}
+
+//_______________________________________________________________________________
+//                                                                  releaseRings
+
+/*!
+  \brief Print the statistics of and release the input ring buffers
+
+  \param verbose -- Print the per-port statistics
+ */
+void releaseRings (bool verbose)
+{
+  for (unsigned int i=0; i<inputRings.size(); i++) {
+    noFramesDropped += inputRings[i]->nofDropped;
+    if ((int)inputRings[i]->maxOccupancy > maxCachedFrames) {
+      maxCachedFrames = inputRings[i]->maxOccupancy;
+    };
+    if (verbose) {
+      cout << "  Port " << inputRings[i]->port
+        << ": frames received: " << inputRings[i]->head
+        << " max. frames in ring: " << inputRings[i]->maxOccupancy
+        << " of " << inputRings[i]->size
+        << " frames dropped: " << inputRings[i]->nofDropped << endl;
+    };
+    delete [] inputRings[i]->slots;
+    delete [] inputRings[i]->lengths;
+    delete inputRings[i];
+  };
+  inputRings.clear();
+
+  close(wakeupFD[0]);
+  if (wakeupFD[1] != wakeupFD[0]) {
+    close(wakeupFD[1]);
+  };
+}
+
+//_______________________________________________________________________________
+//                                                              wakeupProcessing
+
+/*!
+  \brief Wake up the processing thread, if it is waiting for new frames
+ */
+inline void wakeupProcessing ()
+{
+  // pairs with the fence in waitForFrames(): either we see the flag, or the
+  // processing thread sees our frame before going to sleep
+  boost::atomic_thread_fence(boost::memory_order_seq_cst);
+  if (processingWaiting.load(boost::memory_order_relaxed)) {
+#if defined linux
+    uint64_t one = 1;
+#else
+    char one = 1;
+#endif
+    if (write(wakeupFD[1], &one, sizeof(one)) < 0) {
+      // counter/pipe already signalled; nothing to do
+    };
+  };
+}
+
+//_______________________________________________________________________________
+//                                                                nextFilledRing
+
+/*!
+  \brief Get the next ring buffer with frames waiting to be processed
+
+  \return pointer to the ring, or \t NULL if all rings are empty
+
+  The rings are visited round-robin, so no port can starve the others.
+ */
+FrameRing *nextFilledRing ()
+{
+  for (unsigned int n=0; n<inputRings.size(); n++) {
+    FrameRing *ring = inputRings[(nextRing+n) % inputRings.size()];
+    unsigned int occupancy = ring->head.load(boost::memory_order_acquire)
+      - ring->tail.load(boost::memory_order_relaxed);
+    if (occupancy > 0) {
+      if (occupancy > ring->maxOccupancy) {
+        ring->maxOccupancy = occupancy;
+      };
+      nextRing = (nextRing+n+1) % inputRings.size();
+      return ring;
+    };
+  };
+  return NULL;
+}
+
+//_______________________________________________________________________________
+//                                                                 framesWaiting
+
+/*!
+  \brief Are there frames waiting to be processed in any of the ring buffers?
+ */
+bool framesWaiting ()
+{
+  for (unsigned int i=0; i<inputRings.size(); i++) {
+    if (inputRings[i]->head.load(boost::memory_order_relaxed)
+        != inputRings[i]->tail.load(boost::memory_order_relaxed)) {
+      return true;
+    };
+  };
+  return false;
+}
+
+//_______________________________________________________________________________
+//                                                                 frameComplete
+
+/*!
+  \brief Does a frame in a ring buffer hold the full header and data?
+
+  \param ring -- The ring buffer holding the frame
+  \param tail -- Number of the frame in the ring
+  \param verbose -- Report dropped frames
+
+  \return \t true if the frame is complete; an incomplete frame is dropped,
+  i.e. its slot is handed back to the reader thread, and \t false is returned.
+ */
+bool frameComplete (FrameRing *ring, unsigned int tail, bool verbose)
+{
+  int length = ring->lengths[tail % ring->size];
+  if (length >= TBB_FRAME_SIZE) {
+    return true;
+  };
+  if (verbose) {
+    cout << "TBBraw2h5: Dropping incomplete frame from port " << ring->port
+      << ": " << length << " bytes" << endl;
+  };
+  ring->tail.store(tail+1, boost::memory_order_release);
+  return false;
+}
+
+//_______________________________________________________________________________
+//                                                                 waitForFrames
+
+/*!
+  \brief Block until new frames arrive or the timeout has passed
+
+  \param timeout -- Maximum time to wait [in msec]
+
+  \return \t true if woken up because of new frames
+ */
+bool waitForFrames (int timeout)
+{
+  processingWaiting.store(true, boost::memory_order_relaxed);
+  boost::atomic_thread_fence(boost::memory_order_seq_cst);
+  if (framesWaiting()) {
+    processingWaiting.store(false, boost::memory_order_relaxed);
+    return true;
+  };
+
+  struct pollfd pfd;
+  pfd.fd      = wakeupFD[0];
+  pfd.events  = POLLIN;
+  pfd.revents = 0;
+  int status  = poll(&pfd, 1, timeout);
+  processingWaiting.store(false, boost::memory_order_relaxed);
+  if (status > 0) {
+    char drain[8];
+    while (read(wakeupFD[0], drain, sizeof(drain)) > 0) {};
+    return true;
+  };
+  return false;
+}
+
 //_______________________________________________________________________________
 //                                                             socketReaderThread
 
 /*!
   \brief Thread that creates and then reads from a socket into the buffer
 
-  \param port -- UDP port number to read data from
+  \param ring -- Ring buffer to store the frames in; also holds the port number
   \param ip -- Hostname (ip-address) to bind to (not used)
   \param startTimeout -- Timeout when opening socket connection [in sec]
   \param readTimeout -- Timeout while reading from the socket [in sec] 
@@ -577,21 +895,21 @@ std::string stationIdToName(int n)
 
   \return \t true if successful
  */
-void socketReaderThread (int port,
+void socketReaderThread (FrameRing *ring,
     string ip,
     double startTimeout,
     double readTimeout,
     bool verbose,
     bool stayConnected=false)
 {
+  int port = ring->port;
   // Create the main socket
   int main_socket = 0;
   fd_set readSet;
-  struct timeval TimeoutWait, TimeoutRead, NullTimeout;
+  struct timeval TimeoutWait, TimeoutRead;
 
   TimeoutRead.tv_sec  = floor(readTimeout);
   TimeoutRead.tv_usec = (readTimeout-TimeoutRead.tv_sec)*1e6;
-  NullTimeout.tv_sec  = NullTimeout.tv_usec =0;
   main_socket         = socket(PF_INET, SOCK_DGRAM, 0);
 
   if (main_socket<0) {
@@ -601,6 +919,22 @@ void socketReaderThread (int port,
     noRunning--;
     return;
   };
+  //Enlarge the receive buffer, so that the kernel can hold more frames while
+  // the ring is being emptied
+  if (socket_buffer_size > 0)
+  {
+    int bufsize = socket_buffer_size;
+    socklen_t optlen = sizeof(bufsize);
+    if (setsockopt(main_socket, SOL_SOCKET, SO_RCVBUF, &bufsize, optlen) < 0)
+    {
+      perror("TBBraw2h5::socketReaderThread: setsockopt SO_RCVBUF");
+    }
+    else if (verbose && getsockopt(main_socket, SOL_SOCKET, SO_RCVBUF, &bufsize, &optlen) == 0)
+    {
+      cout << "TBBraw2h5::socketReaderThread:"<<port<<": socket buffer size: "
+        << bufsize << " bytes" << endl;
+    };
+  };
 
   //Create a sockaddr_in to describe the local port
   sockaddr_in local_info;
@@ -659,59 +993,113 @@ void socketReaderThread (int port,
     };
   };
   bool ImRunning=true;
-  int status, numWaiting=0, newBufID;
+  int status, numWaiting=0;
+  unsigned int head, nofFree, batch;
+  char dropBuffer[UDP_PACKET_BUFFER_SIZE];
+  char *slot;
+#if defined linux
+  std::vector<struct mmsghdr> msgs (recv_batch_size);
+  std::vector<struct iovec> iovecs (recv_batch_size);
+#else
   struct sockaddr_in incoming_addr;
   socklen_t socklen = sizeof(incoming_addr);
+#endif
   while (ImRunning && !terminateThreads)
   {
-    if (verbose)
+    FD_ZERO(&readSet);
+    FD_SET(main_socket, &readSet);
+    TimeoutWait = TimeoutRead;
+    if ((status = select(main_socket + 1, &readSet, NULL, NULL, &TimeoutWait)) )
     {
-      FD_ZERO(&readSet);
-      FD_SET(main_socket, &readSet);
-      if ((status = select(main_socket + 1, &readSet, NULL, NULL, &NullTimeout)) )
+      //there are frames waiting in the vBuffer; we are the only thread storing
+      // frames in this ring, so we only have to check that it is not full
+      head    = ring->head.load(boost::memory_order_relaxed);
+      nofFree = ring->size - (head - ring->tail.load(boost::memory_order_acquire));
+      batch   = (nofFree < (unsigned int)recv_batch_size) ? nofFree : recv_batch_size;
+#if defined linux
+      //fetch a whole batch with one system call; if the ring is full all
+      // datagrams of the batch end up in the drop buffer
+      if (batch == 0)
+      {
+        batch = recv_batch_size;
+      };
+      memset(&msgs[0], 0, batch*sizeof(struct mmsghdr));
+      for (unsigned int n=0; n<batch; n++)
+      {
+        iovecs[n].iov_base = (nofFree == 0) ? dropBuffer
+          : ring->slots + ((head+n) % ring->size)*UDP_PACKET_BUFFER_SIZE;
+        iovecs[n].iov_len          = UDP_PACKET_BUFFER_SIZE;
+        msgs[n].msg_hdr.msg_iov    = &iovecs[n];
+        msgs[n].msg_hdr.msg_iovlen = 1;
+      };
+      erg = recvmmsg (main_socket, &msgs[0], batch, MSG_DONTWAIT, NULL);
+      if (erg <= 0)
       {
-        numWaiting++;
+        continue;
+      };
+      if (nofFree == 0)
+      {
+        ring->nofDropped.fetch_add(erg, boost::memory_order_relaxed);
       }
       else
       {
-        boost::mutex::scoped_lock lock(writeMutex);
-        if (numWaiting > maxWaitingFrames)
+        //empty datagrams would leave a stale frame in their slot, so move the
+        // following datagrams down to close the hole
+        unsigned int stored = 0;
+        for (int n=0; n<erg; n++)
         {
-          maxWaitingFrames=numWaiting;
+          if (msgs[n].msg_len == 0)
+          {
+            continue;
+          };
+          slot = ring->slots + ((head+stored) % ring->size)*UDP_PACKET_BUFFER_SIZE;
+          if (slot != iovecs[n].iov_base)
+          {
+            memcpy(slot, iovecs[n].iov_base, msgs[n].msg_len);
+          };
+          ring->lengths[(head+stored) % ring->size] = msgs[n].msg_len;
+          stored++;
         };
-        numWaiting=0;
+        //publish the frames to the processing thread
+        ring->head.store(head+stored, boost::memory_order_release);
+        wakeupProcessing();
       };
-    };
-    FD_ZERO(&readSet);
-    FD_SET(main_socket, &readSet);
-    TimeoutWait = TimeoutRead;
-    if ((status = select(main_socket + 1, &readSet, NULL, NULL, &TimeoutWait)) )
-    {
-      //there is a frame waiting in the vBuffer
+      if (verbose)
       {
-        //  make sure that we are the only ones writing to the input buffer
-        //  (concurrent reading is O.K.)
-        boost::mutex::scoped_lock lock(writeMutex);
-        newBufID = inBufStorID+1;
-        if (newBufID >= input_buffer_size)
+        for (int n=0; n<erg; n++)
         {
-          newBufID =0;
-        }
-        if (newBufID == inBufProcessID)
-        {
-          noFramesDropped++;
-          newBufID = inBufStorID;
+          if (msgs[n].msg_len != 2140)
+          {
+            cout << "TBBraw2h5::socketReaderThread:"<<port
+              << ": Received strange packet size: " << msgs[n].msg_len <<endl;
+          };
         };
-        //perform the actual read
-        erg = recvfrom (main_socket,
-            (inputBuffer_p + (newBufID*UDP_PACKET_BUFFER_SIZE)),
-            UDP_PACKET_BUFFER_SIZE,
-            0,
-            (sockaddr *) &incoming_addr,
-            &socklen);
-        inBufStorID = newBufID;
+      };
+#else
+      slot = (batch == 0) ? dropBuffer
+        : ring->slots + (head % ring->size)*UDP_PACKET_BUFFER_SIZE;
+      //perform the actual read
+      erg = recvfrom (main_socket,
+          slot,
+          UDP_PACKET_BUFFER_SIZE,
+          MSG_DONTWAIT,
+          (sockaddr *) &incoming_addr,
+          &socklen);
+      if (erg < 0)
+      {
+        continue;
+      };
+      if (slot == dropBuffer)
+      {
+        ring->nofDropped.fetch_add(1, boost::memory_order_relaxed);
       }
-      ;// writeMutex lock is released here
+      else if (erg > 0)
+      {
+        //publish the frame to the processing thread
+        ring->lengths[head % ring->size] = erg;
+        ring->head.store(head+1, boost::memory_order_release);
+        wakeupProcessing();
+      };
       if (verbose)
       {
         if (erg != 2140)
@@ -720,6 +1108,22 @@ void socketReaderThread (int port,
             << ": Received strange packet size: " << erg <<endl;
         };
       };
+      batch = 1;
+#endif
+      if (verbose)
+      {
+        //a full batch means more frames are (probably) waiting in the vBuffer
+        numWaiting += erg;
+        if ((unsigned int)erg < batch)
+        {
+          boost::mutex::scoped_lock lock(writeMutex);
+          if (numWaiting > maxWaitingFrames)
+          {
+            maxWaitingFrames=numWaiting;
+          };
+          numWaiting=0;
+        };
+      };
     }
     else if (! stayConnected || lastEvent)
     {
@@ -788,16 +1192,15 @@ bool readFromSockets (std::vector<int> ports,
 
   terminateThreads = false;
   maxCachedFrames  = maxWaitingFrames = 0;
-  inBufProcessID   = inBufStorID =0;
   noRunning        = 0;
-  inputBuffer_p    = new char[(input_buffer_size*UDP_PACKET_BUFFER_SIZE)];
 
-  if (inputBuffer_p == NULL) {
+  if (!setupRings(ports)) {
     cerr << "TBBraw2h5::readFromSockets: Failed to allocate input buffer!" <<endl;
     return false;
   } else if (verbose) {
-    cout << "TBBraw2h5::readFromSockets: Allocated " << input_buffer_size*UDP_PACKET_BUFFER_SIZE
-      << " bytes for the input buffer." << endl;
+    cout << "TBBraw2h5::readFromSockets: Allocated " << ports.size() << " x "
+      << inputRings[0]->size*UDP_PACKET_BUFFER_SIZE
+      << " bytes for the input buffers." << endl;
   };
 
   // start the reader-threads
@@ -805,7 +1208,7 @@ bool readFromSockets (std::vector<int> ports,
   readerThreads = new boost::thread*[ports.size()];
   for (i=0; i < ports.size(); i++) {
     readerThreads[i] = new boost::thread(boost::bind(socketReaderThread,
-          ports[i],
+          inputRings[i],
           ip,
           startTimeout,
           readTimeout,
@@ -820,17 +1223,19 @@ bool readFromSockets (std::vector<int> ports,
       return false;
     };
   };
-  int processingID, tmpint;
+  FrameRing *ring;
+  unsigned int tail;
   int amWaiting=0;
-  while ((noRunning>0) || (inBufStorID != inBufProcessID) )  {
-    if (inBufStorID == inBufProcessID)  {
+  while ((noRunning>0) || framesWaiting() )  {
+    if ((ring = nextFilledRing()) == NULL)  {
       if (verbose && ((amWaiting%100)==1) ) {
         cout << "TBBraw2h5::readFromSockets: Status report: Buffer is empty! waiting." << endl;
-        cout << "  Status: inBufStorID:" << inBufStorID << " inBufProcessID: " << inBufProcessID
-          << " noRunning: " << noRunning << " waiting for: " << amWaiting*0.10 << " sec."<< endl;
+        cout << "  Status: noRunning: " << noRunning << " waiting for: " << amWaiting*0.10 << " sec."<< endl;
+      };
+      //sleep until a reader thread stores a frame, or 100ms have passed
+      if (!waitForFrames(100)) {
+        amWaiting++;
       };
-      amWaiting++;
-      usleep(100000);
       if (!waitForAllPorts && maxCachedFrames>0 && (amWaiting*0.10 > readTimeout)){
         if (verbose && ! terminateThreads) {
           cout << "TBBraw2h5::readFromSockets: Stopping all other reader-threads." << endl;
@@ -840,17 +1245,19 @@ bool readFromSockets (std::vector<int> ports,
       continue;
     };
     amWaiting=0;
-    tmpint = (inBufStorID-inBufProcessID+input_buffer_size)%input_buffer_size;
-    if (tmpint > maxCachedFrames) {
-      maxCachedFrames = tmpint;
+    if ((int)ring->maxOccupancy > maxCachedFrames) {
+      maxCachedFrames = ring->maxOccupancy;
     };
-    processingID = inBufProcessID+1;
-    if (processingID >= input_buffer_size) {
-      processingID -= input_buffer_size;
+    tail = ring->tail.load(boost::memory_order_relaxed);
+
+    // Drop frames too short to hold the header and the data
+    if (!frameComplete(ring, tail, verbose))
+    {
+      continue;
     };
 
     // Create new time stamped file if required
-    bufferPointer = inputBuffer_p + (processingID*UDP_PACKET_BUFFER_SIZE);
+    bufferPointer = ring->slots + (tail % ring->size)*UDP_PACKET_BUFFER_SIZE;
     if (tbb == NULL)
     {
       // Get timestamp and convert to ISO 8601 format for filename
@@ -872,7 +1279,7 @@ bool readFromSockets (std::vector<int> ports,
       outfile << "_R" << std::setw(3) << std::setfill('0') << n;
 
       // Create file
-      tbb = new DAL::TBBraw(outfile.str()+"_tbb.h5", observer, project, observationID, filterSelection, "LOFAR", antennaSet);
+      tbb = new DAL::TBBraw(outfile.str()+"_tbb.h5", observer, project, observationID, filterSelection, "LOFAR", antennaSet, access_profile);
       if ( !tbb->isConnected() )
       {
         cout << "[TBBraw2h5] Failed to open output file." << endl;
@@ -887,11 +1294,16 @@ bool readFromSockets (std::vector<int> ports,
         tbb->doHeaderCRC(false);
       };
       tbb->setFixTimes(fixTransientTimes);
+      tbb->setStoragePolicy(storage_policy);
+      if (nof_worker_threads > 0) {
+        tbb->startPipeline(nof_worker_threads);
+      };
     }
 
     tbb->processTBBrawBlock(bufferPointer,
-        UDP_PACKET_BUFFER_SIZE);
-    inBufProcessID = processingID;
+        ring->lengths[tail % ring->size]);
+    //hand the slot back to the reader thread
+    ring->tail.store(tail+1, boost::memory_order_release);
   };
   terminateThreads = true;
   for (i=0;  i< ports.size(); i++){
@@ -899,7 +1311,7 @@ bool readFromSockets (std::vector<int> ports,
     delete readerThreads[i];
   };
   delete [] readerThreads;
-  delete inputBuffer_p;
+  releaseRings(verbose);
   if (verbose) {
     cout << "Socket and Buffer Stats: Maximum # of waiting frames:" << maxWaitingFrames << endl;
     cout << "                        Maximum # of frames in cache:" << maxCachedFrames << endl;
@@ -945,19 +1357,16 @@ bool readStationsFromSockets (std::vector<int> ports,
   terminateThreads = false;
   maxCachedFrames  = 0;
   maxWaitingFrames = 0;
-  inBufProcessID   = 0;
-  inBufStorID      = 0;
   noRunning        = 0;
-  inputBuffer_p    = new char[(input_buffer_size*UDP_PACKET_BUFFER_SIZE)];
 
-  if (inputBuffer_p == NULL) {
+  if (!setupRings(ports)) {
     std::cerr << "TBBraw2h5::readStationsFromSockets: Failed to allocate input buffer!"
       << std::endl;
     return false;
   } else if (verbose) {
-    cout << "TBBraw2h5::readStationsFromSockets: Allocated "
-      << input_buffer_size*UDP_PACKET_BUFFER_SIZE
-      << " bytes for the input buffer." << endl;
+    cout << "TBBraw2h5::readStationsFromSockets: Allocated " << ports.size() << " x "
+      << inputRings[0]->size*UDP_PACKET_BUFFER_SIZE
+      << " bytes for the input buffers." << endl;
   };
 
   //________________________________________________________
@@ -985,7 +1394,7 @@ bool readStationsFromSockets (std::vector<int> ports,
 
   for (i=0; i < ports.size(); i++) {
     readerThreads[i] = new boost::thread (boost::bind(socketReaderThread,
-          ports[i],
+          inputRings[i],
           ip,
           startTimeout,
           readTimeout,
@@ -1004,25 +1413,25 @@ bool readStationsFromSockets (std::vector<int> ports,
   //________________________________________________________
   // Look for and process incoming data
 
-  int processingID = 0;
-  int tmpint       = 0;
+  FrameRing *ring;
+  unsigned int tail;
   int amWaiting    = 0;
   unsigned char stationId;
   char * bufferPointer;
 
-  while (((noRunning>0) || (inBufStorID != inBufProcessID)) )  {
-    if (inBufStorID == inBufProcessID)  {
+  while (((noRunning>0) || framesWaiting()) )  {
+    if ((ring = nextFilledRing()) == NULL)  {
       if (verbose && ((amWaiting%100)==1) ) {
         std::cout << "[TBBraw2h5::readStationsFromSockets]"
           << " Status report: Buffer is empty! waiting." << std::endl;
         // Do not split this up into several lines, as it makes the logfile hard to read!
-        std::cout << "  Status: inBufStorID:" << inBufStorID 
-          << " inBufProcessID: " << inBufProcessID
-          << " noRunning: " << noRunning 
+        std::cout << "  Status: noRunning: " << noRunning 
           << " waiting for: " << amWaiting*0.10 << " sec." << std::endl;
       };
-      amWaiting++;
-      usleep(100000);
+      //sleep until a reader thread stores a frame, or 100ms have passed
+      if (!waitForFrames(100)) {
+        amWaiting++;
+      };
       if (amWaiting*0.10 > readTimeout){
         for (i=0; i<256; i++) {
           if (TBBfiles[i] != NULL) {
@@ -1037,15 +1446,15 @@ bool readStationsFromSockets (std::vector<int> ports,
       continue;
     };
     amWaiting=0;
-    tmpint = (inBufStorID-inBufProcessID+input_buffer_size)%input_buffer_size;
-    if (tmpint > maxCachedFrames) {
-      maxCachedFrames = tmpint;
+    if ((int)ring->maxOccupancy > maxCachedFrames) {
+      maxCachedFrames = ring->maxOccupancy;
     };
-    processingID = inBufProcessID+1;
-    if (processingID >= input_buffer_size) {
-      processingID -= input_buffer_size;
+    tail = ring->tail.load(boost::memory_order_relaxed);
+    if (!frameComplete(ring, tail, verbose))
+    {
+      continue;
     };
-    bufferPointer = (inputBuffer_p + (processingID*UDP_PACKET_BUFFER_SIZE));
+    bufferPointer = ring->slots + (tail % ring->size)*UDP_PACKET_BUFFER_SIZE;
     stationId = DAL::TBBraw::getStationId(bufferPointer);
     if ( (TBBfiles[stationId] == NULL) || 
         (DAL::TBBraw::getDataTime(bufferPointer) > (lasttimes[stationId]+ceil(readTimeout)) ) ){
@@ -1075,23 +1484,36 @@ bool readStationsFromSockets (std::vector<int> ports,
       }
       outfile << "_R" << std::setw(3) << std::setfill('0') << n;
 
-      TBBfiles[stationId] = new DAL::TBBraw(outfile.str()+"_tbb.h5", observer, project, observationID, filterSelection, "LOFAR", antennaSet);
+      TBBfiles[stationId] = new DAL::TBBraw(outfile.str()+"_tbb.h5", observer, project, observationID, filterSelection, "LOFAR", antennaSet, access_profile);
       if ( !TBBfiles[stationId]->isConnected() ) {
         cout << "TBBraw2h5::readStationsFromSockets: Failed to open output file:" 
           << outfile.str() << endl;
         terminateThreads=true;
-      };       
+      }
+      else {
+        TBBfiles[stationId]->setStoragePolicy(storage_policy);
+        if (nof_worker_threads > 0) {
+          TBBfiles[stationId]->startPipeline(nof_worker_threads);
+        };
+      };
     };
-    if ( TBBfiles[stationId]->processTBBrawBlock(bufferPointer, UDP_PACKET_BUFFER_SIZE) ){ 
+    if ( TBBfiles[stationId]->processTBBrawBlock(bufferPointer, ring->lengths[tail % ring->size]) ){ 
       lasttimes[stationId] = DAL::TBBraw::getDataTime(bufferPointer);
     };
-    inBufProcessID = processingID;    
+    //hand the slot back to the reader thread
+    ring->tail.store(tail+1, boost::memory_order_release);
   };
 
+  terminateThreads = true;
+  for (i=0;  i< ports.size(); i++){
+    readerThreads[i]->join();
+    delete readerThreads[i];
+  };
+  delete [] readerThreads;
+
   // Release allocated memory
   delete [] TBBfiles;
-
-  terminateThreads = true;
+  releaseRings(verbose);
 
   return true;
 }
@@ -1180,6 +1602,9 @@ int main(int argc, char *argv[])
   keepRunning            = false;
   lastEvent              = false;
   input_buffer_size = 50000;
+  recv_batch_size = 32;
+  socket_buffer_size = 0;
+  nof_worker_threads = 0;
 
   // Register signal and signal handler
   signal(SIGTERM, signal_callback_handler);
@@ -1205,6 +1630,17 @@ int main(int argc, char *argv[])
     ("fixTimes,F", bpo::value<int>(), "Fix broken time-stamps old style (1), new style (2, default), or not (0)")
     ("doCheckCRC,C", bpo::value<int>(), "Check the CRCs: (0) no check, (1,default) check header.")
     ("bufferSize,B", bpo::value<int>(), "Size of the input buffer, [frames] (default=50000, about 100MB).")
+    ("recvBatch", bpo::value<int>(), "Maximum number of datagrams to fetch with one system call (default=32).")
+    ("socketBuffer", bpo::value<int>(), "Size of the socket receive buffers, [MByte] (default: system default).")
+    ("workers", bpo::value<int>(), "Number of worker threads processing the frames (default=0: no extra threads).")
+    ("storage", bpo::value<std::string>(), "Storage preset of the dipole datasets: default, fast or compact.")
+    ("chunkSize", bpo::value<int>(), "Chunk size of the dipole datasets, [samples] (overrides --storage).")
+    ("compression", bpo::value<std::string>(), "Compression: none, deflate, lzf or szip (overrides --storage).")
+    ("compressionLevel", bpo::value<int>(), "Compression level (1-9) of the deflate filter (overrides --storage).")
+    ("shuffle", bpo::value<int>(), "Apply (1) the shuffle filter before compressing, or not (0) (overrides --storage).")
+    ("access", bpo::value<std::string>(), "HDF5 file access preset: default, ingest, sequential-read or random-read.")
+    ("stripeSize", bpo::value<int>(), "Align large objects to this file system stripe size, [MByte] (overrides --access).")
+    ("driver", bpo::value<std::string>(), "HDF5 file driver: sec2, core or direct (overrides --access).")
     ("keepRunning,K", "Keep running, i.e. process more than one event by restarting the procedure.")
     ("waitForAll,W", "Wait until (some) data was received on all ports.")
     ("multipeStations,M", "Process data from multiple stations into seperate files. (implies -K)")
@@ -1321,6 +1757,72 @@ int main(int argc, char *argv[])
     input_buffer_size = vm["bufferSize"].as<int>();
   }
 
+  if (vm.count("recvBatch"))
+  {
+    recv_batch_size = vm["recvBatch"].as<int>();
+  }
+
+  if (vm.count("socketBuffer"))
+  {
+    socket_buffer_size = vm["socketBuffer"].as<int>()*1024*1024;
+  }
+
+  if (vm.count("workers"))
+  {
+    nof_worker_threads = vm["workers"].as<int>();
+  }
+
+  // The preset first, so the other storage options can override it
+  if (vm.count("storage") && !storage_policy.setPreset(vm["storage"].as<std::string>()))
+  {
+    cout << "[TBBraw2h5] Unknown storage preset: " << vm["storage"].as<std::string>() << endl;
+    return 1;
+  }
+
+  if (vm.count("chunkSize") && !storage_policy.setChunkSize(vm["chunkSize"].as<int>()))
+  {
+    cout << "[TBBraw2h5] Invalid chunk size: " << vm["chunkSize"].as<int>() << endl;
+    return 1;
+  }
+
+  if (vm.count("compression") && !storage_policy.setCompression(vm["compression"].as<std::string>()))
+  {
+    cout << "[TBBraw2h5] Unknown compression: " << vm["compression"].as<std::string>() << endl;
+    return 1;
+  }
+
+  if (vm.count("compressionLevel") && !storage_policy.setCompressionLevel(vm["compressionLevel"].as<int>()))
+  {
+    cout << "[TBBraw2h5] Invalid compression level: " << vm["compressionLevel"].as<int>() << endl;
+    return 1;
+  }
+
+  if (vm.count("shuffle"))
+  {
+    storage_policy.setShuffle(vm["shuffle"].as<int>() != 0);
+  }
+
+  // Same for the file access settings
+  if (vm.count("access") && !access_profile.setPreset(vm["access"].as<std::string>()))
+  {
+    cout << "[TBBraw2h5] Unknown access preset: " << vm["access"].as<std::string>() << endl;
+    return 1;
+  }
+
+  if (vm.count("stripeSize") &&
+      (vm["stripeSize"].as<int>() < 1 ||
+       !access_profile.setAlignment(64*1024, hsize_t(vm["stripeSize"].as<int>())*1024*1024)))
+  {
+    cout << "[TBBraw2h5] Invalid stripe size: " << vm["stripeSize"].as<int>() << endl;
+    return 1;
+  }
+
+  if (vm.count("driver") && !access_profile.setDriver(vm["driver"].as<std::string>()))
+  {
+    cout << "[TBBraw2h5] Unknown file driver: " << vm["driver"].as<std::string>() << endl;
+    return 1;
+  }
+
   //________________________________________________________
   // Check the provided input
 
@@ -1344,6 +1846,12 @@ int main(int argc, char *argv[])
     input_buffer_size = 50000;
   };
 
+  if (recv_batch_size < 1)
+  {
+    cout << "[TBBraw2h5] Receive batch size too small ("<< recv_batch_size << "<1), setting to 1" << endl;
+    recv_batch_size = 1;
+  };
+
   if (keepRunning && !socketmode)
   {
     cout << "[TBBraw2h5] KeepRunning only usefull in socketmode, option disabled!" << endl;
@@ -1360,6 +1868,16 @@ int main(int argc, char *argv[])
     std::cout << "-- CRC checking   = " << doCheckCRC        << std::endl;
     std::cout << "-- Fix Times      = " << fixTransientTimes << std::endl;
     std::cout << "-- Raise Priority = " << raiseIOprio       << std::endl;
+    std::cout << "-- Worker threads = " << nof_worker_threads << std::endl;
+    std::cout << "-- Chunk size     = " << storage_policy.chunkSize() << std::endl;
+    std::cout << "-- Compression    = "
+              << DAL::HDF5StoragePolicy::compressionName(storage_policy.compression())
+              << " (level " << storage_policy.compressionLevel()
+              << ", shuffle " << storage_policy.shuffle() << ")" << std::endl;
+    std::cout << "-- Chunk cache    = " << access_profile.chunkCacheBytes() << " Bytes" << std::endl;
+    std::cout << "-- Alignment      = " << access_profile.alignment() << " Bytes" << std::endl;
+    std::cout << "-- File driver    = "
+              << DAL::HDF5AccessProfile::driverName(access_profile.driver()) << std::endl;
     if (socketmode) {
       std::cout << "-- IP address      = " << ip              << std::endl;
       std::cout << "-- Port numbers    = " << ports           << std::endl;
@@ -1368,6 +1886,8 @@ int main(int argc, char *argv[])
       std::cout << "-- Wait for ports  = " << waitForAll      << std::endl;
       std::cout << "-- Keep Running    = " << keepRunning     << std::endl;
       std::cout << "-- Multipe Stations= " << multipeStations << std::endl;
+      std::cout << "-- Receive batch   = " << recv_batch_size << std::endl;
+      std::cout << "-- Socket buffer   = " << socket_buffer_size << std::endl;
     }
     else {
       std::cout << "-- Input file   = " << infile  << std::endl;
@@ -1450,7 +1970,7 @@ int main(int argc, char *argv[])
     // -----------------------------------------------------------------
     // Generate TBBraw object and open output file
 
-    tbb = new DAL::TBBraw(outfile);
+    tbb = new DAL::TBBraw(outfile, "UNDEFINED", "UNDEFINED", "UNDEFINED", "UNDEFINED", "LOFAR", "UNDEFINED", access_profile);
     if ( !tbb->isConnected() )
     {
       cout << "[TBBraw2h5] Failed to open output file." << endl;
@@ -1467,6 +1987,10 @@ int main(int argc, char *argv[])
       tbb->doHeaderCRC(false);
     };
     tbb->setFixTimes(fixTransientTimes);
+    tbb->setStoragePolicy(storage_policy);
+    if (nof_worker_threads > 0) {
+      tbb->startPipeline(nof_worker_threads);
+    };
 
     // -----------------------------------------------------------------
     // call the conversion routines
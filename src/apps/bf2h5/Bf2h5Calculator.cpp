@@ -19,15 +19,15 @@
  ***************************************************************************/
 
 #include <iostream>
+#include <algorithm>
+#include <unistd.h>
+#include <data_hl/BFRawStokes.h>
 #include "Bf2h5Calculator.h"
 #include "bf2h5.h"
 
 using std::cout;
 using std::cerr;
 using std::endl;
-using std::real;
-using std::imag;
-using std::bad_alloc;
 
 namespace DAL { // Namespace DAL -- begin
   
@@ -41,41 +41,60 @@ namespace DAL { // Namespace DAL -- begin
     \param its_parent         -- Pointer to the parent object from which the 
     calculator is called.
     \param nofSubbands        -- The number of subbands.
-    \param nr_samples_subband -- 
+    \param nr_samples_subband -- The number of samples per subband in a data
+    block.
+    \param nofThreads         -- The number of calculation threads; if 0, one
+    thread per core is used (see defaultNofThreads()).
   */
   Bf2h5Calculator::Bf2h5Calculator (BF2H5 *its_parent,
 				    uint8_t nofSubbands,
-				    uint32_t nr_samples_subband)
+				    uint32_t nr_samples_subband,
+				    unsigned int nofThreads)
     : level(0),
+      itsPendingTasks(0),
       itsParent(its_parent),
       nrOfSubbands(nofSubbands), 
       nrSamplesPerSubband(nr_samples_subband),
-      checking_completeness(false),
+      itsNextWorker(0),
       itsStopProcessing(false),
-      currentBlockNr(0)
+      itsOutputPool(0)
   {
-    pthread_mutex_init(&calculationMapMutex, 0);
-    pthread_cond_init(&condition, 0);
+    pthread_mutex_init(&idleMutex, 0);
+    pthread_cond_init(&workAvailable, 0);
+    pthread_mutex_init(&blockMutex, 0);
     
-    itsDownSampleFactor = itsParent->getDownSampleFactor();
+    itsOutputMode    = itsParent->getOutputMode();
+    itsNofComponents = nofComponents(itsOutputMode);
+    
+    /* Complex voltages are written at the original time resolution */
+    if (itsOutputMode == StokesXXYY) {
+      itsDownSampleFactor = 1;
+    } else {
+      itsDownSampleFactor = itsParent->getDownSampleFactor();
+    }
     itsSingleSubbandNrOutputSamples = nr_samples_subband / itsDownSampleFactor;
     
-    for (unsigned short i = 0; i < NUM_CALCULATION_THREADS; ++i) {
-      thread_data_array[i].busy                = false;
-      //		thread_data_array[i].threadID = 0;
-      thread_data_array[i].blockNr             = 0;
-      thread_data_array[i].subbandNr           = 0;
-      thread_data_array[i].input_data          = 0;
-      thread_data_array[i].subband_output_data = 0;
-      thread_data_array[i].This                = this;
+    if (nofThreads == 0) {
+      nofThreads = defaultNofThreads();
     }
     
-    subbandReady = new bool [nrOfSubbands];
-    for (uint8_t i=0; i < nrOfSubbands; ++i) {
-      subbandReady[i] = false;
+    for (unsigned int i = 0; i < nofThreads; ++i) {
+      worker *w    = new worker;
+      w->This      = this;
+      w->index     = i;
+      w->busy      = false;
+      w->blockNr   = 0;
+      w->subbandNr = 0;
+      w->nofTasks  = 0;
+      w->nofStolen = 0;
+      pthread_mutex_init(&(w->mutex), 0);
+      itsWorkers.push_back(w);
     }
     
-    allocateMemory();
+    /* Split a block in a few tasks per thread, such that idle threads can
+       steal work from threads that fall behind */
+    unsigned int nofTasks = NUM_TASKS_PER_THREAD * nofThreads;
+    itsSubbandsPerTask = std::max(1u, (nrOfSubbands + nofTasks - 1) / nofTasks);
   }
   
   // ==============================================================================
@@ -85,17 +104,14 @@ namespace DAL { // Namespace DAL -- begin
   // ==============================================================================
   
   Bf2h5Calculator::~Bf2h5Calculator() {
-    pthread_mutex_destroy(&calculationMapMutex);
-    pthread_cond_destroy(&condition);
-    //	cout << "destructor Bf2h5Calculator executing" << endl;
-    delete [] subbandReady;
-    //	cout << "deleted subbandReady array" << endl;
-    for (uint8_t i=0; i < nrOfSubbands; ++i) {
-      delete [] dataBlockOutput[i];
-      //			cout << "deleted dataBlockOutput[" << static_cast<int>(i) << "]" << endl;
+    for (unsigned int i = 0; i < itsWorkers.size(); ++i) {
+      pthread_mutex_destroy(&(itsWorkers[i]->mutex));
+      delete itsWorkers[i];
     }
-    delete [] dataBlockOutput;
-    //	cout << "deleted dataBlockOutput array" << endl;
+    pthread_mutex_destroy(&idleMutex);
+    pthread_cond_destroy(&workAvailable);
+    pthread_mutex_destroy(&blockMutex);
+    delete itsOutputPool;
   }
   
   // ==============================================================================
@@ -104,93 +120,183 @@ namespace DAL { // Namespace DAL -- begin
   //
   // ==============================================================================
   
-  void Bf2h5Calculator::allocateMemory(void) {
-    // allocate memory for output data buffers
-    try {
-#ifdef DAL_DEBUGGING_MESSAGES
-      std::cout << "Allocating " << nrOfSubbands * itsSingleSubbandNrOutputSamples * sizeof(float) << " bytes for downsampled data..." << std::endl;
-#endif
-      
-      dataBlockOutput = new float * [nrOfSubbands];
-      for (uint8_t i = 0; i < nrOfSubbands; ++i) {
-	dataBlockOutput[i] = new float [itsSingleSubbandNrOutputSamples];
-	memset(dataBlockOutput[i], 0, itsSingleSubbandNrOutputSamples * sizeof(float));
-      }
-    }
-    catch (bad_alloc)
-      {
-	cerr << "Bf2h5Calculator: Could not allocate memory." << endl;
-	return;
-      }
-    return;
-  }
+  //_______________________________________________________________________________
+  //                                                              defaultNofThreads
   
-  /*
-    void Bf2h5Calculator::wakeUpCall(void) {
-    pthread_mutex_lock (&calculationMapMutex);
-    pthread_cond_broadcast(&condition);
-    pthread_mutex_unlock(&calculationMapMutex);
-    }
+  /*!
+    \return nofThreads -- The number of online processors, or 1 if it cannot be
+    determined.
   */
+  unsigned int Bf2h5Calculator::defaultNofThreads (void)
+  {
+    long nofCores = sysconf(_SC_NPROCESSORS_ONLN);
+    return nofCores > 0 ? nofCores : 1;
+  }
   
   //_______________________________________________________________________________
-  //                                                             calculateDataBlock
+  //                                                                  nofComponents
   
-  // CalculateDataBlock adds a datablock for writing
-  void Bf2h5Calculator::calculateDataBlock (long int blockNr,
-					    BFRawFormat::Sample *sampleData)
+  /*!
+    \param mode -- Output mode.
+
+    \return nofComponents -- The number of arrays the calculator computes per
+    subband in output mode \e mode.
+  */
+  unsigned int Bf2h5Calculator::nofComponents (OutputMode const &mode)
   {
-    std::pair<unsigned int, BFRawFormat::Sample *> dataPair;
-    pthread_mutex_lock (&calculationMapMutex);
-    for (uint8_t subband = 0; subband < nrOfSubbands; ++subband) {
-      dataPair.first = subband;
-      dataPair.second = &(sampleData[ subband * nrSamplesPerSubband]);
-      //	itsData.insert(std::pair<unsigned int, std::pair<unsigned int, BFRawFormat::Sample *> >(blockNr, dataPair));
-      itsData[blockNr].push_back(dataPair);
+    switch (mode) {
+    case StokesIQUV:
+    case StokesXXYY:
+      return 4;
+    default:
+      return 1;
     }
-    level += nrOfSubbands;
-    pthread_cond_broadcast(&condition);
-    pthread_mutex_unlock(&calculationMapMutex);
-    return;
   }
   
-  /*
-    bool Bf2h5Calculator::unscheduledDataLeft(void) {
-    pthread_mutex_lock (&calculationMapMutex);
-    for (calculationMap::const_iterator it = itsData.begin(); it != itsData.end(); ++it) {
-    if (!(it->second.empty())) {
-    pthread_mutex_unlock(&calculationMapMutex);
-    return true;
+  //_______________________________________________________________________________
+  //                                                                     outputMode
+  
+  /*!
+    \param name -- Name of the output mode: \e I, \e IQUV or \e XXYY.
+    \param mode -- The matching output mode.
+
+    \return status -- Returns \e false if \e name is not a known output mode.
+  */
+  bool Bf2h5Calculator::outputMode (std::string const &name,
+				    OutputMode &mode)
+  {
+    if (name == "I") {
+      mode = StokesI;
+    } else if (name == "IQUV") {
+      mode = StokesIQUV;
+    } else if (name == "XXYY") {
+      mode = StokesXXYY;
+    } else {
+      return false;
     }
+    return true;
+  }
+  
+  //_______________________________________________________________________________
+  //                                                                 allocateMemory
+  
+  /*!
+    Allocates the pool of output buffers; has to be called before the first
+    data block is passed to calculateDataBlock().
+
+    \return status -- Returns \e false if the output buffers could not be
+    allocated.
+  */
+  bool Bf2h5Calculator::allocateMemory(void) {
+    // allocate memory for output data buffers, one per block in flight
+    unsigned int nofBuffers = itsParent->nofBuffers() * itsParent->nofStations();
+    itsSubbandOutputSize    = size_t(itsNofComponents) * itsSingleSubbandNrOutputSamples;
+    size_t bufferSize       = itsSubbandOutputSize * nrOfSubbands * sizeof(float);
+#ifdef DAL_DEBUGGING_MESSAGES
+    std::cout << "Allocating " << nofBuffers * bufferSize << " bytes for downsampled data..." << std::endl;
+#endif
+    
+    itsOutputPool = new BufferPool ("output",
+				    nofBuffers,
+				    bufferSize,
+				    itsParent->bufferPolicy(),
+				    itsParent->useHugePages());
+    if (!itsOutputPool->isValid()) {
+      cerr << "Bf2h5Calculator: Could not allocate memory." << endl;
+      return false;
     }
-    pthread_mutex_unlock(&calculationMapMutex);
-    return false;
+    return true;
+  }
+  
+  //_______________________________________________________________________________
+  //                                                             calculateDataBlock
+  
+  /*!
+    Splits the data block into tasks of nofSubbandsPerTask() subbands and
+    distributes them over the queues of the calculation threads. Waits for an
+    output buffer if all of them are in use, unless the buffer policy is to
+    drop the block. May be called concurrently by the readers of the stations.
+
+    \param station    -- Index of the station the block belongs to.
+    \param blockNr    -- Number of the data block.
+    \param sampleData -- The data of the block, [subband][sample].
+
+    \return status -- Returns \e false if the block was dropped, in which case
+    blockComplete() of the parent will not be called for it.
+  */
+  bool Bf2h5Calculator::calculateDataBlock (unsigned int station,
+					    long int blockNr,
+					    BFRawFormat::Sample *sampleData)
+  {
+    /* Get an output buffer; one reference for the calculator, one for the writer */
+    int outputBuffer = itsOutputPool->acquire();
+    if (outputBuffer < 0) {
+      return false;
     }
+    itsOutputPool->retain(outputBuffer);
+    pthread_mutex_lock (&blockMutex);
+    itsWriterBuffers[blockKey(station, blockNr)] = outputBuffer;
+    pthread_mutex_unlock(&blockMutex);
     
+    unsigned int nofWorkers = itsWorkers.size();
+    blockState *block   = new blockState;
+    block->station      = station;
+    block->blockNr      = blockNr;
+    block->remaining    = (nrOfSubbands + itsSubbandsPerTask - 1) / itsSubbandsPerTask;
+    block->outputBuffer = outputBuffer;
+    block->output       = reinterpret_cast<float *>(itsOutputPool->buffer(outputBuffer));
     
-    bool Bf2h5Calculator::stillProcessing(void) {
-    if (unscheduledDataLeft()) {
-    return true;
+    __sync_add_and_fetch(&level, block->remaining);
+    
+    calculationTask task;
+    task.block = block;
+    for (unsigned int subband = 0; subband < nrOfSubbands; subband += itsSubbandsPerTask) {
+      task.firstSubband = subband;
+      task.nofSubbands  = std::min(itsSubbandsPerTask, nrOfSubbands - subband);
+      task.input_data   = &(sampleData[subband * nrSamplesPerSubband]);
+      
+      worker *w = itsWorkers[__sync_fetch_and_add(&itsNextWorker, 1) % nofWorkers];
+      pthread_mutex_lock (&(w->mutex));
+      w->tasks.push_back(task);
+      pthread_mutex_unlock(&(w->mutex));
+      __sync_add_and_fetch(&itsPendingTasks, 1);
     }
-    // now also check if all threads are finished processing
-    for (unsigned short i = 0; i < NUM_CALCULATION_THREADS; ++i) { 
-    if (thread_data_array[i].busy == true) {
+    
+    /* Wake up idle threads */
+    pthread_mutex_lock (&idleMutex);
+    pthread_cond_broadcast(&workAvailable);
+    pthread_mutex_unlock(&idleMutex);
     return true;
-    }
-    }
-    return false;
-    }
+  }
+  
+  //_______________________________________________________________________________
+  //                                                                   blockWritten
+  
+  /*!
+    Releases the reference of the writer on the output buffer of the block. The
+    writer may skip blocks the calculator never received, which is no error.
+
+    \param station -- Index of the station the block belongs to.
+    \param blockNr -- Number of the data block.
   */
+  void Bf2h5Calculator::blockWritten (unsigned int station,
+				      long int blockNr)
+  {
+    pthread_mutex_lock (&blockMutex);
+    std::map<blockKey, int>::iterator it = itsWriterBuffers.find(blockKey(station, blockNr));
+    if (it != itsWriterBuffers.end()) {
+      itsOutputPool->release(it->second);
+      itsWriterBuffers.erase(it);
+    }
+    pthread_mutex_unlock(&blockMutex);
+  }
   
   //_______________________________________________________________________________
   //                                                                stillProcessing
   
   bool Bf2h5Calculator::stillProcessing(void)
   {
-    /* This should actually be done while mutex is locked, but because the answer
-       may lag a bit with reality it's no problem, and speeds up the processing at
-       the end (when the reader is already done, see bf2h5.cpp) 
-    */
+    /* The answer may lag a bit with reality, which is no problem, see bf2h5.cpp */
     return ((level > 0));
   }
   
@@ -209,14 +315,14 @@ namespace DAL { // Namespace DAL -- begin
 #ifdef DAL_DEBUGGING_MESSAGES
     cout << "Stopping the calculator" << endl;
 #endif 
-    pthread_mutex_lock (&calculationMapMutex);
+    pthread_mutex_lock (&idleMutex);
     itsStopProcessing = true;
-    level = 10;
-    pthread_cond_broadcast(&condition);
-    pthread_mutex_unlock (&calculationMapMutex);
-    //	cout << "trying to join calculator threads" << endl;
-    for (unsigned short threadIdx = 0; threadIdx < NUM_CALCULATION_THREADS; ++threadIdx) {
-      status = pthread_join (itsCalculationThread[threadIdx], &thread_result);
+    pthread_cond_broadcast(&workAvailable);
+    pthread_mutex_unlock (&idleMutex);
+    itsOutputPool->stop();
+    
+    for (unsigned int threadIdx = 0; threadIdx < itsWorkers.size(); ++threadIdx) {
+      status = pthread_join (itsWorkers[threadIdx]->thread, &thread_result);
       if (status != 0) {
 	std::cerr << "[Bf2h5Calculator::stop]" << " Calculator thread "
 		  << threadIdx << " returned " << status
@@ -224,7 +330,6 @@ namespace DAL { // Namespace DAL -- begin
 	bResult = false;
       }
       if (thread_result != NULL) {
-	//			cout << "calculator thread " << threadIdx << " non NULL result value" << endl;
 	bResult = false;
       }
     }
@@ -236,41 +341,31 @@ namespace DAL { // Namespace DAL -- begin
   
   std::string Bf2h5Calculator::whatAreYouDoing(void)
   {
-    //	pthread_mutex_lock (&calculationMapMutex);
-    for (calculationMap::const_iterator it = itsData.begin(); it != itsData.end(); ++it) {
-      if (!(it->second.empty())) {
-	char buf[10];
-	std::string ss("Calculator says: I am still processing block ");
-	sprintf(buf, "%ld, ", it->first);
-	ss += buf;
-	ss += " and subband(s) ";
-	
-	for (std::deque<std::pair<uint8_t, BFRawFormat::Sample *> >::const_iterator cit = it->second.begin();
-	     cit != it->second.end(); ++cit) {
-	  sprintf(buf, "%u, ", cit->first);
-	  ss += buf;
-	}
-	pthread_mutex_unlock(&calculationMapMutex);
-	return ss;
-      }
-    }
-    //	pthread_mutex_unlock(&calculationMapMutex);
+    char buf[32];
     
-    for (unsigned short i = 0; i < NUM_CALCULATION_THREADS; ++i) {
-      if (thread_data_array[i].busy == true) {
-	char buf[10];
+    for (unsigned int i = 0; i < itsWorkers.size(); ++i) {
+      if (itsWorkers[i]->busy == true) {
 	std::string ss("Calculator says: my thread ");
-	sprintf(buf, "%d", i);
+	sprintf(buf, "%u", i);
 	ss += buf;
 	ss += " is still processing block ";
-	sprintf(buf, "%ld", thread_data_array[i].blockNr);
+	sprintf(buf, "%ld", itsWorkers[i]->blockNr);
 	ss += buf;
 	ss += " and subband ";
-	sprintf(buf, "%u", thread_data_array[i].subbandNr);
+	sprintf(buf, "%u", itsWorkers[i]->subbandNr);
 	ss += buf;
 	return ss;
       }
     }
+    
+    if (itsPendingTasks > 0) {
+      std::string ss("Calculator says: I still have ");
+      sprintf(buf, "%d", itsPendingTasks);
+      ss += buf;
+      ss += " task(s) waiting to be processed";
+      return ss;
+    }
+    
     return std::string("Calculator says: I don't know what I am doing, but I'm surely busy with something...");
   }
   
@@ -279,151 +374,183 @@ namespace DAL { // Namespace DAL -- begin
   
   void Bf2h5Calculator::startProcessing(void)
   {
-  // start the calculation threads
-  for (unsigned short threadIdx = 0; threadIdx < NUM_CALCULATION_THREADS; ++threadIdx) {
-    if (pthread_create(&itsCalculationThread[threadIdx], NULL, startInternalThread, (void *) &thread_data_array[threadIdx]) != 0) {
-      cerr << "Bf2h5Calculator::startProcessing, ERROR, could not start calculation thread " << static_cast<int>(threadIdx) << endl;
+    // start the calculation threads
+    for (unsigned int threadIdx = 0; threadIdx < itsWorkers.size(); ++threadIdx) {
+      if (pthread_create(&(itsWorkers[threadIdx]->thread), NULL, startInternalThread, (void *) itsWorkers[threadIdx]) != 0) {
+	cerr << "Bf2h5Calculator::startProcessing, ERROR, could not start calculation thread " << threadIdx << endl;
+      }
     }
   }
-}
-
-//_______________________________________________________________________________
-//                                                      doDownSampleSingleSubband
-
-void * Bf2h5Calculator::doDownSampleSingleSubband (void *threaddata)
-{
-  thread_data *tdata(0);
   
-  while(!itsStopProcessing) {
+  //_______________________________________________________________________________
+  //                                                                        getTask
+  
+  /*!
+    \param w    -- The calculation thread asking for work.
+    \param task -- The task to be processed.
+
+    \return found -- \e true if a task was taken from one of the queues.
+  */
+  bool Bf2h5Calculator::getTask (worker *w,
+				 calculationTask &task)
+  {
+    unsigned int nofWorkers = itsWorkers.size();
     
-    pthread_mutex_lock(&calculationMapMutex);
-    while ((level < 1) && (!itsStopProcessing))
-      pthread_cond_wait(&condition, &calculationMapMutex);
+    /* Newest task of the own queue, its input data are most likely in cache */
+    pthread_mutex_lock (&(w->mutex));
+    if (!w->tasks.empty()) {
+      task = w->tasks.back();
+      w->tasks.pop_back();
+      pthread_mutex_unlock(&(w->mutex));
+      __sync_sub_and_fetch(&itsPendingTasks, 1);
+      return true;
+    }
+    pthread_mutex_unlock(&(w->mutex));
     
-    if ((level > 0) && (!itsStopProcessing)) {
-      // grab one subband of the data
-      tdata = reinterpret_cast<thread_data *>(threaddata);
-      calculationMap::iterator firstBlock = itsData.find(currentBlockNr);
-      if (firstBlock != itsData.end()) {
-	std::deque<std::pair<uint8_t, BFRawFormat::Sample *> > &blockDeque = firstBlock->second;
-	tdata->busy = true;
-	tdata->blockNr = firstBlock->first;
-	tdata->subbandNr = blockDeque.front().first;
-	tdata->input_data = blockDeque.front().second;
-	tdata->subband_output_data = dataBlockOutput[tdata->subbandNr];
-	blockDeque.pop_front();
-	if (blockDeque.empty()) {
-	  itsData.erase(itsData.begin());
-	}
-	--level;
-	pthread_mutex_unlock(&calculationMapMutex);
-	
-	// do the actual processing of the data (mutex is unlocked)
-	uint32_t xx_intensity(0), yy_intensity(0);
-	uint64_t start(0);
-	
-	for ( uint32_t count = 0; count < itsSingleSubbandNrOutputSamples; ++count ) // count loops over all output samples
-	  {
-	    tdata->subband_output_data[count] = 0;
-	    for ( uint64_t idx = start; idx < (start + itsDownSampleFactor); ++idx ) // loop over nr of samples defined by downsampling factor
-	      {
-		xx_intensity = (uint32_t)(real(tdata->input_data[ idx ].xx) * real(tdata->input_data[ idx ].xx) +
-					  imag(tdata->input_data[ idx ].xx) * imag(tdata->input_data[ idx ].xx) ); // this will be max 33 bits integer
-		yy_intensity = (uint32_t)(real(tdata->input_data[ idx ].yy) * real(tdata->input_data[ idx ].yy) +
-					  imag(tdata->input_data[ idx ].yy) * imag(tdata->input_data[ idx ].yy) );
-		tdata->subband_output_data[count] += (float)xx_intensity + (float)yy_intensity;
-		//TODO: check if this intensity data needs to be divided by itsDownSampleFactor to get averaged value
-	      }
-	    start += itsDownSampleFactor;
-	  }
-	
-	//  keep track of finished subbands
-	itsParent->calculatorDataReady(tdata->blockNr, tdata->subbandNr, tdata->subband_output_data); // signal itsParent app to write the data
-	subbandReady[tdata->subbandNr] = true;
-	checkIfBlockComplete(); // TODO: do this somewhere else?
-	tdata->busy = false;
+    /* Steal the oldest task from one of the other threads */
+    for (unsigned int n = 1; n < nofWorkers; ++n) {
+      worker *victim = itsWorkers[(w->index + n) % nofWorkers];
+      pthread_mutex_lock (&(victim->mutex));
+      if (!victim->tasks.empty()) {
+	task = victim->tasks.front();
+	victim->tasks.pop_front();
+	pthread_mutex_unlock(&(victim->mutex));
+	__sync_sub_and_fetch(&itsPendingTasks, 1);
+	++(w->nofStolen);
+	return true;
       }
-      else { // didn't find data for current block
-        pthread_mutex_unlock(&calculationMapMutex);
-        return 0;
-      }
-    }
-    else {
-      pthread_mutex_unlock(&calculationMapMutex);
-      return 0;
+      pthread_mutex_unlock(&(victim->mutex));
     }
+    
+    return false;
   }
-  return 0;
-}
-
-//_______________________________________________________________________________
-//                                                           checkIfBlockComplete
-
-void Bf2h5Calculator::checkIfBlockComplete (void) {
-  while (1) {
-    if (!checking_completeness) { // added for thread safety (it could be that a thread becomes ready when just checking completeness for another thread, then we have to wait for the first check to complete before doing the next check
-      checking_completeness = true;
-      for (uint8_t i=0; i < nrOfSubbands; ++i) {
-	if (subbandReady[i] == false) {
-	  checking_completeness = false;
-	  return; // we are not ready with the current block
+  
+  //_______________________________________________________________________________
+  //                                                                   doDownSample
+  
+  void * Bf2h5Calculator::doDownSample (worker *w)
+  {
+    calculationTask task;
+    
+    while (!itsStopProcessing) {
+      
+      if (!getTask(w, task)) {
+	/* Nothing to do: sleep until new tasks are submitted */
+	pthread_mutex_lock (&idleMutex);
+	while ((itsPendingTasks < 1) && (!itsStopProcessing)) {
+	  pthread_cond_wait(&workAvailable, &idleMutex);
 	}
+	pthread_mutex_unlock(&idleMutex);
+	continue;
       }
       
-      // apparently all subbands for this block are done
-      for (uint8_t i=0; i < nrOfSubbands; ++i) { // set subbandReady array to all false for next data block
-	subbandReady[i] = false;
+      w->blockNr = task.block->blockNr;
+      w->busy    = true;
+      
+      for (uint8_t n = 0; n < task.nofSubbands; ++n) {
+	uint8_t subband = task.firstSubband + n;
+	float *output   = task.block->output + subband * itsSubbandOutputSize;
+	w->subbandNr = subband;
+	downSampleSubband(task.input_data + n * nrSamplesPerSubband, output);
+	itsParent->calculatorDataReady(task.block->station, task.block->blockNr, subband, output); // signal itsParent app to write the data
       }
-      //lastReadyBlock = currentBlockNr++;
-      itsParent->blockComplete(++currentBlockNr); // signal parent
-      checking_completeness = false;
-      return;
+      
+      ++(w->nofTasks);
+      w->busy = false;
+      taskFinished(task);
     }
-    usleep(100);
+    return 0;
   }
-}
-
-//_______________________________________________________________________________
-//                                                                     showStatus
+  
+  //_______________________________________________________________________________
+  //                                                              downSampleSubband
+  
+  /*!
+    The Stokes parameters of an output sample are the sum -- not the mean --
+    over \e itsDownSampleFactor input samples, as written by bf2h5 all along;
+    the factor is stored in the DOWNSAMPLE_RATE attribute, such that readers
+    can convert to the mean.
 
-void Bf2h5Calculator::showStatus(void)
-{
-  if (!itsStopProcessing) {
-    cout << "Calculator busy with block: " << currentBlockNr << endl;
-  }
-  else {
-    cout << "Calculator has stopped, status of its threads and data follow below" << endl;
-  }
-  for (unsigned short threadIdx = 0; threadIdx < NUM_CALCULATION_THREADS; ++threadIdx) {
-    cout << "thread[" << threadIdx << "]";
-    if (thread_data_array[threadIdx].busy == true) {
-      cout << " is busy with: block=" << thread_data_array[threadIdx].blockNr << ", subband=" << thread_data_array[threadIdx].subbandNr << ", input data 1st sample xx=" << thread_data_array[threadIdx].input_data->xx << ", yy=" << thread_data_array[threadIdx].input_data->yy << endl;
+    \param input_data  -- The samples of a single subband.
+    \param output_data -- Buffer for the output components of the subband,
+    [component][sample].
+  */
+  void Bf2h5Calculator::downSampleSubband (BFRawFormat::Sample const *input_data,
+					   float *output_data)
+  {
+    uint32_t n = itsSingleSubbandNrOutputSamples;
+    
+    switch (itsOutputMode) {
+    case StokesIQUV:
+      stokesIQUV (input_data, n, itsDownSampleFactor,
+		  output_data, output_data + n, output_data + 2*n, output_data + 3*n);
+      break;
+    case StokesXXYY:
+      for (uint32_t i = 0; i < n; ++i) {
+	output_data[i]     = input_data[i].xx.real();
+	output_data[n+i]   = input_data[i].xx.imag();
+	output_data[2*n+i] = input_data[i].yy.real();
+	output_data[3*n+i] = input_data[i].yy.imag();
+      }
+      break;
+    default:
+      stokesI (input_data, n, itsDownSampleFactor, output_data);
+      break;
     }
-    else {
-      cout << "is idle." << endl;
+  }
+  
+  //_______________________________________________________________________________
+  //                                                                   taskFinished
+  
+  /*!
+    The thread finishing the last task of a block signals the parent that the
+    input buffer of the block can be re-used, and releases the reference of the
+    calculator on the output buffer of the block.
+
+    \param task -- The task that has been processed.
+  */
+  void Bf2h5Calculator::taskFinished (calculationTask const &task)
+  {
+    if (__sync_sub_and_fetch(&(task.block->remaining), 1) == 0) {
+      itsParent->blockComplete(task.block->station, task.block->blockNr); // signal parent
+      itsOutputPool->release(task.block->outputBuffer);
+      delete task.block;
     }
+    __sync_sub_and_fetch(&level, 1);
   }
-  cout << "writemap contains: " << endl;
-  pthread_mutex_lock (&calculationMapMutex);
-  for (calculationMap::const_iterator it = itsData.begin(); it != itsData.end(); ++it) {
-    cout << "block " << it->first;
-    if (it->second.empty()) {
-      cout << " has no subbands left" << endl;
+  
+  //_______________________________________________________________________________
+  //                                                                     showStatus
+  
+  void Bf2h5Calculator::showStatus(void)
+  {
+    if (!itsStopProcessing) {
+      cout << "Calculator and writer hold " << itsOutputPool->nofInUse() << " output buffer(s)" << endl;
     }
     else {
-      cout << ", subbands: ";
-      for (std::deque<std::pair<uint8_t, BFRawFormat::Sample *> >::const_iterator cit = it->second.begin(); cit != it->second.end(); ++cit) {
-	cout << static_cast<int>(cit->first) << ",";
-      }
+      cout << "Calculator has stopped, status of its threads and data follow below" << endl;
     }
-  }
-  pthread_mutex_unlock(&calculationMapMutex);
-  cout << "subband(s) that still need processing for the current block: " << endl;
-  for (uint8_t i=0; i < nrOfSubbands; ++i) {
-    if (subbandReady[i] == false) {
-      cout << static_cast<int>(i) << ",";
+    for (unsigned int threadIdx = 0; threadIdx < itsWorkers.size(); ++threadIdx) {
+      worker *w = itsWorkers[threadIdx];
+      cout << "thread[" << threadIdx << "]";
+      if (w->busy == true) {
+	cout << " is busy with: block=" << w->blockNr << ", subband=" << static_cast<int>(w->subbandNr);
+      }
+      else {
+	cout << " is idle";
+      }
+      pthread_mutex_lock (&(w->mutex));
+      cout << ", " << w->tasks.size() << " task(s) queued, "
+	   << w->nofTasks << " processed, " << w->nofStolen << " stolen";
+      if (!w->tasks.empty()) {
+	cout << ", queued blocks: ";
+	for (std::deque<calculationTask>::const_iterator it = w->tasks.begin(); it != w->tasks.end(); ++it) {
+	  cout << it->block->blockNr << "[" << static_cast<int>(it->firstSubband) << "],";
+	}
+      }
+      pthread_mutex_unlock(&(w->mutex));
+      cout << endl;
     }
   }
-}
   
 } // Namespace DAL -- end
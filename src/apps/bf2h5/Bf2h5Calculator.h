@@ -25,18 +25,18 @@
 #define BF2H5CALCULATOR_H
 
 #include <pthread.h>
-#include <map>
 #include <deque>
+#include <map>
 #include <string>
+#include <vector>
 
 #include <data_hl/BFRawFormat.h>
+#include "BufferPool.h"
 
 class BF2H5;
-//                 block                               subband       pointer to data
-typedef std::map<long int, std::deque<std::pair<uint8_t, BFRawFormat::Sample *> > > calculationMap;
 
-#define NUM_CALCULATION_THREADS 4
-#define NUM_OUTPUT_BUFFERS 2
+//! Number of tasks per calculation thread each data block is split into
+#define NUM_TASKS_PER_THREAD 2
 
 namespace DAL { // Namespace DAL -- begin
   
@@ -47,34 +47,109 @@ namespace DAL { // Namespace DAL -- begin
     \ingroup dal_apps
     
     \author Alwin de Jong
+
+    <h3>Synopsis</h3>
+
+    The calculator downsamples the data blocks handed to it by
+    calculateDataBlock() on a number of calculation threads (by default one
+    per core). Each data block is split into tasks covering a range of
+    subbands, which are distributed over per-thread queues; a thread takes
+    the tasks from the back of its own queue and, once that is empty, steals
+    tasks from the front of the queues of the other threads. Threads
+    therefore only contend with each other when stealing. The number of
+    unfinished tasks of a block is counted down atomically; the thread
+    finishing the last task of a block signals the parent application.
+
+    Blocks may be submitted concurrently for a number of stations, each of
+    which numbers its blocks from zero; a block is identified by the index of
+    its station and its number.
+
+    The output of a block is stored in a buffer of the output BufferPool,
+    which holds the parent's number of buffers for each station. The buffer is referenced by the
+    calculator until the block has been computed and by the writer until the
+    block has been written (see blockWritten()); when the writer falls behind,
+    calculateDataBlock() therefore waits for it or drops the block, depending
+    on the buffer policy of the parent.
+
+    What is computed for each subband depends on the OutputMode of the parent
+    application. The output buffer of a subband holds nofComponents() arrays
+    of itsSingleSubbandNrOutputSamples values each, one per component:
+    <ul>
+      <li>\e Intensity, \e StokesI -- Stokes I
+      <li>\e StokesIQUV -- Stokes I, Q, U and V
+      <li>\e StokesXXYY -- real and imaginary part of X, real and imaginary
+      part of Y; these are not downsampled.
+    </ul>
   */
   class Bf2h5Calculator
   {
   public:
+
+    //! Data products computed by the calculator
+    enum OutputMode {
+      //! Total intensity, written to the per-subband tables of the dataset
+      Intensity,
+      //! Stokes I, written to a BF_StokesDataset
+      StokesI,
+      //! Stokes I, Q, U and V, written to four BF_StokesDatasets
+      StokesIQUV,
+      //! Complex voltages of the X and Y polarization, written to four BF_StokesDatasets
+      StokesXXYY
+    };
     
     // === Construction =========================================================
     
     //! Argumented constructor
     Bf2h5Calculator (BF2H5 *parent,
 		     uint8_t nofSubbands,
-		     uint32_t nr_samples_subband);
+		     uint32_t nr_samples_subband,
+		     unsigned int nofThreads=0);
     
     // === Destruction ==========================================================
     
     //! Default destructor
     ~Bf2h5Calculator();
     
+    // === Parameter access =====================================================
+
+    //! Get the number of calculation threads
+    inline unsigned int nofThreads (void) const {
+      return itsWorkers.size();
+    }
+
+    //! Get the number of subbands processed per task
+    inline unsigned int nofSubbandsPerTask (void) const {
+      return itsSubbandsPerTask;
+    }
+
+    //! Get the default number of calculation threads, i.e. the number of cores
+    static unsigned int defaultNofThreads (void);
+
+    //! Get the number of output components computed in output mode \e mode
+    static unsigned int nofComponents (OutputMode const &mode);
+
+    //! Get the output mode matching its name (I, IQUV or XXYY)
+    static bool outputMode (std::string const &name,
+			    OutputMode &mode);
+
     // === Methods ==============================================================
     
-    //! Allocate memory
-    void allocateMemory (void);
+    //! Allocate the output buffers
+    bool allocateMemory (void);
     
-    //! Calculate the numer of the data block
-    void calculateDataBlock (long int blockNr,
+    //! Calculate the data block \e blockNr of station \e station
+    bool calculateDataBlock (unsigned int station,
+			     long int blockNr,
 			     BFRawFormat::Sample *sampleData);
     
-    //! Signal that the subband has been written
-    void subbandWritten(/*unsigned int blockNr,*/ uint8_t subband);
+    //! Signal that the output of block \e blockNr of station \e station has been written
+    void blockWritten (unsigned int station,
+		       long int blockNr);
+
+    //! Get the pool holding the output buffers
+    inline BufferPool * outputPool (void) const {
+      return itsOutputPool;
+    }
     
     //! Enable the processing of datablock
     void startProcessing(void);
@@ -92,59 +167,116 @@ namespace DAL { // Namespace DAL -- begin
     void showStatus(void);
     
   private:
-    //		bool unscheduledDataLeft(void); // checks if there are still data blocks that need to be scheduled for processing
-    
-    //! Check if a complete block of subbands has been calculated
-    void checkIfBlockComplete (void);
     
+    //! Identifies a data block: index of the station, number of the block
+    typedef std::pair<unsigned int, long int> blockKey;
+
+    //! Book-keeping of the tasks of a data block
+    struct blockState
+    {
+      //! Index of the station the block belongs to
+      unsigned int station;
+      //! Number of the data block
+      long int blockNr;
+      //! Number of unfinished tasks; only changed through atomic operations
+      int remaining;
+      //! Handle of the output buffer of the block
+      int outputBuffer;
+      //! Output of the block, [subband][component][sample]
+      float *output;
+    };
+
+    //! Unit of work: downsampling of a range of subbands of a data block
+    struct calculationTask
+    {
+      //! The block the subbands belong to
+      blockState *block;
+      //! First subband of the range
+      uint8_t firstSubband;
+      //! Number of subbands in the range
+      uint8_t nofSubbands;
+      //! Pointer to the input data of the first subband
+      BFRawFormat::Sample *input_data;
+    };
+
     //! Each calculation thread uses one of these structs
-    struct thread_data
+    struct worker
     {
-      //! Is this thread currently being used?
-      bool busy;
+      //! The calculator the thread is working for
+      Bf2h5Calculator *This;
+      //! Index of the thread
+      unsigned int index;
+      //! The thread itself
+      pthread_t thread;
+      //! Protects the queue of tasks
+      pthread_mutex_t mutex;
+      //! Queue of tasks; the owner works at the back, thieves at the front
+      std::deque<calculationTask> tasks;
+      //! Is this thread currently processing a task?
+      volatile bool busy;
       //! Number of the block being processed
-      long int blockNr;
+      volatile long int blockNr;
       //! Number of the subband being processed by this thread
-      uint8_t subbandNr;
-      //! Pointer to the input data block
-      BFRawFormat::Sample *input_data;
-      float * subband_output_data; // pointer into output buffer where the calculated ata for this subband needs to be written
-      Bf2h5Calculator * This;
-    } thread_data_array[NUM_CALCULATION_THREADS];
+      volatile uint8_t subbandNr;
+      //! Number of tasks processed by this thread
+      unsigned long nofTasks;
+      //! Number of tasks this thread has stolen from other threads
+      unsigned long nofStolen;
+    };
     
     static void * startInternalThread(void * tData)
     {
-      reinterpret_cast<thread_data *>(tData)->This->doDownSampleSingleSubband(tData);
-      return NULL;
+      worker *w = reinterpret_cast<worker *>(tData);
+      return w->This->doDownSample(w);
     }
     
-    void * doDownSampleSingleSubband(void *); // the actual thread that does the downsample calculation for a single subband
+    //! Main loop of a calculation thread
+    void * doDownSample (worker *w);
+    //! Get the next task, from the own queue or from another thread
+    bool getTask (worker *w,
+		  calculationTask &task);
+    //! Compute the output components of a single subband
+    void downSampleSubband (BFRawFormat::Sample const *input_data,
+			    float *output_data);
+    //! Book-keeping after a task has been processed
+    void taskFinished (calculationTask const &task);
     
   private:
     
-    unsigned level;
+    //! Number of tasks queued or being processed
+    int level;
+    //! Number of queued tasks not yet taken by a thread
+    int itsPendingTasks;
     //! Parent application BF2H5    
     BF2H5 * itsParent;
     unsigned short itsDownSampleFactor;
+    //! Data products to compute
+    OutputMode itsOutputMode;
+    //! Number of output components per subband
+    unsigned int itsNofComponents;
     uint8_t nrOfSubbands;
     uint32_t nrSamplesPerSubband;
-    //! Points to array of flags marking subbands that have been written
-    bool * subbandReady;
-    bool checking_completeness;
-    // the parallel threads for calculation
-    pthread_t itsCalculationThread[NUM_CALCULATION_THREADS]; // the calculation threads
-    // the tread_data_array contain input, settings and output data for that tread
+    //! Number of subbands processed per task
+    unsigned int itsSubbandsPerTask;
+    //! The calculation threads
+    std::vector<worker *> itsWorkers;
+    //! Queue the tasks of the next block is added to first
+    unsigned int itsNextWorker;
     bool itsStopProcessing;
-    //! Number of the currently processed block
-    long int currentBlockNr;
-    //! The size in float units of a single subband output data block
+    //! The size in float units of a single component of a subband output data block
     uint32_t itsSingleSubbandNrOutputSamples;
-    float ** dataBlockOutput; // the pointers to the output buffers for output data. Pointer to pointer to single subband output buffer
+    //! Size in float units of the output of a single subband
+    size_t itsSubbandOutputSize;
+    //! Output buffers, one per block in flight
+    BufferPool * itsOutputPool;
+    //! Output buffer held by the writer, per block
+    std::map<blockKey, int> itsWriterBuffers;
     
-    // itsDatamap is protected by the calculationMapMutex and the pthread condition
-    calculationMap itsData; // first = blockNr; second.first = subbandNr; second.second = pointer to start sample of one subband datablock
-    pthread_mutex_t calculationMapMutex;
-    pthread_cond_t  condition;
+    //! Idle threads wait for new tasks on this condition
+    pthread_mutex_t idleMutex;
+    pthread_cond_t  workAvailable;
+    //! Protects itsWriterBuffers
+    pthread_mutex_t blockMutex;
   };
   
 } // Namespace DAL -- end
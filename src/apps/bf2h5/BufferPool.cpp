@@ -0,0 +1,319 @@
+/***************************************************************************
+ *   Copyright (C) 2026                                                    *
+ *   agent <agent@local>                                                   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include <cstring>
+#include <sys/mman.h>
+#include "BufferPool.h"
+
+using std::cerr;
+using std::endl;
+
+//! Alignment of the buffers within the pool
+#define BUFFERPOOL_ALIGNMENT 4096
+//! Size of a huge page
+#define BUFFERPOOL_HUGEPAGE_SIZE (2*1024*1024)
+
+namespace DAL { // Namespace DAL -- begin
+
+  // ==============================================================================
+  //
+  //  Construction
+  //
+  // ==============================================================================
+
+  /*!
+    \param name         -- Name of the pool, used in messages.
+    \param nofBuffers   -- Number of buffers in the pool.
+    \param bufferSize   -- Size of a single buffer in bytes; with a size of zero
+           no memory is allocated, and the pool only limits the number of
+           blocks in flight.
+    \param policy       -- What to do when all buffers are in use.
+    \param useHugePages -- Back the memory of the pool by huge pages? Falls
+           back to normal pages if no huge pages are available.
+  */
+  BufferPool::BufferPool (std::string const &name,
+			  unsigned int nofBuffers,
+			  size_t bufferSize,
+			  Policy const &policy,
+			  bool useHugePages)
+    : itsName(name),
+      itsBufferSize(bufferSize),
+      itsPolicy(policy),
+      itsHugePages(useHugePages),
+      itsMemory(0),
+      itsLength(0),
+      itsMaxInUse(0),
+      itsNofWaits(0),
+      itsNofDropped(0),
+      itsStopped(false)
+  {
+    pthread_mutex_init(&itsMutex, 0);
+    pthread_cond_init(&itsBufferFree, 0);
+
+    if (nofBuffers == 0) {
+      nofBuffers = 1;
+    }
+
+    itsStride = (bufferSize + BUFFERPOOL_ALIGNMENT - 1) & ~size_t(BUFFERPOOL_ALIGNMENT - 1);
+
+    if (itsStride == 0 || allocateMemory (nofBuffers * itsStride)) {
+      itsRefCount.resize (nofBuffers, 0);
+      /* Hand out the buffers in order, lowest handle first */
+      for (int n = nofBuffers - 1; n >= 0; --n) {
+	itsFree.push_back (n);
+      }
+    }
+  }
+
+  // ==============================================================================
+  //
+  //  Destruction
+  //
+  // ==============================================================================
+
+  BufferPool::~BufferPool ()
+  {
+    if (itsMemory) {
+      munmap (itsMemory, itsLength);
+    }
+    pthread_mutex_destroy(&itsMutex);
+    pthread_cond_destroy(&itsBufferFree);
+  }
+
+  // ==============================================================================
+  //
+  //  Parameter access
+  //
+  // ==============================================================================
+
+  //_______________________________________________________________________________
+  //                                                                       nofInUse
+
+  unsigned int BufferPool::nofInUse (void)
+  {
+    pthread_mutex_lock (&itsMutex);
+    unsigned int nofUsed = itsRefCount.size() - itsFree.size();
+    pthread_mutex_unlock (&itsMutex);
+    return nofUsed;
+  }
+
+  //_______________________________________________________________________________
+  //                                                                       maxInUse
+
+  unsigned int BufferPool::maxInUse (void)
+  {
+    pthread_mutex_lock (&itsMutex);
+    unsigned int nofUsed = itsMaxInUse;
+    pthread_mutex_unlock (&itsMutex);
+    return nofUsed;
+  }
+
+  //_______________________________________________________________________________
+  //                                                                         policy
+
+  /*!
+    \param name   -- Name of the policy: \e block or \e drop.
+    \param policy -- The matching policy.
+
+    \return status -- Returns \e false if \e name is not a known policy.
+  */
+  bool BufferPool::policy (std::string const &name,
+			   Policy &policy)
+  {
+    if (name == "block") {
+      policy = Block;
+    } else if (name == "drop") {
+      policy = Drop;
+    } else {
+      return false;
+    }
+    return true;
+  }
+
+  // ==============================================================================
+  //
+  //  Methods
+  //
+  // ==============================================================================
+
+  //_______________________________________________________________________________
+  //                                                                 allocateMemory
+
+  /*!
+    \param length  -- Number of bytes to map.
+
+    \return status -- Returns \e false if the memory could not be mapped.
+  */
+  bool BufferPool::allocateMemory (size_t length)
+  {
+    void *address = MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+    if (itsHugePages) {
+      size_t hugeLength = (length + BUFFERPOOL_HUGEPAGE_SIZE - 1) & ~size_t(BUFFERPOOL_HUGEPAGE_SIZE - 1);
+      address = mmap (NULL, hugeLength, PROT_READ | PROT_WRITE,
+		      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+      if (address != MAP_FAILED) {
+	length = hugeLength;
+      }
+    }
+#endif
+
+    if (address == MAP_FAILED) {
+      if (itsHugePages) {
+	cerr << "[BufferPool::allocateMemory] No huge pages available for pool "
+	     << itsName << ", using normal pages." << endl;
+	itsHugePages = false;
+      }
+      address = mmap (NULL, length, PROT_READ | PROT_WRITE,
+		      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    }
+
+    if (address == MAP_FAILED) {
+      cerr << "[BufferPool::allocateMemory] Failed to allocate " << length
+	   << " bytes for pool " << itsName << endl;
+      return false;
+    }
+
+    /* Touch all pages now rather than on first use */
+    memset (address, 0, length);
+
+    itsMemory = reinterpret_cast<char *>(address);
+    itsLength = length;
+
+    return true;
+  }
+
+  //_______________________________________________________________________________
+  //                                                                        acquire
+
+  /*!
+    \return handle -- Handle of the buffer, with a reference count of one;
+            -1 if no buffer is free under the \e Drop policy, or if the pool
+            has been stopped.
+  */
+  int BufferPool::acquire (void)
+  {
+    int handle = -1;
+
+    /* A pool which failed to allocate its memory never has a buffer to hand
+       out; waiting for one would block forever */
+    if (!isValid()) {
+      return handle;
+    }
+
+    pthread_mutex_lock (&itsMutex);
+
+    if (itsFree.empty() && !itsStopped) {
+      if (itsPolicy == Drop) {
+	++itsNofDropped;
+	pthread_mutex_unlock (&itsMutex);
+	return -1;
+      }
+      ++itsNofWaits;
+      while (itsFree.empty() && !itsStopped) {
+	pthread_cond_wait (&itsBufferFree, &itsMutex);
+      }
+    }
+
+    if (!itsStopped) {
+      handle = itsFree.back();
+      itsFree.pop_back();
+      itsRefCount[handle] = 1;
+      unsigned int nofUsed = itsRefCount.size() - itsFree.size();
+      if (nofUsed > itsMaxInUse) {
+	itsMaxInUse = nofUsed;
+      }
+    }
+
+    pthread_mutex_unlock (&itsMutex);
+
+    return handle;
+  }
+
+  //_______________________________________________________________________________
+  //                                                                         retain
+
+  /*!
+    \param handle -- Handle of a buffer obtained from acquire().
+  */
+  void BufferPool::retain (int handle)
+  {
+    pthread_mutex_lock (&itsMutex);
+    ++itsRefCount[handle];
+    pthread_mutex_unlock (&itsMutex);
+  }
+
+  //_______________________________________________________________________________
+  //                                                                        release
+
+  /*!
+    \param handle -- Handle of a buffer obtained from acquire().
+  */
+  void BufferPool::release (int handle)
+  {
+    pthread_mutex_lock (&itsMutex);
+    if (itsRefCount[handle] <= 0) {
+      cerr << "[BufferPool::release] Buffer " << handle << " of pool "
+	   << itsName << " is not in use!" << endl;
+    }
+    else if (--itsRefCount[handle] == 0) {
+      itsFree.push_back (handle);
+      pthread_cond_signal (&itsBufferFree);
+    }
+    pthread_mutex_unlock (&itsMutex);
+  }
+
+  //_______________________________________________________________________________
+  //                                                                           stop
+
+  void BufferPool::stop (void)
+  {
+    pthread_mutex_lock (&itsMutex);
+    itsStopped = true;
+    pthread_cond_broadcast (&itsBufferFree);
+    pthread_mutex_unlock (&itsMutex);
+  }
+
+  //_______________________________________________________________________________
+  //                                                                        summary
+
+  /*!
+    \param os -- Output stream to which the summary is written.
+  */
+  void BufferPool::summary (std::ostream &os)
+  {
+    pthread_mutex_lock (&itsMutex);
+
+    os << "[BufferPool] Summary of internal parameters." << endl;
+    os << "-- Name                   = " << itsName                          << endl;
+    os << "-- Buffers                = " << itsRefCount.size()
+       << " x " << itsBufferSize << " bytes"                                 << endl;
+    os << "-- Policy                 = " << (itsPolicy == Block ? "block" : "drop") << endl;
+    os << "-- Huge pages             = " << (itsHugePages ? "yes" : "no")  << endl;
+    os << "-- Buffers in use         = " << itsRefCount.size() - itsFree.size() << endl;
+    os << "-- Max. buffers in use    = " << itsMaxInUse                      << endl;
+    os << "-- Waits for a buffer     = " << itsNofWaits                      << endl;
+    os << "-- Dropped buffers        = " << itsNofDropped                    << endl;
+
+    pthread_mutex_unlock (&itsMutex);
+  }
+
+} // Namespace DAL -- end
@@ -0,0 +1,199 @@
+/***************************************************************************
+ *   Copyright (C) 2026                                                    *
+ *   agent <agent@local>                                                   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef BUFFERPOOL_H
+#define BUFFERPOOL_H
+
+#include <pthread.h>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace DAL { // Namespace DAL -- begin
+
+  /*!
+    \class BufferPool
+
+    \ingroup DAL
+    \ingroup dal_apps
+
+    \brief Fixed set of equally sized buffers passed between the bf2h5 stages
+
+    <h3>Synopsis</h3>
+
+    All buffers of the pool are allocated up front, as a single memory mapped
+    region, which optionally is backed by huge pages. The pages are touched at
+    construction, so running out of memory shows up when the pool is created,
+    not in the middle of an observation.
+
+    A buffer is handed out by acquire() as a handle -- its index in the pool --
+    with a reference count of one. A stage passing the buffer on to another
+    stage calls retain() for it; each stage calls release() once it is done
+    with the buffer, and the buffer returns to the pool when its reference
+    count drops to zero.
+
+    When all buffers are in use, acquire() either waits for a buffer to be
+    released (policy \e Block), which propagates back-pressure to the stage
+    filling the buffers, or fails immediately (policy \e Drop), in which case
+    the caller is expected to discard the data. The number of buffers in use is
+    the depth of the queue between the stages using the pool; it is reported by
+    summary() together with its maximum and the number of waits and drops.
+
+    A pool with a buffer size of zero allocates no memory; its handles then
+    only serve as tokens, limiting the number of blocks in flight when the data
+    are kept elsewhere -- e.g. in the memory mapped input file.
+  */
+  class BufferPool
+  {
+  public:
+
+    //! What to do when all buffers of the pool are in use
+    enum Policy {
+      //! Wait until a buffer is released
+      Block,
+      //! Fail, such that the caller discards the data
+      Drop
+    };
+
+    // === Construction =========================================================
+
+    //! Argumented constructor
+    BufferPool (std::string const &name,
+		unsigned int nofBuffers,
+		size_t bufferSize,
+		Policy const &policy=Block,
+		bool useHugePages=false);
+
+    // === Destruction ==========================================================
+
+    //! Destructor
+    ~BufferPool ();
+
+    // === Parameter access =====================================================
+
+    //! Get the name of the pool
+    inline std::string name (void) const {
+      return itsName;
+    }
+
+    //! Get the number of buffers in the pool
+    inline unsigned int nofBuffers (void) const {
+      return itsRefCount.size();
+    }
+
+    //! Get the size of a single buffer in bytes
+    inline size_t bufferSize (void) const {
+      return itsBufferSize;
+    }
+
+    //! Get the policy applied when all buffers are in use
+    inline Policy policy (void) const {
+      return itsPolicy;
+    }
+
+    //! Is the memory of the pool backed by huge pages?
+    inline bool usesHugePages (void) const {
+      return itsHugePages;
+    }
+
+    //! Is the pool usable, i.e. has its memory been allocated?
+    inline bool isValid (void) const {
+      return !itsRefCount.empty();
+    }
+
+    //! Get the number of buffers currently in use
+    unsigned int nofInUse (void);
+
+    //! Get the maximum number of buffers in use at the same time
+    unsigned int maxInUse (void);
+
+    //! Get the pointer to the memory of buffer \e handle
+    inline void * buffer (int handle) const {
+      return itsMemory + handle * itsStride;
+    }
+
+    //! Get the policy matching its name (block or drop)
+    static bool policy (std::string const &name,
+			Policy &policy);
+
+    // === Methods ==============================================================
+
+    //! Get a free buffer; returns -1 if there is none and the data are dropped, or if the pool is not valid
+    int acquire (void);
+
+    //! Add a reference to buffer \e handle
+    void retain (int handle);
+
+    //! Remove a reference from buffer \e handle
+    void release (int handle);
+
+    //! Wake up all threads waiting in acquire(), which then fails
+    void stop (void);
+
+    //! Provide a summary of the internal status
+    inline void summary (void) {
+      summary (std::cout);
+    }
+
+    //! Provide a summary of the internal status
+    void summary (std::ostream &os);
+
+  private:
+
+    //! Map the memory of the pool
+    bool allocateMemory (size_t length);
+
+  private:
+
+    //! Name of the pool, used in messages
+    std::string itsName;
+    //! Size of a single buffer in bytes
+    size_t itsBufferSize;
+    //! Distance between the starts of two buffers in bytes
+    size_t itsStride;
+    //! Policy applied when all buffers are in use
+    Policy itsPolicy;
+    //! Is the memory backed by huge pages?
+    bool itsHugePages;
+    //! Start of the memory of the pool
+    char * itsMemory;
+    //! Length of the memory of the pool in bytes
+    size_t itsLength;
+    //! Reference counts of the buffers; 0 marks a free buffer
+    std::vector<int> itsRefCount;
+    //! Handles of the free buffers
+    std::vector<int> itsFree;
+    //! Maximum number of buffers in use at the same time
+    unsigned int itsMaxInUse;
+    //! Number of times acquire() had to wait for a buffer
+    unsigned long itsNofWaits;
+    //! Number of times acquire() failed under the Drop policy
+    unsigned long itsNofDropped;
+    //! Has the pool been stopped?
+    bool itsStopped;
+    //! Protects the book-keeping of the pool
+    pthread_mutex_t itsMutex;
+    //! Signalled when a buffer is returned to the pool
+    pthread_cond_t itsBufferFree;
+  };
+
+} // Namespace DAL -- end
+
+#endif  /* BUFFERPOOL_H */
@@ -18,6 +18,7 @@
  *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
  ***************************************************************************/
 
+#include <algorithm>
 #include "bf2h5.h"
 #include "HDF5Writer.h"
 #include <data_hl/BFRawFormat.h>
@@ -37,35 +38,64 @@ HDF5Writer::HDF5Writer (BF2H5 *parent,
 			const string &output_file,
 			const LOFAR::RTCP::Parset *ps, 
 			size_t output_block_size,
-			uint8_t nr_subbands)
+			uint8_t nr_subbands,
+			unsigned int nofStations)
   : itsParent(parent),
     rawfile(0), 
-    table(0),
     stopWriting(false),
     itsOutputFile(output_file), 
-    waitForDataTimeOut(0),
-    foundDataForCurrentBlock(false),
     outputBlockSize(output_block_size),
     creation_mode("TCP"),
     nrOfBlocks(0),
-    currentBlockNr(0), 
     nrOfSubbands(nr_subbands),
-    file_byte_size(0)
+    file_byte_size(0),
+    itsOutputMode(Bf2h5Calculator::Intensity),
+    itsNofComponents(1),
+    itsRootGroup(0)
 {
-  subbandReady = new bool [nrOfSubbands];
-  for (uint8_t i=0; i < nrOfSubbands; ++i) {
-    subbandReady[i] = false;
-  }
-  
   pthread_mutex_init(&writeMapMutex, NULL);
   
-  zeroBlock = new float [outputBlockSize];
-  memset(zeroBlock, 0, outputBlockSize * sizeof(float));
+  initStations(nofStations);
   // create output file
   createHDF5File(ps);
 }
 #endif
 
+/*!
+  \param parent            -- The BF2H5 application the writer belongs to.
+  \param output_file       -- Name of the output file.
+  \param output_block_size -- Number of output samples per subband in a block.
+  \param nr_subbands       -- Number of subbands.
+  \param mode              -- Output mode; one of the Stokes output modes.
+  \param nofStations       -- Number of stations, each written to a beam of
+         its own.
+*/
+HDF5Writer::HDF5Writer (BF2H5 *parent,
+			const string &output_file,
+			size_t output_block_size,
+			uint8_t nr_subbands,
+			Bf2h5Calculator::OutputMode mode,
+			unsigned int nofStations)
+  : itsParent(parent),
+    rawfile(0), 
+    stopWriting(false),
+    itsOutputFile(output_file), 
+    outputBlockSize(output_block_size),
+    creation_mode("TCP"),
+    nrOfBlocks(0),
+    nrOfSubbands(nr_subbands),
+    file_byte_size(0),
+    itsOutputMode(mode),
+    itsNofComponents(Bf2h5Calculator::nofComponents(mode)),
+    itsRootGroup(0)
+{
+  pthread_mutex_init(&writeMapMutex, NULL);
+  
+  initStations(nofStations);
+  // create output file
+  createStokesFile();
+}
+
 // ==============================================================================
 //
 //  Destruction
@@ -75,12 +105,19 @@ HDF5Writer::HDF5Writer (BF2H5 *parent,
 HDF5Writer::~HDF5Writer()
 {
   pthread_mutex_destroy(&writeMapMutex);
-  delete [] zeroBlock;
-  delete [] subbandReady;
-  for (uint8_t i = 0; i < nrOfSubbands; ++i) {
-    delete table[i];
+  for (unsigned int n = 0; n < itsStations.size(); ++n) {
+    stationOutput *s = itsStations[n];
+    for (unsigned int i = 0; i < s->datasets.size(); ++i) {
+      delete s->datasets[i];
+    }
+    delete [] s->subbandReady;
+    delete [] s->blockBuffer;
+    for (unsigned int i = 0; i < s->chains.size(); ++i) {
+      delete s->chains[i];
+    }
+    delete s;
   }
-  delete table;
+  delete itsRootGroup;
 }
 
 // ==============================================================================
@@ -89,6 +126,33 @@ HDF5Writer::~HDF5Writer()
 //
 // ==============================================================================
 
+//_______________________________________________________________________________
+//                                                                   initStations
+
+/*!
+  \param nofStations -- Number of stations written.
+*/
+void HDF5Writer::initStations (unsigned int nofStations)
+{
+  size_t blockSize = itsNofComponents * outputBlockSize * nrOfSubbands;
+
+  for (unsigned int n = 0; n < nofStations; ++n) {
+    stationOutput *s            = new stationOutput;
+    s->index                    = n;
+    s->currentBlockNr           = 0;
+    s->foundDataForCurrentBlock = false;
+    s->waitForDataTimeOut       = 0;
+    s->nofAllocatedBlocks       = 0;
+    s->subbandReady             = new bool [nrOfSubbands];
+    for (uint8_t i=0; i < nrOfSubbands; ++i) {
+      s->subbandReady[i] = false;
+    }
+    s->blockBuffer = new float [blockSize];
+    memset(s->blockBuffer, 0, blockSize * sizeof(float));
+    itsStations.push_back(s);
+  }
+}
+
 #ifdef DAL_WITH_LOFAR
 
 void HDF5Writer::createHDF5File (const LOFAR::RTCP::Parset *ps)
@@ -242,70 +306,190 @@ void HDF5Writer::createHDF5File (const LOFAR::RTCP::Parset *ps)
   
   char * beamstr = new char[10];
   
-  int beam_number;
-  
-  beam_number = 0;
-  sprintf( beamstr, "beam%03d", beam_number );
-  beamGroup = dataset.createGroup( beamstr );
-  
-  float ra_val  = header.beamDirections[beam_number+1][0];
-  float dec_val = header.beamDirections[beam_number+1][1];
-  beamGroup->setAttribute( "RA", &ra_val, 1 );
-  beamGroup->setAttribute( "DEC", &dec_val, 1 );
-  
-  int n_subbands[] = { header.nrSubbands };
-  beamGroup->setAttribute( "NUMBER_OF_SUBBANDS", n_subbands );
-  
-  // write the center frequencies of the subbands
-  int * center_frequency = new int[header.nrSubbands];
-  char * cfName = new char[22];
-  for (unsigned int idx=0; idx < header.nrSubbands; idx++)
-    {
-      center_frequency[idx] = (int)header.subbandFrequencies[ idx ];
-      sprintf( cfName, "CENTER_FREQUENCY_SB%03d", idx );
-      beamGroup->setAttribute( cfName, &center_frequency[idx] );
-    }
-  delete [] cfName;
-  delete beamGroup;
-  
+  for (unsigned int station = 0; station < itsStations.size(); ++station) {
+    const BFRawFormat::BFRaw_Header & stationHeader = itsParent->getMainHeader(station);
+    
+    sprintf( beamstr, "beam%03d", station );
+    beamGroup = dataset.createGroup( beamstr );
+    itsStations[station]->groupName = beamstr;
+    
+    float ra_val  = stationHeader.beamDirections[1][0];
+    float dec_val = stationHeader.beamDirections[1][1];
+    beamGroup->setAttribute( "RA", &ra_val, 1 );
+    beamGroup->setAttribute( "DEC", &dec_val, 1 );
+    beamGroup->setAttribute( "STATION", string(stationHeader.station) );
+    
+    int n_subbands[] = { header.nrSubbands };
+    beamGroup->setAttribute( "NUMBER_OF_SUBBANDS", n_subbands );
+    
+    // write the center frequencies of the subbands
+    int * center_frequency = new int[header.nrSubbands];
+    char * cfName = new char[22];
+    for (unsigned int idx=0; idx < header.nrSubbands; idx++)
+      {
+	center_frequency[idx] = (int)stationHeader.subbandFrequencies[ idx ];
+	sprintf( cfName, "CENTER_FREQUENCY_SB%03d", idx );
+	beamGroup->setAttribute( cfName, &center_frequency[idx] );
+      }
+    delete [] cfName;
+    delete [] center_frequency;
+    
+    /* One [time][subband] dataset, chunked by block */
+    std::vector<hsize_t> shape (2);
+    shape[0] = outputBlockSize;
+    shape[1] = header.nrSubbands;
+    
+    itsStations[station]->datasets.push_back (new HDF5Dataset (beamGroup->getId(),
+							       "TOTAL_INTENSITY",
+							       shape,
+							       shape,
+							       H5T_NATIVE_FLOAT,
+							       IO_Mode(IO_Mode::CreateNew)));
+    itsStations[station]->nofAllocatedBlocks = 1;
+    delete beamGroup;
+    
 #ifdef DAL_DEBUGGING_MESSAGES
-  std::cerr << "CREATED New beam group: " << string(beamstr) << std::endl;
-  std::cerr << "   " << header.nrSubbands << " subbands" << std::endl;
+    std::cerr << "CREATED New beam group: " << string(beamstr) << std::endl;
+    std::cerr << "   " << header.nrSubbands << " subbands" << std::endl;
 #endif
+  }
   
-  table = new dalTable * [ header.nrSubbands ];
-  char * sbName = new char[8];
-  
-  // nrSubbands is actually the number of subbands (see email from J.Romein)
-  for (unsigned int idx=0; idx<header.nrSubbands; idx++)
-    {
-      sprintf( sbName, "SB%03d", idx );
-      table[idx] = dataset.createTable( sbName, beamstr );
-    }
-  
-  for (unsigned int idx=0; idx<header.nrSubbands; idx++)
-    {
-      if ( itsParent->doDownSampling() || itsParent->doIntensity() )
-	{
-	  table[idx]->addColumn( "TOTAL_INTENSITY_SQUARED", dal_FLOAT );
-	}
-      else
-	{
-	  table[idx]->addColumn( "X", dal_COMPLEX_SHORT );
-	  table[idx]->addColumn( "Y", dal_COMPLEX_SHORT );
-	}
-    }
-  
-  delete [] sbName;
-  sbName = 0;
-  delete [] center_frequency;
-  center_frequency = 0;
   delete [] beamstr;
   beamstr = 0;
 }
 
 #endif
 
+//_______________________________________________________________________________
+//                                                               createStokesFile
+
+void HDF5Writer::createStokesFile (void)
+{
+  DAL::Stokes::Component components[4];
+  std::vector<unsigned int> nofChannels (nrOfSubbands, 1);
+  std::vector<std::string> stationsList;
+
+  switch (itsOutputMode) {
+  case Bf2h5Calculator::StokesIQUV:
+    components[0] = DAL::Stokes::I;
+    components[1] = DAL::Stokes::Q;
+    components[2] = DAL::Stokes::U;
+    components[3] = DAL::Stokes::V;
+    break;
+  case Bf2h5Calculator::StokesXXYY:
+    components[0] = components[1] = DAL::Stokes::X;
+    components[2] = components[3] = DAL::Stokes::Y;
+    break;
+  default:
+    components[0] = DAL::Stokes::I;
+    break;
+  }
+
+  itsRootGroup = new BF_RootGroup (itsOutputFile);
+
+  /* One beam per station, all in sub-array pointing 0 */
+  for (unsigned int station = 0; station < itsStations.size(); ++station) {
+    std::string path = BF_SubArrayPointing::getName(0) + "/" + BF_BeamGroup::getName(station);
+    std::vector<std::string> stationName (1, itsParent->getMainHeader(station).station);
+    
+    for (unsigned int n = 0; n < itsNofComponents; ++n) {
+      if (!itsRootGroup->openStokesDataset (0, station, n,
+					    outputBlockSize,
+					    nofChannels,
+					    components[n],
+					    H5T_NATIVE_FLOAT,
+					    IO_Mode(IO_Mode::Create))) {
+	std::cerr << "[HDF5Writer::createStokesFile] Failed to create "
+		  << path << "/" << BF_StokesDataset::getName(n) << std::endl;
+      }
+      /* Keep a handle of our own on the dataset for writing */
+      itsStations[station]->datasets.push_back (new BF_StokesDataset (itsRootGroup->locationID(),
+								      path + "/" + BF_StokesDataset::getName(n),
+								      IO_Mode(IO_Mode::ReadWrite)));
+    }
+    /* The datasets are created holding a single block, which is also their chunk size */
+    itsStations[station]->nofAllocatedBlocks = 1;
+    itsStations[station]->groupName          = path;
+    
+    hid_t beamID = H5Gopen (itsRootGroup->locationID(), path.c_str(), H5P_DEFAULT);
+    if (beamID > 0) {
+      HDF5Attribute::write (beamID, "NOF_STATIONS",  int(1));
+      HDF5Attribute::write (beamID, "STATIONS_LIST", stationName);
+      H5Gclose (beamID);
+    }
+    stationsList.push_back (stationName[0]);
+  }
+  
+  hid_t pointingID = H5Gopen (itsRootGroup->locationID(),
+			      BF_SubArrayPointing::getName(0).c_str(),
+			      H5P_DEFAULT);
+  if (pointingID > 0) {
+    HDF5Attribute::write (pointingID, "NOF_STATIONS",  int(stationsList.size()));
+    HDF5Attribute::write (pointingID, "STATIONS_LIST", stationsList);
+    HDF5Attribute::write (pointingID, "NOF_BEAMS",     int(stationsList.size()));
+    H5Gclose (pointingID);
+  }
+
+  uint downsample_factor = itsParent->getDownSampleFactor();
+  if (itsOutputMode == Bf2h5Calculator::StokesXXYY) {
+    downsample_factor = 1;
+  }
+  HDF5Attribute::write (itsRootGroup->locationID(), "CREATION_MODE",   creation_mode);
+  HDF5Attribute::write (itsRootGroup->locationID(), "DOWNSAMPLE_RATE", downsample_factor);
+}
+
+//_______________________________________________________________________________
+//                                                                  setProcessing
+
+/*!
+  \param frequencies -- Center frequency of each subband in Hz.
+  \param sampleTime  -- Duration of an output sample in seconds.
+  \param dm          -- Dispersion measure in pc cm^-3; no dedispersion is done
+         if it is zero.
+  \param normalize   -- Normalize each subband to zero mean and unit variance?
+
+  \return status -- Returns \e false if the number of frequencies does not
+          match the number of subbands.
+*/
+bool HDF5Writer::setProcessing (std::vector<double> const &frequencies,
+				double sampleTime,
+				double dm,
+				bool normalize)
+{
+  if (frequencies.size() != nrOfSubbands) {
+    std::cerr << "[HDF5Writer::setProcessing] Expected " << int(nrOfSubbands)
+	      << " subband frequencies, got " << frequencies.size() << std::endl;
+    return false;
+  }
+
+  for (unsigned int station = 0; station < itsStations.size(); ++station) {
+    stationOutput *s = itsStations[station];
+    for (unsigned int n = 0; n < itsNofComponents; ++n) {
+      DAL::ProcessingChain<float> *chain = new DAL::ProcessingChain<float> (nrOfSubbands);
+      if (dm != 0) {
+	chain->add (new DAL::DedispersionStage<float> (frequencies, sampleTime, dm));
+      }
+      if (normalize) {
+	chain->add (new DAL::BandpassStage<float> (nrOfSubbands));
+      }
+      s->chains.push_back (chain);
+    }
+
+    if (itsRootGroup && dm != 0) {
+      std::string path = BF_SubArrayPointing::getName(0) + "/" + BF_BeamGroup::getName(station);
+      hid_t beamID     = H5Gopen (itsRootGroup->locationID(), path.c_str(), H5P_DEFAULT);
+      if (beamID > 0) {
+	HDF5Attribute::write (beamID, "DEDISPERSION",            std::string("INCOHERENT"));
+	HDF5Attribute::write (beamID, "DISPERSION_MEASURE",      dm);
+	HDF5Attribute::write (beamID, "DISPERSION_MEASURE_UNIT", std::string("pc/cm^3"));
+	H5Gclose (beamID);
+      }
+    }
+  }
+
+  return true;
+}
+
 //_______________________________________________________________________________
 //                                                                          start
 
@@ -316,8 +500,14 @@ bool HDF5Writer::start(void)
   cout << "setting attribute EPOCH_UTC to " << itsParent->getEpochUTC() << endl;
   cout << "setting attribute EPOCH_DATE to " << itsParent->getEpochDate() << endl;	
 #endif
-  dataset.setAttribute( "EPOCH_UTC", itsParent->getEpochUTC() );
-  dataset.setAttribute( "EPOCH_DATE", itsParent->getEpochDate() );
+  if (itsRootGroup) {
+    HDF5Attribute::write (itsRootGroup->locationID(), "EPOCH_UTC",  itsParent->getEpochUTC());
+    HDF5Attribute::write (itsRootGroup->locationID(), "EPOCH_DATE", itsParent->getEpochDate());
+  }
+  else {
+    dataset.setAttribute( "EPOCH_UTC", itsParent->getEpochUTC() );
+    dataset.setAttribute( "EPOCH_DATE", itsParent->getEpochDate() );
+  }
   
   if (pthread_create(&itsWriteThread, NULL, StartInternalThread, (void *) this) == 0) {
     return true;
@@ -350,6 +540,23 @@ bool HDF5Writer::stop (void)
     bResult = false;
   }
 
+  /* Trim the datasets to the blocks actually written */
+  std::vector<hsize_t> shape (2);
+  shape[1] = nrOfSubbands;
+  for (unsigned int station = 0; station < itsStations.size(); ++station) {
+    stationOutput *s = itsStations[station];
+    shape[0] = s->currentBlockNr * outputBlockSize;
+    for (unsigned int n = 0; n < s->datasets.size(); ++n) {
+      if (!s->datasets[n]->resize (shape)) {
+	bResult = false;
+      }
+    }
+    s->nofAllocatedBlocks = s->currentBlockNr;
+    if (!writeFlags (s)) {
+      bResult = false;
+    }
+  }
+
   return bResult;
 }
 
@@ -357,14 +564,101 @@ bool HDF5Writer::stop (void)
 //                                                                   writeSubband
 
 // gets called for every subband that has been calculated by the calculator
-void HDF5Writer::writeSubband (long int blockNr,
+void HDF5Writer::writeSubband (unsigned int station,
+			       long int blockNr,
 			       uint8_t subband,
 			       float *calculator_data)
 {
   std::pair<unsigned int, float *> dataPair(subband, calculator_data);
   pthread_mutex_lock (&writeMapMutex);
-  itsData[blockNr].push_back(dataPair);
+  itsStations[station]->data[blockNr].push_back(dataPair);
+  pthread_mutex_unlock(&writeMapMutex);
+}
+
+//_______________________________________________________________________________
+//                                                                      skipBlock
+
+/*!
+  Called for blocks that were dropped because all buffers were in use, such
+  that the writer does not wait for their subbands. The block is flagged as
+  \e MissingBlock, and is not written.
+
+  \param station -- Index of the station the block belongs to.
+  \param blockNr -- Number of the dropped block.
+*/
+void HDF5Writer::skipBlock (unsigned int station,
+			    long int blockNr)
+{
+  pthread_mutex_lock (&writeMapMutex);
+  itsStations[station]->droppedBlocks.insert(blockNr);
+  pthread_mutex_unlock(&writeMapMutex);
+}
+
+//_______________________________________________________________________________
+//                                                                    flagSamples
+
+/*!
+  May be called from any thread. A range adjoining or overlapping a recent
+  range of the same subband and reason is merged with it, so runs of flagged
+  blocks take up a single row of the flag table.
+
+  \param station -- Index of the station.
+  \param subband -- The subband; -1 for all subbands.
+  \param begin   -- First flagged output sample.
+  \param end     -- Output sample following the flagged range.
+  \param reason  -- Why the samples are flagged.
+*/
+void HDF5Writer::flagSamples (unsigned int station,
+			      int subband,
+			      long long begin,
+			      long long end,
+			      FlagReason reason)
+{
+  if (end <= begin) {
+    return;
+  }
+
+  pthread_mutex_lock (&writeMapMutex);
+
+  std::vector<flagRange> &flags = itsStations[station]->flags;
+  size_t nofRecent = std::min (flags.size(), size_t(nrOfSubbands) + 1);
+
+  for (size_t n = flags.size(); n > flags.size() - nofRecent; --n) {
+    flagRange &range = flags[n-1];
+    if (range.subband == subband && range.reason == reason
+	&& begin <= range.end && end >= range.begin) {
+      range.begin = std::min (range.begin, begin);
+      range.end   = std::max (range.end, end);
+      pthread_mutex_unlock (&writeMapMutex);
+      return;
+    }
+  }
+
+  flagRange range = { begin, end, subband, reason };
+  flags.push_back (range);
+
+  pthread_mutex_unlock (&writeMapMutex);
+}
+
+//_______________________________________________________________________________
+//                                                               nofPendingBlocks
+
+unsigned int HDF5Writer::nofPendingBlocks (void)
+{
+  unsigned int nofBlocks = 0;
+
+  pthread_mutex_lock (&writeMapMutex);
+  for (unsigned int station = 0; station < itsStations.size(); ++station) {
+    writeMap const &data = itsStations[station]->data;
+    for (writeMap::const_iterator it = data.begin(); it != data.end(); ++it) {
+      if (!(it->second.empty())) {
+	++nofBlocks;
+      }
+    }
+  }
   pthread_mutex_unlock(&writeMapMutex);
+
+  return nofBlocks;
 }
 
 //_______________________________________________________________________________
@@ -374,13 +668,16 @@ bool HDF5Writer::dataLeft (void)
 {
   pthread_mutex_lock (&writeMapMutex);
 
-  for (writeMap::const_iterator it = itsData.begin(); it != itsData.end(); ++it) {
-    if (!(it->second.empty())) {
-      cout << "data left, subband: ";
-      cout << static_cast<int>(it->second.front().first);
-      cout << ", block: " << currentBlockNr << endl;
-      pthread_mutex_unlock(&writeMapMutex);
-      return true;
+  for (unsigned int station = 0; station < itsStations.size(); ++station) {
+    stationOutput const *s = itsStations[station];
+    for (writeMap::const_iterator it = s->data.begin(); it != s->data.end(); ++it) {
+      if (!(it->second.empty())) {
+	cout << "data left, station: " << station << ", subband: ";
+	cout << static_cast<int>(it->second.front().first);
+	cout << ", block: " << s->currentBlockNr << endl;
+	pthread_mutex_unlock(&writeMapMutex);
+	return true;
+      }
     }
   }
 
@@ -392,15 +689,16 @@ bool HDF5Writer::dataLeft (void)
 //_______________________________________________________________________________
 //                                                         getDataForCurrentBlock
 
-bool HDF5Writer::getDataForCurrentBlock (void)
+bool HDF5Writer::getDataForCurrentBlock (stationOutput *s,
+					 std::pair<uint8_t, float *> &dataPair)
 {
   pthread_mutex_lock(&writeMapMutex);
-  writeMap::iterator it = itsData.find(currentBlockNr);
-  if (it != itsData.end()) {
+  writeMap::iterator it = s->data.find(s->currentBlockNr);
+  if (it != s->data.end()) {
     if (!(it->second.empty())) {
       dataPair = it->second.front();
       
-      foundDataForCurrentBlock = true;
+      s->foundDataForCurrentBlock = true;
       it->second.pop_front();
       pthread_mutex_unlock(&writeMapMutex);
       return true;
@@ -413,68 +711,300 @@ bool HDF5Writer::getDataForCurrentBlock (void)
 //_______________________________________________________________________________
 //                                                           checkIfBlockComplete
 
-void HDF5Writer::checkIfBlockComplete (void)
+void HDF5Writer::checkIfBlockComplete (stationOutput *s)
 {
   for (uint8_t i=0; i < nrOfSubbands; ++i) {
-    if (subbandReady[i] == false) {
+    if (s->subbandReady[i] == false) {
       return; // we are not ready with the current block
     }
   }
   // this block is done
-  startNextBlock();
+  writeBlock(s);
+  startNextBlock(s);
+}
+
+//_______________________________________________________________________________
+//                                                            currentBlockDropped
+
+bool HDF5Writer::currentBlockDropped (stationOutput *s)
+{
+  pthread_mutex_lock(&writeMapMutex);
+  bool dropped = (s->droppedBlocks.erase(s->currentBlockNr) > 0);
+  pthread_mutex_unlock(&writeMapMutex);
+  return dropped;
 }
 
 //_______________________________________________________________________________
 //                                                                 startNextBlock
 
-void HDF5Writer::startNextBlock (void)
+void HDF5Writer::startNextBlock (stationOutput *s)
 {
-  cout << "block " << currentBlockNr << " is done." << endl;
+  /* The output buffer of the block may be re-used by the calculator */
+  itsParent->blockWritten(s->index, s->currentBlockNr);
+  cout << "station " << s->index << ", block " << s->currentBlockNr << " is done." << endl;
   for (uint8_t i=0; i < nrOfSubbands; ++i) {
-    subbandReady[i] = false;
+    s->subbandReady[i] = false;
   }
   pthread_mutex_lock(&writeMapMutex);
-  itsData.erase(itsData.find(currentBlockNr++));
+  s->data.erase(s->currentBlockNr++);
   pthread_mutex_unlock(&writeMapMutex);
-  waitForDataTimeOut = 0;
-  foundDataForCurrentBlock = false;
+  s->waitForDataTimeOut = 0;
+  s->foundDataForCurrentBlock = false;
   return;
 }
 
+//_______________________________________________________________________________
+//                                                               skipCurrentBlock
+
+/*!
+  The chunks of the block are left unallocated. The processing chains are
+  reset, as the stream they see is interrupted.
+*/
+void HDF5Writer::skipCurrentBlock (stationOutput *s)
+{
+  long long begin = s->currentBlockNr * (long long)outputBlockSize;
+
+  flagSamples (s->index, -1, begin, begin + outputBlockSize, MissingBlock);
+  for (unsigned int n = 0; n < s->chains.size(); ++n) {
+    s->chains[n]->reset();
+  }
+  /* Subbands that did arrive are discarded */
+  memset (s->blockBuffer, 0, itsNofComponents * outputBlockSize * nrOfSubbands * sizeof(float));
+}
+
+//_______________________________________________________________________________
+//                                                               writeSubbandData
+
+/*!
+  \param s       -- The station.
+  \param subband -- The subband.
+  \param data    -- The output of the calculator for the subband,
+         [component][time].
+*/
+void HDF5Writer::writeSubbandData (stationOutput *s,
+				   uint8_t subband,
+				   float const *data)
+{
+  /* Transpose into the [time][subband] layout of the datasets */
+  for (unsigned int n = 0; n < itsNofComponents; ++n) {
+    float const *in = data + n * outputBlockSize;
+    float *out      = s->blockBuffer + n * outputBlockSize * nrOfSubbands + subband;
+    for (size_t t = 0; t < outputBlockSize; ++t) {
+      out[t * nrOfSubbands] = in[t];
+    }
+  }
+}
+
+//_______________________________________________________________________________
+//                                                                 extendDatasets
+
+/*!
+  \param s         -- The station whose datasets are extended.
+  \param nofBlocks -- Number of blocks the datasets need to hold.
+
+  \return status -- Returns \e false if one of the datasets could not be extended.
+*/
+bool HDF5Writer::extendDatasets (stationOutput *s,
+				 long int nofBlocks)
+{
+  bool status = true;
+
+  if (nofBlocks > s->nofAllocatedBlocks) {
+    std::vector<hsize_t> shape (2);
+    shape[0] = (nofBlocks + WRITER_EXTEND_NOF_BLOCKS - 1) * outputBlockSize;
+    shape[1] = nrOfSubbands;
+    for (unsigned int n = 0; n < s->datasets.size(); ++n) {
+      status &= s->datasets[n]->resize (shape);
+    }
+    s->nofAllocatedBlocks = nofBlocks + WRITER_EXTEND_NOF_BLOCKS - 1;
+  }
+
+  return status;
+}
+
+//_______________________________________________________________________________
+//                                                                     writeFlags
+
+/*!
+  \param s -- The station.
+
+  \return status -- Returns \e false if the flag table could not be written.
+*/
+bool HDF5Writer::writeFlags (stationOutput *s)
+{
+  hid_t fileID  = itsRootGroup ? itsRootGroup->locationID() : dataset.getFileHandle();
+  hid_t groupID = H5Gopen (fileID, s->groupName.c_str(), H5P_DEFAULT);
+  bool status   = false;
+
+  if (groupID < 0) {
+    std::cerr << "[HDF5Writer::writeFlags] Failed to open group " << s->groupName << std::endl;
+    return false;
+  }
+
+  pthread_mutex_lock (&writeMapMutex);
+  std::vector<long long> table (s->flags.size() * WRITER_FLAG_COLUMNS);
+  for (size_t n = 0; n < s->flags.size(); ++n) {
+    table[n * WRITER_FLAG_COLUMNS]     = s->flags[n].begin;
+    table[n * WRITER_FLAG_COLUMNS + 1] = s->flags[n].end;
+    table[n * WRITER_FLAG_COLUMNS + 2] = s->flags[n].subband;
+    table[n * WRITER_FLAG_COLUMNS + 3] = s->flags[n].reason;
+  }
+  pthread_mutex_unlock (&writeMapMutex);
+
+  std::vector<hsize_t> shape (2);
+  std::vector<hsize_t> chunk (2);
+  shape[0] = table.size() / WRITER_FLAG_COLUMNS;
+  shape[1] = WRITER_FLAG_COLUMNS;
+  chunk[0] = std::max (shape[0], hsize_t(1));
+  chunk[1] = WRITER_FLAG_COLUMNS;
+
+  HDF5Dataset flags (groupID,
+		     "FLAGS",
+		     shape,
+		     chunk,
+		     H5T_NATIVE_LLONG,
+		     IO_Mode(IO_Mode::Create));
+
+  if (flags.objectID() > 0) {
+    std::vector<std::string> columns (WRITER_FLAG_COLUMNS);
+    columns[0] = "BEGIN";
+    columns[1] = "END";
+    columns[2] = "SUBBAND";
+    columns[3] = "REASON";
+    std::vector<std::string> reasons (3);
+    reasons[MissingBlock]   = "MISSING_BLOCK";
+    reasons[MissingSubband] = "MISSING_SUBBAND";
+    reasons[StationFlagged] = "STATION_FLAGGED";
+
+    status = true;
+    if (!table.empty()) {
+      std::vector<int> block (2);
+      block[0] = shape[0];
+      block[1] = shape[1];
+      status = flags.writeData (&table[0], block);
+    }
+    flags.writeAttribute ("COLUMNS", columns);
+    flags.writeAttribute ("REASONS", reasons);
+  }
+
+  if (!status) {
+    std::cerr << "[HDF5Writer::writeFlags] Failed to write the flag table of "
+	      << s->groupName << std::endl;
+  }
+
+  H5Gclose (groupID);
+
+  return status;
+}
+
+//_______________________________________________________________________________
+//                                                                     writeBlock
+
+/*!
+  The datasets are extended beforehand, so the hyperslab write of a block never
+  has to change the extent of a dataset itself.
+*/
+void HDF5Writer::writeBlock (stationOutput *s)
+{
+  std::vector<int> start (2, 0);
+  std::vector<int> block (2);
+
+  start[0] = s->currentBlockNr * outputBlockSize;
+  block[0] = outputBlockSize;
+  block[1] = nrOfSubbands;
+
+  if (!extendDatasets (s, s->currentBlockNr + 1)) {
+    std::cerr << "[HDF5Writer::writeBlock] Failed to extend datasets for block "
+	      << s->currentBlockNr << " of station " << s->index << std::endl;
+  }
+
+  for (unsigned int n = 0; n < s->datasets.size(); ++n) {
+    float const *data = s->blockBuffer + n * outputBlockSize * nrOfSubbands;
+    if (n < s->chains.size()) {
+      uint64_t nofTimes;
+      data = s->chains[n]->process (data, outputBlockSize, nofTimes);
+    }
+    if (!s->datasets[n]->writeData (data,
+				    start,
+				    block)) {
+      std::cerr << "[HDF5Writer::writeBlock] Failed to write block "
+		<< s->currentBlockNr << " to " << s->datasets[n]->name()
+		<< std::endl;
+    }
+  }
+
+  /* Subbands missing from the next block are written as zeros */
+  memset (s->blockBuffer, 0, itsNofComponents * outputBlockSize * nrOfSubbands * sizeof(float));
+}
+
+//_______________________________________________________________________________
+//                                                                   writeStation
+
+/*!
+  \param s -- The station.
+
+  \return busy -- Returns \e false if there was nothing to do for the station.
+*/
+bool HDF5Writer::writeStation (stationOutput *s)
+{
+  std::pair<uint8_t, float *> dataPair;
+
+  if (getDataForCurrentBlock(s, dataPair)) {
+    writeSubbandData( s, dataPair.first, dataPair.second );
+    s->subbandReady[dataPair.first] = true;
+    checkIfBlockComplete(s);
+    s->waitForDataTimeOut = 0;
+    return true;
+  }
+  else if (currentBlockDropped(s)) {
+    cout << "HDF5Writer: station " << s->index << ", block " << s->currentBlockNr
+	 << " was dropped" << endl;
+    skipCurrentBlock(s);
+    startNextBlock(s);
+    return true;
+  }
+  return false;
+}
+
 //_______________________________________________________________________________
 //                                                                      writeData
 
 /*!
-  This function runs in a separate thread
+  This function runs in a separate thread. It serves the stations round-robin,
+  and only sleeps once there is nothing to do for any of them; the time-out on
+  the subbands of a block is counted in these idle passes.
 */
 void HDF5Writer::writeData (void)
 {
   while (!stopWriting) {
-    if (getDataForCurrentBlock()) {
-      table[dataPair.first]->appendRows( dataPair.second, outputBlockSize );
-      subbandReady[dataPair.first] = true;
-      /*#ifdef DAL_DEBUGGING_MESSAGES
-	cout << "HDF5Writer:Wrote subband " << static_cast<int>(dataPair.first) << " for data block " << currentBlockNr << endl;
-	#endif*/
-      checkIfBlockComplete();
-      waitForDataTimeOut = 0;
-      usleep(50);
+    bool busy = false;
+    for (unsigned int station = 0; station < itsStations.size(); ++station) {
+      busy |= writeStation(itsStations[station]);
     }
-    else { // no data to write, check if subbands received within time limit and go to sleep for a little while
-      if (foundDataForCurrentBlock) { // we don't want to skip a block which the calculator hasn't yet started
-	if (++waitForDataTimeOut > 25) {
-	  cout << "HDF5Writer: block " << currentBlockNr << ", skipping subbands: ";
+    if (busy) {
+      continue;
+    }
+    // no data to write, check if subbands received within time limit and go to sleep for a little while
+    for (unsigned int station = 0; station < itsStations.size(); ++station) {
+      stationOutput *s = itsStations[station];
+      if (s->foundDataForCurrentBlock) { // we don't want to skip a block which the calculator hasn't yet started
+	if (++(s->waitForDataTimeOut) > WRITER_TIMEOUT_PASSES) {
+	  long long begin = s->currentBlockNr * (long long)outputBlockSize;
+	  cout << "HDF5Writer: station " << s->index << ", block " << s->currentBlockNr
+	       << ", skipping subbands: ";
+	  /* The missing subbands are left at zero in the block buffer */
 	  for (uint8_t sb=0; sb < nrOfSubbands; ++sb) {
-	    if (subbandReady[sb] == false) {
-	      table[sb]->appendRows( zeroBlock, outputBlockSize );
+	    if (s->subbandReady[sb] == false) {
+	      flagSamples (s->index, sb, begin, begin + outputBlockSize, MissingSubband);
 	      cout << static_cast<int>(sb) << ", ";
 	    }
 	  }
-	  startNextBlock();
+	  writeBlock(s);
+	  startNextBlock(s);
 	}
       }
-      usleep(10000); // wait when the data of the new block hasn't arrived yet
     }
+    usleep(10000); // wait when the data of the new block hasn't arrived yet
   }
 }
 
@@ -505,31 +1035,35 @@ void HDF5Writer::openRawFile (const char* filename)
 
 void HDF5Writer::showStatus (void)
 {
-  cout << "Writer busy with block: " << currentBlockNr << endl;
-  if (foundDataForCurrentBlock) {
-    cout << "writer did find data for this block" << endl;
-  }
-  else {
-    cout << "writer did not find data for this block" << endl;
-  }
-  cout << "subbands that still needs processing: " << endl;
-  for (uint8_t i=0; i < nrOfSubbands; ++i) {
-    if (subbandReady[i] == false) {
-      cout << static_cast<int>(i) << ",";
+  for (unsigned int station = 0; station < itsStations.size(); ++station) {
+    stationOutput *s = itsStations[station];
+    cout << "Writer busy with station " << station << ", block: " << s->currentBlockNr << endl;
+    if (s->foundDataForCurrentBlock) {
+      cout << "writer did find data for this block" << endl;
     }
-  }
-  pthread_mutex_lock (&writeMapMutex);
-  cout << "data left: ";
-  for (writeMap::const_iterator it = itsData.begin(); it != itsData.end(); ++it) {
-    if (!(it->second.empty())) {
-      cout << "block: " << it->first << ", subbands: ";
-      for (std::deque<std::pair<uint8_t, float *> >::const_iterator cit = it->second.begin();
-	   cit != it->second.end() ; ++cit ) {
-	cout << static_cast<int>(it->second.front().first) << ",";
+    else {
+      cout << "writer did not find data for this block" << endl;
+    }
+    cout << "subbands that still needs processing: " << endl;
+    for (uint8_t i=0; i < nrOfSubbands; ++i) {
+      if (s->subbandReady[i] == false) {
+	cout << static_cast<int>(i) << ",";
       }
     }
+    pthread_mutex_lock (&writeMapMutex);
+    cout << "data left: ";
+    for (writeMap::const_iterator it = s->data.begin(); it != s->data.end(); ++it) {
+      if (!(it->second.empty())) {
+	cout << "block: " << it->first << ", subbands: ";
+	for (std::deque<std::pair<uint8_t, float *> >::const_iterator cit = it->second.begin();
+	     cit != it->second.end() ; ++cit ) {
+	  cout << static_cast<int>(cit->first) << ",";
+	}
+      }
+    }
+    pthread_mutex_unlock(&writeMapMutex);
+    cout << endl;
   }
-  pthread_mutex_unlock(&writeMapMutex);
   return;
 }
 
@@ -25,6 +25,7 @@
 #include <fstream>
 #include <pthread.h>
 #include <map>
+#include <set>
 #include <string>
 #include <sstream> // needed for type conversion
 #include <time.h>
@@ -34,6 +35,10 @@
 #include <dal_config.h>
 #include <core/dalCommon.h>
 #include <core/dalDataset.h>
+#include <core/HDF5Dataset.h>
+#include <data_hl/BF_RootGroup.h>
+#include <data_hl/ProcessingStage.h>
+#include "Bf2h5Calculator.h"
 
 // LOFAR header files
 #ifdef DAL_WITH_LOFAR
@@ -47,6 +52,13 @@ typedef std::map<long int, std::deque<std::pair<uint8_t, float *> > > writeMap;
 // Forward declaration
 class BF2H5;
 
+//! Number of blocks by which the output datasets are grown at once
+#define WRITER_EXTEND_NOF_BLOCKS 16
+//! Number of idle passes of the writer (of 10 ms each) after which missing subbands are given up
+#define WRITER_TIMEOUT_PASSES 25
+//! Number of columns of the flag table
+#define WRITER_FLAG_COLUMNS 4
+
 /*!
   \class HDF5Writer
   
@@ -59,14 +71,78 @@ class BF2H5;
   
   <ul type="square">
     <li>DAL::Bf2h5Calculator
+    <li>DAL::BF_RootGroup
     <li>LOFAR::RTCP::Parset
   </ul>
-  
+
+  <h3>Synopsis</h3>
+
+  The writer serves all stations ingested by the parent application from a
+  single thread, so the HDF5 library is never entered concurrently. Each
+  station has its own beam in the file, and its own block numbering: the
+  writer keeps the current block, the subbands received for it and the output
+  datasets per station, and works on whichever station has data waiting.
+
+  The output of a station is written to 2-dimensional <tt>[time][subband]</tt>
+  datasets, one per output component. The subbands of a block are collected in a block
+  buffer, which is written to each dataset with a single hyperslab write once
+  the block is complete. The datasets are chunked by block and grown
+  WRITER_EXTEND_NOF_BLOCKS blocks at a time; when the writer is stopped they are
+  trimmed to the blocks actually written.
+
+  In the \e Intensity output mode the dataset \e TOTAL_INTENSITY is created in
+  the group \e beam<station> of the dataset. In the Stokes output modes the
+  file is created as a DAL::BF_RootGroup instead, with one
+  DAL::BF_StokesDataset per output component in sub-array pointing 0, beam
+  <station>:
+
+  <table>
+    <tr><th>Output mode</th><th>STOKES_0</th><th>STOKES_1</th><th>STOKES_2</th><th>STOKES_3</th></tr>
+    <tr><td>StokesI</td><td>I</td><td></td><td></td><td></td></tr>
+    <tr><td>StokesIQUV</td><td>I</td><td>Q</td><td>U</td><td>V</td></tr>
+    <tr><td>StokesXXYY</td><td>Re(X)</td><td>Im(X)</td><td>Re(Y)</td><td>Im(Y)</td></tr>
+  </table>
+
+  Data that did not arrive are not zero-filled but recorded, per station, in
+  the flag table \e FLAGS next to the datasets: a 2-dimensional dataset of
+  64-bit integers with one row <tt>[begin, end, subband, reason]</tt> per
+  range of output samples <tt>[begin, end)</tt> holding no valid data for
+  \e subband (-1: all subbands); adjacent ranges of the same subband and
+  reason are merged. The reasons are listed by FlagReason:
+
+  <ul type="square">
+    <li>\e MissingBlock -- the block was dropped before reaching the writer.
+        It is not written at all, so its chunks are never allocated in the
+        file; reading them returns the fill value.
+    <li>\e MissingSubband -- the subband did not reach the writer within
+        WRITER_TIMEOUT_PASSES idle passes. As a chunk holds all subbands of a
+        block, the remaining subbands of the block are written, and the
+        missing one holds zeros.
+    <li>\e StationFlagged -- the samples were flagged by the station, as
+        listed in the flags of the block header of the subband's beam.
+  </ul>
+
+  The flag table is written when the writer is stopped.
+
+  Before a block is written, each of its components can be passed through a
+  DAL::ProcessingChain of its own (see setProcessing()), which dedisperses
+  and/or normalizes the data while they are ingested. The stages used keep the
+  shape of the block, so the layout of the datasets is not affected.
 */
 class HDF5Writer {
 
 public:
 
+  //! Reason for which a range of samples is flagged
+  enum FlagReason {
+    //! The block was dropped before reaching the writer, and is not written
+    MissingBlock = 0,
+    //! The subband did not reach the writer in time; it holds zeros
+    MissingSubband = 1,
+    //! The samples were flagged by the station
+    StationFlagged = 2
+  };
+
   // === Construction ===========================================================
 
 #ifdef DAL_WITH_LOFAR
@@ -74,8 +150,16 @@ public:
 	      const std::string &output_file,
 	      const LOFAR::RTCP::Parset *ps,
 	      size_t output_block_size,
-	      uint8_t nr_subbands);
+	      uint8_t nr_subbands,
+	      unsigned int nofStations=1);
 #endif
+
+  HDF5Writer (BF2H5 *parent,
+	      const std::string &output_file,
+	      size_t output_block_size,
+	      uint8_t nr_subbands,
+	      DAL::Bf2h5Calculator::OutputMode mode,
+	      unsigned int nofStations=1);
   
   // === Destruction ============================================================
 
@@ -87,25 +171,111 @@ public:
   //! Create HDF5 output dataset
   void createHDF5File (const LOFAR::RTCP::Parset *ps);
 #endif
+  //! Create the BF root group and Stokes datasets of the Stokes output modes
+  void createStokesFile (void);
 
+  //! Get the number of stations written
+  inline unsigned int nofStations (void) const {
+    return itsStations.size();
+  }
+  //! Dedisperse and/or normalize the data before writing; call before start()
+  bool setProcessing(std::vector<double> const &frequencies,
+		     double sampleTime,
+		     double dm,
+		     bool normalize);
   //! Start the separate writing thread
   bool start(void);
   //! Add a datablock for writing
-  void writeSubband(long int blockNr, uint8_t subband, float *calculator_data);
+  void writeSubband(unsigned int station, long int blockNr, uint8_t subband, float *calculator_data);
+  //! Mark block \e blockNr of station \e station as dropped; it is not written
+  void skipBlock(unsigned int station, long int blockNr);
+  //! Flag the output samples [begin,end) of \e subband (-1: all subbands) of station \e station
+  void flagSamples(unsigned int station,
+		   int subband,
+		   long long begin,
+		   long long end,
+		   FlagReason reason);
+  //! Get the number of output samples per subband in a block
+  inline size_t blockSize (void) const {
+    return outputBlockSize;
+  }
+  //! Get the number of blocks waiting to be written
+  unsigned int nofPendingBlocks(void);
   void openRawFile( const char* filename );
   //! Check if the writer still has something left to write
   bool dataLeft(void);
-  //! Stop the writing thread
+  //! Stop the writing thread and trim the datasets to the blocks written
   bool stop(void);
   void showStatus(void);
   
  private:
 
+  //! Range of output samples [begin,end) of a subband holding no valid data
+  struct flagRange
+  {
+    //! First output sample of the range
+    long long begin;
+    //! Output sample following the range
+    long long end;
+    //! Subband of the range; -1 for all subbands
+    int subband;
+    //! Why the range is flagged
+    FlagReason reason;
+  };
+
+  //! Output state of a single station
+  struct stationOutput
+  {
+    //! Index of the station; also the number of its beam
+    unsigned int index;
+    //! Path of the group holding the datasets of the station
+    std::string groupName;
+    //! Subbands waiting to be written, per block; protected by writeMapMutex
+    writeMap data;
+    //! Blocks dropped before reaching the writer; protected by writeMapMutex
+    std::set<long int> droppedBlocks;
+    //! Number of the block being written
+    long int currentBlockNr;
+    //! Flags marking the subbands of the current block that have been written
+    bool * subbandReady;
+    //! Has any subband of the current block been received?
+    bool foundDataForCurrentBlock;
+    //! Number of idle passes of the writer spent waiting for the current block
+    uint8_t waitForDataTimeOut;
+    //! Output datasets, one per component
+    std::vector<DAL::HDF5Dataset *> datasets;
+    //! Number of blocks the output datasets currently can hold
+    long int nofAllocatedBlocks;
+    //! Data of the current block, [component][time][subband]
+    float * blockBuffer;
+    //! Processing applied to the blocks before writing, one chain per component
+    std::vector<DAL::ProcessingChain<float> *> chains;
+    //! Ranges of samples without valid data; protected by writeMapMutex
+    std::vector<flagRange> flags;
+  };
+
+  //! Set up the output state of \e nofStations stations
+  void initStations(unsigned int nofStations);
+  //! Write a subband of station \e s, or move on to its next block if possible
+  bool writeStation(stationOutput *s);
   //! Get the data for the currently processed block
-  bool getDataForCurrentBlock(void);
+  bool getDataForCurrentBlock(stationOutput *s, std::pair<uint8_t, float *> &dataPair);
   //! Check if the currently processed block is complete
-  void checkIfBlockComplete(void);
-  void startNextBlock(void);
+  void checkIfBlockComplete(stationOutput *s);
+  //! Check if the currently processed block was dropped
+  bool currentBlockDropped(stationOutput *s);
+  //! Move on to the next block, once the current one is written or dropped
+  void startNextBlock(stationOutput *s);
+  //! Flag the current block as missing, without writing it
+  void skipCurrentBlock(stationOutput *s);
+  //! Write the data of a subband of the currently processed block
+  void writeSubbandData(stationOutput *s, uint8_t subband, float const *data);
+  //! Write the block buffer to the datasets
+  void writeBlock(stationOutput *s);
+  //! Grow the datasets to hold at least \e nofBlocks blocks
+  bool extendDatasets(stationOutput *s, long int nofBlocks);
+  //! Write the flag table of station \e s
+  bool writeFlags(stationOutput *s);
   //! Thread to perform the writing of the data
   void writeData(void);
   //! Start new internal thread
@@ -119,24 +289,25 @@ public:
 
   BF2H5 * itsParent;
   std::fstream * rawfile;
-  DAL::dalTable ** table;
   DAL::dalDataset dataset;
   bool stopWriting;
   std::string itsOutputFile;
-  uint8_t waitForDataTimeOut;
-  std::pair<uint8_t, float *> dataPair;
-  writeMap itsData; // contains the block number, subbands and pointers to datablocks that still need to be written
   pthread_mutex_t writeMapMutex;
-  bool foundDataForCurrentBlock;
-  float * zeroBlock;
   //! Size of a data block (excluded its header)
   size_t outputBlockSize;
   std::string creation_mode;
-  long int nrOfBlocks, currentBlockNr;
-  bool * subbandReady; // points to array of flags marking subbands that have been written
+  long int nrOfBlocks;
   uint8_t nrOfSubbands;
   int64_t file_byte_size;
   pthread_t itsWriteThread;
+  //! Data products written
+  DAL::Bf2h5Calculator::OutputMode itsOutputMode;
+  //! Number of components written per subband
+  unsigned int itsNofComponents;
+  //! Root group of the file in the Stokes output modes
+  DAL::BF_RootGroup * itsRootGroup;
+  //! Output state of the stations
+  std::vector<stationOutput *> itsStations;
 };
 
 
@@ -0,0 +1,217 @@
+/***************************************************************************
+ *   Copyright (C) 2026                                                    *
+ *   agent <agent@local>                                                   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include <algorithm>
+#include <sys/time.h>
+#include "PipelineStats.h"
+
+using std::endl;
+
+namespace DAL { // Namespace DAL -- begin
+
+  // ==============================================================================
+  //
+  //  Construction
+  //
+  // ==============================================================================
+
+  PipelineStats::PipelineStats ()
+    : itsNofDropped(0),
+      itsFirstRead(0),
+      itsLastWritten(0)
+  {
+    pthread_mutex_init(&itsMutex, 0);
+  }
+
+  // ==============================================================================
+  //
+  //  Destruction
+  //
+  // ==============================================================================
+
+  PipelineStats::~PipelineStats ()
+  {
+    pthread_mutex_destroy(&itsMutex);
+  }
+
+  // ==============================================================================
+  //
+  //  Parameter access
+  //
+  // ==============================================================================
+
+  //_______________________________________________________________________________
+  //                                                                     nofWritten
+
+  unsigned long PipelineStats::nofWritten (void)
+  {
+    pthread_mutex_lock (&itsMutex);
+    unsigned long nofBlocks = itsLatency[2].size();
+    pthread_mutex_unlock (&itsMutex);
+    return nofBlocks;
+  }
+
+  //_______________________________________________________________________________
+  //                                                                     nofDropped
+
+  unsigned long PipelineStats::nofDropped (void)
+  {
+    pthread_mutex_lock (&itsMutex);
+    unsigned long nofBlocks = itsNofDropped;
+    pthread_mutex_unlock (&itsMutex);
+    return nofBlocks;
+  }
+
+  //_______________________________________________________________________________
+  //                                                                        elapsed
+
+  double PipelineStats::elapsed (void)
+  {
+    pthread_mutex_lock (&itsMutex);
+    double seconds = itsLastWritten > itsFirstRead ? itsLastWritten - itsFirstRead : 0;
+    pthread_mutex_unlock (&itsMutex);
+    return seconds;
+  }
+
+  //_______________________________________________________________________________
+  //                                                                     percentile
+
+  /*!
+    \param from -- Stage at which the latency starts.
+    \param to   -- Stage at which the latency ends; later than \e from.
+    \param p    -- Percentile, between 0 and 100.
+
+    \return latency -- The latency in seconds; 0 if no block has been written.
+  */
+  double PipelineStats::percentile (Stage from,
+				    Stage to,
+				    double p)
+  {
+    int index = (from == Read) ? (to == Calculated ? 0 : 2) : 1;
+    double latency = 0;
+
+    pthread_mutex_lock (&itsMutex);
+    std::vector<double> &latencies = itsLatency[index];
+    if (!latencies.empty()) {
+      size_t n = std::min (latencies.size() - 1, size_t(p / 100.0 * latencies.size()));
+      std::nth_element (latencies.begin(), latencies.begin() + n, latencies.end());
+      latency = latencies[n];
+    }
+    pthread_mutex_unlock (&itsMutex);
+
+    return latency;
+  }
+
+  //_______________________________________________________________________________
+  //                                                                            now
+
+  double PipelineStats::now (void)
+  {
+    struct timeval tv;
+    gettimeofday (&tv, NULL);
+    return tv.tv_sec + 1e-6 * tv.tv_usec;
+  }
+
+  // ==============================================================================
+  //
+  //  Methods
+  //
+  // ==============================================================================
+
+  //_______________________________________________________________________________
+  //                                                                           mark
+
+  /*!
+    \param station -- Index of the station.
+    \param blockNr -- Number of the block.
+    \param stage   -- The stage the block has passed. Marks for blocks which
+           have not been read, or have been dropped, are ignored.
+  */
+  void PipelineStats::mark (unsigned int station,
+			    long int blockNr,
+			    Stage stage)
+  {
+    double t = now();
+    blockKey key (station, blockNr);
+
+    pthread_mutex_lock (&itsMutex);
+
+    if (stage == Read) {
+      itsPending[key] = std::vector<double> (3, t);
+      if (itsFirstRead == 0) {
+	itsFirstRead = t;
+      }
+    }
+    else {
+      std::map<blockKey, std::vector<double> >::iterator it = itsPending.find (key);
+      if (it != itsPending.end()) {
+	it->second[stage] = t;
+	if (stage == Written) {
+	  itsLatency[0].push_back (it->second[Calculated] - it->second[Read]);
+	  itsLatency[1].push_back (t - it->second[Calculated]);
+	  itsLatency[2].push_back (t - it->second[Read]);
+	  itsLastWritten = t;
+	  itsPending.erase (it);
+	}
+      }
+    }
+
+    pthread_mutex_unlock (&itsMutex);
+  }
+
+  //_______________________________________________________________________________
+  //                                                                        dropped
+
+  void PipelineStats::dropped (unsigned int station,
+			       long int blockNr)
+  {
+    pthread_mutex_lock (&itsMutex);
+    itsPending.erase (blockKey (station, blockNr));
+    ++itsNofDropped;
+    pthread_mutex_unlock (&itsMutex);
+  }
+
+  //_______________________________________________________________________________
+  //                                                                        summary
+
+  /*!
+    \param os -- Output stream to which the summary is written.
+  */
+  void PipelineStats::summary (std::ostream &os)
+  {
+    char const *names[3] = { "Read to calculated    ",
+			    "Calculated to written ",
+			    "Read to written       " };
+    Stage from[3] = { Read, Calculated, Read };
+    Stage to[3]   = { Calculated, Written, Written };
+
+    os << "[PipelineStats] Latencies of the stages in ms (p50 / p90 / p99 / max)." << endl;
+    for (int n = 0; n < 3; ++n) {
+      os << "-- " << names[n] << " = "
+	 << 1e3 * percentile (from[n], to[n], 50) << " / "
+	 << 1e3 * percentile (from[n], to[n], 90) << " / "
+	 << 1e3 * percentile (from[n], to[n], 99) << " / "
+	 << 1e3 * percentile (from[n], to[n], 100) << endl;
+    }
+    os << "-- Blocks written         = " << nofWritten() << endl;
+    os << "-- Blocks dropped         = " << nofDropped() << endl;
+  }
+
+} // Namespace DAL -- end
@@ -0,0 +1,135 @@
+/***************************************************************************
+ *   Copyright (C) 2026                                                    *
+ *   agent <agent@local>                                                   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+
+#ifndef PIPELINESTATS_H
+#define PIPELINESTATS_H
+
+#include <pthread.h>
+#include <iostream>
+#include <map>
+#include <vector>
+
+namespace DAL { // Namespace DAL -- begin
+
+  /*!
+    \class PipelineStats
+
+    \ingroup DAL
+    \ingroup dal_apps
+
+    \brief Latency and throughput statistics of the bf2h5 stages
+
+    <h3>Synopsis</h3>
+
+    The application marks each block of each station when it has been read,
+    when the calculator has completed it, and when the writer has written it;
+    from these time stamps the latencies of the stages are collected, and
+    reported as percentiles by summary(). Blocks that are dropped are only
+    counted. The marks may be set from any thread.
+
+    Statistics are only collected if an object of this class is passed to the
+    application (see BF2H5::setStatistics()), as is done by the benchmark
+    bf2h5bench.
+  */
+  class PipelineStats
+  {
+  public:
+
+    //! Stage a block has passed
+    enum Stage {
+      //! The block has been read from the input
+      Read = 0,
+      //! The calculator has completed the block
+      Calculated = 1,
+      //! The writer has written the block
+      Written = 2
+    };
+
+    // === Construction =========================================================
+
+    //! Default constructor
+    PipelineStats ();
+
+    // === Destruction ==========================================================
+
+    //! Destructor
+    ~PipelineStats ();
+
+    // === Parameter access =====================================================
+
+    //! Get the number of blocks written
+    unsigned long nofWritten (void);
+
+    //! Get the number of blocks dropped
+    unsigned long nofDropped (void);
+
+    //! Get the time between the first block read and the last block written, in seconds
+    double elapsed (void);
+
+    //! Get the percentile \e p (0-100) of the latency from stage \e from to stage \e to, in seconds
+    double percentile (Stage from,
+		       Stage to,
+		       double p);
+
+    // === Methods ==============================================================
+
+    //! Mark block \e blockNr of station \e station as having passed \e stage
+    void mark (unsigned int station,
+	       long int blockNr,
+	       Stage stage);
+
+    //! Count block \e blockNr of station \e station as dropped
+    void dropped (unsigned int station,
+		  long int blockNr);
+
+    //! Provide a summary of the statistics
+    inline void summary (void) {
+      summary (std::cout);
+    }
+
+    //! Provide a summary of the statistics
+    void summary (std::ostream &os);
+
+    //! Get the current wall-clock time in seconds
+    static double now (void);
+
+  private:
+
+    //! Identifies a block: station index and block number
+    typedef std::pair<unsigned int,long int> blockKey;
+
+    //! Time stamps of the blocks in flight, per stage
+    std::map<blockKey, std::vector<double> > itsPending;
+    //! Latencies of the blocks written: read-calculated, calculated-written, read-written
+    std::vector<double> itsLatency[3];
+    //! Number of blocks dropped
+    unsigned long itsNofDropped;
+    //! Time the first block was read
+    double itsFirstRead;
+    //! Time the last block was written
+    double itsLastWritten;
+    //! Protects the statistics
+    pthread_mutex_t itsMutex;
+  };
+
+} // Namespace DAL -- end
+
+#endif  /* PIPELINESTATS_H */
@@ -19,8 +19,11 @@
  ***************************************************************************/
 
 #include <iostream> // for cout,cerr etc.
-#include <fstream> // for file mode
+#include <errno.h>
+#include <fcntl.h> // for file mode
 #include <signal.h> // for time-out on socket
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "bf2h5.h"
 #include "StationBeamReader.h"
@@ -28,13 +31,11 @@
 using std::cerr;
 using std::cout;
 using std::endl;
-using std::ios;
 using std::stringstream;
 using namespace DAL;
 
 namespace DAL { // Namespace DAL -- begin
   
-  int StationBeamReader::server_socket = 0;
   // bool StationBeamReader::time_out = false;
 
   // ============================================================================
@@ -45,11 +46,17 @@ namespace DAL { // Namespace DAL -- begin
   
   StationBeamReader::StationBeamReader (BF2H5 *parent,
 					bool socket_mode)
-    : socklen(sizeof(incoming_addr)),
-      rawfile(0),
+    : finished_reading(false),
+      server_socket(-1),
+      socklen(sizeof(incoming_addr)),
+      file_byte_size(0),
+      itsMapAddress(0),
+      itsMapLength(0),
+      itsMapOffset(0),
       itsParent(parent),
       socketmode(socket_mode), 
       memAllocOK(true),
+      dataBlockSize(0),
       blockHeaderSize(sizeof(BFRawFormat::BlockHeader))
   {
     bigendian = BigEndian();
@@ -64,14 +71,10 @@ namespace DAL { // Namespace DAL -- begin
   StationBeamReader::~StationBeamReader()
   {
     // close sockets and input file if open
-    if (server_socket)
-      close(server_socket);
-    if (rawfile) {
-      if (rawfile->is_open()) {
-	rawfile->close();
-      }
-      delete rawfile;
-      rawfile = NULL;
+    closeSocket();
+    /* The calculator may have used the samples in the mapping until now */
+    if (itsMapAddress) {
+      munmap (itsMapAddress, itsMapLength);
     }
   }
   
@@ -101,39 +104,76 @@ namespace DAL { // Namespace DAL -- begin
   //_____________________________________________________________________________
   //                                                                  openRawFile
 
+  /*!
+    Maps the input file into memory, such that the data blocks can be handed
+    to the calculator without copying them.
+
+    \param filename -- Name of the file containing the raw data.
+  */
   bool StationBeamReader::openRawFile (std::string &filename)
   {
-    rawfile = new std::fstream( filename.data(), ios::binary|ios::in );
+    int fd = ::open (filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+      cerr << "[StationBeamReader::openRawFile] Failed to open " << filename << endl;
+      return false;
+    }
+
+    struct stat fileStatus;
+    if (fstat (fd, &fileStatus) != 0 || fileStatus.st_size == 0) {
+      cerr << "[StationBeamReader::openRawFile] " << filename << " is empty" << endl;
+      ::close (fd);
+      return false;
+    }
+
+    void *address = mmap (NULL, fileStatus.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close (fd);
+
+    if (address == MAP_FAILED) {
+      cerr << "[StationBeamReader::openRawFile] Failed to map " << filename
+	   << " into memory!" << endl;
+      return false;
+    }
+
+    /* The file is read front to back, once */
+    madvise (address, fileStatus.st_size, MADV_SEQUENTIAL);
 
-    /* Move to end of file to determine its file size. */
-    rawfile->seekg(0, ios::end);
-    /* See how many bytes in file */
-    file_byte_size = static_cast<size_t>(rawfile->tellg())-2;
-    /* Move to start of file */
-    rawfile->seekg(0, ios::beg);
+    itsMapAddress  = reinterpret_cast<char *>(address);
+    itsMapLength   = fileStatus.st_size;
+    itsMapOffset   = 0;
+    file_byte_size = itsMapLength - 2;
 
-    return rawfile->is_open();
+    return true;
   }
   
   //_____________________________________________________________________________
   //                                                                finishReading
 
+  /*!
+    In file mode the mapping is kept, as the calculator may still be working
+    on the last blocks; it is released by the destructor.
+  */
   void StationBeamReader::finishReading (void)
   {
 #ifdef DAL_DEBUGGING_MESSAGES
     cout << "StationBeamReader::finishReading, now closing socket connection" << endl;
 #endif
     
-    if (socketmode) {
-      // close socket
+    if (socketmode && !finished_reading) {
+      closeSocket();
+    }
+    finished_reading = true;
+  }
+  
+  //_____________________________________________________________________________
+  //                                                                  closeSocket
+
+  void StationBeamReader::closeSocket (void)
+  {
+    if (server_socket >= 0) {
       shutdown(server_socket, SHUT_RDWR);
       close(server_socket);
+      server_socket = -1;
     }
-    else {
-      if (rawfile->is_open())
-	rawfile->close();
-    }
-    finished_reading = true;
   }
   
   //_____________________________________________________________________________
@@ -169,7 +209,7 @@ namespace DAL { // Namespace DAL -- begin
 #ifdef DAL_DEBUGGING_MESSAGES
 	cerr << "StationBeamReader::connectSocket: ERROR socket bind failed" << endl;
 #endif
-	close(server_socket);
+	closeSocket();
 	return false;
       }
     
@@ -179,7 +219,7 @@ namespace DAL { // Namespace DAL -- begin
 #ifdef DAL_DEBUGGING_MESSAGES
 	cerr << "StationBeamReader::connectSocket: ERROR listen failed" << endl;
 #endif
-	close(server_socket);
+	closeSocket();
 	return false;
       }
     int old_server_socket = server_socket;
@@ -187,13 +227,19 @@ namespace DAL { // Namespace DAL -- begin
 #ifdef DAL_DEBUGGING_MESSAGES
       cerr << "StationBeamReader::connectSocket: ERROR accept failed" << endl;
 #endif
-      close(server_socket);
+      close(old_server_socket);
       return false;
     }
 #ifdef DAL_DEBUGGING_MESSAGES
     cout << "StationBeamReader::connectSocket: socket connected" << endl;
 #endif
     close(old_server_socket);
+
+    /* Room for a few blocks in the kernel, so that a block can be taken in a
+       single read; the kernel limits this to net.core.rmem_max. */
+    int receiveBufferSize = 64 * 1024 * 1024;
+    setsockopt (server_socket, SOL_SOCKET, SO_RCVBUF,
+		&receiveBufferSize, sizeof(receiveBufferSize));
     
     return true;
   }
@@ -204,27 +250,30 @@ namespace DAL { // Namespace DAL -- begin
   bool StationBeamReader::readMainHeader (BFRawFormat::BFRaw_Header &header)
   {
     if (socketmode) {
-      if (recvfrom(server_socket, reinterpret_cast<char *>(&header), sizeof(header),0,  (sockaddr *) &incoming_addr, &socklen) < static_cast<int>(sizeof(header))) {
+      if (receiveBytes(reinterpret_cast<char *>(&header), sizeof(header)) <= 0) {
 #ifdef DAL_DEBUGGING_MESSAGES
 	cerr << "ERROR reading main header from socket" << endl;
 #endif
-	close(server_socket);
+	closeSocket();
 	return false;
       }
     }
     else { // file mode
-      if ( !rawfile->read ( reinterpret_cast<char *>(&header), sizeof(header) ))
+      if (itsMapOffset + sizeof(header) > itsMapLength)
 	{
 #ifdef DAL_DEBUGGING_MESSAGES
 	  cerr << "ERROR reading main header from file" << endl;
-	  cerr << "read pointer position: " << rawfile->tellg() << endl;
+	  cerr << "read pointer position: " << itsMapOffset << endl;
 #endif
 	  return false;
 	}
+      /* The header is converted in place, so it is not used from the mapping */
+      memcpy (&header, itsMapAddress + itsMapOffset, sizeof(header));
+      itsMapOffset += sizeof(header);
       
 #ifdef DAL_DEBUGGING_MESSAGES
       cout << "size of main header: " << sizeof(header) << endl;
-      cout << "read pointer position: " << rawfile->tellg() << endl;
+      cout << "read pointer position: " << itsMapOffset << endl;
 #endif
     }
     
@@ -243,79 +292,144 @@ namespace DAL { // Namespace DAL -- begin
   //_____________________________________________________________________________
   //                                                           readFirstDataBlock
 
-  bool
+  /*!
+    \param first_block_header -- Copy of the header of the first block, in host
+           byte order.
+    \param sample_data        -- Buffer of bufferSize() bytes to read the block
+           into; left unused in file mode.
+    \param data_block_size    -- Size of the samples of a block in bytes.
+
+    \return samples -- Pointer to the samples of the block; NULL if no block
+            could be read.
+  */
+  BFRawFormat::Sample *
   StationBeamReader::readFirstDataBlock (BFRawFormat::BlockHeader &first_block_header,
 					 BFRawFormat::Sample *sample_data,
 					 size_t data_block_size)
   {
-    dataBlockSize      = data_block_size;
-    int64_t read_bytes = receiveBytes(reinterpret_cast<char *>(&first_block_header),
-				      sizeof(BFRawFormat::BlockHeader));
-
-    if (read_bytes > 0) {
+    BFRawFormat::BlockHeader *header = 0;
+    
+    dataBlockSize = data_block_size;
+    
+    BFRawFormat::Sample *samples = nextBlock (header, sample_data);
+    
+    if (samples) {
+      first_block_header = *header;
       if (!bigendian) { convertEndian(&first_block_header); }
-      if ((read_bytes = receiveBytes(reinterpret_cast<char *>(sample_data), dataBlockSize)) != -1) {
-	return true;
-      }
-      else if (read_bytes == 0) {
-	finishReading();
-	return false;
-      }
-      else {
-#ifdef DAL_DEBUGGING_MESSAGES
-	cerr << "ERROR, receiving the first data block samples" << endl;
-#endif
-	return false;
-      }
     }
-    else if (read_bytes == 0) {
-      finishReading();
-      return false;
-    }
-    else {
 #ifdef DAL_DEBUGGING_MESSAGES
-      cerr << "ERROR, receiving the first data block header" << endl;
-#endif
-      //throw "Error, receiving the first data block header";
+    else {
+      cerr << "ERROR, receiving the first data block" << endl;
     }
-    return false;
-    //}
+#endif
+    
+    return samples;
   }
   
   //_____________________________________________________________________________
   //                                                                readDataBlock
 
-  bool StationBeamReader::readDataBlock (BFRawFormat::Sample *sample_data)
+  /*!
+    \param sample_data  -- Buffer of bufferSize() bytes to read the block into;
+           left unused in file mode.
+    \param block_header -- If given, receives a copy of the header of the
+           block, converted to the byte order of the host.
+
+    \return samples -- Pointer to the samples of the block; NULL if no block
+            could be read.
+  */
+  BFRawFormat::Sample * StationBeamReader::readDataBlock (BFRawFormat::Sample *sample_data,
+							  BFRawFormat::BlockHeader *block_header)
   {
-    BFRawFormat::BlockHeader *dump = new BFRawFormat::BlockHeader();
-    int64_t read_bytes = receiveBytes(reinterpret_cast<char *>(dump), blockHeaderSize);
-    delete dump;
-    if (read_bytes > 0) { // throw away block header
-      //	if (!bigendian) { convertEndian(&blockheader); }
-      if ((read_bytes = receiveBytes(reinterpret_cast<char *>(sample_data), dataBlockSize)) > 0) {
-	cout << "sampledata[0].xx=" << sample_data->xx << ", yy=" << sample_data->yy << endl;
-	return true;
-      }
-      else if (read_bytes == 0) {
+    BFRawFormat::BlockHeader *header = 0;
+    
+    BFRawFormat::Sample *samples = nextBlock (header, sample_data);
+
+    if (samples && block_header) {
+      *block_header = *header;
+      if (!bigendian) { convertEndian(block_header); }
+    }
+
+    return samples;
+  }
+  
+  //_____________________________________________________________________________
+  //                                                                    nextBlock
+
+  /*!
+    \param header      -- Set to the header of the block, in the byte order of
+           the input.
+    \param sample_data -- Buffer of bufferSize() bytes to read the block into;
+           left unused in file mode.
+
+    \return samples -- Pointer to the samples of the block; NULL at the end of
+            the input, on a read error, or if the magic number of the block is
+            wrong -- in all these cases reading is finished.
+  */
+  BFRawFormat::Sample *
+  StationBeamReader::nextBlock (BFRawFormat::BlockHeader *&header,
+				BFRawFormat::Sample *sample_data)
+  {
+    BFRawFormat::Sample *samples = 0;
+    
+    if (finished_reading) {
+      return 0;
+    }
+    
+    if (itsMapAddress) {
+      if (itsMapOffset + blockHeaderSize + dataBlockSize > itsMapLength) {
 	finishReading();
-	return false;
+	return 0;
       }
-      else {
-	cerr << "ERROR, receiving data block samples" << endl;
-	return false;
+      header  = reinterpret_cast<BFRawFormat::BlockHeader *>(itsMapAddress + itsMapOffset);
+      samples = reinterpret_cast<BFRawFormat::Sample *>(itsMapAddress + itsMapOffset + blockHeaderSize);
+      itsMapOffset += blockHeaderSize + dataBlockSize;
+    }
+    else {
+      /* Header behind the samples, such that the samples keep the alignment of the buffer */
+      header  = reinterpret_cast<BFRawFormat::BlockHeader *>(reinterpret_cast<char *>(sample_data) + dataBlockSize);
+      samples = sample_data;
+      
+      struct iovec iov[2];
+      iov[0].iov_base = header;
+      iov[0].iov_len  = blockHeaderSize;
+      iov[1].iov_base = samples;
+      iov[1].iov_len  = dataBlockSize;
+      
+      int64_t read_bytes = receiveVector (iov, 2);
+      if (read_bytes <= 0) {
+	if (read_bytes < 0) {
+	  cerr << "ERROR, receiving data block" << endl;
+	}
+	finishReading();
+	return 0;
       }
     }
-    else if (read_bytes == 0) {
+    
+    if (!checkMagic(header)) {
       finishReading();
-      return false;
+      return 0;
     }
-    else {
-#ifdef DAL_DEBUGGING_MESSAGES
-      cerr << "ERROR, receiving data block header" << endl;
-#endif
-      //throw "Error, receiving the first data block header";
+    
+    return samples;
+  }
+  
+  //_____________________________________________________________________________
+  //                                                                   checkMagic
+
+  bool StationBeamReader::checkMagic (BFRawFormat::BlockHeader const *header)
+  {
+    uint32_t magic = header->magic;
+    if (!bigendian) {
+      swapbytes((char *)&magic,4);
+    }
+    if (magic != BFRawFormat::blockMagic) {
+      cerr << "[StationBeamReader::checkMagic] Wrong magic number 0x" << std::hex
+	   << magic << " in block header, expected 0x" << BFRawFormat::blockMagic
+	   << std::dec << endl;
       return false;
     }
+    return true;
   }
   
   //_____________________________________________________________________________
@@ -328,10 +442,12 @@ namespace DAL { // Namespace DAL -- begin
     int8_t *bytepointer = reinterpret_cast<int8_t *>(storage);
 
     while (true) {
-      bytes_read = recvfrom(server_socket, bytepointer, nrOfBytesToRead, 0, (sockaddr *) &incoming_addr, &socklen);
+      bytes_read = recvfrom(server_socket, bytepointer, nrOfBytesToRead, MSG_WAITALL, (sockaddr *) &incoming_addr, &socklen);
       if (bytes_read == -1) { // error reading
-	shutdown(server_socket, SHUT_RDWR);
-	close(server_socket);
+	if (errno == EINTR) {
+	  continue;
+	}
+	closeSocket();
 	return -1;
       }
       else if (bytes_read == 0) { // end of stream?
@@ -345,6 +461,48 @@ namespace DAL { // Namespace DAL -- begin
     }
   }
   
+  //_____________________________________________________________________________
+  //                                                                receiveVector
+
+  /*!
+    \param iov    -- The buffers to fill, in order; adjusted while reading.
+    \param iovcnt -- Number of buffers.
+
+    \return nofBytes -- The number of bytes read; 0 at the end of the stream,
+            -1 on a read error.
+  */
+  int64_t StationBeamReader::receiveVector (struct iovec *iov,
+					    int iovcnt)
+  {
+    int64_t total = 0;
+
+    while (iovcnt > 0) {
+      ssize_t bytes_read = readv(server_socket, iov, iovcnt);
+      if (bytes_read == -1) {
+	if (errno == EINTR) {
+	  continue;
+	}
+	return -1;
+      }
+      else if (bytes_read == 0) { // end of stream, a partial block is discarded
+	return 0;
+      }
+      total += bytes_read;
+      /* Skip the buffers that were filled, continue within the next one */
+      while (iovcnt > 0 && size_t(bytes_read) >= iov->iov_len) {
+	bytes_read -= iov->iov_len;
+	++iov;
+	--iovcnt;
+      }
+      if (iovcnt > 0) {
+	iov->iov_base = reinterpret_cast<char *>(iov->iov_base) + bytes_read;
+	iov->iov_len -= bytes_read;
+      }
+    }
+
+    return total;
+  }
+  
   //_____________________________________________________________________________
   //                                                            swapHeaderEndians
 
@@ -354,7 +512,7 @@ namespace DAL { // Namespace DAL -- begin
     for (int ii = 0; ii < BFRawFormat::maxNrSubbands; ii++)
       {
 	swapbytes((char *)&header.subbandFrequencies[ii],8);
-	swapbytes((char *)&header.subbandToBeamMapping,2);
+	swapbytes((char *)&header.subbandToBeamMapping[ii],2);
       }
     
     for (int ii = 0; ii < 8; ii++)
@@ -28,12 +28,12 @@
 #include <sstream>
 #include <netdb.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 
 #include <coordinates/Angle.h>
 #include <data_hl/BFRawFormat.h>
 
 // Forward declarations
-class fstream;
 class BF2H5;
 
 namespace DAL { // Namespace DAL -- begin
@@ -45,13 +45,26 @@ namespace DAL { // Namespace DAL -- begin
     \ingroup dal_apps
     
     \author Alwin de Jong
+
+    <h3>Synopsis</h3>
+
+    Each data block consists of a block header followed by the samples. In
+    socket mode a block is received with a single scatter read straight into
+    the buffer passed to readDataBlock(): the samples at the start of the
+    buffer, the header behind them, such that the samples keep the alignment
+    of the buffer. The buffer therefore has to hold bufferSize() bytes. Only
+    the magic number of the header is checked, in place; the rest of the
+    header of blocks after the first is only converted if a copy of it is
+    requested from readDataBlock().
+
+    In file mode the input file is mapped into memory, and readDataBlock()
+    returns a pointer to the samples within the mapping instead of copying
+    them into the buffer.
   */
   class StationBeamReader {
     
   public:
     
-    static int server_socket;
-    
     // === Construction ===========================================================
     
     // ! Argumented constructor
@@ -79,12 +92,23 @@ namespace DAL { // Namespace DAL -- begin
     bool readMainHeader (BFRawFormat::BFRaw_Header &header);
     
     //! Read the first block of data
-    bool readFirstDataBlock (BFRawFormat::BlockHeader &first_block_header,
-			     BFRawFormat::Sample *sample_data,
-			     size_t data_block_size);
+    BFRawFormat::Sample * readFirstDataBlock (BFRawFormat::BlockHeader &first_block_header,
+					      BFRawFormat::Sample *sample_data,
+					      size_t data_block_size);
+    
+    //! Read a block of data, optionally returning a copy of its header
+    BFRawFormat::Sample * readDataBlock(BFRawFormat::Sample *sample_data,
+					BFRawFormat::BlockHeader *block_header=0);
+    
+    //! Get the size of the buffers passed to readDataBlock()
+    static inline size_t bufferSize (size_t data_block_size) {
+      return data_block_size + sizeof(BFRawFormat::BlockHeader);
+    }
     
-    //! Read a block of data
-    bool readDataBlock(BFRawFormat::Sample *sample_data);
+    //! Is the input file mapped into memory, i.e. are the buffers left unused?
+    inline bool isMapped (void) const {
+      return itsMapAddress != 0;
+    }
     
     //! Check if we have finished reading data
     inline bool finishedReading(void) const {
@@ -100,6 +124,15 @@ namespace DAL { // Namespace DAL -- begin
     
     //! Low level read from socket
     int64_t receiveBytes (void *storage, int64_t nrOfBytesToRead);
+    //! Low level scatter read from socket
+    int64_t receiveVector (struct iovec *iov, int iovcnt);
+    //! Get the next block, from the socket or the mapped file
+    BFRawFormat::Sample * nextBlock (BFRawFormat::BlockHeader *&header,
+				     BFRawFormat::Sample *sample_data);
+    //! Check the magic number of a block header
+    bool checkMagic (BFRawFormat::BlockHeader const *header);
+    //! Shut down and close the socket, if open
+    void closeSocket (void);
     bool openRawFile( std::string &filename );
     bool connectSocket(unsigned int port_number);
     //! Swap the byte endians if not in bigendian
@@ -114,13 +147,20 @@ namespace DAL { // Namespace DAL -- begin
     bool bigendian;
     
     // socket things:
+    //! Connected socket in socket mode; -1 if there is none
+    int server_socket;
     unsigned portNumber;
     struct sockaddr_in incoming_addr;
     socklen_t socklen;
     
     //file things
-    std::fstream * rawfile;	
     size_t file_byte_size;
+    //! Start of the mapped input file
+    char * itsMapAddress;
+    //! Length of the mapped input file
+    size_t itsMapLength;
+    //! Read position within the mapped input file
+    size_t itsMapOffset;
     
     BF2H5 * itsParent;
     bool socketmode;
@@ -19,6 +19,7 @@
  ***************************************************************************/
 
 #include "bf2h5.h"
+#include <algorithm>
 #include <iostream>
 
 using std::string;
@@ -43,15 +44,22 @@ BF2H5::BF2H5 (const std::string &outfile,
 	      const std::string &parset_filename,
 	      uint downsample_factor,
 	      bool do_intensity)
-  : socketmode(false),
+  : itsNofCalculationThreads(0),
+    itsOutputMode(DAL::Bf2h5Calculator::Intensity),
+    itsNofBuffers(DEFAULT_NR_OF_BUFFERS),
+    itsBufferPolicy(DAL::BufferPool::Block),
+    itsUseHugePages(false),
+    itsDispersionMeasure(0),
+    itsNormalizeBandpass(false),
+    itsStats(0),
     outputFile(outfile),
     itsCalculator(0),
     itsWriter(0),
-    itsReader(0),
     oneBlockdataSize(0),
-    itsReadBuffer(0),
-    itsCurrentNrOfReadBuffers(INITIAL_NR_OF_READ_BUFFERS)
+    itsSamplePool(0)
 {
+  pthread_mutex_init(&itsBufferMutex, 0);
+
   itsParseFile        = parset_filename;
   itsDownsampleFactor = downsample_factor;
   itsDoIntensity      = do_intensity;
@@ -78,12 +86,15 @@ BF2H5::BF2H5 (const std::string &outfile,
 
 BF2H5::~BF2H5()
 {
-  delete itsReader;
+  for (unsigned int n = 0; n < itsStations.size(); ++n) {
+    delete itsStations[n]->reader;
+    delete [] reinterpret_cast<char *>(itsStations[n]->dropBuffer);
+    delete itsStations[n];
+  }
   delete itsWriter;
   delete itsCalculator;
-  for (sampleBuffers::iterator it = itsSampleBuffers.begin(); it != itsSampleBuffers.end(); ++it) {
-    delete [] *it;
-  }
+  delete itsSamplePool;
+  pthread_mutex_destroy(&itsBufferMutex);
 
 #ifdef DAL_WITH_LOFAR
   delete itsParset;
@@ -97,21 +108,82 @@ BF2H5::~BF2H5()
 // ==============================================================================
 
 //_______________________________________________________________________________
-//                                                                  setSocketMode
+//                                                                     addStation
+
+BF2H5::station * BF2H5::addStation (void)
+{
+  station *s    = new station;
+  s->This       = this;
+  s->index      = itsStations.size();
+  s->socketmode = false;
+  s->tcpPort    = 0;
+  s->reader     = 0;
+  s->readBuffer = -1;
+  s->samples    = 0;
+  s->dropBuffer = 0;
+  s->nofBlocks  = 0;
+  itsStations.push_back(s);
+  return s;
+}
+
+//_______________________________________________________________________________
+//                                                                 addSocketInput
+
+/*!
+  \param port -- Port from which the beam of the station is read.
+*/
+void BF2H5::addSocketInput (uint port)
+{
+  station *s    = addStation();
+  s->tcpPort    = port;
+  s->socketmode = true;
+}
+
+//_______________________________________________________________________________
+//                                                                   addFileInput
 
-void BF2H5::setSocketMode(uint port)
+/*!
+  \param infile -- File from which the beam of the station is read.
+*/
+void BF2H5::addFileInput (std::string const &infile)
 {
-  tcpPort    = port;
-  socketmode = true;
+  station *s    = addStation();
+  s->inputFile  = infile;
+  s->socketmode = false;
 }
 
 //_______________________________________________________________________________
-//                                                                    setFileMode
+//                                                                    openStation
+
+/*!
+  \param s -- The station.
 
-void BF2H5::setFileMode(std::string &infile)
+  \return status -- Returns \e false if the input could not be opened, or its
+          main header could not be read.
+*/
+bool BF2H5::openStation (station *s)
 {
-  inputFile  = infile;
-  socketmode = false;
+  bool result = false;
+
+  s->reader = new DAL::StationBeamReader(this, s->socketmode);
+
+  /* Connect to the input source */
+  if (s->socketmode) {
+    result = s->reader->setSocketMode(s->tcpPort);
+  }
+  else {
+    result = s->reader->setFileMode(s->inputFile);
+  }
+
+  if (result) {
+    result = s->reader->readMainHeader(s->mainHeader);
+  }
+  if (!result) {
+    cerr << "[BF2H5::openStation] Could not read the main header of station "
+	 << s->index << endl;
+  }
+
+  return result;
 }
 
 //_______________________________________________________________________________
@@ -121,7 +193,7 @@ void BF2H5::getTimeFromBlockHeader(void)
 {
   // write the utc time to hdf5 file according to header time info
   time_t utc;
-  utc = (time_t)(firstBlockHeader.time[0]/(int64_t)BFMainHeader.sampleRate);
+  utc = (time_t)(itsStations[0]->firstBlockHeader.time[0]/(int64_t)getMainHeader().sampleRate);
   uint16_t buf_size(128);
   char * time_date = new char[buf_size];
   memset (time_date,'\0',buf_size);
@@ -143,72 +215,227 @@ void BF2H5::getTimeFromBlockHeader(void)
 
 bool BF2H5::allocateSampleBuffers(void)
 {
-#ifdef DAL_DEBUGGING_MESSAGES
-  cout << "BF2H5::allocateSampleBuffers: allocating " << itsCurrentNrOfReadBuffers * oneBlockdataSize * sizeof(BFRawFormat::Sample) << " bytes for sample input data" << endl;
-#endif
-  try {
-    for (unsigned short i = 0; i < itsCurrentNrOfReadBuffers; ++i) {
-      BFRawFormat::Sample *pbuf = new BFRawFormat::Sample[ oneBlockdataSize ];
-//		memset(pbuf, 0, oneBlockdataSize * sizeof(BFRawFormat::Sample));
-      itsSampleBuffers.push_back(pbuf);
-      itsBufferTracker[i] = -1;
+  /* Room for the block header behind the samples, so that a block is received
+     in one go; the blocks of a mapped input file are used in place, so if all
+     stations are read from files the pool only limits the number of blocks in
+     flight. */
+  size_t blockSize  = DAL::StationBeamReader::bufferSize(oneBlockdataSize * sizeof(BFRawFormat::Sample));
+  size_t bufferSize = 0;
+  for (unsigned int n = 0; n < itsStations.size(); ++n) {
+    if (!itsStations[n]->reader->isMapped()) {
+      bufferSize = blockSize;
     }
-    itsBufferTracker[0] = 0; // first buffer will be used by block 0
   }
-  catch (bad_alloc) {
+  unsigned int nofBuffers = itsNofBuffers * itsStations.size();
+#ifdef DAL_DEBUGGING_MESSAGES
+  cout << "BF2H5::allocateSampleBuffers: allocating " << nofBuffers * bufferSize << " bytes for sample input data" << endl;
+#endif
+  itsSamplePool = new DAL::BufferPool ("sample",
+				       nofBuffers,
+				       bufferSize,
+				       itsBufferPolicy,
+				       itsUseHugePages);
+  if (!itsSamplePool->isValid()) {
     cerr << "Can't allocate memory for input databuffer." << endl;
     return false;
   }
+  if (itsBufferPolicy == DAL::BufferPool::Drop) {
+    for (unsigned int n = 0; n < itsStations.size(); ++n) {
+      if (itsStations[n]->reader->isMapped()) {
+	continue;
+      }
+      try {
+	itsStations[n]->dropBuffer = reinterpret_cast<BFRawFormat::Sample *>(new char[ blockSize ]);
+      }
+      catch (bad_alloc const &) {
+	cerr << "Can't allocate memory for input databuffer." << endl;
+	return false;
+      }
+    }
+  }
   return true;
 }
 
+//_______________________________________________________________________________
+//                                                            releaseSampleBuffer
+
+/*!
+  \param s       -- The station the block belongs to.
+  \param blockNr -- Number of the data block.
+
+  \return status -- Returns \e false if block \e blockNr has no sample buffer.
+*/
+bool BF2H5::releaseSampleBuffer (station *s,
+				 long int blockNr)
+{
+  bool status = false;
+
+  pthread_mutex_lock (&itsBufferMutex);
+  bufferTracker::iterator it = s->buffers.find(blockNr);
+  if (it != s->buffers.end()) {
+    itsSamplePool->release(it->second);
+    s->buffers.erase(it);
+    status = true;
+  }
+  pthread_mutex_unlock (&itsBufferMutex);
+
+  return status;
+}
+
 //_______________________________________________________________________________
 //                                                                  blockComplete
 
-void BF2H5::blockComplete (long int blockNr)
+void BF2H5::blockComplete (unsigned int station,
+			   long int blockNr)
 {
-  for (bufferTracker::iterator it = itsBufferTracker.begin(); it != itsBufferTracker.end(); ++it) {
-    if (it->second == blockNr) {
-      it->second = -1;
-      return;
-    }
+  if (itsStats) {
+    itsStats->mark(station, blockNr, DAL::PipelineStats::Calculated);
+  }
+  if (!releaseSampleBuffer(itsStations[station], blockNr)) {
+    std::cerr << "[BF2H5::blockComplete] ERROR, trying to free a read buffer for block "
+	      << blockNr << " of station " << station
+	      << " that doesn't have a read buffer!"
+	      << endl;
   }
-  std::cerr << "[BF2H5::blockComplete] ERROR, trying to free a read buffer for block "
-	    << blockNr
-	    << " that doesn't have a read buffer!"
-	    << endl;
 }
 
 //_______________________________________________________________________________
-//                                                               switchReadBuffer
+//                                                               processDataBlock
 
-bool BF2H5::switchReadBuffer (long int block_nr)
+/*!
+  \param s       -- The station the block belongs to.
+  \param blockNr -- Number of the data block held by the current read buffer.
+  \param samples -- The samples of the block, as returned by the reader.
+*/
+void BF2H5::processDataBlock (station *s,
+			      long int blockNr,
+			      BFRawFormat::Sample *samples)
 {
-  for (bufferTracker::iterator it = itsBufferTracker.begin(); it != itsBufferTracker.end(); ++it) {
-    if (it->second == -1) { // not in use
-      it->second    = block_nr;
-      itsReadBuffer = it->first;
-      return true;
-    }
+  pthread_mutex_lock (&itsBufferMutex);
+  s->buffers[blockNr] = s->readBuffer;
+  pthread_mutex_unlock (&itsBufferMutex);
+
+  if (itsStats) {
+    itsStats->mark(s->index, blockNr, DAL::PipelineStats::Read);
   }
 
-  // we didn't find a free read buffer, allocat a new buffer
-  try {
+  /* Blocks until an output buffer is free, unless blocks are to be dropped */
+  if (!itsCalculator->calculateDataBlock(s->index, blockNr, samples)) {
+    dropDataBlock(s, blockNr);
+  }
+}
+
+//_______________________________________________________________________________
+//                                                                  dropDataBlock
+
+/*!
+  \param s       -- The station the block belongs to.
+  \param blockNr -- Number of the data block.
+*/
+void BF2H5::dropDataBlock (station *s,
+			   long int blockNr)
+{
+  releaseSampleBuffer(s, blockNr);
+  itsWriter->skipBlock(s->index, blockNr);
+  if (itsStats) {
+    itsStats->dropped(s->index, blockNr);
+  }
 #ifdef DAL_DEBUGGING_MESSAGES
-    cout << "BF2H5::switchReadBuffer, Calculation not fast enough, adding read buffer no. " << static_cast<int>(itsCurrentNrOfReadBuffers) << " for block " << block_nr << endl;
+  cout << "BF2H5::dropDataBlock, no free buffer, dropping block " << blockNr
+       << " of station " << s->index << endl;
 #endif
-    BFRawFormat::Sample *pbuf = new BFRawFormat::Sample[oneBlockdataSize];
-    itsSampleBuffers.push_back(pbuf);
+}
+
+//_______________________________________________________________________________
+//                                                                  flagDataBlock
+
+/*!
+  The flags of a subband are taken from the beam the subband belongs to. The
+  flagged ranges of input samples are widened to whole output samples.
+
+  \param s       -- The station the block belongs to.
+  \param blockNr -- Number of the data block.
+  \param header  -- Header of the block, in the byte order of the host.
+*/
+void BF2H5::flagDataBlock (station *s,
+			   long int blockNr,
+			   BFRawFormat::BlockHeader const &header)
+{
+  long long blockSize = itsWriter->blockSize();
+  long long factor    = s->mainHeader.nrSamplesPerSubband / blockSize;
+  long long offset    = blockNr * blockSize;
+
+  for (unsigned int sb = 0; sb < s->mainHeader.nrSubbands; ++sb) {
+    int beam = s->mainHeader.subbandToBeamMapping[sb];
+    if (beam < 0 || beam >= 8) {
+      continue;
+    }
+    BFRawFormat::BlockHeader::marshalledFlags const &flags = header.flags[beam];
+    for (uint32_t n = 0; n < flags.nrFlagsRanges && n < 16; ++n) {
+      /* Ranges reaching beyond the block are clipped to it; a range
+	 starting beyond the block is empty and ignored by flagSamples() */
+      long long begin = std::min (flags.flagsRanges[n].begin / factor, blockSize);
+      long long end   = std::min ((flags.flagsRanges[n].end + factor - 1) / factor, blockSize);
+      itsWriter->flagSamples(s->index,
+			     sb,
+			     offset + begin,
+			     offset + end,
+			     HDF5Writer::StationFlagged);
+    }
   }
-  catch (bad_alloc) {
-    cerr << "BF2H5::switchReadBuffer, ERROR cannot allocate memory for new input read buffer." << endl;
-    return false;
+}
+
+//_______________________________________________________________________________
+//                                                               showBufferStatus
+
+/*!
+  \param os -- Output stream to which the status is written.
+*/
+void BF2H5::showBufferStatus (std::ostream &os)
+{
+  if (itsSamplePool) {
+    itsSamplePool->summary(os);
   }
-  itsBufferTracker.insert(std::pair<uint8_t, long int>(itsCurrentNrOfReadBuffers, block_nr));
-  itsReadBuffer = itsCurrentNrOfReadBuffers++; // switch to new buffer
-//	itsCalculator->showStatus();
-//	itsWriter->showStatus();
-  return true;
+  if (itsCalculator) {
+    itsCalculator->outputPool()->summary(os);
+  }
+  if (itsWriter) {
+    os << "-- Blocks waiting for the writer = " << itsWriter->nofPendingBlocks() << endl;
+  }
+}
+
+//_______________________________________________________________________________
+//                                                                    readStation
+
+/*!
+  Reads the blocks following the first one from the input of station \e s,
+  until the input is exhausted. This function runs in a separate thread per
+  station.
+
+  \param s -- The station.
+*/
+void BF2H5::readStation (station *s)
+{
+  BFRawFormat::BlockHeader header;
+
+  while (!(s->reader->finishedReading())) {
+    s->readBuffer = itsSamplePool->acquire(); // blocks while all buffers are in use, unless dropping
+    if (s->readBuffer < 0) {
+      /* The block still has to be read from the input */
+      if (s->reader->readDataBlock(s->dropBuffer)) {
+	dropDataBlock(s, s->nofBlocks++);
+      }
+    }
+    else if ((s->samples = s->reader->readDataBlock(sampleBuffer(s->readBuffer), &header))) { // blocking read
+      flagDataBlock(s, s->nofBlocks, header);
+      processDataBlock(s, s->nofBlocks++, s->samples);
+    }
+    else {
+      itsSamplePool->release(s->readBuffer);
+    }
+  }
+  cout << "[BF2H5::readStation] Reader of station " << s->index
+       << " finished after " << s->nofBlocks << " blocks, connection closed" << endl;
 }
 
 //_______________________________________________________________________________
@@ -216,106 +443,161 @@ bool BF2H5::switchReadBuffer (long int block_nr)
 
 void BF2H5::start (bool const &verbose)
 {
-  bool result          = true;
-  unsigned int blockNr = 0;
-  itsReader            = new DAL::StationBeamReader(this, socketmode);
+  if (itsStations.empty()) {
+    cerr << "[BF2H5::start] No input defined!" << endl;
+    return;
+  }
 
-  /* Connect to the input source */
-  if (socketmode) {
-    result = itsReader->setSocketMode(tcpPort);
+  /* Connect to the input sources; the sockets are accepted in turn */
+  for (unsigned int n = 0; n < itsStations.size(); ++n) {
+    if (!openStation(itsStations[n])) {
+      return;
+    }
   }
-  else {
-    result = itsReader->setFileMode(inputFile);
+
+  const BFRawFormat::BFRaw_Header &BFMainHeader = getMainHeader();
+
+  /* The stations share the buffers, so their blocks need to be of the same shape */
+  for (unsigned int n = 1; n < itsStations.size(); ++n) {
+    const BFRawFormat::BFRaw_Header &header = getMainHeader(n);
+    if (header.nrSubbands != BFMainHeader.nrSubbands ||
+	header.nrSamplesPerSubband != BFMainHeader.nrSamplesPerSubband) {
+      cerr << "[BF2H5::start] Station " << n << " has " << header.nrSubbands
+	   << " subbands of " << header.nrSamplesPerSubband
+	   << " samples per block; expected " << BFMainHeader.nrSubbands
+	   << " subbands of " << BFMainHeader.nrSamplesPerSubband << " samples." << endl;
+      return;
+    }
   }
 
-  if (result) {
-    if (itsReader->readMainHeader(getMainHeaderForWrite())) {
-      
-      if (verbose) {
-	std::cout << "[BF2H5::start]" << std::endl;
-	std::cout << "-- BFMainHeader.nrSamplesPerSubband = "
-		  << BFMainHeader.nrSamplesPerSubband         << std::endl;
-	std::cout << "-- BFMainHeader.nrSubbands          = "
-		  << BFMainHeader.nrSubbands                  << std::endl;
+  if (verbose) {
+    std::cout << "[BF2H5::start]" << std::endl;
+    std::cout << "-- Stations                         = "
+	      << itsStations.size()                       << std::endl;
+    std::cout << "-- BFMainHeader.nrSamplesPerSubband = "
+	      << BFMainHeader.nrSamplesPerSubband         << std::endl;
+    std::cout << "-- BFMainHeader.nrSubbands          = "
+	      << BFMainHeader.nrSubbands                  << std::endl;
 #ifdef DAL_WITH_LOFAR
-	std::cout << "-- parset:nrSubbandSamples          = "
-		  << itsParset->nrSubbandSamples()            << std::endl;
-	std::cout << "-- parset.nrSubbands                = "
-		  << itsParset->nrSubbands()                  << std::endl;
+    std::cout << "-- parset:nrSubbandSamples          = "
+	      << itsParset->nrSubbandSamples()            << std::endl;
+    std::cout << "-- parset.nrSubbands                = "
+	      << itsParset->nrSubbands()                  << std::endl;
 #endif
-      }  // END : if (verbose)
-      
-      oneBlockdataSize = BFMainHeader.nrSamplesPerSubband * BFMainHeader.nrSubbands;
-      // size_t downSampledDataSize = BFMainHeader.nrSamplesPerSubband / itsDownsampleFactor;
-
-      if (allocateSampleBuffers()) {
-
-	// Start the calculator
-        itsCalculator = new DAL::Bf2h5Calculator (this,
-						  BFMainHeader.nrSubbands,
-						  getNrSamplesPerSubband());
-	// Start the writer
+  }  // END : if (verbose)
+  
+  oneBlockdataSize = BFMainHeader.nrSamplesPerSubband * BFMainHeader.nrSubbands;
+  size_t downSampledDataSize = BFMainHeader.nrSamplesPerSubband / itsDownsampleFactor;
+  if (itsOutputMode == DAL::Bf2h5Calculator::StokesXXYY) {
+    downSampledDataSize = BFMainHeader.nrSamplesPerSubband;
+  }
+
+  if (!allocateSampleBuffers()) {
+    return;
+  }
+
+  // Start the calculator
+  itsCalculator = new DAL::Bf2h5Calculator (this,
+					    BFMainHeader.nrSubbands,
+					    getNrSamplesPerSubband(),
+					    itsNofCalculationThreads);
+  if (!itsCalculator->allocateMemory()) {
+    return;
+  }
+  // Start the writer
+  if (itsOutputMode != DAL::Bf2h5Calculator::Intensity) {
+    itsWriter = new HDF5Writer (this,
+				outputFile,
+				downSampledDataSize,
+				BFMainHeader.nrSubbands,
+				itsOutputMode,
+				itsStations.size());
+  }
+  else {
 #ifdef DAL_WITH_LOFAR
-        itsWriter = new HDF5Writer (this,
-				    outputFile,
-				    itsParset,
-				    downSampledDataSize,
-				    BFMainHeader.nrSubbands);
+    itsWriter = new HDF5Writer (this,
+				outputFile,
+				itsParset,
+				downSampledDataSize,
+				BFMainHeader.nrSubbands,
+				itsStations.size());
 #else
-	itsWriter = NULL;
+    cerr << "[BF2H5::start] Writing the intensity tables requires LOFAR;"
+	 << " use one of the Stokes output modes instead." << endl;
+    return;
 #endif
+  }
 
-        if (itsReader->readFirstDataBlock(firstBlockHeader, itsSampleBuffers[itsReadBuffer], oneBlockdataSize * sizeof(BFRawFormat::Sample))) {
-          getTimeFromBlockHeader();
-	  
-	  /* Start up the writer to listen for incoming data */
-          if (itsWriter->start()) {
-            itsCalculator->startProcessing();
-            itsCalculator->calculateDataBlock(blockNr++, itsSampleBuffers[itsReadBuffer]); // calculator will call calculationFinished when done
-            switchReadBuffer(blockNr);
-            while (!(itsReader->finishedReading())) {
-              itsReader->readDataBlock(itsSampleBuffers[itsReadBuffer]); // blocking read
-              itsCalculator->calculateDataBlock(blockNr++, itsSampleBuffers[itsReadBuffer]); // non-blocking calculator will call calculationFinished
-              switchReadBuffer(blockNr);
-            }
-            cout << "[BF2H5::start] Reader finished, connection closed" << endl;
-            while ((itsCalculator->stillProcessing()) || (itsWriter->dataLeft())) {
-              cout << "[BF2H5::start] Still processing last received data..." << endl;
-              /*
-		#ifdef DAL_DEBUGGING_MESSAGES
-		if (itsCalculator->stillProcessing()) {
-		cout << "calculator says it's still processing..." << endl;
-		cout << itsCalculator->whatAreYouDoing() << endl;
-		}
-		if (itsWriter->dataLeft()) {
-		cout << "writer says it has still data left to write..." << endl;
-            }
-#endif
-              */
-              sleep(1); // calculator or hdf5 writer still busy
-            }
-
-            if (!itsCalculator->stop()) {
-              cerr << "[BF2H5::start] Calculator didn't stop all its threads correctly!"
-		   << endl;
-            }
-
-            if (!itsWriter->stop()) {
-              cerr << "[BF2H5::start] Writer thread didn't stop correctly!" << endl;
-            }
-	    
-            cout << "HDF5 file " << inputFile << " has been written." << endl
-		 << "all done!" << endl;
-          } // END : if (itsWriter->start())
-          else {
-            cerr << "[BF2H5::start] Could not start writer thread!" << endl;
-          }
-        }
-        else {
-          cerr << "[BF2H5::start] Error reading first data block!" << endl;
-        }
-      }
+  if (itsDispersionMeasure != 0 || itsNormalizeBandpass) {
+    std::vector<double> frequencies (BFMainHeader.subbandFrequencies,
+				     BFMainHeader.subbandFrequencies + BFMainHeader.nrSubbands);
+    double sampleTime = (BFMainHeader.nrSamplesPerSubband / downSampledDataSize) / BFMainHeader.sampleRate;
+    if (!itsWriter->setProcessing (frequencies, sampleTime, itsDispersionMeasure, itsNormalizeBandpass)) {
+      return;
     }
-  }  // END : if (result)
+  }
+
+  /* The pool is still empty, so acquiring a buffer never fails */
+  for (unsigned int n = 0; n < itsStations.size(); ++n) {
+    station *s    = itsStations[n];
+    s->readBuffer = itsSamplePool->acquire();
+    s->samples    = s->reader->readFirstDataBlock(s->firstBlockHeader,
+						  sampleBuffer(s->readBuffer),
+						  oneBlockdataSize * sizeof(BFRawFormat::Sample));
+    if (!s->samples) {
+      cerr << "[BF2H5::start] Error reading first data block of station " << n << "!" << endl;
+      return;
+    }
+  }
 
+  /* The epoch is taken from the first station */
+  getTimeFromBlockHeader();
+  
+  /* Start up the writer to listen for incoming data */
+  if (!itsWriter->start()) {
+    cerr << "[BF2H5::start] Could not start writer thread!" << endl;
+    return;
+  }
+
+  itsCalculator->startProcessing();
+
+  /* One reader thread per station */
+  std::vector<bool> running (itsStations.size(), false);
+  for (unsigned int n = 0; n < itsStations.size(); ++n) {
+    station *s = itsStations[n];
+    flagDataBlock(s, s->nofBlocks, s->firstBlockHeader);
+    processDataBlock(s, s->nofBlocks++, s->samples); // calculator will call blockComplete when done
+    if (pthread_create(&(s->thread), NULL, startReaderThread, (void *) s) == 0) {
+      running[n] = true;
+    }
+    else {
+      cerr << "[BF2H5::start] Could not start reader thread of station " << n << "!" << endl;
+    }
+  }
+  for (unsigned int n = 0; n < itsStations.size(); ++n) {
+    if (running[n]) {
+      pthread_join(itsStations[n]->thread, NULL);
+    }
+  }
+
+  cout << "[BF2H5::start] Readers finished, connections closed" << endl;
+  while ((itsCalculator->stillProcessing()) || (itsWriter->dataLeft())) {
+    cout << "[BF2H5::start] Still processing last received data..." << endl;
+    showBufferStatus();
+    sleep(1); // calculator or hdf5 writer still busy
+  }
+
+  if (!itsCalculator->stop()) {
+    cerr << "[BF2H5::start] Calculator didn't stop all its threads correctly!"
+	 << endl;
+  }
+
+  if (!itsWriter->stop()) {
+    cerr << "[BF2H5::start] Writer thread didn't stop correctly!" << endl;
+  }
+
+  showBufferStatus();
+  
+  cout << "HDF5 file " << outputFile << " has been written." << endl
+       << "all done!" << endl;
 }
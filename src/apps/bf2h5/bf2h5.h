@@ -22,8 +22,10 @@
 #define BF2H5_H
 
 // Standard header files
+#include <pthread.h>
 #include <string>
 #include <map>
+#include <vector>
 
 #include <dal_config.h>
 
@@ -35,19 +37,21 @@
 // DAL header files
 #include "HDF5Writer.h"
 #include "Bf2h5Calculator.h"
+#include "BufferPool.h"
+#include "PipelineStats.h"
 #include "StationBeamReader.h"
 #include <data_hl/BFRawFormat.h>
 
 #define DAL_DEBUGGING_MESSAGES
 
-#define INITIAL_NR_OF_READ_BUFFERS 2
+//! Default number of buffers per station in the sample and output buffer pools
+#define DEFAULT_NR_OF_BUFFERS 4
 
-typedef std::vector<BFRawFormat::Sample *> sampleBuffers;
 /*!
-  - key = nr of sample buffer
-  - value = current block using the sample buffer (-1 = not in use)
+  - key = number of the data block
+  - value = handle of the sample buffer holding the block
 */
-typedef std::map<uint8_t, long int> bufferTracker;
+typedef std::map<long int, int> bufferTracker;
 
 /*!
   \class BF2H5
@@ -65,9 +69,33 @@ typedef std::map<uint8_t, long int> bufferTracker;
   
   <ul type="square">
     <li>DAL::Bf2h5Calculator
+    <li>DAL::BufferPool
     <li>LOFAR::RTCP::Parset
   </ul>
-  
+
+  <h3>Synopsis</h3>
+
+  The data blocks pass from the reader through the calculator to the writer in
+  buffers taken from two pools of nofBuffers() buffers each: the raw samples of
+  a block are held in a buffer of the sample pool until the calculator is done
+  with the block, its output in a buffer of the output pool of the calculator
+  until the writer has written the block. Memory use is therefore fixed once
+  the pools have been allocated. When a stage falls behind, the stage feeding
+  it either waits for a buffer, or drops the block -- which is then flagged as
+  missing in the output -- depending on bufferPolicy(). The sample ranges
+  flagged in the block headers are passed on to the flag table of the writer.
+
+  The output can be dedispersed (setDispersionMeasure()) and normalized
+  (setBandpassNormalization()) by the writer before it is stored, so
+  downstream tools do not need another pass over the full resolution data.
+
+  A number of stations can be ingested at once, each read from a socket or file
+  of its own (see addSocketInput() and addFileInput()). Every station has a
+  reader thread of its own, numbering its blocks from zero; the pools, the
+  calculator and the writer are shared by all stations, and hold nofBuffers()
+  buffers per station. The stations are written to separate beams of a single
+  output file, in the order in which they were added. Their data blocks need to
+  be of the same shape.
 */
 class BF2H5 {
 
@@ -100,45 +128,116 @@ class BF2H5 {
   inline uint getDownSampleFactor (void) const {
     return itsDownsampleFactor;
   }
-  //! Set input mode to read from socket
-  void setSocketMode(uint port);
-  //! Set input mode to read from file
-  void setFileMode(std::string &infile);
+  //! Add a station, whose beam is read from socket port \e port
+  void addSocketInput (uint port);
+  //! Add a station, whose beam is read from the file \e infile
+  void addFileInput (std::string const &infile);
+  //! Get the number of stations ingested
+  inline unsigned int nofStations (void) const {
+    return itsStations.size();
+  }
+  //! Set the number of calculation threads; 0 uses one thread per core
+  inline void setNofCalculationThreads (uint nofThreads) {
+    itsNofCalculationThreads = nofThreads;
+  }
+  //! Get the number of calculation threads; 0 uses one thread per core
+  inline uint nofCalculationThreads (void) const {
+    return itsNofCalculationThreads;
+  }
+  //! Set the data products written to the output dataset
+  inline void setOutputMode (DAL::Bf2h5Calculator::OutputMode const &mode) {
+    itsOutputMode = mode;
+  }
+  //! Get the data products written to the output dataset
+  inline DAL::Bf2h5Calculator::OutputMode getOutputMode (void) const {
+    return itsOutputMode;
+  }
+  //! Set the number of buffers per station in each of the buffer pools
+  inline void setNofBuffers (uint nofBuffers) {
+    itsNofBuffers = nofBuffers;
+  }
+  //! Get the number of buffers per station in each of the buffer pools
+  inline uint nofBuffers (void) const {
+    return itsNofBuffers;
+  }
+  //! Set what to do when all buffers of a pool are in use
+  inline void setBufferPolicy (DAL::BufferPool::Policy const &policy) {
+    itsBufferPolicy = policy;
+  }
+  //! Get what to do when all buffers of a pool are in use
+  inline DAL::BufferPool::Policy bufferPolicy (void) const {
+    return itsBufferPolicy;
+  }
+  //! Back the buffer pools by huge pages?
+  inline void setUseHugePages (bool useHugePages) {
+    itsUseHugePages = useHugePages;
+  }
+  //! Are the buffer pools backed by huge pages?
+  inline bool useHugePages (void) const {
+    return itsUseHugePages;
+  }
+  //! Set the dispersion measure the data are dedispersed for; 0 disables dedispersion
+  inline void setDispersionMeasure (double dm) {
+    itsDispersionMeasure = dm;
+  }
+  //! Get the dispersion measure the data are dedispersed for
+  inline double dispersionMeasure (void) const {
+    return itsDispersionMeasure;
+  }
+  //! Normalize each subband to zero mean and unit variance?
+  inline void setBandpassNormalization (bool normalize) {
+    itsNormalizeBandpass = normalize;
+  }
+  //! Are the subbands normalized to zero mean and unit variance?
+  inline bool bandpassNormalization (void) const {
+    return itsNormalizeBandpass;
+  }
+  //! Collect the latencies of the stages in \e stats; NULL disables collection
+  inline void setStatistics (DAL::PipelineStats *stats) {
+    itsStats = stats;
+  }
   //! Start the bf2h5 main process
   void start (bool const &verbose=false);
-  //! Get sample data header
-  inline const BFRawFormat::Sample &getSampleData (void) const {
-    return *itsSampleBuffers[itsReadBuffer];
-  }
-  //! Get BF raw data main header
+  //! Show the use of the buffer pools and the queues between the stages
+  void showBufferStatus (std::ostream &os=std::cout);
+  //! Get BF raw data main header of the first station
   inline const BFRawFormat::BFRaw_Header &getMainHeader (void) const {
-    return BFMainHeader;
+    return itsStations[0]->mainHeader;
   }
-  //! Get BF raw data main header for writing
-  BFRawFormat::BFRaw_Header &getMainHeaderForWrite (void) {
-    return BFMainHeader;
+  //! Get BF raw data main header of station \e station
+  inline const BFRawFormat::BFRaw_Header &getMainHeader (unsigned int station) const {
+    return itsStations[station]->mainHeader;
   }
   //! Get the number of samples per subband
   inline uint32_t getNrSamplesPerSubband (void) const {
-    return BFMainHeader.nrSamplesPerSubband;
+    return getMainHeader().nrSamplesPerSubband;
   }
   //! Get the number of subbands
   inline uint16_t getNrSubbands(void) const {
-    return BFMainHeader.nrSubbands;
+    return getMainHeader().nrSubbands;
   }
   
   // === Signaling functions for threads ========================================
 
-  //! Non-blocking write of block \e blockNr within subband \e subband
-  inline void calculatorDataReady (unsigned blockNr,
+  //! Non-blocking write of block \e blockNr of station \e station within subband \e subband
+  inline void calculatorDataReady (unsigned station,
+				   unsigned blockNr,
 				   unsigned subband,
 				   float * calculator_data)
   {
-    itsWriter->writeSubband(blockNr, subband, calculator_data);
+    itsWriter->writeSubband(station, blockNr, subband, calculator_data);
   };
 
   //! Called by the calculator when a block of subbands was completed
-  void blockComplete(long int blockNr);
+  void blockComplete(unsigned int station, long int blockNr);
+
+  //! Called by the writer when a block has been written
+  inline void blockWritten (unsigned int station, long int blockNr) {
+    if (itsStats) {
+      itsStats->mark(station, blockNr, DAL::PipelineStats::Written);
+    }
+    itsCalculator->blockWritten(station, blockNr);
+  }
 
   //! Get epoch as UTC
   inline const std::string &getEpochUTC(void) const {
@@ -150,40 +249,111 @@ class BF2H5 {
   }
   
  private:
+
+  //! Input of a single station; each is read by a thread of its own
+  struct station
+  {
+    //! The application the station is ingested by
+    BF2H5 *This;
+    //! Index of the station; also the number of its beam in the output
+    unsigned int index;
+    //! Input mode: socket (true) or file (false)
+    bool socketmode;
+    //! Port to read from in socket mode
+    uint tcpPort;
+    //! File to read from in file mode
+    std::string inputFile;
+    //! Reader of the input
+    DAL::StationBeamReader *reader;
+    //! Main header of the input
+    BFRawFormat::BFRaw_Header mainHeader;
+    //! Header of the first data block of the input
+    BFRawFormat::BlockHeader firstBlockHeader;
+    //! Handle of the current read buffer
+    int readBuffer;
+    //! Samples of the last block read
+    BFRawFormat::Sample *samples;
+    //! Receives the blocks that are dropped; only used for socket input
+    BFRawFormat::Sample *dropBuffer;
+    //! Sample buffer used for each data block; protected by itsBufferMutex
+    bufferTracker buffers;
+    //! Number of blocks read
+    long int nofBlocks;
+    //! The reader thread
+    pthread_t thread;
+  };
+
+  static void * startReaderThread (void * sData)
+  {
+    station *s = reinterpret_cast<station *>(sData);
+    s->This->readStation(s);
+    return 0;
+  }
+
+  //! Add a station to be ingested
+  station * addStation (void);
+  //! Connect the reader of station \e s and read its main header
+  bool openStation (station *s);
+  //! Main loop of a reader thread
+  void readStation (station *s);
   void getTimeFromBlockHeader(void);
   bool allocateSampleBuffers(void);
-  bool switchReadBuffer(long int block_nr); // switch to the next unused readbuffer, to be used by block: block_nr
+  //! Get the memory of sample buffer \e handle; NULL for mapped input files
+  inline BFRawFormat::Sample * sampleBuffer (int handle) const {
+    return itsSamplePool->bufferSize() ? reinterpret_cast<BFRawFormat::Sample *>(itsSamplePool->buffer(handle)) : 0;
+  }
+  //! Hand the block in the current read buffer of station \e s to the calculator
+  void processDataBlock (station *s,
+			 long int blockNr,
+			 BFRawFormat::Sample *samples);
+  //! Return the sample buffer of block \e blockNr of station \e s to the pool
+  bool releaseSampleBuffer (station *s,
+			    long int blockNr);
+  //! Discard block \e blockNr of station \e s; it is flagged as missing
+  void dropDataBlock (station *s,
+		      long int blockNr);
+  //! Pass the flagged samples of block \e blockNr of station \e s to the writer
+  void flagDataBlock (station *s,
+		      long int blockNr,
+		      BFRawFormat::BlockHeader const &header);
   
  private:
   
-  //! Input mode: socket (true) or file (false)
-  bool socketmode;
+  //! Stations ingested, in the order of their beams in the output
+  std::vector<station *> itsStations;
   //! Compute intensities?
   bool itsDoIntensity;
   //! Downsample the data?
   bool itsDoDownSample;
   //! Downsampling factor
   uint itsDownsampleFactor;
+  //! Number of calculation threads (0: one per core)
+  uint itsNofCalculationThreads;
+  //! Data products written to the output dataset
+  DAL::Bf2h5Calculator::OutputMode itsOutputMode;
+  //! Number of buffers in each of the buffer pools
+  uint itsNofBuffers;
+  //! What to do when all buffers of a pool are in use
+  DAL::BufferPool::Policy itsBufferPolicy;
+  //! Back the buffer pools by huge pages?
+  bool itsUseHugePages;
+  //! Dispersion measure the data are dedispersed for (0: no dedispersion)
+  double itsDispersionMeasure;
+  //! Normalize the bandpass?
+  bool itsNormalizeBandpass;
+  //! Collects the latencies of the stages; may be NULL
+  DAL::PipelineStats *itsStats;
   
   // some main header parameters we need to know here
   std::string itsParseFile;
-  std::string inputFile;
   std::string outputFile;
-  uint tcpPort;
   DAL::Bf2h5Calculator *itsCalculator;
   HDF5Writer *itsWriter;
-  DAL::StationBeamReader *itsReader;
-  
-  // data structures:
-  
-  BFRawFormat::BFRaw_Header BFMainHeader; // holds the main header
-  BFRawFormat::BlockHeader firstBlockHeader; // will hold the header of the first data block
   
   size_t oneBlockdataSize;
   //sample buffers things
-  uint8_t itsReadBuffer, itsCurrentNrOfReadBuffers; // the current read buffer
-  bufferTracker itsBufferTracker; // keeps track of which buffer is used for which data block
-  sampleBuffers itsSampleBuffers; // pointers to input data samplebuffers
+  DAL::BufferPool *itsSamplePool; // input data sample buffers, shared by the stations
+  pthread_mutex_t itsBufferMutex; // protects the buffer trackers of the stations
   
   std::string EpochUTC;
   std::string EpochDate;
@@ -0,0 +1,456 @@
+/***************************************************************************
+ *   Copyright (C) 2026                                                    *
+ *   agent <agent@local>                                                   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+/*!
+  \file bf2h5bench.cpp
+
+  \ingroup DAL
+  \ingroup dal_apps
+
+  \brief Throughput and latency benchmark of the bf2h5 pipeline
+
+  <h3>Synopsis</h3>
+
+  Synthetic BF raw data -- main header, block headers and samples, in the big
+  endian byte order of the station output -- are generated for a configurable
+  number of subbands, samples per block and observation time. They are fed
+  through the complete bf2h5 pipeline (StationBeamReader, Bf2h5Calculator and
+  HDF5Writer), either from a file written beforehand, or over loopback TCP
+  connections from sender threads, which can be paced to a given data rate.
+
+  At the end the sustained input rate is reported together with the
+  percentiles of the latencies of the stages (DAL::PipelineStats), the use of
+  the buffer pools and the number of dropped blocks. With \e --min-rate and
+  \e --max-dropped the benchmark returns a non-zero exit status if the
+  pipeline falls short, so it can serve as a regression test before deploying
+  changes to the ingest nodes.
+
+  <h3>Examples</h3>
+
+  \verbatim
+  bf2h5bench --subbands 62 --samples 16384 --duration 10 --stokes I --downsample 16
+  bf2h5bench --port 5000 --stations 2 --rate 200 --buffer-policy drop --max-dropped 0
+  \endverbatim
+*/
+
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <boost/program_options.hpp>
+
+#include <core/dalCommon.h>
+#include "bf2h5.h"
+#include "PipelineStats.h"
+
+namespace bpo = boost::program_options;
+
+using std::cerr;
+using std::cout;
+using std::endl;
+
+//! Magic number of the main header
+#define BENCH_HEADER_MAGIC 0x3F8304EC
+//! Number of attempts to connect to the reader, 100 ms apart
+#define BENCH_CONNECT_ATTEMPTS 100
+
+//! Synthetic BF raw data stream of a station
+struct benchStream
+{
+  //! Main header, in big endian byte order
+  BFRawFormat::BFRaw_Header header;
+  //! Samples of a block, re-used for every block
+  std::vector<char> samples;
+  //! Number of blocks in the stream
+  long int nofBlocks;
+  //! Number of samples per subband in a block
+  uint32_t nofSamples;
+  //! Data rate at which the stream is sent, in MB/s; 0 for unthrottled
+  double rate;
+  //! Loopback port the stream is sent to
+  uint port;
+  //! Sender thread in socket mode
+  pthread_t thread;
+  //! Did the sender deliver all blocks?
+  bool complete;
+};
+
+//_______________________________________________________________________________
+//                                                                       bigEndian
+
+//! Convert a value to big endian byte order in place
+template <class T>
+void bigEndian (T &value)
+{
+  if (!DAL::BigEndian()) {
+    DAL::swapbytes (reinterpret_cast<char *>(&value), sizeof(T));
+  }
+}
+
+//_______________________________________________________________________________
+//                                                                      initStream
+
+/*!
+  \param stream     -- The stream to set up.
+  \param station    -- Name of the station.
+  \param nofSubbands -- Number of subbands.
+  \param nofSamples -- Number of samples per subband in a block.
+  \param nofBlocks  -- Number of blocks.
+*/
+void initStream (benchStream &stream,
+		 std::string const &station,
+		 uint16_t nofSubbands,
+		 uint32_t nofSamples,
+		 long int nofBlocks)
+{
+  BFRawFormat::BFRaw_Header &h = stream.header;
+
+  memset (&h, 0, sizeof(h));
+  h.magic               = BENCH_HEADER_MAGIC;
+  h.bitsPerSample       = 16;
+  h.nrPolarizations     = 2;
+  h.nrSubbands          = nofSubbands;
+  h.nrSamplesPerSubband = nofSamples;
+  h.sampleRate          = 200e6 / 1024;
+  strncpy (h.station, station.c_str(), sizeof(h.station) - 1);
+  for (uint16_t sb = 0; sb < nofSubbands; ++sb) {
+    h.subbandFrequencies[sb] = 120e6 + sb * h.sampleRate;
+    bigEndian (h.subbandFrequencies[sb]);
+  }
+  bigEndian (h.magic);
+  bigEndian (h.nrSubbands);
+  bigEndian (h.nrSamplesPerSubband);
+  bigEndian (h.sampleRate);
+
+  /* Random samples; their byte order does not matter */
+  stream.samples.resize (size_t(nofSubbands) * nofSamples * sizeof(BFRawFormat::Sample));
+  for (size_t n = 0; n < stream.samples.size(); ++n) {
+    stream.samples[n] = char(rand() % 256);
+  }
+
+  stream.nofBlocks  = nofBlocks;
+  stream.nofSamples = nofSamples;
+  stream.complete   = false;
+}
+
+//_______________________________________________________________________________
+//                                                                     blockHeader
+
+//! Get the header of block \e blockNr, in big endian byte order
+BFRawFormat::BlockHeader blockHeader (benchStream const &stream,
+				      long int blockNr)
+{
+  BFRawFormat::BlockHeader header;
+
+  memset (&header, 0, sizeof(header));
+  header.magic   = BFRawFormat::blockMagic;
+  header.time[0] = int64_t(blockNr) * stream.nofSamples;
+  bigEndian (header.magic);
+  bigEndian (header.time[0]);
+
+  return header;
+}
+
+//_______________________________________________________________________________
+//                                                                       writeFile
+
+/*!
+  \param stream   -- The stream to write.
+  \param filename -- Name of the file.
+
+  \return status -- Returns \e false if the file could not be written.
+*/
+bool writeFile (benchStream const &stream,
+		std::string const &filename)
+{
+  std::ofstream out (filename.c_str(), std::ios::binary | std::ios::trunc);
+
+  out.write (reinterpret_cast<char const *>(&stream.header), sizeof(stream.header));
+  for (long int blockNr = 0; blockNr < stream.nofBlocks && out.good(); ++blockNr) {
+    BFRawFormat::BlockHeader header = blockHeader (stream, blockNr);
+    out.write (reinterpret_cast<char const *>(&header), sizeof(header));
+    out.write (&stream.samples[0], stream.samples.size());
+  }
+
+  return out.good();
+}
+
+//_______________________________________________________________________________
+//                                                                        sendAll
+
+//! Send \e length bytes over the socket; returns \e false on failure
+bool sendAll (int sock,
+	      char const *data,
+	      size_t length)
+{
+  while (length > 0) {
+    ssize_t sent = send (sock, data, length, MSG_NOSIGNAL);
+    if (sent <= 0) {
+      return false;
+    }
+    data   += sent;
+    length -= sent;
+  }
+  return true;
+}
+
+//_______________________________________________________________________________
+//                                                                      sendStream
+
+/*!
+  Connects to the reader on the loopback interface and sends the stream,
+  paced to the data rate of the stream. Runs in a thread of its own.
+
+  \param data -- The stream to send.
+*/
+void * sendStream (void *data)
+{
+  benchStream *stream = reinterpret_cast<benchStream *>(data);
+  size_t blockBytes   = sizeof(BFRawFormat::BlockHeader) + stream->samples.size();
+  double interval     = stream->rate > 0 ? blockBytes / (stream->rate * 1e6) : 0;
+  int sock            = -1;
+
+  struct sockaddr_in address;
+  memset (&address, 0, sizeof(address));
+  address.sin_family      = AF_INET;
+  address.sin_port        = htons (stream->port);
+  address.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+
+  /* The reader only listens once bf2h5 opens the station */
+  for (int attempt = 0; attempt < BENCH_CONNECT_ATTEMPTS && sock < 0; ++attempt) {
+    sock = socket (AF_INET, SOCK_STREAM, 0);
+    if (connect (sock, (sockaddr *) &address, sizeof(address)) < 0) {
+      close (sock);
+      sock = -1;
+      usleep (100000);
+    }
+  }
+  if (sock < 0) {
+    cerr << "[bf2h5bench] Could not connect to port " << stream->port << endl;
+    return 0;
+  }
+
+  if (sendAll (sock, reinterpret_cast<char const *>(&stream->header), sizeof(stream->header))) {
+    double start = DAL::PipelineStats::now();
+    long int blockNr;
+    for (blockNr = 0; blockNr < stream->nofBlocks; ++blockNr) {
+      BFRawFormat::BlockHeader header = blockHeader (*stream, blockNr);
+      if (!sendAll (sock, reinterpret_cast<char const *>(&header), sizeof(header)) ||
+	  !sendAll (sock, &stream->samples[0], stream->samples.size())) {
+	break;
+      }
+      double wait = start + (blockNr + 1) * interval - DAL::PipelineStats::now();
+      if (wait > 0) {
+	usleep (useconds_t(wait * 1e6));
+      }
+    }
+    stream->complete = (blockNr == stream->nofBlocks);
+  }
+
+  close (sock);
+  return 0;
+}
+
+//_______________________________________________________________________________
+//                                                                           main
+
+int main (int argc, char *argv[])
+{
+  uint nofSubbands     = 32;
+  uint nofSamples      = 16384;
+  double duration      = 10;
+  double rate          = 0;
+  uint nofStations     = 1;
+  uint port            = 0;
+  uint dsFactor        = 1;
+  uint nofThreads      = 0;
+  uint nofBuffers      = DEFAULT_NR_OF_BUFFERS;
+  double minRate       = 0;
+  long maxDropped      = -1;
+  std::string infile   = "bf2h5bench.raw";
+  std::string outfile  = "bf2h5bench.h5";
+  DAL::BufferPool::Policy bufferPolicy = DAL::BufferPool::Block;
+  DAL::Bf2h5Calculator::OutputMode outputMode = DAL::Bf2h5Calculator::StokesI;
+
+  // Processing of command line options ____________________
+
+  bpo::options_description desc ("[bf2h5bench] Available command line options");
+
+  desc.add_options ()
+    ("help,H", "Show help messages")
+    ("subbands", bpo::value<uint>(), "Number of subbands (default: 32)")
+    ("samples", bpo::value<uint>(), "Number of samples per subband in a block (default: 16384)")
+    ("duration", bpo::value<double>(), "Observation time generated per station, in seconds (default: 10)")
+    ("stations", bpo::value<uint>(), "Number of stations ingested at once (default: 1)")
+    ("port,P", bpo::value<uint>(), "Send the data over loopback TCP, station n to this port + n; default: read from a file")
+    ("rate", bpo::value<double>(), "Data rate per station in socket mode, in MB/s (default: unthrottled)")
+    ("infile,I", bpo::value<std::string>(), "Name of the generated input file in file mode (default: bf2h5bench.raw)")
+    ("outfile,O", bpo::value<std::string>(), "Name of the output dataset; overwritten (default: bf2h5bench.h5)")
+    ("stokes,S", bpo::value<std::string>(), "Stokes output mode: I (default), IQUV or XXYY")
+    ("downsample,D", bpo::value<uint>(), "Downsample with this factor")
+    ("threads,T", bpo::value<uint>(), "Number of calculation threads (default: number of cores)")
+    ("buffers,B", bpo::value<uint>(), "Number of blocks per station buffered between the stages")
+    ("buffer-policy", bpo::value<std::string>(), "What to do when all buffers are in use: block (default) or drop")
+    ("min-rate", bpo::value<double>(), "Fail if the sustained input rate is below this value, in MB/s")
+    ("max-dropped", bpo::value<long>(), "Fail if more blocks than this are dropped")
+    ;
+
+  bpo::variables_map vm;
+  bpo::store (bpo::parse_command_line(argc,argv,desc), vm);
+
+  if (vm.count("help")) {
+    cout << "\n" << desc << endl;
+    return 0;
+  }
+  if (vm.count("subbands"))    nofSubbands = vm["subbands"].as<uint>();
+  if (vm.count("samples"))     nofSamples  = vm["samples"].as<uint>();
+  if (vm.count("duration"))    duration    = vm["duration"].as<double>();
+  if (vm.count("stations"))    nofStations = vm["stations"].as<uint>();
+  if (vm.count("port"))        port        = vm["port"].as<uint>();
+  if (vm.count("rate"))        rate        = vm["rate"].as<double>();
+  if (vm.count("infile"))      infile      = vm["infile"].as<std::string>();
+  if (vm.count("outfile"))     outfile     = vm["outfile"].as<std::string>();
+  if (vm.count("downsample"))  dsFactor    = vm["downsample"].as<uint>();
+  if (vm.count("threads"))     nofThreads  = vm["threads"].as<uint>();
+  if (vm.count("buffers"))     nofBuffers  = vm["buffers"].as<uint>();
+  if (vm.count("min-rate"))    minRate     = vm["min-rate"].as<double>();
+  if (vm.count("max-dropped")) maxDropped  = vm["max-dropped"].as<long>();
+
+  if (vm.count("buffer-policy") &&
+      !DAL::BufferPool::policy (vm["buffer-policy"].as<std::string>(), bufferPolicy)) {
+    cerr << "[bf2h5bench] Unknown buffer policy; use block or drop." << endl;
+    return 1;
+  }
+  if (vm.count("stokes") &&
+      !DAL::Bf2h5Calculator::outputMode (vm["stokes"].as<std::string>(), outputMode)) {
+    cerr << "[bf2h5bench] Unknown Stokes output mode; use I, IQUV or XXYY." << endl;
+    return 1;
+  }
+  if (nofSubbands < 1 || nofSubbands > (uint)BFRawFormat::maxNrSubbands
+      || nofSamples < 1 || nofStations < 1 || dsFactor < 1 || nofSamples % dsFactor) {
+    cerr << "[bf2h5bench] Invalid shape: 1 to " << BFRawFormat::maxNrSubbands
+	 << " subbands, and a number of samples divisible by the downsampling factor." << endl;
+    return 1;
+  }
+  if (outputMode == DAL::Bf2h5Calculator::StokesXXYY) {
+    dsFactor = 1;
+  }
+
+  // Generation of the input data __________________________
+
+  double sampleRate  = 200e6 / 1024;
+  long int nofBlocks = std::max (1L, long(ceil (duration * sampleRate / nofSamples)));
+  size_t blockBytes  = sizeof(BFRawFormat::BlockHeader) + size_t(nofSubbands) * nofSamples * sizeof(BFRawFormat::Sample);
+  double totalMB     = nofStations * nofBlocks * double(blockBytes) / 1e6;
+
+  std::vector<benchStream> streams (nofStations);
+  for (uint n = 0; n < nofStations; ++n) {
+    char name[20];
+    snprintf (name, sizeof(name), "CS%03u", n + 1);
+    initStream (streams[n], name, nofSubbands, nofSamples, nofBlocks);
+    streams[n].rate = rate;
+    streams[n].port = port + n;
+  }
+
+  cout << "[bf2h5bench] Summary of benchmark parameters." << endl;
+  cout << "-- Stations ............... : " << nofStations << endl;
+  cout << "-- Subbands ............... : " << nofSubbands << endl;
+  cout << "-- Samples per block ...... : " << nofSamples << endl;
+  cout << "-- Blocks per station ..... : " << nofBlocks << endl;
+  cout << "-- Input volume ........... : " << totalMB << " MB" << endl;
+  cout << "-- Input .................. : " << (port ? "loopback TCP" : infile) << endl;
+  if (port) {
+    cout << "-- Rate per station ....... : ";
+    if (rate > 0) cout << rate << " MB/s" << endl; else cout << "unthrottled" << endl;
+  }
+
+  if (!port && !writeFile (streams[0], infile)) {
+    cerr << "[bf2h5bench] Could not write " << infile << endl;
+    return 1;
+  }
+  remove (outfile.c_str());
+
+  // Run of the pipeline ___________________________________
+
+  DAL::PipelineStats stats;
+  BF2H5 bf2h5 (outfile, "", dsFactor, false);
+
+  for (uint n = 0; n < nofStations; ++n) {
+    if (port) {
+      bf2h5.addSocketInput (port + n);
+      pthread_create (&streams[n].thread, 0, sendStream, &streams[n]);
+    } else {
+      /* All stations read the same, memory mapped, file */
+      bf2h5.addFileInput (infile);
+    }
+  }
+  bf2h5.setOutputMode (outputMode);
+  bf2h5.setNofCalculationThreads (nofThreads);
+  bf2h5.setNofBuffers (nofBuffers);
+  bf2h5.setBufferPolicy (bufferPolicy);
+  bf2h5.setStatistics (&stats);
+
+  double start = DAL::PipelineStats::now();
+  bf2h5.start ();
+  double wallTime = DAL::PipelineStats::now() - start;
+
+  for (uint n = 0; port && n < nofStations; ++n) {
+    pthread_join (streams[n].thread, 0);
+  }
+
+  // Report ________________________________________________
+
+  unsigned long nofWritten = stats.nofWritten();
+  unsigned long nofDropped = stats.nofDropped();
+  double pipelineTime      = stats.elapsed();
+  double sustained         = pipelineTime > 0 ? nofWritten * double(blockBytes) / 1e6 / pipelineTime : 0;
+
+  cout << "\n[bf2h5bench] Results." << endl;
+  cout << "-- Wall-clock time ........ : " << wallTime << " s" << endl;
+  cout << "-- Pipeline time .......... : " << pipelineTime << " s (first block read to last block written)" << endl;
+  cout << "-- Sustained input rate ... : " << sustained << " MB/s" << endl;
+  cout << "-- Blocks per second ...... : " << (pipelineTime > 0 ? nofWritten / pipelineTime : 0) << endl;
+  stats.summary (cout);
+
+  int status = 0;
+  if (nofWritten + nofDropped < (unsigned long)(nofStations * nofBlocks)) {
+    cerr << "[bf2h5bench] FAILED: only " << nofWritten + nofDropped << " of "
+	 << nofStations * nofBlocks << " blocks arrived" << endl;
+    status = 1;
+  }
+  if (minRate > 0 && sustained < minRate) {
+    cerr << "[bf2h5bench] FAILED: sustained rate " << sustained
+	 << " MB/s below " << minRate << " MB/s" << endl;
+    status = 1;
+  }
+  if (maxDropped >= 0 && (long)nofDropped > maxDropped) {
+    cerr << "[bf2h5bench] FAILED: " << nofDropped << " blocks dropped, at most "
+	 << maxDropped << " allowed" << endl;
+    status = 1;
+  }
+
+  return status;
+}
@@ -22,6 +22,7 @@
 
 #include <iostream> // for cout
 #include <iomanip>  // for cout field width
+#include <vector>
 #include <fstream>  // for file handle
 #include <complex>  // for complex datatypes
 #include <boost/program_options.hpp>
@@ -56,6 +57,18 @@ void print_examples (std::ostream &os)
   os << "2) Read data from TCP stream to a HDF5 file:" << endl;
   os << "  bf2h5 --port <port number> --outfile <HDF5 output>" << endl;
   os << endl;
+  os << "3) Write Stokes I, Q, U and V, downsampled by a factor 16:" << endl;
+  os << "  bf2h5 --infile <raw data> --outfile <HDF5 output> --stokes IQUV --downsample 16" << endl;
+  os << endl;
+  os << "4) Read three stations from TCP streams into the beams of a single HDF5 file:" << endl;
+  os << "  bf2h5 --port <port 1> --port <port 2> --port <port 3> --outfile <HDF5 output> --stokes I" << endl;
+  os << endl;
+  os << "5) Write Stokes I dedispersed for a DM of 26.8 pc/cm^3, with a normalized bandpass:" << endl;
+  os << "  bf2h5 --infile <raw data> --outfile <HDF5 output> --stokes I --downsample 16 --dm 26.8 --bandpass" << endl;
+  os << endl;
+  os << "6) Write to a Lustre file system with 4 MB stripes:" << endl;
+  os << "  bf2h5 --port <port number> --outfile <HDF5 output> --stokes I --access ingest --stripe-size 4" << endl;
+  os << endl;
 }
 
 //_______________________________________________________________________________
@@ -63,17 +76,25 @@ void print_examples (std::ostream &os)
 
 int main (int argc, char *argv[])
 {
-  std::string infile;
+  std::vector<std::string> infiles;
   std::string outfile;
   std::string parsetFilename;
   std::string ip;
-  uint port             = 0;
+  std::vector<uint> ports;
   bool useParset        = false;
   bool socketmode       = false;
   bool non_interactive  = false;
   bool doIntensity      = false;
   bool doDownsample     = false;
   uint dsFactor         = 1;
+  uint nofThreads       = 0;
+  uint nofBuffers       = DEFAULT_NR_OF_BUFFERS;
+  bool useHugePages     = false;
+  double dm             = 0;
+  bool normalize        = false;
+  DAL::HDF5AccessProfile accessProfile;
+  DAL::BufferPool::Policy bufferPolicy = DAL::BufferPool::Block;
+  DAL::Bf2h5Calculator::OutputMode outputMode = DAL::Bf2h5Calculator::Intensity;
   //	bool doChannelization = false;
   
   // Processing of command line options ____________________
@@ -84,12 +105,22 @@ int main (int argc, char *argv[])
     ("help,H", "Show help messages")
     ("parsetfile,F", bpo::value<std::string>(), "Use parset file for all settings and to get information about input data")
     ("downsample,D", bpo::value<uint>(), "Downsample with this factor")
-    ("infile,I", bpo::value<std::string>(), "Name of the input file")
+    ("infile,I", bpo::value<std::vector<std::string> >(), "Name of the input file; repeat for each station")
     ("outfile,O",bpo::value<std::string>(), "Name of the output dataset")
     //			("source,S", bpo::value<std::string>(), "the source IP address from which to accept the data")
-    ("port,P", bpo::value<uint>(), "Port number to accept beam formed raw data from")
+    ("port,P", bpo::value<std::vector<uint> >(), "Port number to accept beam formed raw data from; repeat for each station")
     //("downsample", "Downsampling of the original data")
     ("intensity", "Compute total intensity")
+    ("stokes,S", bpo::value<std::string>(), "Write Stokes datasets: I, IQUV or XXYY (complex voltages)")
+    ("threads,T", bpo::value<uint>(), "Number of calculation threads (default: number of cores)")
+    ("buffers,B", bpo::value<uint>(), "Number of blocks per station buffered between reader, calculator and writer")
+    ("buffer-policy", bpo::value<std::string>(), "What to do when all buffers are in use: block (default) or drop")
+    ("hugepages", "Allocate the buffers on huge pages")
+    ("dm", bpo::value<double>(), "Dedisperse the output for this dispersion measure (pc/cm^3)")
+    ("bandpass", "Normalize each subband to zero mean and unit variance")
+    ("access", bpo::value<std::string>(), "HDF5 file access preset: default, ingest, sequential-read or random-read")
+    ("stripe-size", bpo::value<uint>(), "Align large objects to this file system stripe size in MB (overrides --access)")
+    ("driver", bpo::value<std::string>(), "HDF5 file driver: sec2, core or direct (overrides --access)")
     ("noninteractive", "non-interactive mode, automatically overwrites output file if it exists")
     ;
   
@@ -107,7 +138,7 @@ int main (int argc, char *argv[])
   }
   
   if (vm.count("infile")) {
-    infile = vm["infile"].as<std::string>();
+    infiles = vm["infile"].as<std::vector<std::string> >();
   }
   
   if (vm.count("outfile")) {
@@ -120,7 +151,7 @@ int main (int argc, char *argv[])
   }
   
   if (vm.count("port")) {
-    port = vm["port"].as<uint>();
+    ports = vm["port"].as<std::vector<uint> >();
     socketmode = true;
   }
   
@@ -149,6 +180,75 @@ int main (int argc, char *argv[])
   if (vm.count("noninteractive")) {
     non_interactive = true; 
   }
+
+  if (vm.count("threads")) {
+    nofThreads = vm["threads"].as<uint>();
+  }
+
+  if (vm.count("buffers")) {
+    nofBuffers = vm["buffers"].as<uint>();
+    if (nofBuffers < 1) {
+      nofBuffers = 1;
+    }
+  }
+
+  if (vm.count("buffer-policy")) {
+    if (!DAL::BufferPool::policy (vm["buffer-policy"].as<std::string>(), bufferPolicy)) {
+      std::cerr << "[bf2h5] Unknown buffer policy "
+		<< vm["buffer-policy"].as<std::string>() << "; use block or drop." << endl;
+      return 1;
+    }
+  }
+
+  if (vm.count("hugepages")) {
+    useHugePages = true;
+  }
+
+  if (vm.count("stokes")) {
+    if (!DAL::Bf2h5Calculator::outputMode (vm["stokes"].as<std::string>(), outputMode)) {
+      std::cerr << "[bf2h5] Unknown Stokes output mode "
+		<< vm["stokes"].as<std::string>() << "; use I, IQUV or XXYY." << endl;
+      return 1;
+    }
+    if (outputMode == DAL::Bf2h5Calculator::StokesXXYY && doDownsample) {
+      std::cerr << "[bf2h5] Complex voltages cannot be downsampled!" << endl;
+      return 1;
+    }
+  }
+
+  if (vm.count("dm")) {
+    dm = vm["dm"].as<double>();
+  }
+
+  if (vm.count("bandpass")) {
+    normalize = true;
+  }
+
+  if (vm.count("access") && !accessProfile.setPreset (vm["access"].as<std::string>())) {
+    std::cerr << "[bf2h5] Unknown access preset "
+	      << vm["access"].as<std::string>()
+	      << "; use default, ingest, sequential-read or random-read." << endl;
+    return 1;
+  }
+
+  if (vm.count("stripe-size")) {
+    uint stripeSize = vm["stripe-size"].as<uint>();
+    if (stripeSize < 1 || !accessProfile.setAlignment (64*1024, hsize_t(stripeSize)*1024*1024)) {
+      std::cerr << "[bf2h5] Invalid stripe size " << stripeSize << endl;
+      return 1;
+    }
+  }
+
+  if (vm.count("driver") && !accessProfile.setDriver (vm["driver"].as<std::string>())) {
+    std::cerr << "[bf2h5] Unknown file driver "
+	      << vm["driver"].as<std::string>() << "; use sec2, core or direct." << endl;
+    return 1;
+  }
+
+  if ((dm != 0 || normalize) && outputMode == DAL::Bf2h5Calculator::StokesXXYY) {
+    std::cerr << "[bf2h5] Complex voltages cannot be dedispersed or normalized!" << endl;
+    return 1;
+  }
   
   // Check completeness of command line options ____________
   
@@ -181,21 +281,44 @@ int main (int argc, char *argv[])
   if (useParset) {
     std::cout << "-- Using parset file ..... : " << parsetFilename << endl;
   }
-  if (socketmode)
+  /* The stations are numbered in this order: sockets first, then files */
+  for (unsigned int n = 0; n < ports.size(); ++n)
     {
-      std::cout << "   Socket mode:" << endl;
+      std::cout << "   Station " << n << ", socket mode:" << endl;
       //		std::cout << "-- IP address .............. : " << ip << endl;
-      std::cout << "-- Port number ............ : " << port << endl;
+      std::cout << "-- Port number ............ : " << ports[n] << endl;
     }
-  else
+  for (unsigned int n = 0; n < infiles.size(); ++n)
     {
-      std::cout << "   File mode:" << endl;
-      std::cout << "-- Input file ............ : " << infile << endl;
-      std::cout << "-- Output file ........... : " << outfile << endl;
+      std::cout << "   Station " << ports.size() + n << ", file mode:" << endl;
+      std::cout << "-- Input file ............ : " << infiles[n] << endl;
     }
+  std::cout << "-- Output file ........... : " << outfile << endl;
   std::cout << "-- Compute total intensity : " << doIntensity  << endl;
   std::cout << "-- Downsampling of data .. : " << doDownsample << endl;
   std::cout << "-- Downsampling factor ... : " << dsFactor       << endl;
+  std::cout << "-- Stokes output mode .... : ";
+  if (vm.count("stokes")) {
+    std::cout << vm["stokes"].as<std::string>() << endl;
+  } else {
+    std::cout << "none (intensity tables)" << endl;
+  }
+  std::cout << "-- Calculation threads ... : ";
+  if (nofThreads > 0) {
+    std::cout << nofThreads << endl;
+  } else {
+    std::cout << DAL::Bf2h5Calculator::defaultNofThreads() << " (one per core)" << endl;
+  }
+  std::cout << "-- Buffered blocks ....... : " << nofBuffers << endl;
+  std::cout << "-- Buffer policy ......... : "
+	    << (bufferPolicy == DAL::BufferPool::Block ? "block" : "drop") << endl;
+  std::cout << "-- Huge pages ............ : " << useHugePages << endl;
+  std::cout << "-- Dispersion measure .... : " << dm << endl;
+  std::cout << "-- Normalize bandpass .... : " << normalize << endl;
+  std::cout << "-- Chunk cache ........... : " << accessProfile.chunkCacheBytes() << " bytes" << endl;
+  std::cout << "-- Alignment ............. : " << accessProfile.alignment() << " bytes" << endl;
+  std::cout << "-- File driver ........... : "
+	    << DAL::HDF5AccessProfile::driverName (accessProfile.driver()) << endl;
   
   // Processing of input data ______________________________
   
@@ -230,14 +353,24 @@ int main (int argc, char *argv[])
       }
     }
   }
+  /* The writer opens the output file without an explicit profile */
+  DAL::HDF5AccessProfile::setDefaultProfile (accessProfile);
+
   BF2H5 bf2h5(outfile, parsetFilename, dsFactor, doIntensity);
   
-  if (socketmode) {
-    bf2h5.setSocketMode(port);
+  for (unsigned int n = 0; n < ports.size(); ++n) {
+    bf2h5.addSocketInput(ports[n]);
   }
-  else  {
-    bf2h5.setFileMode(infile);
+  for (unsigned int n = 0; n < infiles.size(); ++n) {
+    bf2h5.addFileInput(infiles[n]);
   }
+  bf2h5.setNofCalculationThreads(nofThreads);
+  bf2h5.setOutputMode(outputMode);
+  bf2h5.setNofBuffers(nofBuffers);
+  bf2h5.setBufferPolicy(bufferPolicy);
+  bf2h5.setUseHugePages(useHugePages);
+  bf2h5.setDispersionMeasure(dm);
+  bf2h5.setBandpassNormalization(normalize);
   
   bf2h5.start();	
   
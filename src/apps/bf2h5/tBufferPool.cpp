@@ -0,0 +1,307 @@
+/***************************************************************************
+ *   Copyright (C) 2026                                                    *
+ *   agent <agent@local>                                                   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include <unistd.h>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "BufferPool.h"
+
+using std::cerr;
+using std::cout;
+using std::endl;
+using DAL::BufferPool;
+
+/*!
+  \file tBufferPool.cpp
+
+  \ingroup DAL
+  \ingroup dal_apps
+
+  \brief A collection of test routines for the BufferPool class
+
+  \author agent
+
+  \date 2026/10/16
+*/
+
+//! Number of buffers in the pools used for testing
+#define TBUFFERPOOL_BUFFERS 4
+//! Size of the buffers in the pools used for testing
+#define TBUFFERPOOL_SIZE    10000
+
+//_______________________________________________________________________________
+//                                                                  acquireBuffer
+
+//! State shared with a thread calling BufferPool::acquire()
+struct acquireState {
+  //! The pool to acquire a buffer from
+  BufferPool *pool;
+  //! Has acquire() returned?
+  volatile bool done;
+  //! Handle returned by acquire()
+  int handle;
+};
+
+//! Thread function calling BufferPool::acquire()
+void * acquireBuffer (void *arg)
+{
+  acquireState *state = static_cast<acquireState *>(arg);
+  state->handle = state->pool->acquire();
+  state->done   = true;
+  return 0;
+}
+
+//_______________________________________________________________________________
+//                                                             hugePagesAvailable
+
+//! Can huge pages be mapped at all, according to the kernel settings?
+bool hugePagesAvailable ()
+{
+  char const *files[2] = { "/proc/sys/vm/nr_hugepages",
+			   "/proc/sys/vm/nr_overcommit_hugepages" };
+  for (int n=0; n<2; n++) {
+    std::ifstream in (files[n]);
+    long nofPages (0);
+    if (!(in >> nofPages) || nofPages > 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+//_______________________________________________________________________________
+//                                                            test_referenceCount
+
+/*!
+  \brief Test acquiring, retaining and releasing buffers
+
+  \return nofFailedTests -- The number of failed tests encountered within this
+          function.
+*/
+int test_referenceCount ()
+{
+  cout << "\n[tBufferPool::test_referenceCount]\n" << endl;
+
+  int nofFailedTests (0);
+  BufferPool pool ("test", TBUFFERPOOL_BUFFERS, TBUFFERPOOL_SIZE);
+
+  cout << "[1] BufferPool (name, nofBuffers, bufferSize) ..." << endl;
+  pool.summary();
+  if (!pool.isValid() || pool.nofBuffers() != TBUFFERPOOL_BUFFERS
+      || pool.bufferSize() != TBUFFERPOOL_SIZE || pool.nofInUse() != 0) {
+    cerr << "-- Wrong parameters of new pool" << endl;
+    nofFailedTests++;
+  }
+
+  cout << "[2] Acquire all buffers ..." << endl;
+  int handles[TBUFFERPOOL_BUFFERS];
+  for (int n=0; n<TBUFFERPOOL_BUFFERS; n++) {
+    handles[n] = pool.acquire();
+    if (handles[n] < 0) {
+      cerr << "-- Failed to acquire buffer " << n << endl;
+      return ++nofFailedTests;
+    }
+    memset (pool.buffer(handles[n]), n, TBUFFERPOOL_SIZE);
+  }
+  for (int n=0; n<TBUFFERPOOL_BUFFERS; n++) {
+    char *data = static_cast<char *>(pool.buffer(handles[n]));
+    if (data[0] != n || data[TBUFFERPOOL_SIZE-1] != n) {
+      cerr << "-- Buffer " << handles[n] << " overlaps another one" << endl;
+      nofFailedTests++;
+    }
+  }
+  if (pool.nofInUse() != TBUFFERPOOL_BUFFERS || pool.maxInUse() != TBUFFERPOOL_BUFFERS) {
+    cerr << "-- Wrong number of buffers in use: " << pool.nofInUse() << endl;
+    nofFailedTests++;
+  }
+
+  cout << "[3] Retained buffer is returned by the last release ..." << endl;
+  pool.retain (handles[0]);
+  pool.release (handles[0]);
+  if (pool.nofInUse() != TBUFFERPOOL_BUFFERS) {
+    cerr << "-- Retained buffer returned to the pool too early" << endl;
+    nofFailedTests++;
+  }
+  pool.release (handles[0]);
+  if (pool.nofInUse() != TBUFFERPOOL_BUFFERS-1) {
+    cerr << "-- Buffer not returned to the pool" << endl;
+    nofFailedTests++;
+  }
+
+  cout << "[4] Released buffer is handed out again ..." << endl;
+  if (pool.acquire() != handles[0]) {
+    cerr << "-- Released buffer not handed out again" << endl;
+    nofFailedTests++;
+  }
+  for (int n=0; n<TBUFFERPOOL_BUFFERS; n++) {
+    pool.release (handles[n]);
+  }
+  if (pool.nofInUse() != 0 || pool.maxInUse() != TBUFFERPOOL_BUFFERS) {
+    cerr << "-- Buffers still in use after releasing all" << endl;
+    nofFailedTests++;
+  }
+
+  return nofFailedTests;
+}
+
+//_______________________________________________________________________________
+//                                                                test_exhaustion
+
+/*!
+  \brief Test acquiring a buffer from an exhausted pool
+
+  \return nofFailedTests -- The number of failed tests encountered within this
+          function.
+*/
+int test_exhaustion ()
+{
+  cout << "\n[tBufferPool::test_exhaustion]\n" << endl;
+
+  int nofFailedTests (0);
+
+  cout << "[1] Drop policy fails immediately ..." << endl;
+  {
+    BufferPool pool ("drop", TBUFFERPOOL_BUFFERS, TBUFFERPOOL_SIZE, BufferPool::Drop);
+    for (int n=0; n<TBUFFERPOOL_BUFFERS; n++) {
+      pool.acquire();
+    }
+    if (pool.acquire() != -1) {
+      cerr << "-- Acquired buffer from exhausted pool" << endl;
+      nofFailedTests++;
+    }
+    pool.release (0);
+    if (pool.acquire() != 0) {
+      cerr << "-- Failed to acquire released buffer" << endl;
+      nofFailedTests++;
+    }
+    pool.summary();
+  }
+
+  cout << "[2] Block policy waits for a buffer to be released ..." << endl;
+  {
+    BufferPool pool ("block", TBUFFERPOOL_BUFFERS, TBUFFERPOOL_SIZE, BufferPool::Block);
+    acquireState state = { &pool, false, -1 };
+    pthread_t thread;
+
+    for (int n=0; n<TBUFFERPOOL_BUFFERS; n++) {
+      pool.acquire();
+    }
+    pthread_create (&thread, 0, acquireBuffer, &state);
+    usleep (100000);
+    if (state.done) {
+      cerr << "-- Acquired buffer from exhausted pool without waiting" << endl;
+      nofFailedTests++;
+    }
+    pool.release (2);
+    pthread_join (thread, 0);
+    if (state.handle != 2) {
+      cerr << "-- Waiting thread got buffer " << state.handle << endl;
+      nofFailedTests++;
+    }
+    pool.summary();
+  }
+
+  cout << "[3] Waiting thread is woken up by stop() ..." << endl;
+  {
+    BufferPool pool ("stop", TBUFFERPOOL_BUFFERS, TBUFFERPOOL_SIZE, BufferPool::Block);
+    acquireState state = { &pool, false, 0 };
+    pthread_t thread;
+
+    for (int n=0; n<TBUFFERPOOL_BUFFERS; n++) {
+      pool.acquire();
+    }
+    pthread_create (&thread, 0, acquireBuffer, &state);
+    usleep (100000);
+    pool.stop();
+    pthread_join (thread, 0);
+    if (state.handle != -1 || pool.acquire() != -1) {
+      cerr << "-- Acquired buffer from stopped pool" << endl;
+      nofFailedTests++;
+    }
+  }
+
+  cout << "[4] Pool failing to allocate its memory does not block ..." << endl;
+  {
+    BufferPool pool ("invalid", TBUFFERPOOL_BUFFERS, ~size_t(0) >> 4, BufferPool::Block);
+    if (pool.isValid() || pool.acquire() != -1) {
+      cerr << "-- Acquired buffer from invalid pool" << endl;
+      nofFailedTests++;
+    }
+  }
+
+  return nofFailedTests;
+}
+
+//_______________________________________________________________________________
+//                                                                 test_hugePages
+
+/*!
+  \brief Test the fallback to normal pages
+
+  \return nofFailedTests -- The number of failed tests encountered within this
+          function.
+*/
+int test_hugePages ()
+{
+  cout << "\n[tBufferPool::test_hugePages]\n" << endl;
+
+  int nofFailedTests (0);
+  bool available = hugePagesAvailable();
+
+  cout << "[1] Pool requesting huge pages ..." << endl;
+  BufferPool pool ("huge", TBUFFERPOOL_BUFFERS, TBUFFERPOOL_SIZE,
+		   BufferPool::Block, true);
+  pool.summary();
+
+  cout << "-- Huge pages available = " << available << endl;
+  if (!pool.isValid()) {
+    cerr << "-- Failed to allocate pool" << endl;
+    return ++nofFailedTests;
+  }
+  if (!available && pool.usesHugePages()) {
+    cerr << "-- Pool claims huge pages while none are available" << endl;
+    nofFailedTests++;
+  }
+
+  int handle = pool.acquire();
+  memset (pool.buffer(handle), 1, TBUFFERPOOL_SIZE);
+  pool.release (handle);
+
+  return nofFailedTests;
+}
+
+//_______________________________________________________________________________
+//                                                                           main
+
+int main ()
+{
+  int nofFailedTests (0);
+
+  // Test the reference counting of the buffers
+  nofFailedTests += test_referenceCount ();
+  // Test the policies applied to an exhausted pool
+  nofFailedTests += test_exhaustion ();
+  // Test the fallback from huge pages to normal pages
+  nofFailedTests += test_hugePages ();
+
+  return nofFailedTests;
+}
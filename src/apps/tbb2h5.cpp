@@ -88,6 +88,27 @@
       conection. If the provided value is smaller but zero (which is the default)
       the connection to the port is kept open indefinitely.</td>
     </tr>
+    <tr>
+      <td>--recvBatch arg</td>
+      <td>Maximum number of datagrams fetched from the socket with a single
+      system call (using recvmmsg, where available); the default is 32.</td>
+    </tr>
+    <tr>
+      <td>--socketBuffer arg</td>
+      <td>Size of the socket receive buffer (SO_RCVBUF), [MByte]; by default the
+      system default is kept.</td>
+    </tr>
+    <tr>
+      <td>--storage arg</td>
+      <td>Storage preset for the dipole datasets: "default" (no compression),
+      "fast" (shuffle and LZF or deflate at level 1) or "compact" (shuffle and
+      deflate at level 6).</td>
+    </tr>
+    <tr>
+      <td>--compression arg</td>
+      <td>Compression of the dipole datasets: "none", "deflate", "lzf" or
+      "szip"; overrides the preset.</td>
+    </tr>
     <tr>
       <td>-A [--antpos] arg</td>
       <td>File containing the positions of the individual antennas</td>
@@ -177,6 +198,9 @@ int main(int argc, char *argv[])
   int socketmode (0);
   double timeoutStart (0);
   double timeoutRead (0);
+  int recvBatch (TBB_RECV_BATCH_SIZE);
+  int socketBuffer (0);
+  HDF5StoragePolicy storagePolicy;
 
   int fixTransientTimes (0);
   int doCheckCRC (0);
@@ -197,6 +221,10 @@ int main(int argc, char *argv[])
   ("port,P", bpo::value<std::string>(), "Port number to accept data from")
   ("timeoutStart,S", bpo::value<double>(), "Time-out when opening socket connection, [sec].")
   ("timeoutRead,R", bpo::value<double>(), "Time-out when while reading from socket, [sec].")
+  ("recvBatch", bpo::value<int>(), "Maximum number of datagrams to fetch with one system call.")
+  ("socketBuffer", bpo::value<int>(), "Size of the socket receive buffer, [MByte].")
+  ("storage", bpo::value<std::string>(), "Storage preset of the dipole datasets: default, fast or compact.")
+  ("compression", bpo::value<std::string>(), "Compression: none, deflate, lzf or szip.")
   ("fixTimes,F", bpo::value<int>(), "Fix broken time-stamps old style (1), new style (2), or not (0, default)")
   ("doCheckCRC,C", bpo::value<int>(), "Check the CRCs: (0,default) no check, (1) check header, (2) check and report Header.")
   ("antpos,A", bpo::value<std::string>(), "File containing antenna positions")
@@ -252,6 +280,26 @@ int main(int argc, char *argv[])
     timeoutRead = vm["timeoutRead"].as<double>();
   }
   
+  if (vm.count("recvBatch")) {
+    recvBatch = vm["recvBatch"].as<int>();
+  }
+  
+  if (vm.count("socketBuffer")) {
+    socketBuffer = vm["socketBuffer"].as<int>();
+  }
+  
+  if (vm.count("storage")) {
+    if (!storagePolicy.setPreset (vm["storage"].as<std::string>())) {
+      return 1;
+    }
+  }
+  
+  if (vm.count("compression")) {
+    if (!storagePolicy.setCompression (vm["compression"].as<std::string>())) {
+      return 1;
+    }
+  }
+  
   if (vm.count("fixTimes")) {
     fixTransientTimes = vm["fixTimes"].as<int>();
   }
@@ -326,6 +374,7 @@ int main(int argc, char *argv[])
   // Start processing of the input data
 
   TBB tbb = TBB( outfile );
+  tbb.setStoragePolicy (storagePolicy);
 
   if ( socketmode )  // socket mode?
     {
@@ -338,6 +387,9 @@ int main(int argc, char *argv[])
         {
           tbb.setTimeoutRead (timeoutRead);
         }
+      /* Adjust settings for receiving the datagrams */
+      tbb.setRecvBatchSize (recvBatch);
+      tbb.setSocketBufferSize (socketBuffer*1024*1024);
       /* Open connection to socket */
       std::cout << "[tbb2h5] Opening connection to socket ..." << std::endl;
       tbb.connectsocket( ip.c_str(), port.c_str());
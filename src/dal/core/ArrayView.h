@@ -0,0 +1,353 @@
+/***************************************************************************
+ *   Copyright (C) 2026                                                    *
+ *   agent <agent@local>                                                   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef ARRAYVIEW_H
+#define ARRAYVIEW_H
+
+// Standard library header files
+#include <iostream>
+#include <vector>
+
+// DAL header files
+#include "dalCommon.h"
+
+namespace DAL { // Namespace DAL -- begin
+
+  /*!
+    \class ArrayView
+
+    \ingroup DAL
+    \ingroup core
+
+    \brief Typed N-dimensional view on a strided region of a caller-owned buffer
+
+    \author agent
+
+    \date 2026/10/16
+
+    \test tArrayView.cc
+
+    <h3>Synopsis</h3>
+
+    An ArrayView does not own any memory; it describes how the elements of an
+    N-dimensional array are laid out in a buffer provided by the caller: the
+    pointer to the first element, the number of elements along each axis
+    (the shape) and the distance -- in elements -- between two neighbouring
+    elements along each axis (the strides).
+
+    Passed to HDF5Dataset::readData() or HDF5Dataset::writeData(), the axes
+    of the view are matched one-by-one with the axes of the hyperslab selected
+    in the dataset; the data are transferred directly between the file and
+    the elements of the view, without a temporary copy of the full selection.
+    Since the strides are arbitrary, the view can be a sub-block or a single
+    column of a larger matrix, or can have its axes in a different order than
+    the buffer itself. A view in row-major order, contiguous along its last
+    axis, is transferred at once; any other view is split along its leading
+    axes into row-major slices, which are transferred one by one through a
+    staging buffer the size of a single slice -- a transposed [time][antenna]
+    buffer thus is filled from an [antenna][time] dataset one antenna at a
+    time.
+
+    <h3>Example(s)</h3>
+
+    <ol>
+      <li>Read a block of 16 samples from a 2-dim dataset of shape [antenna][time]
+      into column 3 of a buffer of shape [time][antenna]:
+      \code
+      std::vector<hsize_t> shape (2);
+      shape[0] = 16;    // time
+      shape[1] = 8;     // antenna
+      double buffer[16*8];
+
+      // View on the full [time][antenna] buffer, transposed to [antenna][time]
+      DAL::ArrayView<double,2> cube (buffer, shape);
+      DAL::ArrayView<double,2> view = cube.transpose (0,1);
+
+      // Read the samples of antenna 3 into column 3 of the buffer
+      std::vector<int> start (2,0);
+      std::vector<int> block (2,1);
+      start[0] = 3;
+      block[1] = 16;
+      DAL::HDF5Hyperslab slab (start, block);
+      dataset.readData (view.slice (0,3,1), slab);
+      \endcode
+    </ol>
+  */
+  template <class T, unsigned int N>
+    class ArrayView {
+
+    //! Pointer to the first element of the view
+    T *itsData;
+    //! Number of elements along each axis
+    hsize_t itsShape[N];
+    //! Distance, in elements, between neighbouring elements along each axis
+    hsize_t itsStrides[N];
+
+  public:
+
+    // === Construction =========================================================
+
+    //! Default constructor
+    ArrayView ()
+      : itsData (0)
+      {
+	for (unsigned int n(0); n<N; ++n) {
+	  itsShape[n]   = 0;
+	  itsStrides[n] = 1;
+	}
+      }
+
+    /*!
+      \brief Argumented constructor for a contiguous buffer in row-major order
+
+      \param data  -- Pointer to the first element of the buffer.
+      \param shape -- [N] Number of elements along each axis.
+    */
+    ArrayView (T *data,
+	       std::vector<hsize_t> const &shape)
+      : itsData (data)
+      {
+	std::vector<hsize_t> strides (shape.size(), 1);
+	for (int n(int(shape.size())-2); n>=0; --n) {
+	  strides[n] = strides[n+1]*shape[n+1];
+	}
+	setShape (shape, strides);
+      }
+
+    /*!
+      \brief Argumented constructor for a strided region of a buffer
+
+      \param data    -- Pointer to the first element of the view.
+      \param shape   -- [N] Number of elements along each axis.
+      \param strides -- [N] Distance, in elements, between neighbouring
+             elements along each axis.
+    */
+    ArrayView (T *data,
+	       std::vector<hsize_t> const &shape,
+	       std::vector<hsize_t> const &strides)
+      : itsData (data)
+      {
+	setShape (shape, strides);
+      }
+
+    // === Parameter access =====================================================
+
+    //! Get the pointer to the first element of the view
+    inline T * data () const {
+      return itsData;
+    }
+
+    //! Get the rank (i.e. the number of axes) of the view
+    inline unsigned int rank () const {
+      return N;
+    }
+
+    //! Get the number of elements along each axis
+    inline hsize_t const * shape () const {
+      return itsShape;
+    }
+
+    //! Get the distance between neighbouring elements along each axis
+    inline hsize_t const * strides () const {
+      return itsStrides;
+    }
+
+    //! Get the number of elements covered by the view
+    inline hsize_t nofElements () const {
+      hsize_t nelem (1);
+      for (unsigned int n(0); n<N; ++n) {
+	nelem *= itsShape[n];
+      }
+      return nelem;
+    }
+
+    //! Get a reference to the element at position \e index
+    inline T & operator() (std::vector<hsize_t> const &index) const {
+      hsize_t pos (0);
+      for (unsigned int n(0); n<N; ++n) {
+	pos += index[n]*itsStrides[n];
+      }
+      return itsData[pos];
+    }
+
+    // === Methods ==============================================================
+
+    /*!
+      \brief Get the view with the axes \e axis1 and \e axis2 exchanged
+
+      \param axis1 -- First axis to exchange.
+      \param axis2 -- Second axis to exchange.
+      \return view -- View on the same elements, with \e axis1 and \e axis2
+              exchanged; the buffer itself is left untouched.
+    */
+    ArrayView<T,N> transpose (unsigned int const &axis1,
+			      unsigned int const &axis2) const
+      {
+	ArrayView<T,N> view (*this);
+	if (axis1 < N && axis2 < N) {
+	  view.itsShape[axis1]   = itsShape[axis2];
+	  view.itsShape[axis2]   = itsShape[axis1];
+	  view.itsStrides[axis1] = itsStrides[axis2];
+	  view.itsStrides[axis2] = itsStrides[axis1];
+	} else {
+	  std::cerr << "[ArrayView::transpose] Invalid axis " << axis1
+		    << " or " << axis2 << " for view of rank " << N
+		    << std::endl;
+	}
+	return view;
+      }
+
+    /*!
+      \brief Get the view on a range of elements along one axis
+
+      \param axis  -- Axis along which the range is selected.
+      \param start -- Index of the first element of the range.
+      \param count -- Number of elements in the range.
+      \param step  -- Step between the elements of the range.
+      \return view -- View on the selected range; the other axes are kept.
+    */
+    ArrayView<T,N> slice (unsigned int const &axis,
+			  hsize_t const &start,
+			  hsize_t const &count,
+			  hsize_t const &step=1) const
+      {
+	ArrayView<T,N> view (*this);
+	if (axis < N && step > 0 && count > 0
+	    && start+(count-1)*step < itsShape[axis]) {
+	  view.itsData           = itsData + start*itsStrides[axis];
+	  view.itsShape[axis]    = count;
+	  view.itsStrides[axis] *= step;
+	} else {
+	  std::cerr << "[ArrayView::slice] Range [" << start << ":" << count
+		    << ":" << step << "] outside axis " << axis
+		    << " of view with shape "
+		    << std::vector<hsize_t> (itsShape, itsShape+N)
+		    << std::endl;
+	  view.itsShape[0] = 0;
+	}
+	return view;
+      }
+
+    /*!
+      \brief Can the view be expressed as a hyperslab in row-major order?
+
+      This is the case if the axes of the view are nested in the buffer in the
+      order of the axes, i.e. if the elements are visited in ascending order
+      of memory address, when iterating over the last axis fastest.
+
+      \return status -- Returns \e true if the strides of each axis are an
+              integer multiple of, and do not overlap with, the strides of the
+	      next axis.
+    */
+    inline bool isRowMajor () const {
+      return isRowMajor (itsShape, itsStrides);
+    }
+
+    //! Provide a summary of the internal status
+    inline void summary () {
+      summary (std::cout);
+    }
+
+    //! Provide a summary of the internal status
+    void summary (std::ostream &os)
+    {
+      os << "[ArrayView] Summary of internal parameters"  << std::endl;
+      os << "-- Rank                   = " << N             << std::endl;
+      os << "-- Shape                  = "
+	 << std::vector<hsize_t> (itsShape, itsShape+N)     << std::endl;
+      os << "-- Strides                = "
+	 << std::vector<hsize_t> (itsStrides, itsStrides+N) << std::endl;
+      os << "-- nof. elements          = " << nofElements() << std::endl;
+      os << "-- Row-major order        = " << isRowMajor()  << std::endl;
+    }
+
+    // === Static methods =======================================================
+
+    //! Can a view of \e shape and \e strides be expressed as a row-major hyperslab?
+    static bool isRowMajor (hsize_t const *shape,
+			    hsize_t const *strides)
+    {
+      hsize_t eff[N];
+      effectiveStrides (shape, strides, eff);
+
+      if (eff[N-1] < 1) {
+	return false;
+      }
+      for (unsigned int n(0); n+1<N; ++n) {
+	if (eff[n] % eff[n+1] != 0 || eff[n] < shape[n+1]*eff[n+1]) {
+	  return false;
+	}
+      }
+      return true;
+    }
+
+    /*!
+      \brief Get the strides with those of single-element axes made consistent
+
+      The stride of an axis holding a single element is never used to address
+      an element; it is replaced by the extent of the following axes, such
+      that e.g. a single column of a matrix still is found to be in row-major
+      order.
+
+      \param shape   -- [N] Number of elements along each axis.
+      \param strides -- [N] Distance between neighbouring elements along each
+             axis.
+      \param eff     -- [N] The effective strides.
+    */
+    static void effectiveStrides (hsize_t const *shape,
+				  hsize_t const *strides,
+				  hsize_t *eff)
+    {
+      for (int n(N-1); n>=0; --n) {
+	if (shape[n] > 1) {
+	  eff[n] = strides[n];
+	} else {
+	  eff[n] = (n == int(N-1)) ? 1 : eff[n+1]*shape[n+1];
+	}
+      }
+    }
+
+  private:
+
+    //! Set the shape and strides of the view
+    void setShape (std::vector<hsize_t> const &shape,
+		   std::vector<hsize_t> const &strides)
+    {
+      if (shape.size() == N && strides.size() == N) {
+	for (unsigned int n(0); n<N; ++n) {
+	  itsShape[n]   = shape[n];
+	  itsStrides[n] = strides[n];
+	}
+      } else {
+	std::cerr << "[ArrayView::setShape] Mismatch in rank: shape = " << shape
+		  << ", strides = " << strides << ", expected rank " << N
+		  << std::endl;
+	for (unsigned int n(0); n<N; ++n) {
+	  itsShape[n]   = 0;
+	  itsStrides[n] = 1;
+	}
+      }
+    }
+
+  }; // Class ArrayView -- end
+
+} // Namespace DAL -- end
+
+#endif /* ARRAYVIEW_H */
@@ -0,0 +1,464 @@
+/***************************************************************************
+ *   Copyright (C) 2026                                                    *
+ *   agent <agent@local>                                                   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include "HDF5AccessProfile.h"
+
+//! Stripe size assumed by the "ingest" preset [Bytes]
+#define ACCESS_PRESET_STRIPE_SIZE (1024*1024)
+//! Allocation increment of the core driver [Bytes]
+#define ACCESS_CORE_INCREMENT (64*1024*1024)
+//! Block size and alignment of the direct driver [Bytes]
+#define ACCESS_DIRECT_BLOCK_SIZE 4096
+//! Copy buffer size of the direct driver [Bytes]
+#define ACCESS_DIRECT_BUFFER_SIZE (16*1024*1024)
+
+namespace DAL { // Namespace DAL -- begin
+
+  // ============================================================================
+  //
+  //  Construction
+  //
+  // ============================================================================
+
+  HDF5AccessProfile::HDF5AccessProfile ()
+  {
+    setPreset ("default");
+  }
+
+  /*!
+    \param preset -- Name of the preset to start from: "default", "ingest",
+           "sequential-read" or "random-read"; an unknown name results in the
+           default settings.
+  */
+  HDF5AccessProfile::HDF5AccessProfile (std::string const &preset)
+  {
+    setPreset ("default");
+    setPreset (preset);
+  }
+
+  // ============================================================================
+  //
+  //  Parameters
+  //
+  // ============================================================================
+
+  //_____________________________________________________________________________
+  //                                                                setChunkCache
+
+  /*!
+    \param slots      -- Number of hash slots; should be a prime number, about
+           100 times the number of chunks fitting into the cache.
+    \param bytes      -- Size of the cache [Bytes].
+    \param preemption -- Preemption policy (0..1); 0 evicts the least recently
+           used chunk first, 1 evicts fully read/written chunks first.
+
+    \return status -- Returns \e false if a value is out of range; the cache
+            settings are left unchanged in that case.
+  */
+  bool HDF5AccessProfile::setChunkCache (size_t const &slots,
+					 size_t const &bytes,
+					 double const &preemption)
+  {
+    if (slots < 1 || preemption < 0 || preemption > 1) {
+      std::cerr << "[HDF5AccessProfile::setChunkCache] Invalid chunk cache "
+		<< slots << " slots, preemption " << preemption << std::endl;
+      return false;
+    }
+    chunkCacheSlots_p      = slots;
+    chunkCacheBytes_p      = bytes;
+    chunkCachePreemption_p = preemption;
+    return true;
+  }
+
+  //_____________________________________________________________________________
+  //                                                                 setAlignment
+
+  /*!
+    \param threshold -- Objects of at least this size are aligned [Bytes].
+    \param alignment -- Alignment [Bytes], e.g. the stripe size of the file
+           system; 1 disables the alignment.
+
+    \return status -- Returns \e false if a value is out of range.
+  */
+  bool HDF5AccessProfile::setAlignment (hsize_t const &threshold,
+					hsize_t const &alignment)
+  {
+    if (alignment < 1) {
+      std::cerr << "[HDF5AccessProfile::setAlignment] Invalid alignment "
+		<< alignment << std::endl;
+      return false;
+    }
+    alignmentThreshold_p = threshold;
+    alignment_p          = alignment;
+    return true;
+  }
+
+  //_____________________________________________________________________________
+  //                                                                    setDriver
+
+  /*!
+    \param name -- Name of the driver: "sec2", "core" or "direct".
+
+    \return status -- Returns \e false if the name is not recognized.
+  */
+  bool HDF5AccessProfile::setDriver (std::string const &name)
+  {
+    if (name == "sec2") {
+      driver_p = Sec2;
+    } else if (name == "core") {
+      driver_p = Core;
+    } else if (name == "direct") {
+      driver_p = Direct;
+    } else {
+      std::cerr << "[HDF5AccessProfile::setDriver] Unknown driver "
+		<< name << std::endl;
+      return false;
+    }
+    return true;
+  }
+
+  //_____________________________________________________________________________
+  //                                                                    setPreset
+
+  /*!
+    \param name -- Name of the preset: "default", "ingest", "sequential-read"
+           or "random-read".
+
+    \return status -- Returns \e false if the name is not recognized; the
+            profile is left unchanged in that case.
+  */
+  bool HDF5AccessProfile::setPreset (std::string const &name)
+  {
+    /* Settings of the HDF5 library */
+    if (name == "default") {
+      chunkCacheSlots_p      = 521;
+      chunkCacheBytes_p      = 1024*1024;
+      chunkCachePreemption_p = 0.75;
+      alignmentThreshold_p   = 1;
+      alignment_p            = 1;
+      metaBlockSize_p        = 2048;
+      smallDataBlockSize_p   = 2048;
+      metadataCacheBytes_p   = 0;
+      sieveBufferSize_p      = 64*1024;
+      libverLatest_p         = false;
+      driver_p               = Sec2;
+    } else if (name == "ingest") {
+      chunkCacheSlots_p      = 12421;
+      chunkCacheBytes_p      = 64*1024*1024;
+      chunkCachePreemption_p = 1.0;
+      alignmentThreshold_p   = 64*1024;
+      alignment_p            = ACCESS_PRESET_STRIPE_SIZE;
+      metaBlockSize_p        = 1024*1024;
+      smallDataBlockSize_p   = 1024*1024;
+      metadataCacheBytes_p   = 32*1024*1024;
+      sieveBufferSize_p      = 1024*1024;
+      libverLatest_p         = true;
+      driver_p               = Sec2;
+    } else if (name == "sequential-read") {
+      chunkCacheSlots_p      = 1021;
+      chunkCacheBytes_p      = 16*1024*1024;
+      chunkCachePreemption_p = 1.0;
+      alignmentThreshold_p   = 1;
+      alignment_p            = 1;
+      metaBlockSize_p        = 2048;
+      smallDataBlockSize_p   = 2048;
+      metadataCacheBytes_p   = 16*1024*1024;
+      sieveBufferSize_p      = 4*1024*1024;
+      libverLatest_p         = false;
+      driver_p               = Sec2;
+    } else if (name == "random-read") {
+      chunkCacheSlots_p      = 100003;
+      chunkCacheBytes_p      = 256*1024*1024;
+      chunkCachePreemption_p = 0.0;
+      alignmentThreshold_p   = 1;
+      alignment_p            = 1;
+      metaBlockSize_p        = 2048;
+      smallDataBlockSize_p   = 2048;
+      metadataCacheBytes_p   = 64*1024*1024;
+      sieveBufferSize_p      = 64*1024;
+      libverLatest_p         = false;
+      driver_p               = Sec2;
+    } else {
+      std::cerr << "[HDF5AccessProfile::setPreset] Unknown preset "
+		<< name << std::endl;
+      return false;
+    }
+    return true;
+  }
+
+  //_____________________________________________________________________________
+  //                                                                      summary
+
+  /*!
+    \param os -- Output stream to which the summary is written.
+  */
+  void HDF5AccessProfile::summary (std::ostream &os)
+  {
+    os << "[HDF5AccessProfile] Summary of internal parameters." << std::endl;
+    os << "-- Chunk cache slots ........... : " << chunkCacheSlots_p << std::endl;
+    os << "-- Chunk cache size [Bytes] .... : " << chunkCacheBytes_p << std::endl;
+    os << "-- Chunk cache preemption ...... : " << chunkCachePreemption_p << std::endl;
+    os << "-- Alignment threshold [Bytes] . : " << alignmentThreshold_p << std::endl;
+    os << "-- Alignment [Bytes] ........... : " << alignment_p << std::endl;
+    os << "-- Metadata block size [Bytes] . : " << metaBlockSize_p << std::endl;
+    os << "-- Small data block size [Bytes] : " << smallDataBlockSize_p << std::endl;
+    os << "-- Metadata cache [Bytes] ...... : " << metadataCacheBytes_p << std::endl;
+    os << "-- Sieve buffer [Bytes] ........ : " << sieveBufferSize_p << std::endl;
+    os << "-- Latest file format .......... : " << libverLatest_p << std::endl;
+    os << "-- File driver ................. : " << driverName(driver_p)
+       << (available(driver_p) ? "" : " (not available)") << std::endl;
+  }
+
+  // ============================================================================
+  //
+  //  Methods
+  //
+  // ============================================================================
+
+  //_____________________________________________________________________________
+  //                                                         fileAccessProperties
+
+  /*!
+    The chunk cache set here is the default for all datasets opened in the
+    file; datasetAccessProperties() can override it for a single dataset. If
+    the selected driver is not available, the \e sec2 driver is used instead.
+
+    \return plist -- Identifier of a new file access property list, which has
+            to be closed by the caller using <tt>H5Pclose</tt>; negative in
+            case of an error.
+  */
+  hid_t HDF5AccessProfile::fileAccessProperties () const
+  {
+    hid_t plist = H5Pcreate (H5P_FILE_ACCESS);
+
+    if (plist < 0) {
+      std::cerr << "[HDF5AccessProfile::fileAccessProperties] "
+		<< "Failed to create property list!" << std::endl;
+      return plist;
+    }
+
+    /* The number of metadata cache elements is ignored since HDF5 1.8 */
+    H5Pset_cache (plist,
+		  0,
+		  chunkCacheSlots_p,
+		  chunkCacheBytes_p,
+		  chunkCachePreemption_p);
+    H5Pset_alignment (plist, alignmentThreshold_p, alignment_p);
+    H5Pset_meta_block_size (plist, metaBlockSize_p);
+    H5Pset_small_data_block_size (plist, smallDataBlockSize_p);
+    H5Pset_sieve_buf_size (plist, sieveBufferSize_p);
+
+    if (metadataCacheBytes_p > 0) {
+      H5AC_cache_config_t config;
+      config.version = H5AC__CURR_CACHE_CONFIG_VERSION;
+      if (H5Pget_mdc_config (plist, &config) >= 0) {
+	config.set_initial_size = true;
+	config.initial_size     = metadataCacheBytes_p;
+	if (config.max_size < metadataCacheBytes_p) {
+	  config.max_size = metadataCacheBytes_p;
+	}
+	if (config.min_size > metadataCacheBytes_p) {
+	  config.min_size = metadataCacheBytes_p;
+	}
+	H5Pset_mdc_config (plist, &config);
+      }
+    }
+
+    if (libverLatest_p) {
+      H5Pset_libver_bounds (plist, H5F_LIBVER_LATEST, H5F_LIBVER_LATEST);
+    }
+
+    Driver driver = driver_p;
+    if (!available(driver)) {
+      std::cerr << "[HDF5AccessProfile::fileAccessProperties] "
+		<< driverName(driver) << " driver not available, using sec2 instead."
+		<< std::endl;
+      driver = Sec2;
+    }
+
+    switch (driver) {
+    case Core:
+      H5Pset_fapl_core (plist, ACCESS_CORE_INCREMENT, true);
+      break;
+    case Direct:
+#ifdef H5_HAVE_DIRECT
+      H5Pset_fapl_direct (plist,
+			  ACCESS_DIRECT_BLOCK_SIZE,
+			  ACCESS_DIRECT_BLOCK_SIZE,
+			  ACCESS_DIRECT_BUFFER_SIZE);
+#endif
+      break;
+    default:
+      H5Pset_fapl_sec2 (plist);
+      break;
+    }
+
+    return plist;
+  }
+
+  //_____________________________________________________________________________
+  //                                                      datasetAccessProperties
+
+  /*!
+    \return plist -- Identifier of a new dataset access property list, which has
+            to be closed by the caller using <tt>H5Pclose</tt>; negative in
+            case of an error.
+  */
+  hid_t HDF5AccessProfile::datasetAccessProperties () const
+  {
+    hid_t plist = H5Pcreate (H5P_DATASET_ACCESS);
+
+    if (plist < 0) {
+      std::cerr << "[HDF5AccessProfile::datasetAccessProperties] "
+		<< "Failed to create property list!" << std::endl;
+      return plist;
+    }
+
+    H5Pset_chunk_cache (plist,
+			chunkCacheSlots_p,
+			chunkCacheBytes_p,
+			chunkCachePreemption_p);
+
+    return plist;
+  }
+
+  //_____________________________________________________________________________
+  //                                                                     openFile
+
+  /*!
+    \param filename    -- Name of the file.
+    \param accessFlags -- \c H5F_ACC_RDONLY or \c H5F_ACC_RDWR.
+
+    \return fileID -- Identifier of the file; negative if the file could not be
+            opened.
+  */
+  hid_t HDF5AccessProfile::openFile (std::string const &filename,
+				     unsigned int const &accessFlags) const
+  {
+    hid_t fapl   = fileAccessProperties ();
+    hid_t fileID = H5Fopen (filename.c_str(),
+			    accessFlags,
+			    fapl < 0 ? H5P_DEFAULT : fapl);
+    if (fapl >= 0) {
+      H5Pclose (fapl);
+    }
+    return fileID;
+  }
+
+  //_____________________________________________________________________________
+  //                                                                   createFile
+
+  /*!
+    \param filename    -- Name of the file.
+    \param accessFlags -- \c H5F_ACC_TRUNC or \c H5F_ACC_EXCL.
+
+    \return fileID -- Identifier of the file; negative if the file could not be
+            created.
+  */
+  hid_t HDF5AccessProfile::createFile (std::string const &filename,
+				       unsigned int const &accessFlags) const
+  {
+    hid_t fapl   = fileAccessProperties ();
+    hid_t fileID = H5Fcreate (filename.c_str(),
+			      accessFlags,
+			      H5P_DEFAULT,
+			      fapl < 0 ? H5P_DEFAULT : fapl);
+    if (fapl >= 0) {
+      H5Pclose (fapl);
+    }
+    return fileID;
+  }
+
+  //_____________________________________________________________________________
+  //                                                                   driverName
+
+  /*!
+    \param driver -- Low-level file driver
+
+    \return name -- Name of the driver, as accepted by setDriver().
+  */
+  std::string HDF5AccessProfile::driverName (Driver const &driver)
+  {
+    switch (driver) {
+    case Core:
+      return "core";
+    case Direct:
+      return "direct";
+    default:
+      return "sec2";
+    }
+  }
+
+  //_____________________________________________________________________________
+  //                                                                    available
+
+  /*!
+    \param driver -- Low-level file driver
+
+    \return available -- \e true if the driver is part of the HDF5 library in
+            use.
+  */
+  bool HDF5AccessProfile::available (Driver const &driver)
+  {
+    switch (driver) {
+    case Direct:
+#ifdef H5_HAVE_DIRECT
+      return true;
+#else
+      return false;
+#endif
+    default:
+      return true;
+    }
+  }
+
+  //_____________________________________________________________________________
+  //                                                               defaultProfile
+
+  HDF5AccessProfile const & HDF5AccessProfile::defaultProfile ()
+  {
+    return processDefault ();
+  }
+
+  //_____________________________________________________________________________
+  //                                                            setDefaultProfile
+
+  /*!
+    Not thread-safe; set the default profile at start-up, before any files are
+    opened.
+
+    \param profile -- Profile used for all files opened without an explicit
+           profile from now on.
+  */
+  void HDF5AccessProfile::setDefaultProfile (HDF5AccessProfile const &profile)
+  {
+    processDefault() = profile;
+  }
+
+  //_____________________________________________________________________________
+  //                                                               processDefault
+
+  HDF5AccessProfile & HDF5AccessProfile::processDefault ()
+  {
+    static HDF5AccessProfile profile;
+    return profile;
+  }
+
+} // Namespace DAL -- end
@@ -0,0 +1,305 @@
+/***************************************************************************
+ *   Copyright (C) 2026                                                    *
+ *   agent <agent@local>                                                   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef HDF5ACCESSPROFILE_H
+#define HDF5ACCESSPROFILE_H
+
+// Standard library header files
+#include <iostream>
+#include <string>
+
+// DAL header files
+#include <dal_config.h>
+
+namespace DAL { // Namespace DAL -- begin
+
+  /*!
+    \class HDF5AccessProfile
+
+    \ingroup DAL
+    \ingroup core
+
+    \brief File and dataset access settings used when opening HDF5 files
+
+    \author agent
+
+    \date 2026/10/16
+
+    \test tHDF5AccessProfile.cc
+
+    <h3>Prerequisite</h3>
+
+    <ul type="square">
+      <li><a href="http://www.hdfgroup.org/HDF5/doc/RM/RM_H5P.html">HDF5
+      Property List Interface</a>
+      <li>HDF5StoragePolicy -- the settings applied when creating datasets
+    </ul>
+
+    <h3>Synopsis</h3>
+
+    Where the IO_Mode determines \e whether a file is opened, created or
+    truncated, the access profile determines \e how the HDF5 library accesses
+    it afterwards. The library defaults are tuned for small files on a local
+    disk, and are a poor match for multi-GB files on a parallel file system
+    such as Lustre. The profile covers
+
+    - the raw data chunk cache: number of hash slots, size in bytes and
+    preemption policy (\e w0: 0 evicts least recently used chunks first, 1
+    evicts fully read/written chunks first);
+    - the alignment of file objects larger than a threshold, e.g. to the
+    stripe size of the file system;
+    - the aggregation of metadata and small raw data into larger blocks;
+    - the initial size of the metadata cache and the size of the sieve buffer
+    used for contiguous datasets;
+    - the file format version bounds -- the latest format is more compact and
+    faster for large numbers of groups and attributes, but cannot be read by
+    HDF5 versions before 1.8;
+    - the low-level file driver: \e sec2 (POSIX I/O, the default), \e core
+    (the file is kept in memory and written on closing) or \e direct
+    (O_DIRECT, bypassing the page cache; only if the library was built with
+    it -- otherwise \e sec2 is used).
+
+    The presets are
+    - \e default -- the settings of the HDF5 library, as used so far;
+    - \e ingest -- large chunk cache evicting completed chunks first, objects
+    aligned to a 1 MB stripe, 1 MB metadata and small data blocks, latest file
+    format; for writing data at high rates;
+    - \e sequential-read -- moderate chunk cache evicting chunks once read,
+    large sieve buffer;
+    - \e random-read -- very large chunk cache with many slots and LRU
+    eviction, large metadata cache.
+
+    All files opened without an explicit profile use the process-wide default
+    profile, which can be changed through setDefaultProfile() -- e.g. from a
+    command line option -- without touching the code opening the files.
+
+    <h3>Example(s)</h3>
+
+    \code
+    HDF5AccessProfile profile;
+    profile.setPreset ("ingest");
+    profile.setAlignment (65536, 4*1024*1024);   // 4 MB Lustre stripes
+
+    dalDataset dataset (filename, "HDF5", IO_Mode(IO_Mode::Create), profile);
+    \endcode
+  */
+  class HDF5AccessProfile {
+
+  public:
+
+    //! Low-level file drivers
+    enum Driver {
+      //! POSIX I/O (the HDF5 default)
+      Sec2,
+      //! File kept in memory, written to disk on closing
+      Core,
+      //! POSIX I/O bypassing the page cache
+      Direct
+    };
+
+  private:
+
+    //! Number of hash slots of the raw data chunk cache
+    size_t chunkCacheSlots_p;
+    //! Size of the raw data chunk cache [Bytes]
+    size_t chunkCacheBytes_p;
+    //! Preemption policy of the raw data chunk cache (0..1)
+    double chunkCachePreemption_p;
+    //! Objects of at least this size are aligned [Bytes]
+    hsize_t alignmentThreshold_p;
+    //! Alignment of the objects in the file [Bytes]
+    hsize_t alignment_p;
+    //! Minimum size of the blocks metadata is aggregated into [Bytes]
+    hsize_t metaBlockSize_p;
+    //! Minimum size of the blocks small raw data is aggregated into [Bytes]
+    hsize_t smallDataBlockSize_p;
+    //! Initial size of the metadata cache [Bytes]; 0 for the library default
+    size_t metadataCacheBytes_p;
+    //! Size of the sieve buffer [Bytes]
+    size_t sieveBufferSize_p;
+    //! Use the latest file format?
+    bool libverLatest_p;
+    //! Low-level file driver
+    Driver driver_p;
+
+  public:
+
+    // === Construction =========================================================
+
+    //! Default constructor
+    HDF5AccessProfile ();
+
+    //! Argumented constructor
+    HDF5AccessProfile (std::string const &preset);
+
+    // === Parameter access =====================================================
+
+    //! Get the number of hash slots of the raw data chunk cache
+    inline size_t chunkCacheSlots () const {
+      return chunkCacheSlots_p;
+    }
+
+    //! Get the size of the raw data chunk cache [Bytes]
+    inline size_t chunkCacheBytes () const {
+      return chunkCacheBytes_p;
+    }
+
+    //! Get the preemption policy of the raw data chunk cache
+    inline double chunkCachePreemption () const {
+      return chunkCachePreemption_p;
+    }
+
+    //! Set the raw data chunk cache
+    bool setChunkCache (size_t const &slots,
+			size_t const &bytes,
+			double const &preemption=0.75);
+
+    //! Get the threshold above which objects are aligned [Bytes]
+    inline hsize_t alignmentThreshold () const {
+      return alignmentThreshold_p;
+    }
+
+    //! Get the alignment of objects in the file [Bytes]
+    inline hsize_t alignment () const {
+      return alignment_p;
+    }
+
+    //! Align objects of at least \e threshold bytes to \e alignment bytes
+    bool setAlignment (hsize_t const &threshold,
+		       hsize_t const &alignment);
+
+    //! Get the minimum size of the metadata blocks [Bytes]
+    inline hsize_t metaBlockSize () const {
+      return metaBlockSize_p;
+    }
+
+    //! Get the minimum size of the small raw data blocks [Bytes]
+    inline hsize_t smallDataBlockSize () const {
+      return smallDataBlockSize_p;
+    }
+
+    //! Set the minimum size of the blocks metadata and small data are aggregated into
+    inline void setAggregation (hsize_t const &metaBlockSize,
+				hsize_t const &smallDataBlockSize) {
+      metaBlockSize_p      = metaBlockSize;
+      smallDataBlockSize_p = smallDataBlockSize;
+    }
+
+    //! Get the initial size of the metadata cache [Bytes]
+    inline size_t metadataCacheBytes () const {
+      return metadataCacheBytes_p;
+    }
+
+    //! Set the initial size of the metadata cache [Bytes]; 0 for the library default
+    inline void setMetadataCacheBytes (size_t const &bytes) {
+      metadataCacheBytes_p = bytes;
+    }
+
+    //! Get the size of the sieve buffer [Bytes]
+    inline size_t sieveBufferSize () const {
+      return sieveBufferSize_p;
+    }
+
+    //! Set the size of the sieve buffer [Bytes]
+    inline void setSieveBufferSize (size_t const &bytes) {
+      sieveBufferSize_p = bytes;
+    }
+
+    //! Is the latest file format used?
+    inline bool libverLatest () const {
+      return libverLatest_p;
+    }
+
+    //! Use the latest file format, or the earliest format able to store the objects
+    inline void setLibverLatest (bool const &latest) {
+      libverLatest_p = latest;
+    }
+
+    //! Get the low-level file driver
+    inline Driver driver () const {
+      return driver_p;
+    }
+
+    //! Set the low-level file driver
+    inline void setDriver (Driver const &driver) {
+      driver_p = driver;
+    }
+
+    //! Set the low-level file driver by name ("sec2", "core", "direct")
+    bool setDriver (std::string const &name);
+
+    //! Set all parameters to one of the presets
+    bool setPreset (std::string const &name);
+
+    /*!
+      \brief Get the name of the class
+
+      \return className -- The name of the class, HDF5AccessProfile.
+    */
+    inline std::string className () const {
+      return "HDF5AccessProfile";
+    }
+
+    //! Provide a summary of the object's internal parameters and status
+    inline void summary () {
+      summary (std::cout);
+    }
+
+    //! Provide a summary of the object's internal parameters and status
+    void summary (std::ostream &os);
+
+    // === Methods ==============================================================
+
+    //! Create a file access property list with the settings of the profile
+    hid_t fileAccessProperties () const;
+
+    //! Create a dataset access property list with the chunk cache of the profile
+    hid_t datasetAccessProperties () const;
+
+    //! Open an existing HDF5 file using the profile
+    hid_t openFile (std::string const &filename,
+		    unsigned int const &accessFlags=H5F_ACC_RDONLY) const;
+
+    //! Create a new HDF5 file using the profile
+    hid_t createFile (std::string const &filename,
+		      unsigned int const &accessFlags=H5F_ACC_TRUNC) const;
+
+    //! Get the name of a low-level file driver
+    static std::string driverName (Driver const &driver);
+
+    //! Is a low-level file driver available?
+    static bool available (Driver const &driver);
+
+    //! Get the profile used for files opened without an explicit profile
+    static HDF5AccessProfile const & defaultProfile ();
+
+    //! Set the profile used for files opened without an explicit profile
+    static void setDefaultProfile (HDF5AccessProfile const &profile);
+
+  private:
+
+    //! Get the modifiable process-wide default profile
+    static HDF5AccessProfile & processDefault ();
+
+  }; // Class HDF5AccessProfile -- end
+
+} // Namespace DAL -- end
+
+#endif /* HDF5ACCESSPROFILE_H */
@@ -705,9 +705,14 @@ namespace DAL { // Namespace DAL -- begin
     */
     
     if (status) {
+      /* Variable-length strings are passed to HDF5 as array of C strings */
+      std::vector<const char*> buffer (size);
+      for (unsigned int n=0; n<size; ++n) {
+	buffer[n] = data[n].c_str();
+      }
       datatype = H5Aget_type(attribute);
       /* Write the data to the attribute ... */
-      h5err = H5Awrite (attribute, datatype, data);
+      h5err = H5Awrite (attribute, datatype, &buffer[0]);
       /* ... and check the return value of the operation */
       if (h5err<0) {
 	std::cerr << "[HDF5Attribute::write]"
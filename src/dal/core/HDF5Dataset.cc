@@ -18,6 +18,8 @@
  *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
  ***************************************************************************/
 
+#include <cstring>
+
 #include <core/HDF5Dataset.h>
 
 namespace DAL {
@@ -121,6 +123,7 @@ namespace DAL {
   HDF5Dataset::HDF5Dataset (HDF5Dataset const &other)
     : HDF5Object (other)
   {
+    itsMemspace = -1;
     copy (other);
   }
 
@@ -138,6 +141,7 @@ namespace DAL {
 
     HDF5Object::close (itsDatatype);
     HDF5Object::close (itsDataspace);
+    HDF5Object::close (itsMemspace);
   }
   
   // ============================================================================
@@ -211,9 +215,11 @@ namespace DAL {
     itsName        = "Dataset";
     itsLocation    = -1;
     itsDataspace   = -1;
+    itsMemspace    = -1;
     itsDatatype    = -1;
     itsLayout      = H5D_COMPACT;
     itsShape.clear();
+    itsMemspaceShape.clear();
     itsChunking.clear();
     itsHyperslab.clear();
   }
@@ -693,9 +699,12 @@ namespace DAL {
 	};
 	
 	/* As the dataset might have been resized, the "shape" parameter needs to be
-	   updated to the current value.
+	   updated to the current value; the dataspace attached to the dataset
+	   has been reopened in that case, so it can be inspected directly.
 	*/
-	HDF5Dataspace::shape(itsLocation, itsShape);
+	if (resizeDataset) {
+	  HDF5Dataspace::shape(itsDataspace, itsShape);
+	}
       } else {
 	std::cerr << "[HDF5Dataset::setHyperslab]"
 		  << " Unable to select hyperslab - invalid HDF5 dataspace!"
@@ -760,6 +769,57 @@ namespace DAL {
     return setHyperslab (slab,true);
   }
 
+  //_____________________________________________________________________________
+  //                                                                       resize
+
+  /*!
+    In contrast to the implicit extension when writing beyond the boundaries of
+    the dataset, this allows growing a dataset ahead of the data written to it
+    -- e.g. by a number of blocks at once -- and shrinking it again afterwards.
+
+    \param shape   -- New shape of the dataset; the rank must not change.
+
+    \return status -- Status of the operation; returns \e false in case an error
+            was encountered.
+  */
+  bool HDF5Dataset::resize (std::vector<hsize_t> const &shape)
+  {
+    unsigned int nelem = shape.size();
+
+    if (!H5Iis_valid(itsLocation)) {
+      std::cerr << "[HDF5Dataset::resize]"
+		<< " Unable to resize dataset - invalid HDF5 object!"
+		<< std::endl;
+      return false;
+    }
+
+    if (nelem != itsShape.size()) {
+      std::cerr << "[HDF5Dataset::resize] Rank mismatch: "
+		<< itsShape << " -> " << shape
+		<< std::endl;
+      return false;
+    }
+
+    hsize_t dims[nelem];
+    for (unsigned int n(0); n<nelem; ++n) {
+      dims[n] = shape[n];
+    }
+
+    if (H5Dset_extent (itsLocation, dims) < 0) {
+      std::cerr << "[HDF5Dataset::resize] Error changing extent of dataset "
+		<< itsName << " to " << shape
+		<< std::endl;
+      return false;
+    }
+
+    /* The dataspace attached to the dataset needs to reflect the new extent */
+    HDF5Object::close (itsDataspace);
+    itsDataspace = H5Dget_space (itsLocation);
+    HDF5Dataspace::shape (itsLocation, itsShape);
+
+    return true;
+  }
+
   //_____________________________________________________________________________
   //                                                                     readData
   
@@ -880,6 +940,8 @@ namespace DAL {
     os << "-- Dataset name           = " << itsName             << std::endl;
     os << "-- Dataset ID             = " << itsLocation         << std::endl;
     os << "-- Dataspace ID           = " << itsDataspace        << std::endl;
+    os << "-- Memory dataspace ID    = " << itsMemspace         << std::endl;
+    os << "-- Memory dataspace shape = " << itsMemspaceShape    << std::endl;
     os << "-- Datatype ID            = " << itsDatatype         << std::endl;
     os << "-- Dataset rank           = " << rank()              << std::endl;
     os << "-- Dataset shape          = " << itsShape            << std::endl;
@@ -929,9 +991,13 @@ namespace DAL {
     itsShape.clear();
     itsChunking.clear();
     itsHyperslab.clear();
+    itsMemspaceShape.clear();
 
     itsName        = other.itsName;
     itsDataspace   = other.itsDataspace;
+    /* The memory dataspace is not shared with the other object */
+    HDF5Object::close (itsMemspace);
+    itsMemspace    = -1;
     itsDatatype    = other.itsDatatype;
     itsLayout      = other.itsLayout;
     itsShape       = other.itsShape;
@@ -939,6 +1005,388 @@ namespace DAL {
     itsHyperslab   = other.itsHyperslab;
   }
 
+  //_____________________________________________________________________________
+  //                                                                     memspace
+
+  /*!
+    The memory dataspace is created on first use and kept for subsequent
+    reads and writes; it only is modified -- in place -- once the shape of the
+    selection changes.
+
+    \param rank -- Rank of the memory dataspace.
+    \param dims -- [rank] Shape of the memory dataspace.
+
+    \return memspace -- Identifier of the memory dataspace; a negative value in
+            case an error was encountered.
+  */
+  hid_t HDF5Dataset::memspace (unsigned int const &rank,
+			       hsize_t const *dims)
+  {
+    bool sameShape = (itsMemspaceShape.size() == rank);
+
+    for (unsigned int n(0); sameShape && n<rank; ++n) {
+      sameShape = (itsMemspaceShape[n] == dims[n]);
+    }
+
+    if (sameShape && H5Iis_valid(itsMemspace)) {
+      return itsMemspace;
+    }
+
+    if (H5Iis_valid(itsMemspace)) {
+      if (H5Sset_extent_simple (itsMemspace, rank, dims, NULL) < 0) {
+	HDF5Object::close (itsMemspace);
+	itsMemspace = -1;
+      }
+    }
+
+    if (!H5Iis_valid(itsMemspace)) {
+      itsMemspace = H5Screate_simple (rank, dims, NULL);
+    }
+
+    if (H5Iis_valid(itsMemspace)) {
+      itsMemspaceShape.assign (dims, dims+rank);
+    } else {
+      std::cerr << "[HDF5Dataset::memspace] Failed to set up memory dataspace!"
+		<< std::endl;
+      itsMemspaceShape.clear();
+    }
+
+    return itsMemspace;
+  }
+
+  //_____________________________________________________________________________
+  //                                                                  setMemspace
+
+  /*!
+    The memory dataspace spans the buffer region, with the extent of each axis
+    given by the ratio of the strides of two subsequent axes; the elements of
+    the region are selected as a strided hyperslab.
+
+    \param rank    -- Rank of the buffer region.
+    \param shape   -- [rank] Number of elements along each axis of the region.
+    \param strides -- [rank] Distance, in elements, between neighbouring
+           elements along each axis of the region; the region must be in
+	   row-major order.
+
+    \return status -- Status of the operation; returns \e false in case an error
+            was encountered.
+  */
+  bool HDF5Dataset::setMemspace (unsigned int const &rank,
+				 hsize_t const *shape,
+				 hsize_t const *strides)
+  {
+    std::vector<hsize_t> eff (rank);
+    std::vector<hsize_t> dims (rank);
+    std::vector<hsize_t> start (rank,0);
+    std::vector<hsize_t> step (rank,1);
+
+    effectiveStrides (rank, shape, strides, &eff[0]);
+
+    dims[0] = shape[0];
+    for (unsigned int n(1); n<rank; ++n) {
+      dims[n] = eff[n-1]/eff[n];
+    }
+    step[rank-1] = eff[rank-1];
+    if (rank == 1) {
+      dims[0] = (shape[0]-1)*eff[0] + 1;
+    } else {
+      dims[rank-1] = eff[rank-2];
+    }
+
+    if (!H5Iis_valid(memspace (rank, &dims[0]))) {
+      return false;
+    }
+
+    if (H5Sselect_hyperslab (itsMemspace,
+			     H5S_SELECT_SET,
+			     &start[0],
+			     &step[0],
+			     shape,
+			     NULL) < 0) {
+      std::cerr << "[HDF5Dataset::setMemspace] Failed to select array view in"
+		<< " memory dataspace!" << std::endl;
+      H5Sselect_all (itsMemspace);
+      return false;
+    }
+
+    return true;
+  }
+
+  //_____________________________________________________________________________
+  //                                                                 transferView
+
+  /*!
+    The axes of the buffer region are matched one-by-one with the axes of the
+    hyperslab. If the region is in row-major order, with neighbouring elements
+    along its last axis adjacent in memory -- e.g. a sub-block of a larger
+    matrix -- it is transferred at once, through a hyperslab in the memory
+    dataspace. Otherwise -- e.g. for a column of a matrix or a transposed
+    layout -- the region is split along its leading axes into slices which are
+    in row-major order; each slice is transferred through a contiguous staging
+    buffer, from which the elements are copied into (or to which they are
+    collected from) the region by hand. HDF5 handles memory selections of
+    isolated elements one at a time, which for chunked datasets is more than
+    an order of magnitude slower than this copy.
+
+    \param data     -- Pointer to the first element of the buffer region.
+    \param datatype -- Type of the individual elements in the buffer.
+    \param slab     -- Hyperslab selected in the dataset.
+    \param rank     -- Rank of the buffer region.
+    \param shape    -- [rank] Number of elements along each axis of the region.
+    \param strides  -- [rank] Distance, in elements, between neighbouring
+           elements along each axis of the region.
+    \param write    -- Write the region to the dataset? If \e false the region
+           is read from the dataset.
+
+    \return status -- Status of the operation; returns \e false in case an error
+            was encountered.
+  */
+  bool HDF5Dataset::transferView (void *data,
+				  hid_t const &datatype,
+				  HDF5Hyperslab const &slab,
+				  unsigned int const &rank,
+				  hsize_t const *shape,
+				  hsize_t const *strides,
+				  bool const &write)
+  {
+    std::vector<int> start  = slab.start();
+    std::vector<int> stride = slab.stride();
+    std::vector<int> count  = slab.count();
+    std::vector<int> block  = slab.block();
+    std::vector<hsize_t> eff (rank);
+    herr_t h5error (0);
+
+    /* Check the shape of the region against the selection in the dataset */
+
+    if (rank != itsShape.size() || start.size() != rank) {
+      std::cerr << "[HDF5Dataset::transferView] Rank of array view (" << rank
+		<< ") does not match rank of dataset (" << itsShape.size() << ")"
+		<< std::endl;
+      return false;
+    }
+
+    for (unsigned int n(0); n<rank; ++n) {
+      hsize_t nofSelected = (count.size() == rank ? count[n] : 1)
+	* (block.size() == rank ? block[n] : 1);
+      if (shape[n] != nofSelected) {
+	std::cerr << "[HDF5Dataset::transferView] Shape of array view "
+		  << std::vector<hsize_t> (shape, shape+rank)
+		  << " does not match Hyperslab (count=" << count
+		  << ", block=" << block << ")" << std::endl;
+	return false;
+      }
+      if (shape[n] == 0) {
+	std::cerr << "[HDF5Dataset::transferView] Empty array view!" << std::endl;
+	return false;
+      }
+    }
+
+    /* Region in row-major order, contiguous along its last axis */
+
+    effectiveStrides (rank, shape, strides, &eff[0]);
+
+    if (eff[rank-1] == 1 && isRowMajor (rank, shape, strides)) {
+      if (!setMemspace (rank, shape, strides)) {
+	return false;
+      }
+      if (write) {
+	h5error = H5Dwrite (itsLocation, datatype, itsMemspace, itsDataspace,
+			    H5P_DEFAULT, data);
+      } else {
+	h5error = H5Dread (itsLocation, datatype, itsMemspace, itsDataspace,
+			   H5P_DEFAULT, data);
+      }
+      /* Leave the memory dataspace in its default state for the next call */
+      H5Sselect_all (itsMemspace);
+      return (h5error >= 0);
+    }
+
+    /* Split the region along its leading axes, until the remaining slice is
+       in row-major order */
+
+    std::vector<hsize_t> sliceShape (shape, shape+rank);
+    unsigned int nofSplit (0);
+
+    while (!isRowMajor (rank, &sliceShape[0], strides)) {
+      sliceShape[nofSplit++] = 1;
+    }
+
+    /* Contiguous staging buffer for a single slice */
+
+    hsize_t nofSliceElements (1);
+    for (unsigned int n(0); n<rank; ++n) {
+      nofSliceElements *= sliceShape[n];
+    }
+    size_t typeSize = H5Tget_size (datatype);
+    std::vector<char> staging (nofSliceElements*typeSize);
+
+    if (!H5Iis_valid(memspace (1, &nofSliceElements))) {
+      return false;
+    }
+
+    /* Selection in the dataset, with the defaults used by HDF5Hyperslab */
+
+    std::vector<hsize_t> fileStart (rank);
+    std::vector<hsize_t> fileStride (rank,1);
+    std::vector<hsize_t> fileCount (rank,1);
+    std::vector<hsize_t> fileBlock (rank,1);
+
+    for (unsigned int n(0); n<rank; ++n) {
+      fileStart[n] = start[n];
+      if (stride.size() == rank) fileStride[n] = stride[n];
+      if (count.size() == rank)  fileCount[n]  = count[n];
+      if (block.size() == rank)  fileBlock[n]  = block[n];
+    }
+
+    /* Selection of a single slice: one element along each split axis */
+
+    std::vector<hsize_t> sliceStart (fileStart);
+    std::vector<hsize_t> sliceCount (fileCount);
+    std::vector<hsize_t> sliceBlock (fileBlock);
+    std::vector<hsize_t> index (rank,0);
+    char *buffer = static_cast<char *>(data);
+    hsize_t innerShape  = sliceShape[rank-1];
+    hsize_t innerStride = strides[rank-1]*typeSize;
+    bool moreSlices (true);
+
+    for (unsigned int n(0); n<nofSplit; ++n) {
+      sliceCount[n] = 1;
+      sliceBlock[n] = 1;
+    }
+
+    while (moreSlices && h5error >= 0) {
+      for (unsigned int n(0); n<nofSplit; ++n) {
+	sliceStart[n] = fileStart[n]
+	  + (index[n]/fileBlock[n])*fileStride[n] + index[n]%fileBlock[n];
+      }
+
+      h5error = H5Sselect_hyperslab (itsDataspace,
+				     H5S_SELECT_SET,
+				     &sliceStart[0],
+				     &fileStride[0],
+				     &sliceCount[0],
+				     &sliceBlock[0]);
+      if (h5error >= 0 && !write) {
+	h5error = H5Dread (itsLocation, datatype, itsMemspace, itsDataspace,
+			   H5P_DEFAULT, &staging[0]);
+      }
+      if (h5error < 0) {
+	break;
+      }
+
+      /* Copy between the staging buffer and the slice of the region, one row
+	 along the last axis at a time */
+      char *element = &staging[0];
+      for (hsize_t row(0); row<nofSliceElements/innerShape; ++row) {
+	hsize_t offset (0);
+	for (unsigned int n(0); n<rank; ++n) {
+	  offset += index[n]*strides[n];
+	}
+	char *position = buffer + offset*typeSize;
+	for (hsize_t m(0); m<innerShape; ++m) {
+	  if (write) {
+	    memcpy (element, position, typeSize);
+	  } else {
+	    memcpy (position, element, typeSize);
+	  }
+	  element  += typeSize;
+	  position += innerStride;
+	}
+	/* Advance to the next row of the slice */
+	for (int n(rank-2); n>=int(nofSplit); --n) {
+	  if (++index[n] < shape[n]) {
+	    break;
+	  }
+	  index[n] = 0;
+	}
+      }
+
+      if (write) {
+	h5error = H5Dwrite (itsLocation, datatype, itsMemspace, itsDataspace,
+			    H5P_DEFAULT, &staging[0]);
+      }
+
+      /* Advance to the next slice, last split axis fastest */
+      moreSlices = false;
+      for (int n(nofSplit-1); n>=0; --n) {
+	if (++index[n] < shape[n]) {
+	  moreSlices = true;
+	  break;
+	}
+	index[n] = 0;
+      }
+    }
+
+    /* Restore the selection of the full hyperslab in the dataset */
+    H5Sselect_hyperslab (itsDataspace,
+			 H5S_SELECT_SET,
+			 &fileStart[0],
+			 &fileStride[0],
+			 &fileCount[0],
+			 &fileBlock[0]);
+
+    return (h5error >= 0);
+  }
+
+  //_____________________________________________________________________________
+  //                                                             effectiveStrides
+
+  /*!
+    The stride of an axis holding a single element is never used to address
+    an element; it is replaced by the extent of the following axes, as done
+    by ArrayView::effectiveStrides().
+
+    \param rank    -- Rank of the buffer region.
+    \param shape   -- [rank] Number of elements along each axis.
+    \param strides -- [rank] Distance between neighbouring elements along each
+           axis.
+    \param eff     -- [rank] The effective strides.
+  */
+  void HDF5Dataset::effectiveStrides (unsigned int const &rank,
+				      hsize_t const *shape,
+				      hsize_t const *strides,
+				      hsize_t *eff)
+  {
+    for (int n(rank-1); n>=0; --n) {
+      if (shape[n] > 1) {
+	eff[n] = strides[n];
+      } else {
+	eff[n] = (n == int(rank-1)) ? 1 : eff[n+1]*shape[n+1];
+      }
+    }
+  }
+
+  //_____________________________________________________________________________
+  //                                                                   isRowMajor
+
+  /*!
+    \param rank    -- Rank of the buffer region.
+    \param shape   -- [rank] Number of elements along each axis.
+    \param strides -- [rank] Distance between neighbouring elements along each
+           axis.
+
+    \return rowMajor -- Returns \e true if the strides of each axis are an
+            integer multiple of, and do not overlap with, the strides of the
+	    next axis; see ArrayView::isRowMajor().
+  */
+  bool HDF5Dataset::isRowMajor (unsigned int const &rank,
+				hsize_t const *shape,
+				hsize_t const *strides)
+  {
+    std::vector<hsize_t> eff (rank);
+    effectiveStrides (rank, shape, strides, &eff[0]);
+
+    if (eff[rank-1] < 1) {
+      return false;
+    }
+    for (unsigned int n(0); n+1<rank; ++n) {
+      if (eff[n] % eff[n+1] != 0 || eff[n] < shape[n+1]*eff[n+1]) {
+	return false;
+      }
+    }
+    return true;
+  }
+
   //_____________________________________________________________________________
   //                                                                         copy
   
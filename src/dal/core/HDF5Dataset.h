@@ -26,7 +26,9 @@
 #include <vector>
 
 #include <core/dalCommon.h>
+#include <core/ArrayView.h>
 #include <core/HDF5Attribute.h>
+#include <core/HDF5Datatype.h>
 #include <core/HDF5Object.h>
 #include <core/HDF5Hyperslab.h>
 
@@ -256,6 +258,10 @@ namespace DAL {
     std::string itsName;
     //! Dataspace identifier
     hid_t itsDataspace;
+    //! Memory dataspace, kept for as long as the shape of the selection holds
+    hid_t itsMemspace;
+    //! Shape of the memory dataspace
+    std::vector<hsize_t> itsMemspaceShape;
     //! Datatype identifier
     hid_t itsDatatype;
     //! Shape of the dataset
@@ -347,6 +353,11 @@ namespace DAL {
       return itsDatatype;
     }
 
+    //! Get the identifier of the memory dataspace used for I/O
+    inline hid_t memspaceID () const {
+      return itsMemspace;
+    }
+
     // === Public Methods =======================================================
     
     //! Provide a summary of the internal status
@@ -394,6 +405,9 @@ namespace DAL {
 		       std::vector<int> const &block,
 		       H5S_seloper_t const &selection=H5S_SELECT_SET);
 
+    //! Change the extent of the dataset
+    bool resize (std::vector<hsize_t> const &shape);
+
     //! Get the address in the file, expressed in bytes from the beginning of the file. 
     inline haddr_t offset () {
       return offset (itsLocation);
@@ -504,6 +518,24 @@ namespace DAL {
 			 start,
 			 block);
       }
+
+    /*!
+      \brief Read the data into a strided region of a caller-owned buffer
+      \param view    -- View on the elements of the buffer into which the data
+             are read; along each axis its shape must match the number of
+	     elements selected by the hyperslab.
+      \param slab    -- Hyberslab defining a selection of the data.
+      \return status -- Status of the operation; returns \e false in case an
+              error was encountered.
+    */
+    template <class T, unsigned int N>
+      bool readData (ArrayView<T,N> const &view,
+		     HDF5Hyperslab &slab)
+      {
+	return readData (view,
+			 slab,
+			 HDF5Datatype::nativeType<T>());
+      }
     
     // === Write the data =======================================================
 
@@ -582,6 +614,24 @@ namespace DAL {
 			  block);
       }
 
+    /*!
+      \brief Write the data from a strided region of a caller-owned buffer
+      \param view    -- View on the elements of the buffer holding the data to
+             be written; along each axis its shape must match the number of
+	     elements selected by the hyperslab.
+      \param slab    -- Hyberslab defining a selection of the data.
+      \return status -- Status of the operation; returns \e false in case an
+              error was encountered.
+    */
+    template <class T, unsigned int N>
+      bool writeData (ArrayView<T,N> const &view,
+		      HDF5Hyperslab &slab)
+      {
+	return writeData (view,
+			  slab,
+			  HDF5Datatype::nativeType<T>());
+      }
+
     // === Static methods =======================================================
     
     //! Returns the address in the file of the dataset \c location.
@@ -605,6 +655,30 @@ namespace DAL {
     //! Select a hyperslab for the dataspace attached to the dataset
     bool setHyperslab (HDF5Hyperslab &slab,
 		       bool const &resizeDataset);
+    //! Get a memory dataspace of the given shape
+    hid_t memspace (unsigned int const &rank,
+		    hsize_t const *dims);
+    //! Select the elements of a row-major buffer region in the memory dataspace
+    bool setMemspace (unsigned int const &rank,
+		      hsize_t const *shape,
+		      hsize_t const *strides);
+    //! Transfer the data between the selected hyperslab and a buffer region
+    bool transferView (void *data,
+		       hid_t const &datatype,
+		       HDF5Hyperslab const &slab,
+		       unsigned int const &rank,
+		       hsize_t const *shape,
+		       hsize_t const *strides,
+		       bool const &write);
+    //! Get the strides of a buffer region with those of single-element axes made consistent
+    static void effectiveStrides (unsigned int const &rank,
+				  hsize_t const *shape,
+				  hsize_t const *strides,
+				  hsize_t *eff);
+    //! Can a buffer region be expressed as a row-major hyperslab?
+    static bool isRowMajor (unsigned int const &rank,
+			    hsize_t const *shape,
+			    hsize_t const *strides);
     //! Open/Create a dataset
     bool open (hid_t &datasetID,
 	       hid_t const &location,
@@ -642,9 +716,8 @@ namespace DAL {
 	  for (unsigned int n=0; n<nelem; ++n) {
 	    dimensions[n] = block[n];
 	  }
-	  hid_t memorySpace = H5Screate_simple (nelem,
-						dimensions,
-						NULL);
+	  hid_t memorySpace = memspace (nelem,
+					dimensions);
 	  /* Read the data from the dataset */
 	  h5error = H5Dread (itsLocation,
 			     datatype,
@@ -654,8 +727,6 @@ namespace DAL {
 			     data);
 	  /* Release allocated memory */
 	  delete [] dimensions;
-	  /* Release HDF5 object identifier */
-	  HDF5Object::close (memorySpace);
 	} else {
 	  std::cerr << "[HDF5Dataset::readData] Failed to properly set up Hyperslab!"
 		    << std::endl;
@@ -728,23 +799,17 @@ namespace DAL {
 	    }
 	  }
 
-	  hid_t memspace = H5Screate_simple (nelem,
-					     dims,
-					     dims);
+	  hid_t memorySpace = memspace (nelem,
+					dims);
 	  
 	  // Write data to dataset _________________________
 	  
 	  h5error = H5Dwrite (itsLocation,
 			      datatype,
-			      memspace,
+			      memorySpace,
 			      itsDataspace,
 			      H5P_DEFAULT,
 			      data);
-	  
-
-	  // Release memory space __________________________
-	  
-	  HDF5Object::close (H5Sclose (memspace));
 	} else {
 	  std::cerr << "[HDF5Dataset::writeDate] Failed to properly set up Hyperslab!"
 		    << std::endl;
@@ -754,6 +819,58 @@ namespace DAL {
 	return status;
       }
 
+    /*!
+      \brief Read the data into a strided region of a caller-owned buffer
+      \param view     -- View on the elements of the buffer into which the data
+             are read.
+      \param slab     -- Hyberslab defining a selection of the data.
+      \param datatype -- Type of the individual elements in the buffer.
+      \return status  -- Status of the operation; returns \e false in case an
+              error was encountered.
+    */
+    template <class T, unsigned int N>
+      bool readData (ArrayView<T,N> const &view,
+		     HDF5Hyperslab &slab,
+		     hid_t const &datatype)
+      {
+	/* Map the selection in the dataset onto the elements of the view */
+	if (!setHyperslab (slab, false)
+	    || !transferView (view.data(), datatype, slab, N,
+			      view.shape(), view.strides(), false)) {
+	  std::cerr << "[HDF5Dataset::readData] Failed to transfer data through array view!"
+		    << std::endl;
+	  return false;
+	}
+
+	return true;
+      }
+
+    /*!
+      \brief Write the data from a strided region of a caller-owned buffer
+      \param view     -- View on the elements of the buffer holding the data to
+             be written.
+      \param slab     -- Hyberslab defining a selection of the data.
+      \param datatype -- Type of the individual elements in the buffer.
+      \return status  -- Status of the operation; returns \e false in case an
+              error was encountered.
+    */
+    template <class T, unsigned int N>
+      bool writeData (ArrayView<T,N> const &view,
+		      HDF5Hyperslab &slab,
+		      hid_t const &datatype)
+      {
+	/* Map the elements of the view onto the selection in the dataset */
+	if (!setHyperslab (slab, true)
+	    || !transferView (view.data(), datatype, slab, N,
+			      view.shape(), view.strides(), true)) {
+	  std::cerr << "[HDF5Dataset::writeData] Failed to transfer data through array view!"
+		    << std::endl;
+	  return false;
+	}
+
+	return true;
+      }
+
   }; // end class HDF5Dataset
   
 } // end namespace DAL
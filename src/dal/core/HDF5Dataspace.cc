@@ -239,10 +239,13 @@ namespace DAL { // Namespace DAL -- begin
     // Get object identifier for the dataspace
     
     hid_t dataspaceID = 0;
+    bool ownDataspace = true;
     
     switch (HDF5Object::objectType(location)) {
     case H5I_DATASPACE:
-      dataspaceID = H5Scopy (location);
+      /* A dataspace is inspected in place, rather than through a copy */
+      dataspaceID  = location;
+      ownDataspace = false;
       break;
     case H5I_DATASET:
       dataspaceID = H5Dget_space (location);
@@ -277,7 +280,9 @@ namespace DAL { // Namespace DAL -- begin
 				&maxDimensions[0]);
     }
     
-    H5Sclose (dataspaceID);
+    if (ownDataspace) {
+      H5Sclose (dataspaceID);
+    }
     
     return status;
   }
@@ -371,5 +371,60 @@ namespace DAL { // Namespace DAL -- begin
     
     return name;
   }
+
+  //_____________________________________________________________________________
+  //                                                                   nativeType
+
+  /// @cond TEMPLATE_SPECIALIZATIONS
+
+  //! Native datatype for elements of type \c bool
+  template <> hid_t HDF5Datatype::nativeType<bool> ()
+  {
+    return H5T_NATIVE_HBOOL;
+  }
+
+  //! Native datatype for elements of type \c int
+  template <> hid_t HDF5Datatype::nativeType<int> ()
+  {
+    return H5T_NATIVE_INT;
+  }
+
+  //! Native datatype for elements of type \c uint
+  template <> hid_t HDF5Datatype::nativeType<uint> ()
+  {
+    return H5T_NATIVE_UINT;
+  }
+
+  //! Native datatype for elements of type \c short
+  template <> hid_t HDF5Datatype::nativeType<short> ()
+  {
+    return H5T_NATIVE_SHORT;
+  }
+
+  //! Native datatype for elements of type \c long
+  template <> hid_t HDF5Datatype::nativeType<long> ()
+  {
+    return H5T_NATIVE_LONG;
+  }
+
+  //! Native datatype for elements of type \c long \c long
+  template <> hid_t HDF5Datatype::nativeType<long long> ()
+  {
+    return H5T_NATIVE_LLONG;
+  }
+
+  //! Native datatype for elements of type \c float
+  template <> hid_t HDF5Datatype::nativeType<float> ()
+  {
+    return H5T_NATIVE_FLOAT;
+  }
+
+  //! Native datatype for elements of type \c double
+  template <> hid_t HDF5Datatype::nativeType<double> ()
+  {
+    return H5T_NATIVE_DOUBLE;
+  }
+
+  /// @endcond
   
 } // Namespace DAL -- end
@@ -110,6 +110,10 @@ namespace DAL { // Namespace DAL -- begin
     
     //! Get name for the datatype
     static std::string datatypeName (hid_t const &id);
+
+    //! Get the native datatype for elements of type \e T held in memory
+    template <class T>
+      static hid_t nativeType ();
     
   private:
     
@@ -696,7 +696,8 @@ namespace DAL { // Namespace DAL -- begin
     bool haveBlock (true);
     herr_t h5error;
 
-    /* Get shape and rank of the dataspace */
+    /* Get shape and rank of the dataspace; the dataset is queried rather than
+       the caller's dataspace, which may predate a change of the extent */
     HDF5Dataspace::shape (datasetID,shape);
     nelem = shape.size();
     
@@ -686,16 +686,18 @@ namespace DAL { // Namespace DAL -- begin
   /*!
     \param filename -- Name of the file to be opened.
     \param flags    -- I/O mode flags.
+    \param profile  -- File access settings.
     \return fileID  -- HDF5 object identifier for the opened file; returns \e 0 
             in case the operation failed.
    */
   hid_t HDF5Object::openFile (std::string const &filename,
-			  IO_Mode const &flags)
+			      IO_Mode const &flags,
+			      HDF5AccessProfile const &profile)
   {
     hid_t fileID = 0;
 
     /* Forward the function call */
-    open (fileID, filename, flags);
+    openFile (fileID, filename, flags, profile);
 
     return fileID;
   }
@@ -707,12 +709,15 @@ namespace DAL { // Namespace DAL -- begin
     \retvalfileID    --
     \param filename  -- 
     \param flags     --
+    \param profile   -- File access settings: chunk cache, alignment, file
+           driver, etc.
     \return fileTruncated -- Was the file truncated? Returns \e true is this 
             was the case.
   */
   bool HDF5Object::openFile (hid_t &fileID,
 			     std::string const &filename,
-			     IO_Mode const &flags)
+			     IO_Mode const &flags,
+			     HDF5AccessProfile const &profile)
   {
     bool fileExists    = false;
     bool fileTruncated = false; 
@@ -737,39 +742,31 @@ namespace DAL { // Namespace DAL -- begin
       if ( flags.flags() & IO_Mode::Truncate ) {
 	/* Truncate existing file */
 	fileTruncated = true;
-	fileID        = H5Fcreate (filename.c_str(),
-				   H5F_ACC_TRUNC,
-				   H5P_DEFAULT,
-				   H5P_DEFAULT);
+	fileID        = profile.createFile (filename,
+					    H5F_ACC_TRUNC);
       } else if ( flags.flags() & IO_Mode::Create ) {
 	/* Truncate existing file */
 	fileTruncated = true;
-	fileID        = H5Fcreate (filename.c_str(),
-				   H5F_ACC_TRUNC,
-				   H5P_DEFAULT,
-				   H5P_DEFAULT);
+	fileID        = profile.createFile (filename,
+					    H5F_ACC_TRUNC);
       } else {
 	if ( flags.flags() & IO_Mode::ReadWrite ) {
 	  /* Open file as read/write */
 	  fileTruncated = false;
-	  fileID        = H5Fopen (filename.c_str(),
-				   H5F_ACC_RDWR,
-				   H5P_DEFAULT);
+	  fileID        = profile.openFile (filename,
+					    H5F_ACC_RDWR);
 	} else {
 	  /* Open file as read-only */
 	  fileTruncated = false;
-	  fileID        = H5Fopen (filename.c_str(),
-				   H5F_ACC_RDONLY,
-				   H5P_DEFAULT);
+	  fileID        = profile.openFile (filename,
+					    H5F_ACC_RDONLY);
 	}
       }
     } else {
       /* Create new file from scratch */
       fileTruncated = true;
-      fileID        = H5Fcreate (filename.c_str(),
-				 H5F_ACC_TRUNC,
-				 H5P_DEFAULT,
-				 H5P_DEFAULT);
+      fileID        = profile.createFile (filename,
+					  H5F_ACC_TRUNC);
     }
 
     return fileTruncated;
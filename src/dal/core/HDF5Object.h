@@ -30,6 +30,7 @@
 #include <vector>
 
 #include <core/IO_Mode.h>
+#include <core/HDF5AccessProfile.h>
 
 namespace DAL { // Namespace DAL -- begin
   
@@ -301,11 +302,13 @@ namespace DAL { // Namespace DAL -- begin
     
     //! Open HDF5 file
     static hid_t openFile (std::string const &filename,
-			   IO_Mode const &flags=IO_Mode(IO_Mode::OpenOrCreate));
+			   IO_Mode const &flags=IO_Mode(IO_Mode::OpenOrCreate),
+			   HDF5AccessProfile const &profile=HDF5AccessProfile::defaultProfile());
     //! Open HDF5 file
     static bool openFile (hid_t &fileID,
 			  std::string const &filename,
-			  IO_Mode const &flags=IO_Mode(IO_Mode::OpenOrCreate));
+			  IO_Mode const &flags=IO_Mode(IO_Mode::OpenOrCreate),
+			  HDF5AccessProfile const &profile=HDF5AccessProfile::defaultProfile());
     
     //! Open an object in an HDF5 file
     static hid_t open (hid_t const &location,
@@ -0,0 +1,308 @@
+/***************************************************************************
+ *   Copyright (C) 2026                                                    *
+ *   agent <agent@local>                                                   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include "HDF5StoragePolicy.h"
+
+//! Filter ID under which the LZF filter is registered with the HDF Group
+#define H5Z_FILTER_LZF 32000
+//! Chunk size [samples] of the "fast" and "compact" presets
+#define STORAGE_PRESET_CHUNK_SIZE 65536
+
+namespace DAL { // Namespace DAL -- begin
+
+  // ============================================================================
+  //
+  //  Construction
+  //
+  // ============================================================================
+
+  HDF5StoragePolicy::HDF5StoragePolicy ()
+  {
+    chunkSize_p        = CHUNK_SIZE;
+    shuffle_p          = false;
+    compression_p      = None;
+    compressionLevel_p = 1;
+  }
+
+  /*!
+    \param chunkSize        -- Chunk size along the extendible axis [samples]
+    \param compression      -- Compression filter
+    \param shuffle          -- Apply the shuffle filter before compression?
+    \param compressionLevel -- Compression level of the deflate filter
+  */
+  HDF5StoragePolicy::HDF5StoragePolicy (int const &chunkSize,
+					Compression const &compression,
+					bool const &shuffle,
+					int const &compressionLevel)
+  {
+    chunkSize_p        = CHUNK_SIZE;
+    compressionLevel_p = 1;
+    setChunkSize (chunkSize);
+    setCompression (compression);
+    setShuffle (shuffle);
+    setCompressionLevel (compressionLevel);
+  }
+
+  // ============================================================================
+  //
+  //  Parameters
+  //
+  // ============================================================================
+
+  //_____________________________________________________________________________
+  //                                                                 setChunkSize
+
+  /*!
+    \param chunkSize -- Chunk size along the extendible axis [samples]
+
+    \return status -- Returns \e false if the chunk size is not positive; the
+            chunk size is left unchanged in that case.
+  */
+  bool HDF5StoragePolicy::setChunkSize (int const &chunkSize)
+  {
+    if (chunkSize < 1) {
+      std::cerr << "[HDF5StoragePolicy::setChunkSize] Invalid chunk size "
+		<< chunkSize << std::endl;
+      return false;
+    }
+    chunkSize_p = chunkSize;
+    return true;
+  }
+
+  //_____________________________________________________________________________
+  //                                                               setCompression
+
+  /*!
+    \param name -- Name of the compression filter: "none", "deflate" (or
+           "gzip"), "lzf" or "szip".
+
+    \return status -- Returns \e false if the name is not recognized.
+  */
+  bool HDF5StoragePolicy::setCompression (std::string const &name)
+  {
+    if (name == "none") {
+      compression_p = None;
+    } else if (name == "deflate" || name == "gzip") {
+      compression_p = Deflate;
+    } else if (name == "lzf") {
+      compression_p = LZF;
+    } else if (name == "szip") {
+      compression_p = SZIP;
+    } else {
+      std::cerr << "[HDF5StoragePolicy::setCompression] Unknown compression "
+		<< name << std::endl;
+      return false;
+    }
+    return true;
+  }
+
+  //_____________________________________________________________________________
+  //                                                          setCompressionLevel
+
+  /*!
+    \param level -- Compression level of the deflate filter; 1 is fastest, 9
+           compresses best.
+
+    \return status -- Returns \e false if the level is out of range.
+  */
+  bool HDF5StoragePolicy::setCompressionLevel (int const &level)
+  {
+    if (level < 1 || level > 9) {
+      std::cerr << "[HDF5StoragePolicy::setCompressionLevel] Invalid level "
+		<< level << std::endl;
+      return false;
+    }
+    compressionLevel_p = level;
+    return true;
+  }
+
+  //_____________________________________________________________________________
+  //                                                                    setPreset
+
+  /*!
+    \param name -- Name of the preset: "default", "fast" or "compact".
+
+    \return status -- Returns \e false if the name is not recognized.
+  */
+  bool HDF5StoragePolicy::setPreset (std::string const &name)
+  {
+    if (name == "default") {
+      chunkSize_p        = CHUNK_SIZE;
+      shuffle_p          = false;
+      compression_p      = None;
+      compressionLevel_p = 1;
+    } else if (name == "fast") {
+      chunkSize_p        = STORAGE_PRESET_CHUNK_SIZE;
+      shuffle_p          = true;
+      compression_p      = available(LZF) ? LZF : Deflate;
+      compressionLevel_p = 1;
+    } else if (name == "compact") {
+      chunkSize_p        = STORAGE_PRESET_CHUNK_SIZE;
+      shuffle_p          = true;
+      compression_p      = Deflate;
+      compressionLevel_p = 6;
+    } else {
+      std::cerr << "[HDF5StoragePolicy::setPreset] Unknown preset "
+		<< name << std::endl;
+      return false;
+    }
+    return true;
+  }
+
+  //_____________________________________________________________________________
+  //                                                                      summary
+
+  /*!
+    \param os -- Output stream to which the summary is written.
+  */
+  void HDF5StoragePolicy::summary (std::ostream &os)
+  {
+    os << "[HDF5StoragePolicy] Summary of internal parameters." << std::endl;
+    os << "-- Chunk size [samples] ........ : " << chunkSize_p << std::endl;
+    os << "-- Shuffle filter .............. : " << shuffle_p << std::endl;
+    os << "-- Compression ................. : " << compressionName(compression_p)
+       << (available(compression_p) ? "" : " (not available)") << std::endl;
+    os << "-- Compression level ........... : " << compressionLevel_p << std::endl;
+  }
+
+  // ============================================================================
+  //
+  //  Methods
+  //
+  // ============================================================================
+
+  //_____________________________________________________________________________
+  //                                                    datasetCreationProperties
+
+  /*!
+    The chunk dimensions are not part of the property list, as they depend on
+    the rank of the dataset; they are set by the array classes from
+    chunkDimensions(). If the selected compression filter is not available,
+    the deflate filter is used instead.
+
+    \return plist -- Identifier of a new dataset creation property list, which
+            has to be closed by the caller using <tt>H5Pclose</tt>; negative
+            in case of an error.
+  */
+  hid_t HDF5StoragePolicy::datasetCreationProperties () const
+  {
+    hid_t plist = H5Pcreate (H5P_DATASET_CREATE);
+    Compression compression = compression_p;
+
+    if (plist < 0) {
+      std::cerr << "[HDF5StoragePolicy::datasetCreationProperties] "
+		<< "Failed to create property list!" << std::endl;
+      return plist;
+    }
+
+    if (!available(compression)) {
+      std::cerr << "[HDF5StoragePolicy::datasetCreationProperties] "
+		<< compressionName(compression) << " filter not available";
+      compression = available(Deflate) ? Deflate : None;
+      std::cerr << ", using " << compressionName(compression) << " instead."
+		<< std::endl;
+    }
+
+    /* The shuffle filter has to come first in the pipeline; it makes no sense
+       without compression, and would get in the way of SZIP. */
+    if (shuffle_p && compression != None && compression != SZIP) {
+      H5Pset_shuffle (plist);
+    }
+
+    switch (compression) {
+    case Deflate:
+      H5Pset_deflate (plist, compressionLevel_p);
+      break;
+    case LZF:
+      H5Pset_filter (plist, H5Z_FILTER_LZF, H5Z_FLAG_OPTIONAL, 0, NULL);
+      break;
+    case SZIP:
+      H5Pset_szip (plist, H5_SZIP_NN_OPTION_MASK, 16);
+      break;
+    default:
+      break;
+    }
+
+    return plist;
+  }
+
+  //_____________________________________________________________________________
+  //                                                              compressionName
+
+  /*!
+    \param compression -- Compression filter
+
+    \return name -- Name of the filter, as accepted by setCompression().
+  */
+  std::string HDF5StoragePolicy::compressionName (Compression const &compression)
+  {
+    switch (compression) {
+    case Deflate:
+      return "deflate";
+    case LZF:
+      return "lzf";
+    case SZIP:
+      return "szip";
+    default:
+      return "none";
+    }
+  }
+
+  //_____________________________________________________________________________
+  //                                                                    available
+
+  /*!
+    \param compression -- Compression filter
+
+    \return available -- \e true if data can be compressed with the filter
+            using the HDF5 library in use.
+  */
+  bool HDF5StoragePolicy::available (Compression const &compression)
+  {
+    H5Z_filter_t filter;
+    unsigned int config (0);
+
+    switch (compression) {
+    case None:
+      return true;
+    case Deflate:
+      filter = H5Z_FILTER_DEFLATE;
+      break;
+    case LZF:
+      filter = H5Z_FILTER_LZF;
+      break;
+    case SZIP:
+      filter = H5Z_FILTER_SZIP;
+      break;
+    default:
+      return false;
+    }
+
+    /* Unknown filters are reported as errors; keep them quiet */
+    H5E_BEGIN_TRY {
+      if (H5Zfilter_avail (filter) <= 0 || H5Zget_filter_info (filter, &config) < 0) {
+	config = 0;
+      }
+    } H5E_END_TRY;
+
+    return (config & H5Z_FILTER_CONFIG_ENCODE_ENABLED) != 0;
+  }
+
+} // Namespace DAL -- end
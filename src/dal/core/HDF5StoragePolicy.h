@@ -0,0 +1,218 @@
+/***************************************************************************
+ *   Copyright (C) 2026                                                    *
+ *   agent <agent@local>                                                   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef HDF5STORAGEPOLICY_H
+#define HDF5STORAGEPOLICY_H
+
+// Standard library header files
+#include <iostream>
+#include <string>
+#include <vector>
+
+// DAL header files
+#include "dalCommon.h"
+
+namespace DAL { // Namespace DAL -- begin
+
+  /*!
+    \class HDF5StoragePolicy
+
+    \ingroup DAL
+    \ingroup core
+
+    \brief Chunking and compression settings for new, extendible datasets
+
+    \author agent
+
+    \date 2026/10/16
+
+    \test tHDF5StoragePolicy.cc
+
+    <h3>Prerequisite</h3>
+
+    <ul type="square">
+      <li><a href="http://www.hdfgroup.org/HDF5/doc/H5.user/Filters.html">HDF5
+      Filters</a>
+    </ul>
+
+    <h3>Synopsis</h3>
+
+    The policy describes how the data of an extendible (1-dimensional, e.g. a
+    TBB dipole dataset) array is stored: the size of the chunks along the
+    extendible axis and the filters the chunks are passed through on writing.
+    The shuffle filter re-orders the bytes of the values so that the high bytes
+    -- which are mostly sign extension for 12-bit ADC samples stored as
+    \e short -- end up next to each other, which makes the data compress a lot
+    better. The following compression filters are supported:
+
+    - \e deflate (gzip) -- part of every HDF5 library built with zlib; the
+    compression level (1-9) trades speed against size.
+    - \e LZF -- very fast, moderate compression; needs the LZF filter (as
+    shipped with h5py/PyTables) to be available as a plugin.
+    - \e SZIP -- needs an HDF5 library built with an SZIP encoder.
+
+    If the selected filter is not available in the HDF5 library in use,
+    datasetCreationProperties() falls back to \e deflate (or no compression at
+    all), so files can always be written.
+
+    The presets are
+    - \e default -- the chunk size used so far, no filters;
+    - \e fast -- large chunks, shuffle and LZF (or deflate at level 1), tuned
+    for ingesting data at high rates;
+    - \e compact -- large chunks, shuffle and deflate at level 6.
+
+    <h3>Example(s)</h3>
+
+    \code
+    HDF5StoragePolicy policy;
+    policy.setPreset ("fast");
+
+    hid_t dcpl = policy.datasetCreationProperties ();
+    dalArray *array = group->createShortArray (name,
+                                               dims,
+                                               data,
+                                               policy.chunkDimensions(),
+                                               dcpl);
+    H5Pclose (dcpl);
+    \endcode
+  */
+  class HDF5StoragePolicy {
+
+  public:
+
+    //! Compression filters
+    enum Compression {
+      //! No compression
+      None,
+      //! deflate (gzip) compression
+      Deflate,
+      //! LZF compression (filter plugin)
+      LZF,
+      //! SZIP compression
+      SZIP
+    };
+
+  private:
+
+    //! Chunk size along the extendible axis [samples]
+    int chunkSize_p;
+    //! Apply the shuffle filter before compression?
+    bool shuffle_p;
+    //! Compression filter
+    Compression compression_p;
+    //! Compression level of the deflate filter
+    int compressionLevel_p;
+
+  public:
+
+    // === Construction =========================================================
+
+    //! Default constructor
+    HDF5StoragePolicy ();
+
+    //! Argumented constructor
+    HDF5StoragePolicy (int const &chunkSize,
+		       Compression const &compression=None,
+		       bool const &shuffle=true,
+		       int const &compressionLevel=1);
+
+    // === Parameter access =====================================================
+
+    //! Get the chunk size along the extendible axis [samples]
+    inline int chunkSize () const {
+      return chunkSize_p;
+    }
+
+    //! Set the chunk size along the extendible axis [samples]
+    bool setChunkSize (int const &chunkSize);
+
+    //! Get the chunk dimensions for a 1-dimensional array
+    inline std::vector<int> chunkDimensions () const {
+      return std::vector<int> (1, chunkSize_p);
+    }
+
+    //! Is the shuffle filter applied before compression?
+    inline bool shuffle () const {
+      return shuffle_p;
+    }
+
+    //! Enable/disable the shuffle filter
+    inline void setShuffle (bool const &shuffle) {
+      shuffle_p = shuffle;
+    }
+
+    //! Get the compression filter
+    inline Compression compression () const {
+      return compression_p;
+    }
+
+    //! Set the compression filter
+    inline void setCompression (Compression const &compression) {
+      compression_p = compression;
+    }
+
+    //! Set the compression filter by name ("none", "deflate", "lzf", "szip")
+    bool setCompression (std::string const &name);
+
+    //! Get the compression level of the deflate filter
+    inline int compressionLevel () const {
+      return compressionLevel_p;
+    }
+
+    //! Set the compression level (1-9) of the deflate filter
+    bool setCompressionLevel (int const &level);
+
+    //! Set chunking and compression to one of the presets
+    bool setPreset (std::string const &name);
+
+    /*!
+      \brief Get the name of the class
+
+      \return className -- The name of the class, HDF5StoragePolicy.
+    */
+    inline std::string className () const {
+      return "HDF5StoragePolicy";
+    }
+
+    //! Provide a summary of the object's internal parameters and status
+    inline void summary () {
+      summary (std::cout);
+    }
+
+    //! Provide a summary of the object's internal parameters and status
+    void summary (std::ostream &os);
+
+    // === Methods ==============================================================
+
+    //! Create a dataset creation property list with the filters of the policy
+    hid_t datasetCreationProperties () const;
+
+    //! Get the name of a compression filter
+    static std::string compressionName (Compression const &compression);
+
+    //! Is the encoder of a compression filter available?
+    static bool available (Compression const &compression);
+
+  }; // Class HDF5StoragePolicy -- end
+
+} // Namespace DAL -- end
+
+#endif /* HDF5STORAGEPOLICY_H */
+
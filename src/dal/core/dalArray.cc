@@ -39,6 +39,76 @@ namespace DAL {
     itsRank      = 0;
     datatype     = "UNKNOWN";
     status       = 0;
+    itsFilespace    = 0;
+    itsMemspace     = 0;
+    itsMemspaceSize = 0;
+  }
+  
+  //_____________________________________________________________________________
+  //                                                                     dalArray
+  
+  /*!
+    \param other -- Another dalArray object from which to create this new one.
+  */
+  dalArray::dalArray (dalArray const &other)
+    : dalObjectBase (other)
+  {
+    itsFilespace    = 0;
+    itsMemspace     = 0;
+    itsMemspaceSize = 0;
+    copy (other);
+  }
+  
+  // ============================================================================
+  //
+  //  Destruction
+  //
+  // ============================================================================
+
+  dalArray::~dalArray ()
+  {
+    releaseDataspaces();
+  }
+  
+  // ============================================================================
+  //
+  //  Operators
+  //
+  // ============================================================================
+  
+  //_____________________________________________________________________________
+  //                                                                    operator=
+  
+  /*!
+    \param other -- Another dalArray object from which to make a copy.
+  */
+  dalArray& dalArray::operator= (dalArray const &other)
+  {
+    if (this != &other) {
+      dalObjectBase::operator= (other);
+      releaseDataspaces();
+      copy (other);
+    }
+    return *this;
+  }
+  
+  //_____________________________________________________________________________
+  //                                                                         copy
+  
+  /*!
+    The cached dataspaces are not shared with \e other, as closing either
+    object would invalidate them for the other one; they are set up again on
+    the first write.
+
+    \param other -- Another dalArray object from which to make a copy.
+  */
+  void dalArray::copy (dalArray const &other)
+  {
+    itsRank      = other.itsRank;
+    datatype     = other.datatype;
+    status       = other.status;
+    itsDatasetID = other.itsDatasetID;
+    itsFileID    = other.itsFileID;
   }
   
   //_____________________________________________________________________________
@@ -56,6 +126,8 @@ namespace DAL {
     hid_t * lclfile = (hid_t*)voidfile;  // H5File object
     itsFileID       = *lclfile;          // get the file handle
 
+    releaseDataspaces();
+
     if ( ( itsDatasetID = H5Dopen( itsFileID, itsName.c_str(), H5P_DEFAULT ) ) < 0 )
       std::cerr << "ERROR: could not open array '" << arrayname << "'.\n";
 
@@ -70,6 +142,8 @@ namespace DAL {
   */
   bool dalArray::close()
   {
+    releaseDataspaces();
+
     if ( H5Dclose(itsDatasetID) < 0 ) {
       std::cerr << "ERROR: dalArray::close() failed.\n";
       return DAL::FAIL;
@@ -115,53 +189,23 @@ namespace DAL {
 			int data[],
 			int arraysize )
   {
-    hsize_t      dims[1] = { arraysize };
-    int32_t      itsRank  = 1;
-    hsize_t      off[1]  = { offset };
-    hid_t filespace      = 0;
-    hid_t dataspace      = 0;
-    
-    /* Select a hyperslab  */
-    if ( ( filespace = H5Dget_space( itsDatasetID ) ) < 0 )
-      {
-        std::cerr << "ERROR: Could not get filespace for array.\n";
-        return DAL::FAIL;
-      }
-    
-    if ( H5Sselect_hyperslab( filespace, H5S_SELECT_SET, off, NULL,
-                              dims, NULL) < 0 )
-      {
-        std::cerr << "ERROR: Could not select hyperslab for array.\n";
-        H5Sclose(filespace);
-        return DAL::FAIL;
-      }
-    
-    /* Define memory space */
-    if ( ( dataspace = H5Screate_simple (itsRank, dims, NULL) ) < 0 )
-      {
-        std::cerr << "ERROR: Could not create dataspace for array.\n";
-        H5Sclose(filespace);
-        return DAL::FAIL;
-      }
+    /* Select a hyperslab and define the memory space */
+    if ( !selectHyperslab (offset, arraysize) || !setMemspace (arraysize) ) {
+      return DAL::FAIL;
+    }
 
     /* Write the data to the hyperslab  */
     if ( H5Dwrite( itsDatasetID,
 		   H5T_NATIVE_INT,
-		   dataspace,
-		   filespace,
+		   itsMemspace,
+		   itsFilespace,
                    H5P_DEFAULT,
 		   data ) < 0 )
       {
         std::cerr << "ERROR: Could not write integer array.\n";
-        H5Sclose(dataspace);
-        H5Sclose(filespace);
         return DAL::FAIL;
       }
 
-    /* Close the memory- and data-space */
-    H5Sclose(dataspace);
-    H5Sclose(filespace);
-
     return DAL::SUCCESS;
   }
   
@@ -180,49 +224,19 @@ namespace DAL {
 			short data[],
 			int arraysize)
   {
-    hsize_t      dims[1] = { arraysize };
-    int32_t      itsRank  = 1;
-    hsize_t      off[1]  = { offset };
-    hid_t filespace      = 0;
-    hid_t dataspace      = 0;
-    
-    /* Select a hyperslab  */
-    if ( ( filespace = H5Dget_space( itsDatasetID ) ) < 0 )
-      {
-        std::cerr << "ERROR: Could not get filespace for array.\n";
-        return DAL::FAIL;
-      }
-
-    if ( H5Sselect_hyperslab( filespace, H5S_SELECT_SET, off, NULL,
-                              dims, NULL ) < 0 )
-      {
-        std::cerr << "ERROR: Could not select hyperslab for array.\n";
-        H5Sclose(filespace);
-        return DAL::FAIL;
-      }
-
-    /* Define memory space */
-    if ( ( dataspace = H5Screate_simple (itsRank, dims, NULL) ) < 0 )
-      {
-        std::cerr << "ERROR: Could not create dataspace for array.\n";
-        H5Sclose(filespace);
-        return DAL::FAIL;
-      }
+    /* Select a hyperslab and define the memory space */
+    if ( !selectHyperslab (offset, arraysize) || !setMemspace (arraysize) ) {
+      return DAL::FAIL;
+    }
 
     /* Write the data to the hyperslab  */
-    if ( H5Dwrite (itsDatasetID, H5T_NATIVE_SHORT, dataspace, filespace,
+    if ( H5Dwrite (itsDatasetID, H5T_NATIVE_SHORT, itsMemspace, itsFilespace,
                    H5P_DEFAULT, data ) < 0 )
       {
         std::cerr << "ERROR: Could not write short array.\n";
-        H5Sclose(dataspace);
-        H5Sclose(filespace);
         return DAL::FAIL;
       }
 
-    /* Close the memory- and data-space */
-    H5Sclose(dataspace);
-    H5Sclose(filespace);
-
     return DAL::SUCCESS;
   }
 
@@ -241,25 +255,12 @@ namespace DAL {
 			std::complex<float> data[],
 			int arraysize)
   {
-    hsize_t  dims[1] = { arraysize };
-    hsize_t  off[1]  = { offset };
-    hid_t filespace  = 0;
     hid_t complex_id = 0;
 
     /* Select a hyperslab  */
-    if ( ( filespace = H5Dget_space( itsDatasetID ) ) < 0 )
-      {
-        std::cerr << "ERROR: Could not get filespace for array.\n";
-        return DAL::FAIL;
-      }
-
-    if ( H5Sselect_hyperslab( filespace, H5S_SELECT_SET, off, NULL,
-                              dims, NULL) < 0 )
-      {
-        std::cerr << "ERROR: Could not select hyperslab for array.\n";
-        H5Sclose(filespace);
-        return DAL::FAIL;
-      }
+    if ( !selectHyperslab (offset, arraysize) ) {
+      return DAL::FAIL;
+    }
 
     /* Define memory space */
     typedef struct
@@ -271,7 +272,6 @@ namespace DAL {
     if ( ( complex_id = H5Tcreate (H5T_COMPOUND, sizeof(complex_t)) ) < 0 )
       {
         std::cerr << "ERROR: Could not create complex datatype.\n";
-        H5Sclose(filespace);
         return DAL::FAIL;
       }
 
@@ -279,7 +279,6 @@ namespace DAL {
                     H5T_NATIVE_DOUBLE ) < 0 )
       {
         std::cerr << "ERROR: Could not insert element into compound datatype.\n";
-        H5Sclose(filespace);
         return DAL::FAIL;
       }
 
@@ -287,20 +286,17 @@ namespace DAL {
                     H5T_NATIVE_DOUBLE ) < 0 )
       {
         std::cerr << "ERROR: Could not insert element into compound datatype.\n";
-        H5Sclose(filespace);
         return DAL::FAIL;
       }
 
     /* Write the data to the hyperslab  */
-    if ( H5Dwrite( itsDatasetID, complex_id, filespace, filespace,
+    if ( H5Dwrite( itsDatasetID, complex_id, itsFilespace, itsFilespace,
                    H5P_DEFAULT, data ) < 0 )
       {
         std::cerr << "ERROR: Could not write complex<float> array.\n";
-        H5Sclose(filespace);
         return DAL::FAIL;
       }
 
-    H5Sclose(filespace);
     return DAL::SUCCESS;
   }
 
@@ -321,25 +317,12 @@ namespace DAL {
 			std::complex<Int16> data[],
 			int arraysize)
   {
-    hsize_t      dims[1] = { arraysize };
-    hsize_t      off[1]  = { offset };
-    hid_t filespace      = 0;
     hid_t complex_id     = 0;
 
-    if ( ( filespace = H5Dget_space( itsDatasetID ) ) < 0 )
-      {
-        std::cerr << "ERROR: Could not get filespace for array.\n";
-        return DAL::FAIL;
-      }
-
     /* Select a hyperslab  */
-    if ( H5Sselect_hyperslab( filespace, H5S_SELECT_SET, off, NULL,
-                              dims, NULL ) < 0 )
-      {
-        std::cerr << "ERROR: Could not select hyperslab for array.\n";
-        H5Sclose(filespace);
-        return DAL::FAIL;
-      }
+    if ( !selectHyperslab (offset, arraysize) ) {
+      return DAL::FAIL;
+    }
 
     /* Define memory space */
     typedef struct
@@ -351,7 +334,6 @@ namespace DAL {
     if ( ( complex_id = H5Tcreate (H5T_COMPOUND, sizeof(complex_t)) ) < 0 )
       {
         std::cerr << "ERROR: Could not create complex datatype.\n";
-        H5Sclose(filespace);
         return DAL::FAIL;
       }
 
@@ -359,7 +341,6 @@ namespace DAL {
                      H5T_NATIVE_SHORT ) < 0 )
       {
         std::cerr << "ERROR: Could not insert element into compound datatype.\n";
-        H5Sclose(filespace);
         return DAL::FAIL;
       }
 
@@ -367,24 +348,119 @@ namespace DAL {
                      H5T_NATIVE_SHORT ) < 0 )
       {
         std::cerr << "ERROR: Could not insert element into compound datatype.\n";
-        H5Sclose(filespace);
         return DAL::FAIL;
       }
 
     /* Write the data to the hyperslab  */
-    if ( H5Dwrite( itsDatasetID, complex_id, filespace, filespace,
+    if ( H5Dwrite( itsDatasetID, complex_id, itsFilespace, itsFilespace,
                    H5P_DEFAULT, data ) < 0 )
       {
         std::cerr << "ERROR: Could not write complex<Int16> array.\n";
-        H5Sclose(filespace);
         return DAL::FAIL;
       }
 
-    H5Sclose(filespace);
 
     return DAL::SUCCESS;
   }
 
+  //_____________________________________________________________________________
+  //                                                              selectHyperslab
+
+  /*!
+    The file dataspace is retrieved from the array once and kept for the
+    following writes, which only update the selection in place.
+
+    \param offset    -- Position to begin writing array.
+    \param arraysize -- Size of the array to write.
+    \return bool -- DAL::FAIL or DAL::SUCCESS
+  */
+  bool dalArray::selectHyperslab (int offset,
+				  int arraysize)
+  {
+    if ( offset < 0 || arraysize < 0 )
+      {
+        std::cerr << "ERROR: Negative offset or size of array slab.\n";
+        return DAL::FAIL;
+      }
+
+    hsize_t dims[1] = { static_cast<hsize_t>(arraysize) };
+    hsize_t off[1]  = { static_cast<hsize_t>(offset) };
+
+    if ( itsFilespace <= 0 && ( itsFilespace = H5Dget_space( itsDatasetID ) ) < 0 )
+      {
+        std::cerr << "ERROR: Could not get filespace for array.\n";
+        itsFilespace = 0;
+        return DAL::FAIL;
+      }
+
+    if ( H5Sselect_hyperslab( itsFilespace, H5S_SELECT_SET, off, NULL,
+                              dims, NULL) < 0 )
+      {
+        std::cerr << "ERROR: Could not select hyperslab for array.\n";
+        return DAL::FAIL;
+      }
+
+    return DAL::SUCCESS;
+  }
+
+  //_____________________________________________________________________________
+  //                                                                  setMemspace
+
+  /*!
+    \param arraysize -- Size of the array to write; the memory dataspace only is
+           modified if this differs from the size of the previous write.
+    \return bool -- DAL::FAIL or DAL::SUCCESS
+  */
+  bool dalArray::setMemspace (int arraysize)
+  {
+    if ( arraysize < 0 )
+      {
+        std::cerr << "ERROR: Negative size of array slab.\n";
+        return DAL::FAIL;
+      }
+
+    hsize_t dims[1] = { static_cast<hsize_t>(arraysize) };
+
+    if ( itsMemspace > 0 && itsMemspaceSize == dims[0] ) {
+      return DAL::SUCCESS;
+    }
+
+    if ( itsMemspace > 0 && H5Sset_extent_simple (itsMemspace, 1, dims, NULL) < 0 )
+      {
+        H5Sclose(itsMemspace);
+        itsMemspace = 0;
+      }
+
+    if ( itsMemspace <= 0 && ( itsMemspace = H5Screate_simple (1, dims, NULL) ) < 0 )
+      {
+        std::cerr << "ERROR: Could not create dataspace for array.\n";
+        itsMemspace     = 0;
+        itsMemspaceSize = 0;
+        return DAL::FAIL;
+      }
+
+    itsMemspaceSize = dims[0];
+
+    return DAL::SUCCESS;
+  }
+
+  //_____________________________________________________________________________
+  //                                                            releaseDataspaces
+
+  void dalArray::releaseDataspaces ()
+  {
+    if ( itsFilespace > 0 ) {
+      H5Sclose(itsFilespace);
+    }
+    if ( itsMemspace > 0 ) {
+      H5Sclose(itsMemspace);
+    }
+
+    itsFilespace    = 0;
+    itsMemspace     = 0;
+    itsMemspaceSize = 0;
+  }
+
   //_____________________________________________________________________________
   //                                                                         dims
 
@@ -428,6 +504,9 @@ namespace DAL {
     for ( uint32_t ii=0; ii < rank; ii++ )
       lcldims[ ii ] = newdims[ ii ];
 
+    /* The file dataspace no longer reflects the extent of the array */
+    releaseDataspaces();
+
     if ( H5Dextend( itsDatasetID, lcldims ) )
       {
         std::cerr << "ERROR: Could not extend array dimensions.\n";
@@ -438,6 +517,34 @@ namespace DAL {
 
   }
 
+  //_____________________________________________________________________________
+  //                                                                       resize
+
+  /*!
+    \param dims The new desired dimensions of the array; data outside the new
+                shape are discarded.
+    \return bool -- DAL::FAIL or DAL::SUCCESS
+  */
+  bool dalArray::resize (std::vector<int> const &newdims)
+  {
+    uint32_t rank = newdims.size();
+    hsize_t lcldims[ rank ];
+
+    for ( uint32_t ii=0; ii < rank; ii++ )
+      lcldims[ ii ] = newdims[ ii ];
+
+    /* The file dataspace no longer reflects the extent of the array */
+    releaseDataspaces();
+
+    if ( H5Dset_extent( itsDatasetID, lcldims ) < 0 )
+      {
+        std::cerr << "ERROR: Could not set array dimensions.\n";
+        return DAL::FAIL;
+      }
+
+    return DAL::SUCCESS;
+  }
+
   //_____________________________________________________________________________
   //                                                                getAttributes
 
@@ -50,6 +50,12 @@ namespace DAL {
     std::string datatype;
     //! HDF5 return status
     herr_t status;
+    //! File dataspace of the array, kept until the extent of the array changes
+    hid_t itsFilespace;
+    //! Memory dataspace, kept until the size of the written block changes
+    hid_t itsMemspace;
+    //! Number of elements in the memory dataspace
+    hsize_t itsMemspaceSize;
     
   protected:
     
@@ -64,6 +70,18 @@ namespace DAL {
 
     //! Default constructor
     dalArray();
+    //! Copy constructor
+    dalArray (dalArray const &other);
+
+    // === Destruction ==========================================================
+
+    //! Destructor
+    ~dalArray ();
+
+    // === Operators ============================================================
+
+    //! Overloading of the copy operator
+    dalArray& operator= (dalArray const &other);
 
     // === Parameter access =====================================================
 
@@ -170,6 +188,8 @@ namespace DAL {
 
     //! Increase the dimensions of the array.
     bool extend (std::vector<int> const &dims);
+    //! Change the dimensions of the array; other than extend() this can shrink it.
+    bool resize (std::vector<int> const &dims);
     //! Write \e data of type \e short.
     bool write (int offset, short data[], int arraysize);
     //! Write \e data of type \e int.
@@ -178,6 +198,19 @@ namespace DAL {
     bool write (int offset, std::complex<float> data[], int arraysize );
     //! Write \e data of type \e complex<Int16>.
     bool write (int offset, std::complex<Int16> data[], int arraysize );
+
+  private:
+
+    //! Select \e arraysize elements from \e offset on in the file dataspace
+    bool selectHyperslab (int offset, int arraysize);
+    //! Set up the memory dataspace for a block of \e arraysize elements
+    bool setMemspace (int arraysize);
+    //! Release the file and memory dataspaces
+    void releaseDataspaces ();
+    //! Unconditional copying
+    void copy (dalArray const &other);
+
+  public:
     
     // === Python wrapper functions =============================================
 
@@ -21,6 +21,11 @@
 
 #include "dalCommon.h"
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define DAL_WITH_X86_KERNELS
+#include <immintrin.h>
+#endif
+
 #ifdef DAL_WITH_CASA
 using casa::MPosition;
 #endif
@@ -62,13 +67,160 @@ namespace DAL {
     }
   }
   
+  //_____________________________________________________________________________
+  //                                                                  swapbytes16
+
+  //! Scalar kernel for swapbytes16
+  static void swapbytes16_scalar (uint16_t *data,
+				  uint64_t nofValues)
+  {
+    for (uint64_t n=0; n<nofValues; n++) {
+      data[n] = (uint16_t)((data[n] >> 8) | (data[n] << 8));
+    }
+  }
+
+#ifdef DAL_WITH_X86_KERNELS
+  //! SSSE3 kernel for swapbytes16, swapping 8 values per instruction
+  __attribute__((target("ssse3")))
+  static void swapbytes16_ssse3 (uint16_t *data,
+				 uint64_t nofValues)
+  {
+    const __m128i mask = _mm_set_epi8 (14,15,12,13,10,11,8,9,6,7,4,5,2,3,0,1);
+    uint64_t n = 0;
+
+    for (; n+8<=nofValues; n+=8) {
+      __m128i v = _mm_loadu_si128 ((__m128i*)(data+n));
+      _mm_storeu_si128 ((__m128i*)(data+n), _mm_shuffle_epi8 (v, mask));
+    }
+    swapbytes16_scalar (data+n, nofValues-n);
+  }
+
+  //! AVX2 kernel for swapbytes16, swapping 16 values per instruction
+  __attribute__((target("avx2")))
+  static void swapbytes16_avx2 (uint16_t *data,
+				uint64_t nofValues)
+  {
+    const __m256i mask = _mm256_set_epi8 (14,15,12,13,10,11,8,9,6,7,4,5,2,3,0,1,
+					  14,15,12,13,10,11,8,9,6,7,4,5,2,3,0,1);
+    uint64_t n = 0;
+
+    for (; n+16<=nofValues; n+=16) {
+      __m256i v = _mm256_loadu_si256 ((__m256i*)(data+n));
+      _mm256_storeu_si256 ((__m256i*)(data+n), _mm256_shuffle_epi8 (v, mask));
+    }
+    swapbytes16_scalar (data+n, nofValues-n);
+  }
+#endif
+
+  //! Signature of the swapbytes16 kernels
+  typedef void (*swapbytes16_fn) (uint16_t *, uint64_t);
+
+  /*!
+    \brief Pick the fastest swapbytes16 kernel supported by the host
+
+    \retval name -- Name of the selected kernel
+  */
+  static swapbytes16_fn swapbytes16_select (std::string &name)
+  {
+#ifdef DAL_WITH_X86_KERNELS
+    __builtin_cpu_init ();
+    if (__builtin_cpu_supports ("avx2")) {
+      name = "avx2";
+      return swapbytes16_avx2;
+    }
+    if (__builtin_cpu_supports ("ssse3")) {
+      name = "ssse3";
+      return swapbytes16_ssse3;
+    }
+#endif
+    name = "scalar";
+    return swapbytes16_scalar;
+  }
+
+  //! The swapbytes16 kernel selected for the host, with its name
+  struct swapbytes16_dispatch {
+    swapbytes16_fn kernel;
+    std::string name;
+    swapbytes16_dispatch () {
+      kernel = swapbytes16_select (name);
+    }
+  };
+
+  //! Select the kernel on first use (independent of static initialization order)
+  static swapbytes16_dispatch const & swapbytes16_dispatcher ()
+  {
+    static const swapbytes16_dispatch dispatch;
+    return dispatch;
+  }
+
+  /*!
+    Equivalent to calling swapbytes(addr+2*n,2) for all values, but uses SIMD
+    instructions where the host supports them (selected at run-time).
+
+    \param addr      -- Pointer to the data; no alignment is required.
+    \param nofValues -- Number of 16-bit values to swap.
+  */
+  void swapbytes16 (void *addr,
+		    uint64_t nofValues)
+  {
+    swapbytes16_dispatcher().kernel (static_cast<uint16_t*>(addr), nofValues);
+  }
+
+  /*!
+    \return name -- Name of the kernel used by swapbytes16(): "avx2", "ssse3"
+            or "scalar".
+  */
+  std::string swapbytes16_kernel ()
+  {
+    return swapbytes16_dispatcher().name;
+  }
+  
   //_____________________________________________________________________________
   //                                                                        crc16
+
+  /*!
+    \brief Tables for the word-wise calculation of the CRC16 (polynomial 0x8005)
+
+    Shifting a 16-bit word <tt>hi*x^8+lo</tt> through the register adds
+    <tt>(hi*x^24 + lo*x^16) mod P</tt>, which is looked up in \e high[hi] and
+    \e low[lo].
+  */
+  class CRC16Table {
+  public:
+    uint16_t low[256];
+    uint16_t high[256];
+    CRC16Table () {
+      for (int i=0; i<256; i++) {
+	uint16_t crc = i << 8;
+	for (int bit=0; bit<8; bit++) {
+	  crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x8005) : (uint16_t)(crc << 1);
+	}
+	low[i] = crc;
+      }
+      for (int i=0; i<256; i++) {
+	high[i] = (uint16_t)(low[i] << 8) ^ low[low[i] >> 8];
+      }
+    }
+  };
+
+  //! Build the table on first use (independent of static initialization order)
+  static CRC16Table const & crc16_table ()
+  {
+    static const CRC16Table table;
+    return table;
+  }
   
   /*!
     Generic CRC16 method working on 16-bit unsigned data adapted from Python
     script by Gijs Schoonderbeek.
 
+    The words are shifted through the 16-bit register most significant bit
+    first (polynomial 0x8005, starting from zero), so the result is the
+    remainder of the division of the whole message by the polynomial; a
+    message with its CRC appended thus gives zero. Instead of one bit at a
+    time, the first \e length-1 words are processed a word at a time using two
+    lookup tables, and the last word is added to the resulting register.
+
     \param buffer -- Pointer to the data
     \param length -- Length of the data in 16-bit words.
     
@@ -77,25 +229,19 @@ namespace DAL {
   uint16_t crc16 (uint16_t * buffer,
 		  uint32_t length)
   {
-    uint16_t CRC            = 0;
-    const uint32_t CRC_poly = 0x18005;
-    const uint16_t bits     = 16;
-    uint32_t data           = 0;
-    const uint32_t CRC_div  = (CRC_poly & 0x7fffffff) << 15;
+    CRC16Table const &table = crc16_table();
+    uint16_t crc = 0;
+    uint16_t v;
+
+    if (length == 0) {
+      return 0;
+    }
     
-    data = (buffer[0] & 0x7fffffff) << 16;
-    for (uint32_t i=1; i<length; i++) {
-      data += buffer[i];
-      for (uint16_t j=0; j<bits; j++) {
-	if ((data & 0x80000000) != 0) {
-	  data ^= CRC_div;
-	}
-	data &= 0x7fffffff;
-	data <<= 1;
-      }
+    for (uint32_t i=0; i<length-1; i++) {
+      v   = crc ^ buffer[i];
+      crc = table.high[v >> 8] ^ table.low[v & 0xff];
     }
-    CRC = data >> 16;
-    return CRC;
+    return crc ^ buffer[length-1];
   }
   
   // ============================================================================
@@ -97,6 +97,8 @@ using std::endl;
   used routines:
   - Conversion routines
     - DAL::julday
+    - DAL::swapbytes, DAL::swapbytes16
+    - DAL::crc16
   - Service functions
     - DAL::it_exists
     - DAL::BigEndian
@@ -144,6 +146,13 @@ namespace DAL {
   void swapbytes (char *addr,
 		  int8_t nbytes);
   
+  //! Swap the bytes of an array of 16-bit values
+  void swapbytes16 (void *addr,
+		    uint64_t nofValues);
+  
+  //! Name of the kernel used by swapbytes16 on this machine
+  std::string swapbytes16_kernel ();
+  
   //_____________________________________________________________________________
   //                                                                        crc16
 
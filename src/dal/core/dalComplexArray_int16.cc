@@ -32,12 +32,16 @@ namespace DAL {   // BEGIN -- namespace DAL
     \param data      -- complex<float> vector of data to write
     \param chnkdims  -- resizing (chunking) dimensions. Empty vector if the
            size of the array is fixed.
+    \param creationProperties -- Dataset creation property list (e.g. with
+           compression filters) for extendible arrays; the chunk size is set on
+           a copy of it.
   */
   dalComplexArray_int16::dalComplexArray_int16 (hid_t obj_id,
 						std::string arrayname,
 						std::vector<int> dims,
 						std::complex<Int16> data[],
-						std::vector<int> chnkdims)
+						std::vector<int> chnkdims,
+						hid_t creationProperties)
   {
     hid_t datatype    = 0;
     hid_t dataspace   = 0;
@@ -98,8 +102,9 @@ namespace DAL {   // BEGIN -- namespace DAL
                       << arrayname << "'.\n";
           }
 
-        hid_t cparms;
-        if ( ( cparms = H5Pcreate( H5P_DATASET_CREATE ) ) < 0 )
+        hid_t cparms = ( creationProperties == H5P_DEFAULT )
+          ? H5Pcreate( H5P_DATASET_CREATE ) : H5Pcopy( creationProperties );
+        if ( cparms < 0 )
           {
             std::cerr << "ERROR: Could not create property list for '"
                       << arrayname << "'.\n";
@@ -116,6 +121,8 @@ namespace DAL {   // BEGIN -- namespace DAL
           {
             std::cerr << "ERROR: Could not create array '" << arrayname << "'.\n";
           }
+
+        H5Pclose( cparms );
       }
     // otherwise, write the data this way
     else
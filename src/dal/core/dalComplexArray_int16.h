@@ -47,7 +47,8 @@ namespace DAL {
 			   std::string arrayname,
 			   std::vector<int> dims,
 			   std::complex<Int16> data[],
-			   std::vector<int>chnkdims);
+			   std::vector<int>chnkdims,
+			   hid_t creationProperties=H5P_DEFAULT);
   };
 
 } //   END -- namespace DAL
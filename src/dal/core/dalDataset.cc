@@ -47,10 +47,12 @@ namespace DAL {
     \param flags     -- I/O mode flags
            \e filename. By default an already existing file is kept and only
 	   opened -- if you want to overwrite use <tt>overwrite=true</tt>
+    \param profile   -- File access settings, used if the file is an HDF5 file.
   */
   dalDataset::dalDataset (std::string const &filename,
 			  dalFileType const &filetype,
-			  IO_Mode const &flags)
+			  IO_Mode const &flags,
+			  HDF5AccessProfile const &profile)
     : dalObjectBase()
   {
     /* Initialize internal parameters ... */
@@ -59,7 +61,8 @@ namespace DAL {
 	  flags);
     /* ... and try to open the file. */
     open (filename.c_str(),
-	  flags);
+	  flags,
+	  profile);
   }
   
   //_____________________________________________________________________________
@@ -71,10 +74,12 @@ namespace DAL {
     \param flags     -- I/O mode flags.
            \e filename. By default an already existing file is kept and only
 	   opened -- if you want to overwrite use <tt>overwrite=true</tt>
+    \param profile   -- File access settings, used if the file is an HDF5 file.
   */
   dalDataset::dalDataset (std::string const &filename,
 			  dalFileType::Type const &filetype,
-			  IO_Mode const &flags)
+			  IO_Mode const &flags,
+			  HDF5AccessProfile const &profile)
     : dalObjectBase()
   {
     /* Initialize internal parameters ... */
@@ -83,7 +88,8 @@ namespace DAL {
 	  flags);
     /* ... and try to open the file. */
     open (filename.c_str(),
-	  flags);
+	  flags,
+	  profile);
   }
   
   //_____________________________________________________________________________
@@ -95,10 +101,12 @@ namespace DAL {
     \param overwrite -- Overwrite existing file if one already exists for name
            \e filename. By default an already existing file is kept and only
 	   opened -- if you want to overwrite use <tt>overwrite=true</tt>
+    \param profile   -- File access settings, used if the file is an HDF5 file.
   */
   dalDataset::dalDataset (std::string const &filename,
                           std::string filetype,
-			  IO_Mode const &flags)
+			  IO_Mode const &flags,
+			  HDF5AccessProfile const &profile)
     : dalObjectBase()
   {
     init (filename,
@@ -106,7 +114,8 @@ namespace DAL {
 	  flags);
 
     open (filename,
-	  flags);
+	  flags,
+	  profile);
   }
   
   // ============================================================================
@@ -154,8 +163,9 @@ namespace DAL {
   
   void dalDataset::init()
   {
-    itsFilter      = dalFilter();
-    h5fh_p         = 0;
+    itsFilter        = dalFilter();
+    h5fh_p           = 0;
+    itsAccessProfile = HDF5AccessProfile::defaultProfile();
 #ifdef DAL_WITH_CASA
     itsMS          = casa::MeasurementSet();
 #endif
@@ -234,7 +244,8 @@ namespace DAL {
     
     fileTruncated = HDF5Object::openFile (h5fh_p,
 					  filename,
-					  flags);
+					  flags,
+					  itsAccessProfile);
     
     /* Check the HDF5 objec identifier; if it is ok, do internal book-keeping */
     if (H5Iis_valid(h5fh_p)) {
@@ -441,15 +452,18 @@ namespace DAL {
   /*!
     \param filename  -- The name of the file to open.
     \param flags     -- I/O mode flags.
+    \param profile   -- File access settings, used if the file is an HDF5 file.
     \return bool     -- Status of the operation, either DAL::FAIL or
             DAL::SUCCESS.
   */
   bool dalDataset::open (std::string const &filename,
-			 IO_Mode const &flags)
+			 IO_Mode const &flags,
+			 HDF5AccessProfile const &profile)
   {
-    bool status    = true;
-    bool fileExits = false;
-    itsFlags       = flags;
+    bool status      = true;
+    bool fileExits   = false;
+    itsFlags         = flags;
+    itsAccessProfile = profile;
     
     /* Turn off error reporting */
     H5Eset_auto(H5E_DEFAULT, NULL, NULL);
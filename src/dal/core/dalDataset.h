@@ -108,6 +108,8 @@ namespace DAL {
     dalFilter itsFilter;
     //! HDF5 file handle
     hid_t h5fh_p;
+    //! File access settings used when opening an HDF5 file
+    HDF5AccessProfile itsAccessProfile;
     
 #ifdef DAL_WITH_CASA
     casa::MeasurementSet itsMS;   // CASA measurement set
@@ -124,17 +126,20 @@ namespace DAL {
     //! Argumented constructor
     dalDataset (std::string const &filename,
 		dalFileType const &filetype=dalFileType(),
-		IO_Mode const &flags=IO_Mode(IO_Mode::Open));
+		IO_Mode const &flags=IO_Mode(IO_Mode::Open),
+		HDF5AccessProfile const &profile=HDF5AccessProfile::defaultProfile());
     
     //! Argumented constructor
     dalDataset (std::string const &filename,
 		dalFileType::Type const &filetype,
-		IO_Mode const &flags=IO_Mode(IO_Mode::Open));
+		IO_Mode const &flags=IO_Mode(IO_Mode::Open),
+		HDF5AccessProfile const &profile=HDF5AccessProfile::defaultProfile());
     
     //! Argumented constructor
     dalDataset (std::string const &filename,
 		std::string filetype,
-		IO_Mode const &flags=IO_Mode(IO_Mode::Open));
+		IO_Mode const &flags=IO_Mode(IO_Mode::Open),
+		HDF5AccessProfile const &profile=HDF5AccessProfile::defaultProfile());
     
     // === Destruction ==========================================================
     
@@ -148,11 +153,17 @@ namespace DAL {
       return h5fh_p;
     }
 
+    //! Get the file access settings used when opening an HDF5 file
+    inline HDF5AccessProfile accessProfile () const {
+      return itsAccessProfile;
+    }
+
     // === Public methods =======================================================
     
     //! Open the dataset
     bool open (std::string const &filename,
-	       IO_Mode const &flags=IO_Mode(IO_Mode::Open));
+	       IO_Mode const &flags=IO_Mode(IO_Mode::Open),
+	       HDF5AccessProfile const &profile=HDF5AccessProfile::defaultProfile());
     //! Close the dataset
     bool close();
     //! Get the attributes of the dataset
@@ -277,6 +277,8 @@ namespace DAL {
     \param data A structure containing the data to be written.  The size
                 of the data must match the provided dimensions.
     \param cdims The chunk dimensions for an extendible array.
+    \param creationProperties Dataset creation property list (e.g. with
+                compression filters) for an extendible array.
 
     \return dalArray * A pointer to an array object.
   */
@@ -284,10 +286,12 @@ namespace DAL {
   dalGroup::createShortArray( std::string arrayname,
                               std::vector<int> dims,
                               short data[],
-                              std::vector<int> cdims )
+                              std::vector<int> cdims,
+                              hid_t creationProperties )
   {
     dalShortArray * la;
-    la = new dalShortArray( itsGroupID, arrayname, dims, data, cdims );
+    la = new dalShortArray( itsGroupID, arrayname, dims, data, cdims,
+                            creationProperties );
     return la;
   }
 
@@ -391,6 +395,8 @@ namespace DAL {
     \param data A structure containing the data to be written.  The size
                 of the data must match the provided dimensions.
     \param cdims The chunk dimensions for an extendible array.
+    \param creationProperties Dataset creation property list (e.g. with
+                compression filters) for an extendible array.
 
     \return dalArray * A pointer to an array object.
   */
@@ -398,10 +404,12 @@ namespace DAL {
   dalGroup::createComplexShortArray( std::string arrayname,
                                      std::vector<int> dims,
                                      std::complex<Int16> data[],
-                                     std::vector<int> cdims )
+                                     std::vector<int> cdims,
+                                     hid_t creationProperties )
   {
     dalComplexArray_int16 * la;
-    la = new dalComplexArray_int16( itsGroupID, arrayname, dims, data, cdims );
+    la = new dalComplexArray_int16( itsGroupID, arrayname, dims, data, cdims,
+                                    creationProperties );
     return la;
   }
 
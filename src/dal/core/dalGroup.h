@@ -97,7 +97,8 @@ namespace DAL {
     dalArray * createShortArray(        std::string arrayname,
 					std::vector<int> dims,
 					short data[],
-					std::vector<int>cdims);
+					std::vector<int>cdims,
+					hid_t creationProperties=H5P_DEFAULT);
     //! Create an array of ints within the group.
     dalArray * createIntArray(          std::string arrayname,
 					std::vector<int> dims,
@@ -117,7 +118,8 @@ namespace DAL {
     dalArray * createComplexShortArray( std::string arrayname,
 					std::vector<int> dims,
 					std::complex<Int16> data[],
-					std::vector<int>cdims );
+					std::vector<int>cdims,
+					hid_t creationProperties=H5P_DEFAULT );
     //! Retrief the array or table member names from the group.
     std::vector<std::string> getMemberNames();
     
@@ -39,12 +39,16 @@ namespace DAL {
                 array.  The size of the structure should match the dimensions
                 of the array.
     \param chnkdims Specifies the chunk size for extendible arrays.
+    \param creationProperties Dataset creation property list (e.g. with
+                compression filters) for extendible arrays; the chunk size is
+                set on a copy of it.
    */
   dalShortArray::dalShortArray( hid_t obj_id,
 				std::string arrayname,
                                 std::vector<int> dims,
 				short data[],
-                                std::vector<int> chnkdims )
+                                std::vector<int> chnkdims,
+                                hid_t creationProperties )
   {
     hid_t datatype  = 0;
     hid_t dataspace = 0;  // declare a few h5 variables
@@ -81,7 +85,8 @@ namespace DAL {
 	  std::cerr << "ERROR: Could not set array dataspace.\n";
 	}
       
-      hid_t cparms = H5Pcreate( H5P_DATASET_CREATE );
+      hid_t cparms = ( creationProperties == H5P_DEFAULT )
+	? H5Pcreate( H5P_DATASET_CREATE ) : H5Pcopy( creationProperties );
       if ( cparms < 0 )
 	{
 	  std::cerr << "ERROR: Could not set array propertylist.\n";
@@ -98,6 +103,7 @@ namespace DAL {
 	  std::cerr << "ERROR: Could not create array.\n";
 	}
       
+      H5Pclose( cparms );
     }
     // otherwise, write the data this way
     else {
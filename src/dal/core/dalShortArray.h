@@ -44,7 +44,8 @@ namespace DAL {
 		   std::string arrayname,
 		   std::vector<int> dims,
 		   short data[],
-		   std::vector<int>chnkdims);
+		   std::vector<int>chnkdims,
+		   hid_t creationProperties=H5P_DEFAULT);
 
     //! Read data  from the array
     short * readShortArray (hid_t obj_id,
@@ -0,0 +1,359 @@
+/***************************************************************************
+ *   Copyright (C) 2026                                                    *
+ *   agent <agent@local>                                                   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include <algorithm>
+#include <ctime>
+
+#include <core/ArrayView.h>
+#include <core/HDF5Dataset.h>
+
+// Namespace usage
+using std::cerr;
+using std::cout;
+using std::endl;
+using DAL::ArrayView;
+using DAL::HDF5Dataset;
+using DAL::HDF5Hyperslab;
+
+/*!
+  \file tArrayView.cc
+
+  \ingroup DAL
+  \ingroup core
+
+  \brief A collection of test routines for the ArrayView class
+
+  \author agent
+
+  \date 2026/10/16
+*/
+
+//! Number of antennas in the test dataset
+#define TARRAYVIEW_ANTENNAS 4
+//! Number of time samples in the test dataset
+#define TARRAYVIEW_SAMPLES  16
+//! Number of antennas in the dataset used to time transposed reads
+#define TARRAYVIEW_LARGE_ANTENNAS 16
+//! Number of time samples in the dataset used to time transposed reads
+#define TARRAYVIEW_LARGE_SAMPLES  262144
+
+//_______________________________________________________________________________
+//                                                                  test_geometry
+
+/*!
+  \brief Test the shape and strides of views derived from a buffer
+
+  \return nofFailedTests -- The number of failed tests encountered within this
+          function.
+*/
+int test_geometry ()
+{
+  cout << "\n[tArrayView::test_geometry]" << endl;
+
+  int nofFailedTests (0);
+  double buffer[6*8];
+  std::vector<hsize_t> shape (2);
+  shape[0] = 6;
+  shape[1] = 8;
+
+  cout << "\n[1] ArrayView (data, shape) ..." << endl;
+  ArrayView<double,2> matrix (buffer, shape);
+  matrix.summary();
+  if (matrix.strides()[0] != 8 || matrix.strides()[1] != 1
+      || matrix.nofElements() != 48 || !matrix.isRowMajor()) {
+    cerr << "-- Wrong geometry of contiguous view" << endl;
+    nofFailedTests++;
+  }
+
+  cout << "\n[2] ArrayView::transpose ..." << endl;
+  ArrayView<double,2> transposed = matrix.transpose (0,1);
+  transposed.summary();
+  if (transposed.shape()[0] != 8 || transposed.strides()[0] != 1
+      || transposed.shape()[1] != 6 || transposed.strides()[1] != 8
+      || transposed.isRowMajor()) {
+    cerr << "-- Wrong geometry of transposed view" << endl;
+    nofFailedTests++;
+  }
+
+  cout << "\n[3] ArrayView::slice ..." << endl;
+  ArrayView<double,2> column = transposed.slice (0,3,1);
+  column.summary();
+  if (column.data() != buffer+3 || column.shape()[0] != 1
+      || column.shape()[1] != 6 || !column.isRowMajor()) {
+    cerr << "-- Wrong geometry of single column" << endl;
+    nofFailedTests++;
+  }
+
+  ArrayView<double,2> strided = matrix.slice (1,1,4,2);
+  if (strided.data() != buffer+1 || strided.shape()[1] != 4
+      || strided.strides()[1] != 2 || !strided.isRowMajor()) {
+    cerr << "-- Wrong geometry of strided view" << endl;
+    nofFailedTests++;
+  }
+
+  return nofFailedTests;
+}
+
+//_______________________________________________________________________________
+//                                                                    test_dataset
+
+/*!
+  \brief Test reading and writing a dataset through views on caller buffers
+
+  The dataset has shape [antenna][time]; the buffers in memory are organized
+  as [time][antenna].
+
+  \return nofFailedTests -- The number of failed tests encountered within this
+          function.
+*/
+int test_dataset ()
+{
+  cout << "\n[tArrayView::test_dataset]" << endl;
+
+  int nofFailedTests (0);
+  std::string filename ("tArrayView.h5");
+  unsigned int nofAntennas (TARRAYVIEW_ANTENNAS);
+  unsigned int nofSamples (TARRAYVIEW_SAMPLES);
+  std::vector<hsize_t> shape (2);
+  std::vector<hsize_t> cube (2);
+  std::vector<int> start (2,0);
+  std::vector<int> block (2);
+  double data[TARRAYVIEW_ANTENNAS*TARRAYVIEW_SAMPLES];
+  double buffer[TARRAYVIEW_SAMPLES*TARRAYVIEW_ANTENNAS];
+
+  shape[0] = nofAntennas;
+  shape[1] = nofSamples;
+  cube[0]  = nofSamples;
+  cube[1]  = nofAntennas;
+
+  hid_t fileID = H5Fcreate (filename.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+  HDF5Dataset dataset (fileID, "Data", shape);
+
+  cout << "\n[1] Write contiguous [antenna][time] block ..." << endl;
+  {
+    for (unsigned int a=0; a<nofAntennas; ++a) {
+      for (unsigned int t=0; t<nofSamples; ++t) {
+	data[a*nofSamples+t] = 100*a + t;
+      }
+    }
+    block[0] = nofAntennas;
+    block[1] = nofSamples;
+    HDF5Hyperslab slab (start, block);
+    if (!dataset.writeData (ArrayView<double,2> (data, shape), slab)) {
+      cerr << "-- Failed to write data" << endl;
+      nofFailedTests++;
+    }
+  }
+
+  cout << "\n[2] Read into transposed [time][antenna] buffer ..." << endl;
+  {
+    ArrayView<double,2> view = ArrayView<double,2> (buffer, cube).transpose (0,1);
+    HDF5Hyperslab slab (start, block);
+    if (!dataset.readData (view, slab)) {
+      cerr << "-- Failed to read data" << endl;
+      nofFailedTests++;
+    }
+    for (unsigned int t=0; t<nofSamples; ++t) {
+      for (unsigned int a=0; a<nofAntennas; ++a) {
+	if (buffer[t*nofAntennas+a] != 100*a + t) {
+	  cerr << "-- Wrong value at [" << t << "][" << a << "] : "
+	       << buffer[t*nofAntennas+a] << endl;
+	  nofFailedTests++;
+	  t = nofSamples;
+	  break;
+	}
+      }
+    }
+  }
+
+  cout << "\n[3] Read one antenna into a column of the buffer ..." << endl;
+  {
+    for (unsigned int n=0; n<nofSamples*nofAntennas; ++n) {
+      buffer[n] = -1;
+    }
+    ArrayView<double,2> view = ArrayView<double,2> (buffer, cube).transpose (0,1);
+    start[0] = 2;
+    block[0] = 1;
+    HDF5Hyperslab slab (start, block);
+    if (!dataset.readData (view.slice (0,2,1), slab)) {
+      cerr << "-- Failed to read data" << endl;
+      nofFailedTests++;
+    }
+    for (unsigned int t=0; t<nofSamples; ++t) {
+      if (buffer[t*nofAntennas+2] != 200 + t || buffer[t*nofAntennas+1] != -1) {
+	cerr << "-- Wrong value in row " << t << endl;
+	nofFailedTests++;
+	break;
+      }
+    }
+  }
+
+  cout << "\n[4] Write a column of the buffer to one antenna ..." << endl;
+  {
+    for (unsigned int t=0; t<nofSamples; ++t) {
+      buffer[t*nofAntennas+1] = -double(t);
+    }
+    ArrayView<double,2> view = ArrayView<double,2> (buffer, cube).transpose (0,1);
+    start[0] = 1;
+    block[0] = 1;
+    HDF5Hyperslab slab (start, block);
+    if (!dataset.writeData (view.slice (0,1,1), slab)) {
+      cerr << "-- Failed to write data" << endl;
+      nofFailedTests++;
+    }
+    /* Read back the full dataset in its own layout */
+    start[0] = 0;
+    block[0] = nofAntennas;
+    HDF5Hyperslab all (start, block);
+    dataset.readData (ArrayView<double,2> (data, shape), all);
+    for (unsigned int t=0; t<nofSamples; ++t) {
+      if (data[nofSamples+t] != -double(t) || data[t] != t) {
+	cerr << "-- Wrong value at sample " << t << endl;
+	nofFailedTests++;
+	break;
+      }
+    }
+  }
+
+  cout << "\n[5] Reject view not matching the Hyperslab ..." << endl;
+  {
+    HDF5Hyperslab slab (start, block);
+    if (dataset.readData (ArrayView<double,2> (buffer, cube), slab)) {
+      cerr << "-- Read into view of wrong shape did not fail" << endl;
+      nofFailedTests++;
+    }
+  }
+
+  H5Fclose (fileID);
+
+  return nofFailedTests;
+}
+
+//_______________________________________________________________________________
+//                                                                 test_transpose
+
+/*!
+  \brief Test the time taken to read into a transposed buffer
+
+  A transposed view is split into one row-major slice per antenna, such that
+  reading through the view must not take much longer than a contiguous read
+  followed by transposing the data by hand.
+
+  \return nofFailedTests -- The number of failed tests encountered within this
+          function.
+*/
+int test_transpose ()
+{
+  cout << "\n[tArrayView::test_transpose]" << endl;
+
+  int nofFailedTests (0);
+  std::string filename ("tArrayView.h5");
+  hsize_t nofAntennas (TARRAYVIEW_LARGE_ANTENNAS);
+  hsize_t nofSamples (TARRAYVIEW_LARGE_SAMPLES);
+  std::vector<hsize_t> shape (2);
+  std::vector<hsize_t> cube (2);
+  std::vector<int> start (2,0);
+  std::vector<int> block (2);
+  std::vector<double> data (nofAntennas*nofSamples);
+  std::vector<double> buffer (nofSamples*nofAntennas);
+  clock_t clockStart;
+  double timeView;
+  double timeContiguous;
+
+  shape[0] = cube[1] = nofAntennas;
+  shape[1] = cube[0] = nofSamples;
+  block[0] = nofAntennas;
+  block[1] = nofSamples;
+
+  for (hsize_t n=0; n<data.size(); ++n) {
+    data[n] = n;
+  }
+
+  hid_t fileID = H5Fcreate (filename.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+  HDF5Dataset dataset (fileID, "Data", shape);
+  HDF5Hyperslab slab (start, block);
+  dataset.writeData (ArrayView<double,2> (&data[0], shape), slab);
+
+  cout << "\n[1] Contiguous read and transpose by hand ..." << endl;
+  {
+    clockStart = clock();
+    dataset.readData (ArrayView<double,2> (&data[0], shape), slab);
+    for (hsize_t a=0; a<nofAntennas; ++a) {
+      for (hsize_t t=0; t<nofSamples; ++t) {
+	buffer[t*nofAntennas+a] = data[a*nofSamples+t];
+      }
+    }
+    timeContiguous = double(clock()-clockStart)/CLOCKS_PER_SEC;
+    cout << "-- Time = " << timeContiguous << " s" << endl;
+  }
+
+  cout << "\n[2] Read into transposed [time][antenna] buffer ..." << endl;
+  {
+    std::fill (buffer.begin(), buffer.end(), -1.0);
+    ArrayView<double,2> view = ArrayView<double,2> (&buffer[0], cube).transpose (0,1);
+    clockStart = clock();
+    if (!dataset.readData (view, slab)) {
+      cerr << "-- Failed to read data" << endl;
+      nofFailedTests++;
+    }
+    timeView = double(clock()-clockStart)/CLOCKS_PER_SEC;
+    cout << "-- Time = " << timeView << " s" << endl;
+
+    for (hsize_t t=0; t<nofSamples; ++t) {
+      for (hsize_t a=0; a<nofAntennas; ++a) {
+	if (buffer[t*nofAntennas+a] != double(a*nofSamples+t)) {
+	  cerr << "-- Wrong value at [" << t << "][" << a << "] : "
+	       << buffer[t*nofAntennas+a] << endl;
+	  nofFailedTests++;
+	  t = nofSamples;
+	  break;
+	}
+      }
+    }
+
+    /* Allow for timer resolution and load on the test machine */
+    if (timeView > 4*timeContiguous + 0.1) {
+      cerr << "-- Read through transposed view too slow: " << timeView
+	   << " s against " << timeContiguous << " s" << endl;
+      nofFailedTests++;
+    }
+  }
+
+  H5Fclose (fileID);
+
+  return nofFailedTests;
+}
+
+//_______________________________________________________________________________
+//                                                                           main
+
+int main ()
+{
+  int nofFailedTests (0);
+
+  // Test the geometry of the views
+  nofFailedTests += test_geometry ();
+  // Test I/O through views
+  nofFailedTests += test_dataset ();
+  // Test the time taken by transposed reads
+  nofFailedTests += test_transpose ();
+
+  return nofFailedTests;
+}
@@ -0,0 +1,274 @@
+/***************************************************************************
+ *   Copyright (C) 2026                                                    *
+ *   agent <agent@local>                                                   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include <core/HDF5AccessProfile.h>
+#include <core/HDF5Object.h>
+
+// Namespace usage
+using std::cerr;
+using std::cout;
+using std::endl;
+using DAL::HDF5AccessProfile;
+
+/*!
+  \file tHDF5AccessProfile.cc
+
+  \ingroup DAL
+  \ingroup core
+
+  \brief A collection of test routines for the HDF5AccessProfile class
+
+  \author agent
+
+  \date 2026/10/16
+*/
+
+//_______________________________________________________________________________
+//                                                              test_constructors
+
+/*!
+  \brief Test constructors for a new HDF5AccessProfile object
+
+  \return nofFailedTests -- The number of failed tests encountered within this
+          function.
+*/
+int test_constructors ()
+{
+  cout << "\n[tHDF5AccessProfile::test_constructors]" << endl;
+
+  int nofFailedTests (0);
+
+  cout << "\n[1] HDF5AccessProfile () ..." << endl;
+  {
+    HDF5AccessProfile profile;
+    profile.summary();
+    if (profile.chunkCacheSlots() != 521 ||
+	profile.chunkCacheBytes() != 1024*1024 ||
+	profile.alignment() != 1 ||
+	profile.libverLatest() ||
+	profile.driver() != HDF5AccessProfile::Sec2) {
+      cerr << "-- Default profile differs from the HDF5 library defaults" << endl;
+      nofFailedTests++;
+    }
+  }
+
+  cout << "\n[2] HDF5AccessProfile (preset) ..." << endl;
+  {
+    HDF5AccessProfile profile ("ingest");
+    profile.summary();
+    if (profile.alignment() != 1024*1024 ||
+	profile.chunkCachePreemption() != 1.0 ||
+	!profile.libverLatest()) {
+      cerr << "-- Wrong parameters" << endl;
+      nofFailedTests++;
+    }
+  }
+
+  return nofFailedTests;
+}
+
+//_______________________________________________________________________________
+//                                                                test_parameters
+
+/*!
+  \brief Test setting the parameters, by value and through the presets
+
+  \return nofFailedTests -- The number of failed tests encountered within this
+          function.
+*/
+int test_parameters ()
+{
+  cout << "\n[tHDF5AccessProfile::test_parameters]" << endl;
+
+  int nofFailedTests (0);
+  HDF5AccessProfile profile;
+
+  cout << "\n[1] Availability of the drivers ..." << endl;
+  cout << "-- sec2   = " << HDF5AccessProfile::available(HDF5AccessProfile::Sec2) << endl;
+  cout << "-- core   = " << HDF5AccessProfile::available(HDF5AccessProfile::Core) << endl;
+  cout << "-- direct = " << HDF5AccessProfile::available(HDF5AccessProfile::Direct) << endl;
+  if (!HDF5AccessProfile::available(HDF5AccessProfile::Sec2)) {
+    cerr << "-- The sec2 driver should always be available" << endl;
+    nofFailedTests++;
+  }
+
+  cout << "\n[2] Presets ..." << endl;
+  if (!profile.setPreset("random-read") ||
+      profile.chunkCachePreemption() != 0.0 ||
+      profile.chunkCacheBytes() <= 1024*1024) {
+    cerr << "-- Wrong settings for preset \"random-read\"" << endl;
+    nofFailedTests++;
+  }
+  if (!profile.setPreset("sequential-read") ||
+      profile.sieveBufferSize() <= 64*1024) {
+    cerr << "-- Wrong settings for preset \"sequential-read\"" << endl;
+    nofFailedTests++;
+  }
+  if (!profile.setPreset("default") ||
+      profile.chunkCacheBytes() != 1024*1024) {
+    cerr << "-- Wrong settings for preset \"default\"" << endl;
+    nofFailedTests++;
+  }
+
+  cout << "\n[3] Rejection of invalid values ..." << endl;
+  if (profile.setPreset("fastest") ||
+      profile.setDriver("mpio") ||
+      profile.setChunkCache(0, 1024) ||
+      profile.setChunkCache(521, 1024, 1.5) ||
+      profile.setAlignment(1024, 0)) {
+    cerr << "-- Accepted an invalid value" << endl;
+    nofFailedTests++;
+  }
+  if (profile.chunkCacheSlots() != 521 ||
+      profile.alignment() != 1) {
+    cerr << "-- Invalid value changed the profile" << endl;
+    nofFailedTests++;
+  }
+
+  cout << "\n[4] Drivers by name ..." << endl;
+  {
+    std::string names[3] = { "sec2", "core", "direct" };
+    for (int n=0; n<3; n++) {
+      if (!profile.setDriver(names[n]) ||
+	  HDF5AccessProfile::driverName(profile.driver()) != names[n]) {
+	cerr << "-- Failed to set driver " << names[n] << endl;
+	nofFailedTests++;
+      }
+    }
+  }
+
+  return nofFailedTests;
+}
+
+//_______________________________________________________________________________
+//                                                                     test_files
+
+/*!
+  \brief Test creating and opening files with the presets
+
+  \return nofFailedTests -- The number of failed tests encountered within this
+          function.
+*/
+int test_files ()
+{
+  cout << "\n[tHDF5AccessProfile::test_files]" << endl;
+
+  int nofFailedTests (0);
+  std::string filename ("tHDF5AccessProfile.h5");
+  std::string presets[4] = { "default", "ingest", "sequential-read", "random-read" };
+
+  for (int n=0; n<4; n++) {
+    cout << "\n[" << n+1 << "] File with preset " << presets[n] << " ..." << endl;
+
+    HDF5AccessProfile profile (presets[n]);
+    hid_t fileID = 0;
+
+    DAL::HDF5Object::openFile (fileID,
+			       filename,
+			       DAL::IO_Mode(DAL::IO_Mode::Create),
+			       profile);
+    if (fileID < 0) {
+      cerr << "-- Failed to create the file" << endl;
+      nofFailedTests++;
+      continue;
+    }
+
+    /* Check the settings the file was opened with */
+    hid_t fapl = H5Fget_access_plist (fileID);
+    size_t slots (0);
+    size_t bytes (0);
+    double w0 (0);
+    hsize_t threshold (0);
+    hsize_t alignment (0);
+    H5F_libver_t low;
+    H5F_libver_t high;
+    H5Pget_cache (fapl, NULL, &slots, &bytes, &w0);
+    H5Pget_alignment (fapl, &threshold, &alignment);
+    H5Pget_libver_bounds (fapl, &low, &high);
+    H5Pclose (fapl);
+
+    cout << "-- Chunk cache = " << slots << " slots, " << bytes << " Bytes" << endl;
+    cout << "-- Alignment   = " << alignment << " Bytes" << endl;
+
+    if (slots != profile.chunkCacheSlots() ||
+	bytes != profile.chunkCacheBytes() ||
+	alignment != profile.alignment()) {
+      cerr << "-- File not opened with the settings of the profile" << endl;
+      nofFailedTests++;
+    }
+    if ((low == H5F_LIBVER_LATEST) != profile.libverLatest()) {
+      cerr << "-- Wrong file format version bounds" << endl;
+      nofFailedTests++;
+    }
+
+    H5Fclose (fileID);
+
+    /* Open the file again, through the default profile */
+    HDF5AccessProfile::setDefaultProfile (profile);
+    fileID = DAL::HDF5Object::openFile (filename,
+					DAL::IO_Mode(DAL::IO_Mode::ReadOnly));
+    if (fileID < 0) {
+      cerr << "-- Failed to re-open the file" << endl;
+      nofFailedTests++;
+    } else {
+      H5Fclose (fileID);
+    }
+  }
+
+  HDF5AccessProfile::setDefaultProfile (HDF5AccessProfile());
+
+  cout << "\n[5] File with the core driver ..." << endl;
+  {
+    HDF5AccessProfile profile;
+    profile.setDriver (HDF5AccessProfile::Core);
+    hid_t fileID = profile.createFile (filename);
+    if (fileID < 0) {
+      cerr << "-- Failed to create the file" << endl;
+      nofFailedTests++;
+    } else {
+      hid_t fapl = H5Fget_access_plist (fileID);
+      if (H5Pget_driver (fapl) != H5FD_CORE) {
+	cerr << "-- File not opened with the core driver" << endl;
+	nofFailedTests++;
+      }
+      H5Pclose (fapl);
+      H5Fclose (fileID);
+    }
+  }
+
+  return nofFailedTests;
+}
+
+//_______________________________________________________________________________
+//                                                                           main
+
+int main ()
+{
+  int nofFailedTests (0);
+
+  // Test for the constructor(s)
+  nofFailedTests += test_constructors ();
+  // Test setting the parameters
+  nofFailedTests += test_parameters ();
+  // Test opening files
+  nofFailedTests += test_files ();
+
+  return nofFailedTests;
+}
@@ -473,12 +473,53 @@ int test_array1d (hid_t const &fileID)
 
     // release allocated memory
     delete [] data;
-    
+
   } catch (std::string message) {
     std::cerr << message << endl;
     ++nofFailedTests;
   }
-  
+
+  /*__________________________________________________________________
+    Test 3: Repeated reads of the same shape share the memory dataspace
+  */
+
+  cout << "[3] Reuse of the memory dataspace ..." << endl;
+  try {
+    std::vector<double> data (shape[0]/4);
+
+    start[0] = 0;
+    block[0] = data.size();
+    dataset.readData (&data[0],start,block);
+    hid_t memspace = dataset.memspaceID();
+
+    for (unsigned int step=1; step<4; ++step) {
+      start[0] = step*data.size();
+      dataset.readData (&data[0],start,block);
+      if (dataset.memspaceID() != memspace) {
+	cerr << "-- Memory dataspace recreated for a read of the same shape" << endl;
+	++nofFailedTests;
+      }
+      /* Each block covers four of the 16 steps written in test 1 */
+      if (data[0] != 4*step+1 || data[data.size()-1] != 4*step+4) {
+	cerr << "-- Wrong data read back at step " << step << endl;
+	++nofFailedTests;
+      }
+    }
+
+    /* A different shape is applied to the existing memory dataspace */
+    start[0] = 16;
+    block[0] = 32;
+    dataset.readData (&data[0],start,block);
+    if (data[0] != 1 || data[31] != 1 || !H5Iis_valid(dataset.memspaceID())) {
+      cerr << "-- Failed to read data with a changed selection shape" << endl;
+      ++nofFailedTests;
+    }
+
+  } catch (std::string message) {
+    std::cerr << message << endl;
+    ++nofFailedTests;
+  }
+
   return nofFailedTests;
 }
 
@@ -969,7 +1010,51 @@ int test_extension (std::string const &filename)
     // release allocated memory
     delete [] data;
   }
- 
+
+  //__________________________________________________________________
+  // Test 4 : Grow the dataset in advance, write within the new
+  //          boundaries, then shrink it to the part written.
+
+  std::cout << "[4] Resize dataset before and after writing ..." << std::endl;
+  {
+    HDF5Dataset dataset (groupID, "test4", shape);
+    std::vector<hsize_t> extent (shape);
+    unsigned int nofSteps = 4;
+    unsigned int n        = 0;
+
+    /* Grow the first axis to hold nofSteps tiles of full size */
+    extent[0] = nofSteps*sidelength;
+    if (!dataset.resize (extent)) {
+      std::cerr << "-- Failed to grow dataset!" << std::endl;
+      ++nofFailedTests;
+    }
+
+    block[0] = sidelength;
+    block[1] = sidelength;
+    start[1] = 0;
+
+    nofDatapoints = sidelength*sidelength;
+    double *data  = new double [nofDatapoints];
+
+    for (unsigned int nx=0; nx<nofSteps-1; ++nx) {
+      start[0] = nx*sidelength;
+      for (n=0; n<nofDatapoints; ++n) {
+	data[n] = 1.0*nx;
+      }
+      dataset.writeData (data, start, block);
+    }
+
+    /* Shrink the first axis to the tiles actually written */
+    extent[0] = (nofSteps-1)*sidelength;
+    if (!dataset.resize (extent) || dataset.shape() != extent) {
+      std::cerr << "-- Failed to shrink dataset!" << std::endl;
+      ++nofFailedTests;
+    }
+    std::cout << "-- shape = " << dataset.shape() << std::endl;
+
+    delete [] data;
+  }
+
   //________________________________________________________
   // Close the file
 
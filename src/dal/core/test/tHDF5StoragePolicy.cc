@@ -0,0 +1,248 @@
+/***************************************************************************
+ *   Copyright (C) 2026                                                    *
+ *   agent <agent@local>                                                   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include <core/HDF5StoragePolicy.h>
+#include <core/dalShortArray.h>
+
+// Namespace usage
+using std::cerr;
+using std::cout;
+using std::endl;
+using DAL::HDF5StoragePolicy;
+
+/*!
+  \file tHDF5StoragePolicy.cc
+
+  \ingroup DAL
+  \ingroup core
+
+  \brief A collection of test routines for the HDF5StoragePolicy class
+
+  \author agent
+
+  \date 2026/10/16
+*/
+
+//_______________________________________________________________________________
+//                                                              test_constructors
+
+/*!
+  \brief Test constructors for a new HDF5StoragePolicy object
+
+  \return nofFailedTests -- The number of failed tests encountered within this
+          function.
+*/
+int test_constructors ()
+{
+  cout << "\n[tHDF5StoragePolicy::test_constructors]" << endl;
+
+  int nofFailedTests (0);
+
+  cout << "\n[1] HDF5StoragePolicy () ..." << endl;
+  {
+    HDF5StoragePolicy policy;
+    policy.summary();
+    if (policy.chunkSize() != CHUNK_SIZE ||
+	policy.compression() != HDF5StoragePolicy::None) {
+      cerr << "-- Default policy differs from the previous behaviour" << endl;
+      nofFailedTests++;
+    }
+  }
+
+  cout << "\n[2] HDF5StoragePolicy (chunkSize,compression,shuffle,level) ..." << endl;
+  {
+    HDF5StoragePolicy policy (1024, HDF5StoragePolicy::Deflate, true, 4);
+    policy.summary();
+    if (policy.chunkSize() != 1024 ||
+	policy.compression() != HDF5StoragePolicy::Deflate ||
+	!policy.shuffle() ||
+	policy.compressionLevel() != 4) {
+      cerr << "-- Wrong parameters" << endl;
+      nofFailedTests++;
+    }
+  }
+
+  return nofFailedTests;
+}
+
+//_______________________________________________________________________________
+//                                                                test_parameters
+
+/*!
+  \brief Test setting the parameters, by value and through the presets
+
+  \return nofFailedTests -- The number of failed tests encountered within this
+          function.
+*/
+int test_parameters ()
+{
+  cout << "\n[tHDF5StoragePolicy::test_parameters]" << endl;
+
+  int nofFailedTests (0);
+  HDF5StoragePolicy policy;
+
+  cout << "\n[1] Availability of the filters ..." << endl;
+  cout << "-- deflate = " << HDF5StoragePolicy::available(HDF5StoragePolicy::Deflate) << endl;
+  cout << "-- lzf     = " << HDF5StoragePolicy::available(HDF5StoragePolicy::LZF) << endl;
+  cout << "-- szip    = " << HDF5StoragePolicy::available(HDF5StoragePolicy::SZIP) << endl;
+  if (!HDF5StoragePolicy::available(HDF5StoragePolicy::None)) {
+    cerr << "-- No compression should always be available" << endl;
+    nofFailedTests++;
+  }
+
+  cout << "\n[2] Presets ..." << endl;
+  if (!policy.setPreset("fast") || !policy.shuffle() ||
+      policy.compression() == HDF5StoragePolicy::None ||
+      policy.compressionLevel() != 1) {
+    cerr << "-- Wrong settings for preset \"fast\"" << endl;
+    nofFailedTests++;
+  }
+  if (!policy.setPreset("compact") ||
+      policy.compression() != HDF5StoragePolicy::Deflate) {
+    cerr << "-- Wrong settings for preset \"compact\"" << endl;
+    nofFailedTests++;
+  }
+  if (!policy.setPreset("default") ||
+      policy.compression() != HDF5StoragePolicy::None ||
+      policy.chunkSize() != CHUNK_SIZE) {
+    cerr << "-- Wrong settings for preset \"default\"" << endl;
+    nofFailedTests++;
+  }
+
+  cout << "\n[3] Rejection of invalid values ..." << endl;
+  if (policy.setPreset("slow") ||
+      policy.setCompression("bzip2") ||
+      policy.setChunkSize(0) ||
+      policy.setCompressionLevel(10)) {
+    cerr << "-- Accepted an invalid value" << endl;
+    nofFailedTests++;
+  }
+  if (policy.chunkSize() != CHUNK_SIZE ||
+      policy.compression() != HDF5StoragePolicy::None) {
+    cerr << "-- Invalid value changed the policy" << endl;
+    nofFailedTests++;
+  }
+
+  cout << "\n[4] Compression by name ..." << endl;
+  {
+    std::string names[4] = { "none", "deflate", "lzf", "szip" };
+    for (int n=0; n<4; n++) {
+      if (!policy.setCompression(names[n]) ||
+	  HDF5StoragePolicy::compressionName(policy.compression()) != names[n]) {
+	cerr << "-- Failed to set compression " << names[n] << endl;
+	nofFailedTests++;
+      }
+    }
+  }
+
+  return nofFailedTests;
+}
+
+//_______________________________________________________________________________
+//                                                                  test_datasets
+
+/*!
+  \brief Test creating compressed datasets
+
+  \return nofFailedTests -- The number of failed tests encountered within this
+          function.
+*/
+int test_datasets ()
+{
+  cout << "\n[tHDF5StoragePolicy::test_datasets]" << endl;
+
+  int nofFailedTests (0);
+  std::string filename ("tHDF5StoragePolicy.h5");
+  std::string presets[3] = { "default", "fast", "compact" };
+  std::vector<int> dims (1, 1<<18);
+  /* Noise with a range of 12 bits, as in the TBB data */
+  std::vector<short> data (dims[0]);
+  for (unsigned int n=0; n<data.size(); n++) {
+    data[n] = (rand() % 4096) - 2048;
+  }
+
+  hid_t fileID = H5Fcreate (filename.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+
+  for (int n=0; n<3; n++) {
+    cout << "\n[" << n+1 << "] Dataset with preset " << presets[n] << " ..." << endl;
+
+    HDF5StoragePolicy policy;
+    policy.setPreset (presets[n]);
+    hid_t dcpl = policy.datasetCreationProperties ();
+    DAL::dalShortArray array (fileID,
+			      presets[n],
+			      dims,
+			      &data[0],
+			      policy.chunkDimensions(),
+			      dcpl);
+    H5Pclose (dcpl);
+
+    /* Check the filters of the dataset and the space used to store it */
+    hid_t datasetID = array.getId();
+    hid_t plist     = H5Dget_create_plist (datasetID);
+    int nofFilters  = H5Pget_nfilters (plist);
+    hsize_t storage = H5Dget_storage_size (datasetID);
+    H5Pclose (plist);
+
+    cout << "-- nof. filters = " << nofFilters << endl;
+    cout << "-- Storage size = " << storage << " of "
+	 << data.size()*sizeof(short) << " Bytes" << endl;
+
+    if ((policy.compression() == HDF5StoragePolicy::None) != (nofFilters == 0)) {
+      cerr << "-- Wrong number of filters" << endl;
+      nofFailedTests++;
+    }
+    if (nofFilters > 0 && storage >= data.size()*sizeof(short)) {
+      cerr << "-- Data was not compressed" << endl;
+      nofFailedTests++;
+    }
+
+    /* Read the data back */
+    std::vector<short> buffer (data.size());
+    H5Dread (datasetID, H5T_NATIVE_SHORT, H5S_ALL, H5S_ALL, H5P_DEFAULT, &buffer[0]);
+    if (buffer != data) {
+      cerr << "-- Data read back differs from data written" << endl;
+      nofFailedTests++;
+    }
+
+    array.close();
+  }
+
+  H5Fclose (fileID);
+
+  return nofFailedTests;
+}
+
+//_______________________________________________________________________________
+//                                                                           main
+
+int main ()
+{
+  int nofFailedTests (0);
+
+  // Test for the constructor(s)
+  nofFailedTests += test_constructors ();
+  // Test setting the parameters
+  nofFailedTests += test_parameters ();
+  // Test creating datasets
+  nofFailedTests += test_datasets ();
+
+  return nofFailedTests;
+}
@@ -32,6 +32,7 @@
 */
 
 #include <core/dalArray.h>
+#include <core/dalShortArray.h>
 
 //_______________________________________________________________________________
 //                                                              test_constructors
@@ -113,6 +114,72 @@ int test_constructors (std::string const &filename)
   return nofFailedTests;
 }
 
+//_______________________________________________________________________________
+//                                                                      test_copy
+
+/*!
+  \brief Test copies of an array, which must not share its cached dataspaces
+
+  \return nofFailedTests -- The number of failed tests encountered within this
+          function
+*/
+int test_copy ()
+{
+  std::cout << "\n[tdalArray::test_copy]\n" << std::endl;
+
+  int nofFailedTests (0);
+  std::string filename ("tdalArray_copy.h5");
+  std::vector<int> dims (1,8);
+  std::vector<int> chunk (1,8);
+  short data[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+
+  hid_t fileID = H5Fcreate (filename.c_str(),
+			    H5F_ACC_TRUNC,
+			    H5P_DEFAULT,
+			    H5P_DEFAULT);
+  DAL::dalShortArray arr (fileID, "Data", dims, data, chunk);
+
+  std::cout << "[1] Write through the original array ..." << std::endl;
+  if (!arr.write (0, data, 4)) {
+    std::cerr << "-- Failed to write through original array" << std::endl;
+    nofFailedTests++;
+  }
+
+  std::cout << "[2] Copy constructor ..." << std::endl;
+  {
+    DAL::dalShortArray copy (arr);
+    if (!copy.write (4, data, 4)) {
+      std::cerr << "-- Failed to write through copied array" << std::endl;
+      nofFailedTests++;
+    }
+  }
+  if (!arr.write (0, data, 4)) {
+    std::cerr << "-- Failed to write after the copy was destroyed" << std::endl;
+    nofFailedTests++;
+  }
+
+  std::cout << "[3] Copy operator ..." << std::endl;
+  {
+    DAL::dalShortArray other (fileID, "Other", dims, data, chunk);
+    other.write (0, data, 8);
+    other.close();
+    other = arr;
+    if (!other.write (2, data, 4)) {
+      std::cerr << "-- Failed to write through assigned array" << std::endl;
+      nofFailedTests++;
+    }
+  }
+  if (!arr.write (0, data, 4)) {
+    std::cerr << "-- Failed to write after the copy was destroyed" << std::endl;
+    nofFailedTests++;
+  }
+
+  arr.close();
+  H5Fclose (fileID);
+
+  return nofFailedTests;
+}
+
 //_______________________________________________________________________________
 //                                                                           main
 
@@ -136,6 +203,7 @@ int main (int argc, char *argv[])
   // Run the tests
 
   nofFailedTests += test_constructors ();
+  nofFailedTests += test_copy ();
 
   if (haveDataset) {
     nofFailedTests += test_constructors (filename);
@@ -0,0 +1,328 @@
+/***************************************************************************
+ *   Copyright (C) 2026                                                    *
+ *   agent <agent@local>                                                   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include <sys/time.h>
+#include <cstring>
+#include <core/dalCommon.h>
+
+using std::cout;
+using std::cerr;
+using std::endl;
+
+// -----------------------------------------------------------------------------
+
+/*!
+  \file tdalCommon_kernels.cc
+
+  \ingroup DAL
+  \ingroup core
+
+  \brief Test and benchmark the CRC16 and byte-swap kernels in dalCommon
+
+  \author agent
+
+  \date 2026/10/16
+
+  The kernels DAL::crc16 and DAL::swapbytes16 are compared with the original,
+  bit- resp. byte-wise implementations of the same operations, first for
+  correctness, then for speed on data the size of TBB frames.
+
+  <h3>Examples</h3>
+
+  Calling the test program without any further command-line parameters only
+  runs the tests; the benchmark is run in addition when requested, optionally
+  with the number of headers resp. frames to process:
+  \verbatim
+  tdalCommon_kernels --benchmark 1000000
+  \endverbatim
+*/
+
+//! Number of 16-bit words in a TBB frame header
+#define TEST_HEADER_WORDS 44
+//! Number of samples in a TBB transient data frame
+#define TEST_FRAME_SAMPLES 1024
+
+//_______________________________________________________________________________
+//                                                                 reference_crc16
+
+/*!
+  \brief Original, bit-wise implementation of DAL::crc16
+*/
+uint16_t reference_crc16 (uint16_t * buffer,
+			  uint32_t length)
+{
+  const uint32_t CRC_poly = 0x18005;
+  const uint16_t bits     = 16;
+  uint32_t data           = 0;
+  const uint32_t CRC_div  = (CRC_poly & 0x7fffffff) << 15;
+
+  data = (buffer[0] & 0x7fffffff) << 16;
+  for (uint32_t i=1; i<length; i++) {
+    data += buffer[i];
+    for (uint16_t j=0; j<bits; j++) {
+      if ((data & 0x80000000) != 0) {
+	data ^= CRC_div;
+      }
+      data &= 0x7fffffff;
+      data <<= 1;
+    }
+  }
+  return data >> 16;
+}
+
+//_______________________________________________________________________________
+//                                                             reference_swapbytes
+
+/*!
+  \brief Original way of swapping an array of 16-bit values
+*/
+void reference_swapbytes (short *data,
+			  int nofValues)
+{
+  for (int n=0; n<nofValues; n++) {
+    DAL::swapbytes ((char *)&(data[n]), 2);
+  }
+}
+
+//_______________________________________________________________________________
+//                                                                        seconds
+
+//! Wall-clock time in seconds
+double seconds ()
+{
+  struct timeval tv;
+  gettimeofday (&tv, NULL);
+  return tv.tv_sec + 1e-6*tv.tv_usec;
+}
+
+//_______________________________________________________________________________
+//                                                                     test_crc16
+
+/*!
+  \brief Compare DAL::crc16 with the bit-wise reference
+
+  \return nofFailedTests -- The number of failed tests encountered within this
+          function
+*/
+int test_crc16 ()
+{
+  cout << "\n[tdalCommon_kernels::test_crc16]\n" << endl;
+
+  int nofFailedTests (0);
+  std::vector<uint16_t> buffer (100);
+
+  cout << "[1] Random messages of 1 to 100 words ..." << endl;
+  srand (42);
+  for (uint32_t length=1; length<=buffer.size(); length++) {
+    for (int trial=0; trial<20; trial++) {
+      for (uint32_t n=0; n<length; n++) {
+	buffer[n] = rand() & 0xffff;
+      }
+      if (DAL::crc16 (&buffer[0], length) != reference_crc16 (&buffer[0], length)) {
+	cerr << "-- Mismatch for message of length " << length << endl;
+	nofFailedTests++;
+	break;
+      }
+    }
+  }
+
+  cout << "[2] Message with CRC appended ..." << endl;
+  {
+    for (uint32_t n=0; n<TEST_HEADER_WORDS; n++) {
+      buffer[n] = rand() & 0xffff;
+    }
+    /* With the last word set to zero, the CRC of the rest ends up in the
+       register; storing it there makes the CRC of the whole message zero. */
+    buffer[TEST_HEADER_WORDS-1] = 0;
+    buffer[TEST_HEADER_WORDS-1] = DAL::crc16 (&buffer[0], TEST_HEADER_WORDS);
+    if (DAL::crc16 (&buffer[0], TEST_HEADER_WORDS) != 0
+	|| reference_crc16 (&buffer[0], TEST_HEADER_WORDS) != 0) {
+      cerr << "-- CRC of a message with its CRC appended is not zero" << endl;
+      nofFailedTests++;
+    }
+  }
+
+  return nofFailedTests;
+}
+
+//_______________________________________________________________________________
+//                                                               test_swapbytes16
+
+/*!
+  \brief Compare DAL::swapbytes16 with swapping value by value
+
+  \return nofFailedTests -- The number of failed tests encountered within this
+          function
+*/
+int test_swapbytes16 ()
+{
+  cout << "\n[tdalCommon_kernels::test_swapbytes16]\n" << endl;
+
+  int nofFailedTests (0);
+  std::vector<short> data (TEST_FRAME_SAMPLES+8);
+  std::vector<short> reference (TEST_FRAME_SAMPLES+8);
+
+  cout << "-- Selected kernel = " << DAL::swapbytes16_kernel() << endl;
+
+  cout << "[1] Arrays of 0 to 100 values at all offsets ..." << endl;
+  for (int offset=0; offset<8; offset++) {
+    for (int nofValues=0; nofValues<=100; nofValues++) {
+      for (unsigned int n=0; n<data.size(); n++) {
+	data[n] = reference[n] = rand() & 0xffff;
+      }
+      DAL::swapbytes16 (&data[offset], nofValues);
+      reference_swapbytes (&reference[offset], nofValues);
+      if (data != reference) {
+	cerr << "-- Mismatch for " << nofValues << " values at offset "
+	     << offset << endl;
+	nofFailedTests++;
+      }
+    }
+  }
+
+  cout << "[2] Unaligned array the size of a TBB frame ..." << endl;
+  {
+    /* The samples follow the 88-byte header in the frame buffer */
+    std::vector<char> frame (2*TEST_FRAME_SAMPLES+89);
+    short *sdata = (short *)(&frame[89]);
+    for (int n=0; n<TEST_FRAME_SAMPLES; n++) {
+      memcpy (sdata+n, &n, 2);
+    }
+    DAL::swapbytes16 (sdata, TEST_FRAME_SAMPLES);
+    for (int n=0; n<TEST_FRAME_SAMPLES; n++) {
+      short value;
+      memcpy (&value, sdata+n, 2);
+      DAL::swapbytes ((char *)&value, 2);
+      if (value != n) {
+	cerr << "-- Mismatch at sample " << n << endl;
+	nofFailedTests++;
+	break;
+      }
+    }
+  }
+
+  return nofFailedTests;
+}
+
+//_______________________________________________________________________________
+//                                                                 benchmark
+
+/*!
+  \brief Compare the speed of the kernels with the original code
+
+  \param nofIterations -- Number of headers resp. frames to process
+
+  \return nofFailedTests -- The number of failed tests encountered within this
+          function
+*/
+int benchmark (int nofIterations)
+{
+  cout << "\n[tdalCommon_kernels::benchmark]\n" << endl;
+
+  int nofFailedTests (0);
+  double start, reference, kernel;
+  uint32_t checksum (0);
+  std::vector<uint16_t> header (TEST_HEADER_WORDS);
+  std::vector<short> frame (TEST_FRAME_SAMPLES);
+
+  for (int n=0; n<TEST_HEADER_WORDS; n++) {
+    header[n] = rand() & 0xffff;
+  }
+  for (int n=0; n<TEST_FRAME_SAMPLES; n++) {
+    frame[n] = rand() & 0xffff;
+  }
+
+  cout << "[1] CRC16 of " << nofIterations << " TBB frame headers ..." << endl;
+  start = seconds();
+  for (int n=0; n<nofIterations; n++) {
+    header[0] = n;
+    checksum += reference_crc16 (&header[0], TEST_HEADER_WORDS);
+  }
+  reference = seconds()-start;
+  start = seconds();
+  for (int n=0; n<nofIterations; n++) {
+    header[0] = n;
+    checksum -= DAL::crc16 (&header[0], TEST_HEADER_WORDS);
+  }
+  kernel = seconds()-start;
+  cout << "-- bit-wise   : " << 1e9*reference/nofIterations << " ns/header" << endl;
+  cout << "-- table      : " << 1e9*kernel/nofIterations << " ns/header" << endl;
+  cout << "-- speed-up   : " << reference/kernel << endl;
+  if (checksum != 0) {
+    cerr << "-- Checksums of both versions differ" << endl;
+    nofFailedTests++;
+  }
+
+  cout << "[2] Byte-swapping of " << nofIterations << " TBB frames ..." << endl;
+  start = seconds();
+  for (int n=0; n<nofIterations; n++) {
+    reference_swapbytes (&frame[0], TEST_FRAME_SAMPLES);
+  }
+  reference = seconds()-start;
+  start = seconds();
+  for (int n=0; n<nofIterations; n++) {
+    DAL::swapbytes16 (&frame[0], TEST_FRAME_SAMPLES);
+  }
+  kernel = seconds()-start;
+  cout << "-- swapbytes  : " << 1e9*reference/nofIterations << " ns/frame" << endl;
+  cout << "-- " << DAL::swapbytes16_kernel() << std::string(11-DAL::swapbytes16_kernel().size(),' ')
+       << ": " << 1e9*kernel/nofIterations << " ns/frame" << endl;
+  cout << "-- speed-up   : " << reference/kernel << endl;
+
+  return nofFailedTests;
+}
+
+//_______________________________________________________________________________
+//                                                                           main
+
+/*!
+  \brief Main routine of the test program
+
+  \param argc -- Number of command line arguments
+  \param argv -- Command line arguments; <tt>--benchmark</tt> runs the
+         benchmark as well, optionally followed by the number of iterations
+
+  \return nofFailedTests -- The number of failed tests encountered within and
+          identified by this test program.
+*/
+int main (int argc,
+	  char *argv[])
+{
+  int nofFailedTests (0);
+  bool haveBenchmark (false);
+  int nofIterations (10000);
+
+  if (argc > 1 && strcmp (argv[1], "--benchmark") == 0) {
+    haveBenchmark = true;
+    if (argc > 2) {
+      nofIterations = atoi (argv[2]);
+    }
+  }
+
+  // Test the kernels against the original implementations
+  nofFailedTests += test_crc16 ();
+  nofFailedTests += test_swapbytes16 ();
+  // Compare the speed of the kernels and the original implementations
+  if (haveBenchmark) {
+    nofFailedTests += benchmark (nofIterations);
+  }
+
+  return nofFailedTests;
+}
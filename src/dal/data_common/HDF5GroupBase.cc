@@ -249,24 +249,16 @@ namespace DAL { // Namespace DAL -- begin
   {
     bool status       = true;
     bool absolutePath = false;
-    std::string filename;
     std::string dataset;
     
-    // Get name of file and dataset ________________________
+    // Get name of the dataset _____________________________
     
-    status  = DAL::h5get_filename (filename, location);
-    status *= DAL::h5get_name (dataset, location, absolutePath);
+    status = DAL::h5get_name (dataset, location, absolutePath);
     
     if (status) {
-      // open the file
-      hid_t fileID = H5Fopen (filename.c_str(),
-			      H5F_ACC_RDWR,
-			      H5P_DEFAULT);
-      if (fileID<0) {
-	fileID = H5Fopen (filename.c_str(),
-			  H5F_ACC_RDONLY,
-			  H5P_DEFAULT);
-      }
+      /* Use the file the location belongs to, rather than reopening it by
+	 name, such that its access properties and driver are kept */
+      hid_t fileID = H5Iget_file_id (location);
       // open the dataset
       status = open (fileID, dataset, false);
       // release file handler
@@ -59,6 +59,8 @@ class BFRawFormat {
  public:
   
   static const short maxNrSubbands = 62;
+  //! Magic number at the start of each block header
+  static const uint32_t blockMagic = 0x2913D852;
   
   //! Components of the BFRaw header
   struct BFRaw_Header
@@ -0,0 +1,580 @@
+/***************************************************************************
+ *   Copyright (C) 2026                                                    *
+ *   agent <agent@local>                                                   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include <data_hl/BFRawStokes.h>
+
+#include <algorithm>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define DAL_WITH_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+//! Number of input samples converted at once if the downsampling factor does not fit the SIMD width
+#define STOKES_CHUNK_SIZE 256
+
+namespace DAL { // Namespace DAL -- begin
+
+  /*
+    All kernels come in two flavours, selected by the template parameter
+    'full': Stokes I only (Q, U and V are not touched), or all four Stokes
+    parameters.
+
+    The "samples" kernels convert each input sample into one output sample,
+    the "downsample" kernels sum the values of 'factor' input samples; the
+    SIMD versions of the latter require 'factor' to be a multiple of the
+    number of samples held by a vector register.
+  */
+
+  //! Signature of the kernels converting each input sample
+  typedef void (*stokes_samples_fn) (BFRawFormat::Sample const *, uint64_t,
+				     float *, float *, float *, float *);
+  //! Signature of the kernels summing over the downsampling factor
+  typedef void (*stokes_downsample_fn) (BFRawFormat::Sample const *, uint64_t, unsigned int,
+					float *, float *, float *, float *);
+
+  // ============================================================================
+  //
+  //  Scalar kernels
+  //
+  // ============================================================================
+
+  //! Scalar kernel converting each input sample
+  template <bool full>
+  static void stokes_samples_scalar (BFRawFormat::Sample const *samples,
+				     uint64_t nofSamples,
+				     float *I,
+				     float *Q,
+				     float *U,
+				     float *V)
+  {
+    for (uint64_t n=0; n<nofSamples; n++) {
+      float xr = samples[n].xx.real();
+      float xi = samples[n].xx.imag();
+      float yr = samples[n].yy.real();
+      float yi = samples[n].yy.imag();
+      float pX = xr*xr + xi*xi;
+      float pY = yr*yr + yi*yi;
+      I[n] = pX + pY;
+      if (full) {
+	Q[n] = pX - pY;
+	U[n] = 2 * (xr*yr + xi*yi);
+	V[n] = 2 * (xr*yi - xi*yr);
+      }
+    }
+  }
+
+  //! Scalar kernel summing over the downsampling factor
+  template <bool full>
+  static void stokes_downsample_scalar (BFRawFormat::Sample const *samples,
+					uint64_t nofOutputSamples,
+					unsigned int factor,
+					float *I,
+					float *Q,
+					float *U,
+					float *V)
+  {
+    for (uint64_t n=0; n<nofOutputSamples; n++) {
+      float sX (0), sY (0), sU (0), sV (0);
+      for (unsigned int k=0; k<factor; k++, samples++) {
+	float xr = samples->xx.real();
+	float xi = samples->xx.imag();
+	float yr = samples->yy.real();
+	float yi = samples->yy.imag();
+	sX += xr*xr + xi*xi;
+	sY += yr*yr + yi*yi;
+	if (full) {
+	  sU += xr*yr + xi*yi;
+	  sV += xr*yi - xi*yr;
+	}
+      }
+      I[n] = sX + sY;
+      if (full) {
+	Q[n] = sX - sY;
+	U[n] = 2 * sU;
+	V[n] = 2 * sV;
+      }
+    }
+  }
+
+#ifdef DAL_WITH_X86_KERNELS
+
+  // ============================================================================
+  //
+  //  SSE2 kernels
+  //
+  // ============================================================================
+
+  /*
+    A vector register holds the 32-bit words X0 Y0 X1 Y1 of two samples, each
+    word being a complex<int16_t> with the real part in the low half. From the
+    real and imaginary parts (re, im) and the same with X and Y swapped (reS,
+    imS) follow, per word,
+
+      P = re*re + im*im        ->  |X|^2        |Y|^2
+      C = re*reS + im*imS      ->  Re(X Y^*)    Re(X Y^*)
+      S = re*imS - im*reS      ->  Im(X^* Y)   -Im(X^* Y)
+
+    so the Stokes parameters of a sample follow from the pair of words.
+  */
+
+  //! Powers and cross products of the two samples in a vector register
+  template <bool full>
+  __attribute__((target("sse2")))
+  static inline void stokes_products_sse2 (__m128i w,
+					   __m128 &P,
+					   __m128 &C,
+					   __m128 &S)
+  {
+    __m128 re = _mm_cvtepi32_ps (_mm_srai_epi32 (_mm_slli_epi32 (w, 16), 16));
+    __m128 im = _mm_cvtepi32_ps (_mm_srai_epi32 (w, 16));
+    P = _mm_add_ps (_mm_mul_ps (re, re), _mm_mul_ps (im, im));
+    if (full) {
+      __m128 reS = _mm_shuffle_ps (re, re, _MM_SHUFFLE(2,3,0,1));
+      __m128 imS = _mm_shuffle_ps (im, im, _MM_SHUFFLE(2,3,0,1));
+      C = _mm_add_ps (_mm_mul_ps (re, reS), _mm_mul_ps (im, imS));
+      S = _mm_sub_ps (_mm_mul_ps (re, imS), _mm_mul_ps (im, reS));
+    }
+  }
+
+  //! SSE2 kernel converting each input sample, 4 samples per iteration
+  template <bool full>
+  __attribute__((target("sse2")))
+  static void stokes_samples_sse2 (BFRawFormat::Sample const *samples,
+				   uint64_t nofSamples,
+				   float *I,
+				   float *Q,
+				   float *U,
+				   float *V)
+  {
+    const __m128 two = _mm_set1_ps (2);
+    __m128 P0, P1, C0, C1, S0, S1;
+    uint64_t n = 0;
+
+    for (; n+4<=nofSamples; n+=4) {
+      stokes_products_sse2<full> (_mm_loadu_si128 ((__m128i const *)(samples+n)),   P0, C0, S0);
+      stokes_products_sse2<full> (_mm_loadu_si128 ((__m128i const *)(samples+n+2)), P1, C1, S1);
+      /* Gather the X resp. Y words of the four samples */
+      __m128 pX = _mm_shuffle_ps (P0, P1, _MM_SHUFFLE(2,0,2,0));
+      __m128 pY = _mm_shuffle_ps (P0, P1, _MM_SHUFFLE(3,1,3,1));
+      _mm_storeu_ps (I+n, _mm_add_ps (pX, pY));
+      if (full) {
+	_mm_storeu_ps (Q+n, _mm_sub_ps (pX, pY));
+	_mm_storeu_ps (U+n, _mm_mul_ps (two, _mm_shuffle_ps (C0, C1, _MM_SHUFFLE(2,0,2,0))));
+	_mm_storeu_ps (V+n, _mm_mul_ps (two, _mm_shuffle_ps (S0, S1, _MM_SHUFFLE(2,0,2,0))));
+      }
+    }
+    if (full) {
+      stokes_samples_scalar<full> (samples+n, nofSamples-n, I+n, Q+n, U+n, V+n);
+    } else {
+      stokes_samples_scalar<full> (samples+n, nofSamples-n, I+n, 0, 0, 0);
+    }
+  }
+
+  //! Sum of the X words (first value) and Y words (second value) of a register
+  __attribute__((target("sse2")))
+  static inline void stokes_hsum_sse2 (__m128 v,
+				       float &sX,
+				       float &sY)
+  {
+    __m128 t = _mm_add_ps (v, _mm_movehl_ps (v, v));
+    sX = _mm_cvtss_f32 (t);
+    sY = _mm_cvtss_f32 (_mm_shuffle_ps (t, t, _MM_SHUFFLE(1,1,1,1)));
+  }
+
+  //! SSE2 kernel summing over the downsampling factor; factor must be even
+  template <bool full>
+  __attribute__((target("sse2")))
+  static void stokes_downsample_sse2 (BFRawFormat::Sample const *samples,
+				      uint64_t nofOutputSamples,
+				      unsigned int factor,
+				      float *I,
+				      float *Q,
+				      float *U,
+				      float *V)
+  {
+    __m128 P, C, S;
+    float sX, sY, sU, sV, dummy;
+
+    for (uint64_t n=0; n<nofOutputSamples; n++) {
+      __m128 accP = _mm_setzero_ps ();
+      __m128 accC = _mm_setzero_ps ();
+      __m128 accS = _mm_setzero_ps ();
+      for (unsigned int k=0; k<factor; k+=2, samples+=2) {
+	stokes_products_sse2<full> (_mm_loadu_si128 ((__m128i const *)samples), P, C, S);
+	accP = _mm_add_ps (accP, P);
+	if (full) {
+	  accC = _mm_add_ps (accC, C);
+	  accS = _mm_add_ps (accS, S);
+	}
+      }
+      stokes_hsum_sse2 (accP, sX, sY);
+      I[n] = sX + sY;
+      if (full) {
+	stokes_hsum_sse2 (accC, sU, dummy);
+	stokes_hsum_sse2 (accS, sV, dummy);
+	Q[n] = sX - sY;
+	U[n] = 2 * sU;
+	V[n] = 2 * sV;
+      }
+    }
+  }
+
+  // ============================================================================
+  //
+  //  AVX2 kernels
+  //
+  // ============================================================================
+
+  //! Powers and cross products of the four samples in a vector register
+  template <bool full>
+  __attribute__((target("avx2")))
+  static inline void stokes_products_avx2 (__m256i w,
+					   __m256 &P,
+					   __m256 &C,
+					   __m256 &S)
+  {
+    __m256 re = _mm256_cvtepi32_ps (_mm256_srai_epi32 (_mm256_slli_epi32 (w, 16), 16));
+    __m256 im = _mm256_cvtepi32_ps (_mm256_srai_epi32 (w, 16));
+    P = _mm256_add_ps (_mm256_mul_ps (re, re), _mm256_mul_ps (im, im));
+    if (full) {
+      __m256 reS = _mm256_shuffle_ps (re, re, _MM_SHUFFLE(2,3,0,1));
+      __m256 imS = _mm256_shuffle_ps (im, im, _MM_SHUFFLE(2,3,0,1));
+      C = _mm256_add_ps (_mm256_mul_ps (re, reS), _mm256_mul_ps (im, imS));
+      S = _mm256_sub_ps (_mm256_mul_ps (re, imS), _mm256_mul_ps (im, reS));
+    }
+  }
+
+  //! Gather the X words of two registers, in the order of the samples
+  __attribute__((target("avx2")))
+  static inline __m256 stokes_gather_avx2 (__m256 a,
+					   __m256 b,
+					   int const imm)
+  {
+    /* The shuffle works per 128-bit lane: samples 0 1 4 5 | 2 3 6 7 */
+    __m256 v = (imm == 0) ? _mm256_shuffle_ps (a, b, _MM_SHUFFLE(2,0,2,0))
+      : _mm256_shuffle_ps (a, b, _MM_SHUFFLE(3,1,3,1));
+    return _mm256_castpd_ps (_mm256_permute4x64_pd (_mm256_castps_pd (v), _MM_SHUFFLE(3,1,2,0)));
+  }
+
+  //! AVX2 kernel converting each input sample, 8 samples per iteration
+  template <bool full>
+  __attribute__((target("avx2")))
+  static void stokes_samples_avx2 (BFRawFormat::Sample const *samples,
+				   uint64_t nofSamples,
+				   float *I,
+				   float *Q,
+				   float *U,
+				   float *V)
+  {
+    const __m256 two = _mm256_set1_ps (2);
+    __m256 P0, P1, C0, C1, S0, S1;
+    uint64_t n = 0;
+
+    for (; n+8<=nofSamples; n+=8) {
+      stokes_products_avx2<full> (_mm256_loadu_si256 ((__m256i const *)(samples+n)),   P0, C0, S0);
+      stokes_products_avx2<full> (_mm256_loadu_si256 ((__m256i const *)(samples+n+4)), P1, C1, S1);
+      __m256 pX = stokes_gather_avx2 (P0, P1, 0);
+      __m256 pY = stokes_gather_avx2 (P0, P1, 1);
+      _mm256_storeu_ps (I+n, _mm256_add_ps (pX, pY));
+      if (full) {
+	_mm256_storeu_ps (Q+n, _mm256_sub_ps (pX, pY));
+	_mm256_storeu_ps (U+n, _mm256_mul_ps (two, stokes_gather_avx2 (C0, C1, 0)));
+	_mm256_storeu_ps (V+n, _mm256_mul_ps (two, stokes_gather_avx2 (S0, S1, 0)));
+      }
+    }
+    if (full) {
+      stokes_samples_scalar<full> (samples+n, nofSamples-n, I+n, Q+n, U+n, V+n);
+    } else {
+      stokes_samples_scalar<full> (samples+n, nofSamples-n, I+n, 0, 0, 0);
+    }
+  }
+
+  //! Fold the two 128-bit lanes of an AVX register
+  __attribute__((target("avx2")))
+  static inline __m128 stokes_fold_avx2 (__m256 v)
+  {
+    return _mm_add_ps (_mm256_castps256_ps128 (v), _mm256_extractf128_ps (v, 1));
+  }
+
+  //! AVX2 kernel summing over the downsampling factor; factor must be a multiple of 4
+  template <bool full>
+  __attribute__((target("avx2")))
+  static void stokes_downsample_avx2 (BFRawFormat::Sample const *samples,
+				      uint64_t nofOutputSamples,
+				      unsigned int factor,
+				      float *I,
+				      float *Q,
+				      float *U,
+				      float *V)
+  {
+    __m256 P, C, S;
+    float sX, sY, sU, sV, dummy;
+
+    for (uint64_t n=0; n<nofOutputSamples; n++) {
+      __m256 accP = _mm256_setzero_ps ();
+      __m256 accC = _mm256_setzero_ps ();
+      __m256 accS = _mm256_setzero_ps ();
+      for (unsigned int k=0; k<factor; k+=4, samples+=4) {
+	stokes_products_avx2<full> (_mm256_loadu_si256 ((__m256i const *)samples), P, C, S);
+	accP = _mm256_add_ps (accP, P);
+	if (full) {
+	  accC = _mm256_add_ps (accC, C);
+	  accS = _mm256_add_ps (accS, S);
+	}
+      }
+      stokes_hsum_sse2 (stokes_fold_avx2 (accP), sX, sY);
+      I[n] = sX + sY;
+      if (full) {
+	stokes_hsum_sse2 (stokes_fold_avx2 (accC), sU, dummy);
+	stokes_hsum_sse2 (stokes_fold_avx2 (accS), sV, dummy);
+	Q[n] = sX - sY;
+	U[n] = 2 * sU;
+	V[n] = 2 * sV;
+      }
+    }
+  }
+
+#endif
+
+  // ============================================================================
+  //
+  //  Dispatching
+  //
+  // ============================================================================
+
+  //! The kernels selected for the host, with their name
+  struct stokes_dispatch {
+    //! Number of samples per vector register
+    unsigned int width;
+    stokes_samples_fn samplesI;
+    stokes_samples_fn samplesIQUV;
+    stokes_downsample_fn downsampleI;
+    stokes_downsample_fn downsampleIQUV;
+    std::string name;
+
+    //! Pick the fastest kernels supported by the host
+    stokes_dispatch () {
+#ifdef DAL_WITH_X86_KERNELS
+      __builtin_cpu_init ();
+      if (__builtin_cpu_supports ("avx2")) {
+	name           = "avx2";
+	width          = 4;
+	samplesI       = stokes_samples_avx2<false>;
+	samplesIQUV    = stokes_samples_avx2<true>;
+	downsampleI    = stokes_downsample_avx2<false>;
+	downsampleIQUV = stokes_downsample_avx2<true>;
+	return;
+      }
+      if (__builtin_cpu_supports ("sse2")) {
+	name           = "sse2";
+	width          = 2;
+	samplesI       = stokes_samples_sse2<false>;
+	samplesIQUV    = stokes_samples_sse2<true>;
+	downsampleI    = stokes_downsample_sse2<false>;
+	downsampleIQUV = stokes_downsample_sse2<true>;
+	return;
+      }
+#endif
+      name           = "scalar";
+      width          = 1;
+      samplesI       = stokes_samples_scalar<false>;
+      samplesIQUV    = stokes_samples_scalar<true>;
+      downsampleI    = stokes_downsample_scalar<false>;
+      downsampleIQUV = stokes_downsample_scalar<true>;
+    }
+  };
+
+  //! Select the kernels on first use (independent of static initialization order)
+  static stokes_dispatch const & stokes_dispatcher ()
+  {
+    static const stokes_dispatch dispatch;
+    return dispatch;
+  }
+
+  /*!
+    \brief Downsample with a factor that does not fit the SIMD width
+
+    The input is converted in chunks of STOKES_CHUNK_SIZE samples by the
+    vectorized per-sample kernel, whose results are then summed.
+  */
+  template <bool full>
+  static void stokes_downsample_chunked (stokes_samples_fn kernel,
+					 BFRawFormat::Sample const *samples,
+					 uint64_t nofOutputSamples,
+					 unsigned int factor,
+					 float *I,
+					 float *Q,
+					 float *U,
+					 float *V)
+  {
+    float buffer[4][STOKES_CHUNK_SIZE];
+    float acc[4] = { 0, 0, 0, 0 };
+    uint64_t nofSamples = nofOutputSamples*factor;
+    uint64_t out (0);
+    unsigned int count (0);
+
+    for (uint64_t pos=0; pos<nofSamples; pos+=STOKES_CHUNK_SIZE) {
+      uint64_t length = std::min (nofSamples-pos, (uint64_t)STOKES_CHUNK_SIZE);
+      kernel (samples+pos, length, buffer[0], buffer[1], buffer[2], buffer[3]);
+      for (uint64_t n=0; n<length; n++) {
+	acc[0] += buffer[0][n];
+	if (full) {
+	  acc[1] += buffer[1][n];
+	  acc[2] += buffer[2][n];
+	  acc[3] += buffer[3][n];
+	}
+	if (++count == factor) {
+	  I[out] = acc[0];
+	  if (full) {
+	    Q[out] = acc[1];
+	    U[out] = acc[2];
+	    V[out] = acc[3];
+	  }
+	  acc[0] = acc[1] = acc[2] = acc[3] = 0;
+	  count  = 0;
+	  ++out;
+	}
+      }
+    }
+  }
+
+  // ============================================================================
+  //
+  //  Interface functions
+  //
+  // ============================================================================
+
+  //_____________________________________________________________________________
+  //                                                                      stokesI
+
+  /*!
+    \param samples          -- [nofOutputSamples*downsampleFactor] Input samples.
+    \param nofOutputSamples -- Number of output samples.
+    \param downsampleFactor -- Number of input samples summed per output sample.
+    \retval I               -- [nofOutputSamples] Stokes I.
+  */
+  void stokesI (BFRawFormat::Sample const *samples,
+		uint64_t nofOutputSamples,
+		unsigned int downsampleFactor,
+		float *I)
+  {
+    stokes_dispatch const &dispatch = stokes_dispatcher();
+
+    if (downsampleFactor == 1) {
+      dispatch.samplesI (samples, nofOutputSamples, I, 0, 0, 0);
+    } else if (downsampleFactor % dispatch.width == 0) {
+      dispatch.downsampleI (samples, nofOutputSamples, downsampleFactor, I, 0, 0, 0);
+    } else {
+      stokes_downsample_chunked<false> (dispatch.samplesI, samples, nofOutputSamples,
+					downsampleFactor, I, 0, 0, 0);
+    }
+  }
+
+  //_____________________________________________________________________________
+  //                                                                   stokesIQUV
+
+  /*!
+    \param samples          -- [nofOutputSamples*downsampleFactor] Input samples.
+    \param nofOutputSamples -- Number of output samples.
+    \param downsampleFactor -- Number of input samples summed per output sample.
+    \retval I               -- [nofOutputSamples] Stokes I.
+    \retval Q               -- [nofOutputSamples] Stokes Q.
+    \retval U               -- [nofOutputSamples] Stokes U.
+    \retval V               -- [nofOutputSamples] Stokes V.
+  */
+  void stokesIQUV (BFRawFormat::Sample const *samples,
+		   uint64_t nofOutputSamples,
+		   unsigned int downsampleFactor,
+		   float *I,
+		   float *Q,
+		   float *U,
+		   float *V)
+  {
+    stokes_dispatch const &dispatch = stokes_dispatcher();
+
+    if (downsampleFactor == 1) {
+      dispatch.samplesIQUV (samples, nofOutputSamples, I, Q, U, V);
+    } else if (downsampleFactor % dispatch.width == 0) {
+      dispatch.downsampleIQUV (samples, nofOutputSamples, downsampleFactor, I, Q, U, V);
+    } else {
+      stokes_downsample_chunked<true> (dispatch.samplesIQUV, samples, nofOutputSamples,
+				       downsampleFactor, I, Q, U, V);
+    }
+  }
+
+  //_____________________________________________________________________________
+  //                                                              stokesReference
+
+  /*!
+    Straightforward implementation, summing in double precision; only Stokes I
+    is computed if any of \e Q, \e U and \e V is NULL.
+
+    \param samples          -- [nofOutputSamples*downsampleFactor] Input samples.
+    \param nofOutputSamples -- Number of output samples.
+    \param downsampleFactor -- Number of input samples summed per output sample.
+    \retval I               -- [nofOutputSamples] Stokes I.
+    \retval Q               -- [nofOutputSamples] Stokes Q.
+    \retval U               -- [nofOutputSamples] Stokes U.
+    \retval V               -- [nofOutputSamples] Stokes V.
+  */
+  void stokesReference (BFRawFormat::Sample const *samples,
+			uint64_t nofOutputSamples,
+			unsigned int downsampleFactor,
+			float *I,
+			float *Q,
+			float *U,
+			float *V)
+  {
+    bool full = (Q != 0 && U != 0 && V != 0);
+
+    for (uint64_t n=0; n<nofOutputSamples; n++) {
+      double sI (0), sQ (0), sU (0), sV (0);
+      for (unsigned int k=0; k<downsampleFactor; k++) {
+	std::complex<double> X (samples->xx.real(), samples->xx.imag());
+	std::complex<double> Y (samples->yy.real(), samples->yy.imag());
+	sI += std::norm(X) + std::norm(Y);
+	sQ += std::norm(X) - std::norm(Y);
+	sU += 2 * real (X*std::conj(Y));
+	sV += 2 * imag (std::conj(X)*Y);
+	++samples;
+      }
+      I[n] = sI;
+      if (full) {
+	Q[n] = sQ;
+	U[n] = sU;
+	V[n] = sV;
+      }
+    }
+  }
+
+  //_____________________________________________________________________________
+  //                                                                 stokesKernel
+
+  /*!
+    \return name -- Name of the kernels used by stokesI() and stokesIQUV():
+            "avx2", "sse2" or "scalar".
+  */
+  std::string stokesKernel ()
+  {
+    return stokes_dispatcher().name;
+  }
+
+} // Namespace DAL -- end
@@ -0,0 +1,110 @@
+/***************************************************************************
+ *   Copyright (C) 2026                                                    *
+ *   agent <agent@local>                                                   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef BFRAWSTOKES_H
+#define BFRAWSTOKES_H
+
+#include <string>
+
+#include <data_hl/BFRawFormat.h>
+
+/*!
+  \file BFRawStokes.h
+
+  \ingroup DAL
+  \ingroup data_hl
+
+  \brief Conversion of BF raw samples into (downsampled) Stokes parameters
+
+  \author agent
+
+  \date 2026/10/16
+
+  \test tBFRawStokes.cc
+
+  <h3>Prerequisite</h3>
+
+  <ul type="square">
+    <li>BFRawFormat
+  </ul>
+
+  <h3>Synopsis</h3>
+
+  For the complex voltages \f$ X \f$ and \f$ Y \f$ of the two polarizations
+  (BFRawFormat::Sample::xx and BFRawFormat::Sample::yy) the Stokes parameters
+  are
+
+  \f[
+    I = |X|^2 + |Y|^2 , \quad
+    Q = |X|^2 - |Y|^2 , \quad
+    U = 2\, \mathrm{Re}(X Y^*) , \quad
+    V = 2\, \mathrm{Im}(X^* Y)
+  \f]
+
+  Each output sample is the sum of the values of \e downsampleFactor
+  consecutive input samples (as written by bf2h5 so far; no division by the
+  downsampling factor takes place).
+
+  The work is done by SIMD kernels (SSE2 or AVX2), the fastest one supported
+  by the host being selected at run-time; stokesKernel() returns its name.
+  stokesReference() is the plain scalar implementation used to verify them.
+  No alignment of the input or output buffers is required.
+
+  <h3>Example(s)</h3>
+
+  \code
+  // Stokes I of one subband, downsampled by a factor 16
+  std::vector<float> I (nrSamplesPerSubband/16);
+  DAL::stokesI (subbandData, I.size(), 16, &I[0]);
+  \endcode
+*/
+
+namespace DAL { // Namespace DAL -- begin
+
+  //! Stokes I of BF raw samples, summed over \e downsampleFactor samples
+  void stokesI (BFRawFormat::Sample const *samples,
+		uint64_t nofOutputSamples,
+		unsigned int downsampleFactor,
+		float *I);
+
+  //! Stokes I, Q, U and V of BF raw samples, summed over \e downsampleFactor samples
+  void stokesIQUV (BFRawFormat::Sample const *samples,
+		   uint64_t nofOutputSamples,
+		   unsigned int downsampleFactor,
+		   float *I,
+		   float *Q,
+		   float *U,
+		   float *V);
+
+  //! Scalar reference implementation of stokesI and stokesIQUV
+  void stokesReference (BFRawFormat::Sample const *samples,
+			uint64_t nofOutputSamples,
+			unsigned int downsampleFactor,
+			float *I,
+			float *Q=0,
+			float *U=0,
+			float *V=0);
+
+  //! Name of the kernel used by stokesI and stokesIQUV on this machine
+  std::string stokesKernel ();
+
+} // Namespace DAL -- end
+
+#endif /* BFRAWSTOKES_H */
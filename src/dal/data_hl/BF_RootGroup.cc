@@ -35,7 +35,8 @@ namespace DAL { // Namespace DAL -- begin
     \param filename -- Name of the dataset to open.
   */
   BF_RootGroup::BF_RootGroup (std::string const &filename)
-    : HDF5GroupBase()
+    : HDF5GroupBase(),
+      itsAccessProfile(HDF5AccessProfile::defaultProfile())
   {
     if (!open (0,filename,IO_Mode(itsFlags))) {
       std::cerr << "[BF_RootGroup::BF_RootGroup] Failed to open file "
@@ -51,10 +52,13 @@ namespace DAL { // Namespace DAL -- begin
     \param filename -- Filename object from which the actual file name of the
            dataset is derived.
     \param flags    -- I/O mode flags.
+    \param profile  -- File access settings.
   */
   BF_RootGroup::BF_RootGroup (DAL::Filename &infile,
-			      IO_Mode const &flags)
-    : HDF5GroupBase(flags)
+			      IO_Mode const &flags,
+			      HDF5AccessProfile const &profile)
+    : HDF5GroupBase(flags),
+      itsAccessProfile(profile)
   {
     if (!open (0,infile.filename(),itsFlags)) {
       std::cerr << "[BF_RootGroup::BF_RootGroup] Failed to open file "
@@ -70,10 +74,13 @@ namespace DAL { // Namespace DAL -- begin
     \param attributes -- CommonAttributes object from which the actual file name
            of the dataset is extracted.
     \param flags      -- I/O mode flags.
+    \param profile    -- File access settings.
   */
   BF_RootGroup::BF_RootGroup (CommonAttributes const &attributes,
-			      IO_Mode const &flags)
-    : HDF5GroupBase(flags)
+			      IO_Mode const &flags,
+			      HDF5AccessProfile const &profile)
+    : HDF5GroupBase(flags),
+      itsAccessProfile(profile)
   {
     if (!open (0,attributes.filename(),itsFlags)) {
       std::cerr << "[BF_RootGroup::BF_RootGroup] Failed to open file "
@@ -252,7 +259,8 @@ namespace DAL { // Namespace DAL -- begin
 
     bool fileTruncated = HDF5Object::openFile (location_p,
 					       name,
-					       itsFlags);
+					       itsFlags,
+					       itsAccessProfile);
 
     // Set attributes ______________________________________
     
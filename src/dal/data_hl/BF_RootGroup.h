@@ -172,6 +172,8 @@ namespace DAL { // Namespace DAL -- begin
     std::map<std::string,BF_SubArrayPointing> itsSubarrayPointings;
     //! Container for system-wide logs
     std::map<std::string,SysLog> itsSystemLog;
+    //! File access settings used when opening the file
+    HDF5AccessProfile itsAccessProfile;
 
   public:
     
@@ -182,11 +184,13 @@ namespace DAL { // Namespace DAL -- begin
     
     //! Argumented constructor
     BF_RootGroup (DAL::Filename &infile,
-		  IO_Mode const &flags=IO_Mode(IO_Mode::OpenOrCreate));
+		  IO_Mode const &flags=IO_Mode(IO_Mode::OpenOrCreate),
+		  HDF5AccessProfile const &profile=HDF5AccessProfile::defaultProfile());
     
     //! Argumented constructor
     BF_RootGroup (CommonAttributes const &attributes,
-		  IO_Mode const &flags=IO_Mode(IO_Mode::OpenOrCreate));
+		  IO_Mode const &flags=IO_Mode(IO_Mode::OpenOrCreate),
+		  HDF5AccessProfile const &profile=HDF5AccessProfile::defaultProfile());
     
     // === Destruction ==========================================================
     
@@ -201,6 +205,11 @@ namespace DAL { // Namespace DAL -- begin
     //! Set the set of common attributes attached to the root group of the file
     bool setCommonAttributes (CommonAttributes const &attributes);
 
+    //! Get the file access settings used when opening the file
+    inline HDF5AccessProfile accessProfile () const {
+      return itsAccessProfile;
+    }
+
     /*!
       \brief Get the name of the class
       
@@ -0,0 +1,47 @@
+/***************************************************************************
+ *   Copyright (C) 2026                                                    *
+ *   agent <agent@local>                                                   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include <data_hl/ProcessingStage.h>
+
+namespace DAL { // Namespace DAL -- begin
+
+  //_____________________________________________________________________________
+  //                                                              dispersionDelay
+
+  /*!
+    \param dm                 -- Dispersion measure in pc cm^-3.
+    \param frequency          -- Frequency in Hz.
+    \param referenceFrequency -- Reference frequency in Hz.
+
+    \return delay -- Arrival time at \e frequency minus the arrival time at
+            \e referenceFrequency, in seconds; positive if \e frequency is the
+            lower of the two.
+  */
+  double dispersionDelay (double dm,
+			  double frequency,
+			  double referenceFrequency)
+  {
+    double f  = frequency * 1e-6;
+    double f0 = referenceFrequency * 1e-6;
+
+    return DAL_DISPERSION_CONSTANT * dm * (1.0 / (f * f) - 1.0 / (f0 * f0));
+  }
+
+} // Namespace DAL -- end
@@ -0,0 +1,637 @@
+/***************************************************************************
+ *   Copyright (C) 2026                                                    *
+ *   agent <agent@local>                                                   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef PROCESSINGSTAGE_H
+#define PROCESSINGSTAGE_H
+
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+/*!
+  \file ProcessingStage.h
+
+  \ingroup DAL
+  \ingroup data_hl
+
+  \brief Streaming reduction stages for blocks of <tt>[time][channel]</tt> data
+
+  \author agent
+
+  \date 2026/10/16
+
+  \test tProcessingStage.cc
+
+  <h3>Synopsis</h3>
+
+  A processing stage works on a stream of data blocks, each holding a number of
+  time samples of \e nofChannels channels, stored as <tt>[time][channel]</tt>.
+  The blocks are passed to ProcessingStage::process() in the order of the
+  stream; any state needed to continue with the next block (partially averaged
+  samples, the history of the dedispersion) is kept by the stage, so the
+  result does not depend on how the stream is cut into blocks. The stages
+  provided are
+
+  <ul type="square">
+    <li>AveragingStage -- averaging of a number of consecutive time samples
+        and/or adjacent channels;
+    <li>DedispersionStage -- incoherent dedispersion for a given dispersion
+        measure, by shifting each channel in time;
+    <li>BandpassStage -- normalization of each channel to zero mean and unit
+        variance, using the statistics of the stream so far.
+  </ul>
+
+  A ProcessingChain applies a number of stages one after the other, keeping
+  the intermediate results in buffers of its own. It is used by bf2h5 to
+  reduce the data while they are ingested, and is available in Python as
+  <tt>pydal.ProcessingChain</tt>.
+
+  <h3>Example(s)</h3>
+
+  \code
+  // Dedisperse and normalize blocks of 4096 samples of 248 subbands
+  DAL::ProcessingChain<float> chain (248);
+  chain.add (new DAL::DedispersionStage<float> (frequencies, sampleTime, 56.8));
+  chain.add (new DAL::BandpassStage<float> (248));
+
+  uint64_t nofTimes;
+  float const *result = chain.process (block, 4096, nofTimes);
+  \endcode
+*/
+
+//! Dispersion constant in s MHz^2 pc^-1 cm^3
+#define DAL_DISPERSION_CONSTANT 4.148808e3
+
+namespace DAL { // Namespace DAL -- begin
+
+  //! Delay of a dispersed signal at \e frequency w.r.t. \e referenceFrequency, in seconds
+  double dispersionDelay (double dm,
+			  double frequency,
+			  double referenceFrequency);
+
+  // ============================================================================
+  //
+  //  ProcessingStage
+  //
+  // ============================================================================
+
+  /*!
+    \class ProcessingStage
+
+    \ingroup DAL
+    \ingroup data_hl
+
+    \brief Interface of a stage processing a stream of <tt>[time][channel]</tt> blocks
+  */
+  template <class T>
+    class ProcessingStage {
+
+  protected:
+
+    //! Number of channels of the input
+    unsigned int itsNofChannels;
+
+  public:
+
+    // === Construction =========================================================
+
+    //! Argumented constructor
+    ProcessingStage (unsigned int nofChannels)
+      : itsNofChannels (nofChannels)
+      {}
+
+    // === Destruction ==========================================================
+
+    //! Destructor
+    virtual ~ProcessingStage () {}
+
+    // === Parameter access =====================================================
+
+    //! Get the number of channels of the input
+    inline unsigned int nofChannels () const {
+      return itsNofChannels;
+    }
+
+    //! Get the number of channels of the output
+    virtual unsigned int nofOutputChannels () const {
+      return itsNofChannels;
+    }
+
+    //! Get the number of time samples output by process() for \e nofTimes input samples
+    virtual uint64_t nofOutputTimes (uint64_t nofTimes) const {
+      return nofTimes;
+    }
+
+    //! Get the name of the stage
+    virtual std::string name () const = 0;
+
+    // === Methods ==============================================================
+
+    /*!
+      \brief Process the next block of the stream
+
+      \param input    -- Input block, <tt>[nofTimes][nofChannels()]</tt>.
+      \param nofTimes -- Number of time samples in the input block.
+      \param output   -- Output block, with room for <tt>[nofOutputTimes(nofTimes)][nofOutputChannels()]</tt>
+             samples; may not overlap with the input.
+
+      \return nofOutputTimes -- Number of time samples written to the output.
+    */
+    virtual uint64_t process (T const *input,
+			      uint64_t nofTimes,
+			      T *output) = 0;
+
+    //! Forget the state kept from the previous blocks, to start a new stream
+    virtual void reset () {}
+  };
+
+  // ============================================================================
+  //
+  //  AveragingStage
+  //
+  // ============================================================================
+
+  /*!
+    \class AveragingStage
+
+    \ingroup DAL
+    \ingroup data_hl
+
+    \brief Average over \e timeFactor time samples and \e channelFactor channels
+
+    Output sample <tt>[t][c]</tt> is the mean of the input samples
+    <tt>[t*timeFactor ... (t+1)*timeFactor-1][c*channelFactor ... (c+1)*channelFactor-1]</tt>
+    of the stream. Time samples left over at the end of a block are carried
+    over to the next one; channels left over at the end of a row are dropped.
+  */
+  template <class T>
+    class AveragingStage : public ProcessingStage<T> {
+
+    //! Number of time samples averaged
+    unsigned int itsTimeFactor;
+    //! Number of channels averaged
+    unsigned int itsChannelFactor;
+    //! Sums of the output sample being accumulated
+    std::vector<double> itsSum;
+    //! Number of time samples in itsSum
+    unsigned int itsNofSummed;
+
+  public:
+
+    //! Argumented constructor
+    AveragingStage (unsigned int nofChannels,
+		    unsigned int timeFactor,
+		    unsigned int channelFactor=1)
+      : ProcessingStage<T> (nofChannels),
+      itsTimeFactor (timeFactor ? timeFactor : 1),
+      itsChannelFactor (channelFactor ? channelFactor : 1),
+      itsNofSummed (0)
+      {
+	itsSum.resize (nofOutputChannels(), 0);
+      }
+
+    //! Get the number of time samples averaged
+    inline unsigned int timeFactor () const {
+      return itsTimeFactor;
+    }
+
+    //! Get the number of channels averaged
+    inline unsigned int channelFactor () const {
+      return itsChannelFactor;
+    }
+
+    //! Get the number of channels of the output
+    unsigned int nofOutputChannels () const {
+      return this->itsNofChannels / itsChannelFactor;
+    }
+
+    //! Get the number of time samples output for \e nofTimes input samples
+    uint64_t nofOutputTimes (uint64_t nofTimes) const {
+      return (itsNofSummed + nofTimes) / itsTimeFactor;
+    }
+
+    //! Get the name of the stage
+    std::string name () const {
+      return "AveragingStage";
+    }
+
+    //! Process the next block of the stream
+    uint64_t process (T const *input,
+		      uint64_t nofTimes,
+		      T *output)
+    {
+      unsigned int nofOutChannels = nofOutputChannels();
+      double scale                = 1.0 / (double(itsTimeFactor) * itsChannelFactor);
+      uint64_t nofOutput          = 0;
+
+      for (uint64_t t = 0; t < nofTimes; ++t) {
+	T const *row = input + t * this->itsNofChannels;
+	for (unsigned int c = 0; c < nofOutChannels; ++c) {
+	  for (unsigned int n = 0; n < itsChannelFactor; ++n) {
+	    itsSum[c] += row[c * itsChannelFactor + n];
+	  }
+	}
+	if (++itsNofSummed == itsTimeFactor) {
+	  T *out = output + nofOutput * nofOutChannels;
+	  for (unsigned int c = 0; c < nofOutChannels; ++c) {
+	    out[c]    = T(itsSum[c] * scale);
+	    itsSum[c] = 0;
+	  }
+	  itsNofSummed = 0;
+	  ++nofOutput;
+	}
+      }
+
+      return nofOutput;
+    }
+
+    //! Forget the partially averaged time samples
+    void reset () {
+      itsSum.assign (itsSum.size(), 0);
+      itsNofSummed = 0;
+    }
+  };
+
+  // ============================================================================
+  //
+  //  DedispersionStage
+  //
+  // ============================================================================
+
+  /*!
+    \class DedispersionStage
+
+    \ingroup DAL
+    \ingroup data_hl
+
+    \brief Incoherent dedispersion by shifting the channels in time
+
+    A dispersed signal reaches channel \e c a time
+    \f$ \Delta t_c = k_{\rm DM}\, {\rm DM}\, (f_c^{-2} - f_{\max}^{-2}) \f$
+    after it reaches the highest frequency \f$ f_{\max} \f$; rounded to whole
+    samples, this gives the delay \f$ d_c \f$ of the channel. To keep the stage
+    causal, the channels are aligned to the most delayed one: output sample
+    <tt>[t][c]</tt> is input sample <tt>[t - (maxDelay() - delay(c))][c]</tt>
+    of the stream, the last maxDelay() samples of each channel being kept
+    for the next block. The output therefore has as many time samples as the
+    input, with the signal appearing at its arrival time at the lowest
+    frequency; the first maxDelay() samples of the stream are partially zero.
+  */
+  template <class T>
+    class DedispersionStage : public ProcessingStage<T> {
+
+    //! Dispersion measure in pc cm^-3
+    double itsDM;
+    //! Delay of each channel in samples
+    std::vector<unsigned int> itsDelay;
+    //! Maximum delay in samples
+    unsigned int itsMaxDelay;
+    //! Last itsMaxDelay time samples of the stream, [time][channel]
+    std::vector<T> itsHistory;
+
+  public:
+
+    /*!
+      \param frequencies -- Center frequency of each channel in Hz.
+      \param sampleTime  -- Duration of a time sample in seconds.
+      \param dm          -- Dispersion measure in pc cm^-3.
+    */
+    DedispersionStage (std::vector<double> const &frequencies,
+		       double sampleTime,
+		       double dm)
+      : ProcessingStage<T> (frequencies.size()),
+      itsDM (dm),
+      itsMaxDelay (0)
+      {
+	double maxFrequency = 0;
+	for (unsigned int c = 0; c < frequencies.size(); ++c) {
+	  if (frequencies[c] > maxFrequency) {
+	    maxFrequency = frequencies[c];
+	  }
+	}
+
+	itsDelay.resize (frequencies.size(), 0);
+	for (unsigned int c = 0; c < frequencies.size(); ++c) {
+	  if (frequencies[c] > 0 && sampleTime > 0) {
+	    itsDelay[c] = (unsigned int)floor (dispersionDelay (dm, frequencies[c], maxFrequency) / sampleTime + 0.5);
+	  }
+	  if (itsDelay[c] > itsMaxDelay) {
+	    itsMaxDelay = itsDelay[c];
+	  }
+	}
+
+	itsHistory.resize (itsMaxDelay * this->itsNofChannels, 0);
+      }
+
+    //! Get the dispersion measure in pc cm^-3
+    inline double dm () const {
+      return itsDM;
+    }
+
+    //! Get the delay of channel \e channel in samples
+    inline unsigned int delay (unsigned int channel) const {
+      return itsDelay[channel];
+    }
+
+    //! Get the delay of the lowest frequency channel in samples
+    inline unsigned int maxDelay () const {
+      return itsMaxDelay;
+    }
+
+    //! Get the name of the stage
+    std::string name () const {
+      return "DedispersionStage";
+    }
+
+    //! Process the next block of the stream
+    uint64_t process (T const *input,
+		      uint64_t nofTimes,
+		      T *output)
+    {
+      unsigned int nofChannels = this->itsNofChannels;
+
+      /* The stream is the history followed by the input block */
+      for (unsigned int c = 0; c < nofChannels; ++c) {
+	uint64_t lag = itsMaxDelay - itsDelay[c];
+	for (uint64_t t = 0; t < nofTimes; ++t) {
+	  uint64_t index = itsMaxDelay + t - lag;
+	  if (index < itsMaxDelay) {
+	    output[t * nofChannels + c] = itsHistory[index * nofChannels + c];
+	  } else {
+	    output[t * nofChannels + c] = input[(index - itsMaxDelay) * nofChannels + c];
+	  }
+	}
+      }
+
+      /* Keep the last itsMaxDelay samples of the stream; without any delay
+	 there is no history to keep */
+      if (itsHistory.empty()) {
+	return nofTimes;
+      }
+
+      if (nofTimes >= itsMaxDelay) {
+	memcpy (&itsHistory[0],
+		input + (nofTimes - itsMaxDelay) * nofChannels,
+		itsHistory.size() * sizeof(T));
+      } else if (nofTimes > 0) {
+	size_t kept = (itsMaxDelay - nofTimes) * nofChannels;
+	memmove (&itsHistory[0], &itsHistory[nofTimes * nofChannels], kept * sizeof(T));
+	memcpy (&itsHistory[kept], input, nofTimes * nofChannels * sizeof(T));
+      }
+
+      return nofTimes;
+    }
+
+    //! Clear the history of the stream
+    void reset () {
+      itsHistory.assign (itsHistory.size(), 0);
+    }
+  };
+
+  // ============================================================================
+  //
+  //  BandpassStage
+  //
+  // ============================================================================
+
+  /*!
+    \class BandpassStage
+
+    \ingroup DAL
+    \ingroup data_hl
+
+    \brief Normalize each channel to zero mean and unit variance
+
+    The mean \f$ \mu_c \f$ and standard deviation \f$ \sigma_c \f$ of each
+    channel are accumulated over the stream; each block is added to them before
+    it is normalized as \f$ (x - \mu_c) / \sigma_c \f$. Channels without any
+    variation are only shifted to zero mean.
+  */
+  template <class T>
+    class BandpassStage : public ProcessingStage<T> {
+
+    //! Number of time samples accumulated
+    uint64_t itsNofSamples;
+    //! Sum of the samples of each channel
+    std::vector<double> itsSum;
+    //! Sum of the squared samples of each channel
+    std::vector<double> itsSumSquares;
+
+  public:
+
+    //! Argumented constructor
+    BandpassStage (unsigned int nofChannels)
+      : ProcessingStage<T> (nofChannels),
+      itsNofSamples (0),
+      itsSum (nofChannels, 0),
+      itsSumSquares (nofChannels, 0)
+      {}
+
+    //! Get the mean of channel \e channel so far
+    inline double mean (unsigned int channel) const {
+      return itsNofSamples ? itsSum[channel] / itsNofSamples : 0;
+    }
+
+    //! Get the standard deviation of channel \e channel so far
+    inline double rms (unsigned int channel) const {
+      if (itsNofSamples == 0) {
+	return 0;
+      }
+      double mu       = mean (channel);
+      double variance = itsSumSquares[channel] / itsNofSamples - mu * mu;
+      return variance > 0 ? sqrt (variance) : 0;
+    }
+
+    //! Get the name of the stage
+    std::string name () const {
+      return "BandpassStage";
+    }
+
+    //! Process the next block of the stream
+    uint64_t process (T const *input,
+		      uint64_t nofTimes,
+		      T *output)
+    {
+      unsigned int nofChannels = this->itsNofChannels;
+
+      for (uint64_t t = 0; t < nofTimes; ++t) {
+	T const *row = input + t * nofChannels;
+	for (unsigned int c = 0; c < nofChannels; ++c) {
+	  itsSum[c]        += row[c];
+	  itsSumSquares[c] += double(row[c]) * row[c];
+	}
+      }
+      itsNofSamples += nofTimes;
+
+      for (unsigned int c = 0; c < nofChannels; ++c) {
+	double mu    = mean (c);
+	double sigma = rms (c);
+	double scale = sigma > 0 ? 1.0 / sigma : 1.0;
+	for (uint64_t t = 0; t < nofTimes; ++t) {
+	  output[t * nofChannels + c] = T((input[t * nofChannels + c] - mu) * scale);
+	}
+      }
+
+      return nofTimes;
+    }
+
+    //! Forget the statistics of the stream
+    void reset () {
+      itsNofSamples = 0;
+      itsSum.assign (itsSum.size(), 0);
+      itsSumSquares.assign (itsSumSquares.size(), 0);
+    }
+  };
+
+  // ============================================================================
+  //
+  //  ProcessingChain
+  //
+  // ============================================================================
+
+  /*!
+    \class ProcessingChain
+
+    \ingroup DAL
+    \ingroup data_hl
+
+    \brief A number of processing stages applied one after the other
+
+    The chain takes ownership of the stages added to it. The number of input
+    channels of a stage has to match the number of output channels of the
+    stage before it.
+  */
+  template <class T>
+    class ProcessingChain {
+
+    //! Number of channels of the input
+    unsigned int itsNofChannels;
+    //! The stages, in the order in which they are applied
+    std::vector<ProcessingStage<T> *> itsStages;
+    //! Output buffers of the stages, used alternately
+    std::vector<T> itsBuffer[2];
+
+    //! Unimplemented; the chain owns its stages
+    ProcessingChain (ProcessingChain const &);
+    //! Unimplemented; the chain owns its stages
+    ProcessingChain & operator= (ProcessingChain const &);
+
+  public:
+
+    // === Construction =========================================================
+
+    //! Argumented constructor
+    ProcessingChain (unsigned int nofChannels)
+      : itsNofChannels (nofChannels)
+      {}
+
+    // === Destruction ==========================================================
+
+    //! Destructor; deletes the stages
+    ~ProcessingChain () {
+      for (unsigned int n = 0; n < itsStages.size(); ++n) {
+	delete itsStages[n];
+      }
+    }
+
+    // === Parameter access =====================================================
+
+    //! Get the number of channels of the input
+    inline unsigned int nofChannels () const {
+      return itsNofChannels;
+    }
+
+    //! Get the number of channels of the output
+    inline unsigned int nofOutputChannels () const {
+      return itsStages.empty() ? itsNofChannels : itsStages.back()->nofOutputChannels();
+    }
+
+    //! Get the number of stages
+    inline unsigned int nofStages () const {
+      return itsStages.size();
+    }
+
+    //! Get stage \e n
+    inline ProcessingStage<T> * stage (unsigned int n) const {
+      return itsStages[n];
+    }
+
+    // === Methods ==============================================================
+
+    /*!
+      \param stage -- Stage appended to the chain; it is deleted by the chain,
+             also if it cannot be added.
+
+      \return status -- Returns \e false if the number of channels of the stage
+              does not match the output of the chain.
+    */
+    bool add (ProcessingStage<T> *stage)
+    {
+      if (stage->nofChannels() != nofOutputChannels()) {
+	delete stage;
+	return false;
+      }
+      itsStages.push_back (stage);
+      return true;
+    }
+
+    /*!
+      \param input          -- Input block, <tt>[nofTimes][nofChannels()]</tt>.
+      \param nofTimes       -- Number of time samples in the input block.
+      \param nofOutputTimes -- Number of time samples in the result.
+
+      \return result -- The result, <tt>[nofOutputTimes][nofOutputChannels()]</tt>;
+              valid until the next call to process(). Without any stages this
+              is the input itself.
+    */
+    T const * process (T const *input,
+		       uint64_t nofTimes,
+		       uint64_t &nofOutputTimes)
+    {
+      T const *data = input;
+
+      nofOutputTimes = nofTimes;
+      for (unsigned int n = 0; n < itsStages.size(); ++n) {
+	std::vector<T> &buffer = itsBuffer[n % 2];
+	size_t size = itsStages[n]->nofOutputTimes (nofOutputTimes) * itsStages[n]->nofOutputChannels();
+	if (buffer.size() < size) {
+	  buffer.resize (size);
+	}
+	nofOutputTimes = itsStages[n]->process (data, nofOutputTimes, buffer.empty() ? 0 : &buffer[0]);
+	data = buffer.empty() ? 0 : &buffer[0];
+      }
+
+      return data;
+    }
+
+    //! Reset all stages, to start a new stream
+    void reset ()
+    {
+      for (unsigned int n = 0; n < itsStages.size(); ++n) {
+	itsStages[n]->reset();
+      }
+    }
+  };
+
+} // Namespace DAL -- end
+
+#endif /* PROCESSINGSTAGE_H */
@@ -236,9 +236,7 @@ namespace DAL { // Namespace DAL -- begin
       // If the file already exists, close it ...
       infile.close();
       // ... and open it as HDF5 file
-      location_p = H5Fopen (name.c_str(),
-			    H5F_ACC_RDWR,
-			    H5P_DEFAULT);
+      location_p = HDF5AccessProfile::defaultProfile().openFile (name, H5F_ACC_RDWR);
     } else {
       infile.close();
       location_p = 0;
@@ -251,10 +249,7 @@ namespace DAL { // Namespace DAL -- begin
       /* If failed to open file, check if we are supposed to create one */
       if ( (flags.flags() & IO_Mode::Create) ||
 	   (flags.flags() & IO_Mode::CreateNew) ) {
-	location_p = H5Fcreate (name.c_str(),
-				H5F_ACC_TRUNC,
-				H5P_DEFAULT,
-				H5P_DEFAULT);
+	location_p = HDF5AccessProfile::defaultProfile().createFile (name, H5F_ACC_TRUNC);
 	/* Write LOFAR common attribute to the root group of the file */
 	commonAttributes_p.h5write(location_p);
 	/* Write the additional attributes attached to the root group */
@@ -104,6 +104,9 @@ namespace DAL {
 
     setTimeoutStart (-1.0);
     setTimeoutRead (1.0);
+    setRecvBatchSize ();
+    socketBufferSize_p = 0;
+    creationProperties_p = -1;
 
     seqnrLast_p  = 0;
     bigendian_p  = BigEndian();
@@ -120,7 +123,6 @@ namespace DAL {
     dipoles.clear();
     dims.push_back(0);
     offset_p   = 0;
-    cdims.push_back(CHUNK_SIZE);
     //stationstr = NULL;
     memset(uid,'-',10);
     payload_crc       = 0;
@@ -136,6 +138,7 @@ namespace DAL {
     maxWaitingFrames = 0;
     noFramesDropped = 0;
     inputBuffer_P = new char [(INPUT_BUFFER_SIZE*UDP_PACKET_BUFFER_SIZE)];
+    inputFrameSize_p.assign (INPUT_BUFFER_SIZE, 0);
     udpBuff_p = inputBuffer_P;
 #endif
     /* Initialization of public data */
@@ -200,6 +203,10 @@ namespace DAL {
 #ifdef USE_INPUT_BUFFER
     delete [] inputBuffer_P;
 #endif
+    if (creationProperties_p >= 0)
+      {
+        H5Pclose (creationProperties_p);
+      }
   }
 
   // ============================================================================
@@ -262,6 +269,43 @@ namespace DAL {
                     time_usec);
   }
 
+  //_____________________________________________________________________________
+  //                                                             setRecvBatchSize
+
+  /*!
+    \param nofFrames -- Maximum number of datagrams to fetch from the socket with
+           a single system call; values below 1 are replaced by 1, values above
+           the size of the input buffer are limited to it. Batching is only
+           done on systems providing \t recvmmsg; elsewhere one datagram is read
+           per call.
+  */
+  void TBB::setRecvBatchSize (int const &nofFrames)
+  {
+    if (nofFrames < 1) {
+      recvBatchSize_p = 1;
+    } else if (nofFrames > INPUT_BUFFER_SIZE-1) {
+      recvBatchSize_p = INPUT_BUFFER_SIZE-1;
+    } else {
+      recvBatchSize_p = nofFrames;
+    }
+  }
+
+  //_____________________________________________________________________________
+  //                                                             setStoragePolicy
+
+  /*!
+    \param policy -- Chunk size and compression filters of the dipole arrays;
+           arrays which already exist are not changed.
+  */
+  void TBB::setStoragePolicy (HDF5StoragePolicy const &policy)
+  {
+    storagePolicy_p = policy;
+    if (creationProperties_p >= 0) {
+      H5Pclose (creationProperties_p);
+      creationProperties_p = -1;
+    }
+  }
+
   // ============================================================================
   //
   //  Methods
@@ -297,6 +341,12 @@ namespace DAL {
     << ";"
     << timeoutRead_p.tv_usec
     << "]" << endl;
+    os << "-- Datagrams per receive : " << recvBatchSize_p     << endl;
+    os << "-- Socket buffer size .. : " << socketBufferSize_p  << endl;
+    os << "-- Chunk size [samples]  : " << storagePolicy_p.chunkSize() << endl;
+    os << "-- Compression ......... : "
+       << HDF5StoragePolicy::compressionName(storagePolicy_p.compression())
+       << (storagePolicy_p.shuffle() ? " (shuffled)" : "") << endl;
   }
 
   //_____________________________________________________________________________
@@ -328,6 +378,25 @@ namespace DAL {
         return;
       }
 
+    // Step 2a: Enlarge the receive buffer of the socket, so that the kernel can
+    // hold more datagrams while we are busy
+    if (socketBufferSize_p > 0)
+      {
+        int bufsize = socketBufferSize_p;
+        socklen_t optlen = sizeof(bufsize);
+        if (setsockopt(main_socket, SOL_SOCKET, SO_RCVBUF, &bufsize, optlen) < 0)
+          {
+            perror("setsockopt SO_RCVBUF");
+          }
+        else if (getsockopt(main_socket, SOL_SOCKET, SO_RCVBUF, &bufsize, &optlen) == 0
+                 && bufsize < socketBufferSize_p)
+          {
+            // the value reported by Linux includes the bookkeeping overhead
+            std::cerr << "TBB::connectsocket: socket buffer limited to "
+                      << bufsize << " bytes (net.core.rmem_max)" << std::endl;
+          }
+      }
+
     // Step 3: Create a sockaddr_in to describe the local port
     sockaddr_in local_info;
     local_info.sin_family = AF_INET;
@@ -433,37 +502,127 @@ namespace DAL {
   }
 #endif
   //_____________________________________________________________________________
-  // Read data from a socket into the input buffer
+  // Receive waiting datagrams into the input buffer
 #ifdef USE_INPUT_BUFFER
+  /*!
+    Fetches up to \t maxFrames datagrams, which have to be waiting in the socket
+    already, into the free slots of the input buffer following \t inBufStorID.
+    On systems providing \t recvmmsg this takes a single system call.
+
+    \param maxFrames -- Maximum number of datagrams to receive; has to be smaller
+           than the number of free slots in the input buffer.
+
+    \return nofFrames -- Number of datagrams stored in the input buffer; 0 if
+            no datagram was waiting, -1 in case of an error.
+  */
+  int TBB::receiveFrames (int maxFrames)
+  {
+    int nofFrames = 0;
+    int bufID;
+
+#if defined linux
+    int nofMsgs;
+    std::vector<struct mmsghdr> msgs (maxFrames);
+    std::vector<struct iovec> iovecs (maxFrames);
+
+    memset (&msgs[0], 0, maxFrames*sizeof(struct mmsghdr));
+    bufID = inBufStorID;
+    for (int n=0; n<maxFrames; n++) {
+      if (++bufID >= INPUT_BUFFER_SIZE) {
+        bufID = 0;
+      }
+      iovecs[n].iov_base         = inputBuffer_P + (bufID*UDP_PACKET_BUFFER_SIZE);
+      iovecs[n].iov_len          = UDP_PACKET_BUFFER_SIZE;
+      msgs[n].msg_hdr.msg_iov    = &iovecs[n];
+      msgs[n].msg_hdr.msg_iovlen = 1;
+    }
+
+    nofMsgs = recvmmsg (main_socket, &msgs[0], maxFrames, MSG_DONTWAIT, NULL);
+    if (nofMsgs < 0) {
+      return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+    }
+    /* Empty datagrams would leave a stale frame in their slot, so move the
+       following datagrams down to close the hole. */
+    bufID = inBufStorID;
+    for (int n=0; n<nofMsgs; n++) {
+      if (msgs[n].msg_len == 0) {
+        continue;
+      }
+      if (++bufID >= INPUT_BUFFER_SIZE) {
+        bufID = 0;
+      }
+      if (iovecs[n].iov_base != inputBuffer_P + (bufID*UDP_PACKET_BUFFER_SIZE)) {
+        memcpy (inputBuffer_P + (bufID*UDP_PACKET_BUFFER_SIZE),
+                iovecs[n].iov_base,
+                msgs[n].msg_len);
+      }
+      inputFrameSize_p[bufID] = msgs[n].msg_len;
+      nofFrames++;
+    }
+#else
+    int nofBytes;
+
+    (void)maxFrames;
+    bufID = inBufStorID+1;
+    if (bufID >= INPUT_BUFFER_SIZE) {
+      bufID = 0;
+    }
+    nofBytes = recvfrom (main_socket, (inputBuffer_P + (bufID*UDP_PACKET_BUFFER_SIZE)),
+                         UDP_PACKET_BUFFER_SIZE, MSG_DONTWAIT, (sockaddr *) &incoming_addr, &socklen);
+    if (nofBytes < 0) {
+      return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+    }
+    inputFrameSize_p[bufID] = nofBytes;
+    nofFrames = (nofBytes > 0) ? 1 : 0;
+#endif
+
+    inBufStorID = (inBufStorID + nofFrames) % INPUT_BUFFER_SIZE;
+    return nofFrames;
+  }
+
+  //_____________________________________________________________________________
+  // Read data from a socket into the input buffer
+
+  /*!
+    Drains the datagrams waiting in the socket into the input buffer, batches of
+    up to recvBatchSize() datagrams at a time, and then points \t udpBuff_p to
+    the next frame to process. Only if the input buffer is empty this waits (up
+    to the read time-out) for new data.
+
+    \return status -- \e SUCCESS if a frame is available, \e FAIL if the data
+            stopped coming.
+  */
   int TBB::readSocketBuffer()
   {
     struct timeval readTimeout;
-    FD_ZERO(&readSet);
-    FD_SET(main_socket, &readSet);
-    int newBufID, nFramesWaiting = 0;
+    int nofFree, batch, nofFrames, nFramesWaiting = 0;
+    bool drained = false;
+
+    //fetch batches of frames, until the socket has been emptied
+    while (!drained) {
+      nofFree = (inBufProcessID - inBufStorID - 1 + INPUT_BUFFER_SIZE) % INPUT_BUFFER_SIZE;
+      if (nofFree == 0) {
+        //cerr << "TBB::readSocketBuffer: Buffer overflow! Overwriting last frame." << endl;
+        rr = recvfrom( main_socket, (inputBuffer_P + (inBufStorID*UDP_PACKET_BUFFER_SIZE)),
+                       UDP_PACKET_BUFFER_SIZE, MSG_DONTWAIT, (sockaddr *) &incoming_addr, &socklen);
+        if (rr < 0) {
+          drained = true;
+        } else {
+          inputFrameSize_p[inBufStorID] = rr;
+          noFramesDropped++;
+          nFramesWaiting++;
+        }
+        continue;
+      }
+      batch     = (nofFree < recvBatchSize_p) ? nofFree : recvBatchSize_p;
+      nofFrames = receiveFrames (batch);
+      if (nofFrames > 0) {
+        nFramesWaiting += nofFrames;
+      }
+      // a short batch means the socket has been emptied
+      drained = (nofFrames < batch);
+    }
 
-    //set timeout to zero (don't wait, just poll)
-    readTimeout.tv_sec = readTimeout.tv_usec = 0;
-    while (select(main_socket + 1, &readSet, NULL, NULL, &readTimeout) > 0 )
-      {
-        //there is a frame waiting in the vBuffer
-        newBufID = inBufStorID+1;
-        if (newBufID >= INPUT_BUFFER_SIZE)
-          {
-            newBufID =0;
-          }
-        if (newBufID == inBufProcessID)
-          {
-            //cerr << "TBB::readSocketBuffer: Buffer overflow! Overwriting last frame." << endl;
-            noFramesDropped++;
-            newBufID = inBufStorID;
-          };
-        //perform the actual read
-        rr = recvfrom( main_socket, (inputBuffer_P + (newBufID*UDP_PACKET_BUFFER_SIZE)),
-                       UDP_PACKET_BUFFER_SIZE, 0, (sockaddr *) &incoming_addr, &socklen);
-        nFramesWaiting++;
-        inBufStorID = newBufID;
-      };
     if (nFramesWaiting > maxWaitingFrames) {
       maxWaitingFrames = nFramesWaiting;
     };
@@ -474,15 +633,7 @@ namespace DAL {
       FD_ZERO(&readSet);
       FD_SET(main_socket, &readSet);
       status = select(main_socket + 1, &readSet, NULL, NULL, &readTimeout);
-      if (status) {
-	inBufStorID++;
-	if (inBufStorID >= INPUT_BUFFER_SIZE) {
-	  inBufStorID =0;
-	}
-	rr = recvfrom( main_socket, (inputBuffer_P+(inBufStorID*UDP_PACKET_BUFFER_SIZE)),
-		       UDP_PACKET_BUFFER_SIZE, 0, (sockaddr *) &incoming_addr, &socklen);
-      }
-      else {
+      if (status <= 0 || receiveFrames (recvBatchSize_p) <= 0) {
 	// we waited for "timeoutRead_p" but still no data -> end of data
 	cout << "TBB::readSocketBuffer: Data stopped coming" << endl;
 	cout << "TBB::readSocketBuffer: inBufProcessID: " << inBufProcessID
@@ -505,6 +656,7 @@ namespace DAL {
         inBufProcessID =0;
       };
     udpBuff_p = (inputBuffer_P + (inBufProcessID*UDP_PACKET_BUFFER_SIZE));
+    rr        = inputFrameSize_p[inBufProcessID];
     return SUCCESS;
   };
 #endif
@@ -634,30 +786,11 @@ namespace DAL {
     printf("\n");
   }
   
-  // Generic CRC16 method working on 16-bit unsigned data
-  // adapted from Python script by Gijs Schoonderbeek.
+  // Generic CRC16 method working on 16-bit unsigned data (see DAL::crc16)
   
   uint16_t TBB::CRC16(uint16_t * buffer, uint32_t length)
   {
-    uint16_t CRC = 0;
-    const uint32_t CRC_poly = 0x18005;
-    const uint16_t bits = 16;
-    uint32_t data = 0;
-    const uint32_t CRC_div = (CRC_poly & 0x7fffffff) << 15;
-    
-    data = (buffer[0] & 0x7fffffff) << 16;
-    for (uint32_t i=1; i<length; i++) {
-      data += buffer[i];
-      for (uint16_t j=0; j<bits; j++) {
-	if ((data & 0x80000000) != 0) {
-	  data ^= CRC_div;
-	}
-	data &= 0x7fffffff;
-	data <<= 1;
-      }
-    }
-    CRC = data >> 16;
-    return CRC;
+    return crc16 (buffer, length);
   }
   
   //_____________________________________________________________________________
@@ -805,20 +938,29 @@ namespace DAL {
   {
     std::vector<int> firstdims;
     firstdims.push_back( 0 );
+    std::vector<int> cdims = storagePolicy_p.chunkDimensions();
+
+    /* The filters are the same for all dipoles; only check them once */
+    if ( creationProperties_p < 0 ) {
+      creationProperties_p = storagePolicy_p.datasetCreationProperties();
+    }
+    hid_t dcpl = ( creationProperties_p < 0 ) ? H5P_DEFAULT : creationProperties_p;
 
     if ( 0 == headerPtr->n_freq_bands ) {
       short nodata[0];
       dipoleArray_p = stationGroupPtr->createShortArray( newuid,
 							 firstdims,
 							 nodata,
-							 cdims );
+							 cdims,
+							 dcpl );
     }
     else {
       std::complex<Int16> nodata[0];
       dipoleArray_p = stationGroupPtr->createComplexShortArray( newuid,
 								firstdims,
 								nodata,
-								cdims );
+								cdims,
+								dcpl );
       stationGroupPtr->setAttribute ("OBSERVATION_MODE",
 				     std::vector<std::string>(1,"Sub-band") );
     }
@@ -953,10 +1095,7 @@ namespace DAL {
 
     if ( bigendian_p )
       {
-        for ( short zz=0; zz < headerp_p->n_samples_per_frame; zz++ )
-          {
-            swapbytes( (char *)&(sdata[zz]), 2 );
-          };
+        swapbytes16( sdata, headerp_p->n_samples_per_frame );
       };
 
     //calculate the writeOffset from time of first block and this block
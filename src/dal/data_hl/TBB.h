@@ -25,8 +25,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <errno.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <netdb.h>
@@ -34,6 +36,7 @@
 #include <string>
 
 #include <core/dalDataset.h>
+#include <core/HDF5StoragePolicy.h>
 
 #define ETHEREAL_HEADER_LENGTH = 46;
 #define FIRST_EXTRA_HDR_LENGTH = 40;
@@ -49,6 +52,9 @@
 // number of frames in the input buffer (50000 is ca. 100MB)
 //(the vBuf of the system on the storage nodes can store ca. 3600 frames!)
 #define INPUT_BUFFER_SIZE 50000
+// default number of datagrams fetched from the socket with a single system
+// call (only used on systems providing recvmmsg)
+#define TBB_RECV_BATCH_SIZE 32
 
 namespace DAL {
   
@@ -169,12 +175,22 @@ namespace DAL {
     fd_set readSet;
     struct timeval timeoutStart_p;
     struct timeval timeoutRead_p;
+    //! Maximum number of datagrams received with a single system call
+    int recvBatchSize_p;
+    //! Size of the socket receive buffer (SO_RCVBUF) [Bytes]; 0: system default
+    int socketBufferSize_p;
+    //! Chunking and compression of the dipole arrays
+    HDF5StoragePolicy storagePolicy_p;
+    //! Dataset creation property list made from storagePolicy_p (-1 if not yet created)
+    hid_t creationProperties_p;
 #ifdef USE_INPUT_BUFFER
     //!pointers (array indices) for the last buffer processed and the last buffer written
     int inBufProcessID,inBufStorID;
     //!the Input Buffer
     //    char inputBuffer_P[INPUT_BUFFER_SIZE][UDP_PACKET_BUFFER_SIZE];
     char * inputBuffer_P;
+    //!size of the datagram stored in each slot of the input buffer
+    std::vector<int> inputFrameSize_p;
     //!pointer to the UDP-datagram
     char *udpBuff_p;
     //!maximum number of frames waiting in the vBuf while reading
@@ -198,7 +214,6 @@ namespace DAL {
     //! Definition of array dimensions (shape)
     std::vector<int> dims;
     int offset_p;
-    std::vector<int> cdims;
     //! Name of the HDF5 group storing data for a station
     //char * stationstr;
     //! Unique identifier for an individual dipole
@@ -206,6 +221,8 @@ namespace DAL {
 #ifdef USE_INPUT_BUFFER
     //! Read data from the socket and/or set udpBuff_p to next frame in buffer
     int readSocketBuffer();
+    //! Receive up to \t maxFrames waiting datagrams into the input buffer
+    int receiveFrames (int maxFrames);
 #else
     //! Read data from a socket
     int readsocket( unsigned int nbytes,
@@ -341,6 +358,33 @@ namespace DAL {
       timeoutRead_p.tv_sec  = time_sec;
       timeoutRead_p.tv_usec = time_usec;
     }
+
+    //! Get the maximum number of datagrams received with a single system call
+    inline int recvBatchSize () const {
+      return recvBatchSize_p;
+    }
+    //! Set the maximum number of datagrams received with a single system call
+    void setRecvBatchSize (int const &nofFrames=TBB_RECV_BATCH_SIZE);
+
+    //! Get the requested size of the socket receive buffer, [Bytes]
+    inline int socketBufferSize () const {
+      return socketBufferSize_p;
+    }
+    /*!
+      \brief Set the size of the socket receive buffer (SO_RCVBUF)
+      \param nofBytes -- Size of the buffer, [Bytes]; values <=0 keep the
+             system default. Has to be set before calling connectsocket().
+    */
+    inline void setSocketBufferSize (int const &nofBytes) {
+      socketBufferSize_p = nofBytes;
+    }
+
+    //! Get the chunking and compression of the dipole arrays
+    inline HDF5StoragePolicy storagePolicy () const {
+      return storagePolicy_p;
+    }
+    //! Set the chunking and compression of the dipole arrays created from now on
+    void setStoragePolicy (HDF5StoragePolicy const &policy);
     
       //___________________________________________________________________________
       // Methods
@@ -0,0 +1,286 @@
+/***************************************************************************
+ *   Copyright (C) 2026                                                    *
+ *   agent <agent@local>                                                   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include <data_hl/TBB_BlockIterator.h>
+
+#include <algorithm>
+
+namespace DAL {  // Namespace DAL -- begin
+
+  // ============================================================================
+  //
+  //  Construction
+  //
+  // ============================================================================
+
+  //_____________________________________________________________________________
+  //                                                            TBB_BlockIterator
+
+  /*!
+    \param timeseries -- Time-series from whose selected dipoles the data are
+           read.
+    \param offset     -- [dipole] Offset of each selected dipole w.r.t. the
+           reference antenna [samples], as returned by
+           TBB_Timeseries::sample_offset.
+    \param nofSamples -- Length of the aligned time axis [samples].
+    \param blocksize  -- Number of samples per block.
+    \param nofBuffers -- Number of buffers in the pool; the I/O thread reads
+           up to <tt>nofBuffers-1</tt> blocks ahead of the current one.
+  */
+  TBB_BlockIterator::TBB_BlockIterator (TBB_Timeseries &timeseries,
+					std::vector<int> const &offset,
+					unsigned int const &nofSamples,
+					int const &blocksize,
+					int const &nofBuffers)
+    : timeseries_p (timeseries),
+      blocksize_p (blocksize),
+      offset_p (offset)
+  {
+    init (nofBuffers, nofSamples);
+  }
+
+#ifdef DAL_WITH_CASA
+
+  //_____________________________________________________________________________
+  //                                                            TBB_BlockIterator
+
+  /*!
+    The dipole starting to record last is used as reference antenna, such that
+    all dipoles have data from the first sample of the aligned time axis on;
+    the time axis extends up to the last sample of any of the dipoles.
+
+    \param timeseries -- Time-series from whose selected dipoles the data are
+           read.
+    \param blocksize  -- Number of samples per block.
+    \param nofBuffers -- Number of buffers in the pool; the I/O thread reads
+           up to <tt>nofBuffers-1</tt> blocks ahead of the current one.
+  */
+  TBB_BlockIterator::TBB_BlockIterator (TBB_Timeseries &timeseries,
+					int const &blocksize,
+					int const &nofBuffers)
+    : timeseries_p (timeseries),
+      blocksize_p (blocksize)
+  {
+    uint refAntenna          = timeseries.alignment_reference_antenna();
+    std::vector<uint> length = timeseries.data_length();
+    long long nofSamples (0);
+
+    offset_p = timeseries.sample_offset (refAntenna);
+
+    for (unsigned int n=0; n<length.size() && n<offset_p.size(); ++n) {
+      nofSamples = std::max (nofSamples, (long long)(length[n])+offset_p[n]);
+    }
+
+    init (nofBuffers, nofSamples);
+  }
+
+#endif
+
+  //_____________________________________________________________________________
+  //                                                                         init
+
+  /*!
+    \param nofBuffers -- Number of buffers in the pool.
+    \param nofSamples -- Length of the aligned time axis [samples].
+  */
+  void TBB_BlockIterator::init (int const &nofBuffers,
+				unsigned int const &nofSamples)
+  {
+    nofDipoles_p    = timeseries_p.nofSelectedDatasets();
+    currentBlock_p  = -1;
+    nofRead_p       = 0;
+    nofReleased_p   = 0;
+    stop_p          = false;
+    threadRunning_p = false;
+
+    if (blocksize_p < 1 || offset_p.size() != nofDipoles_p) {
+      std::cerr << "[TBB_BlockIterator] Invalid block size or number of offsets!"
+		<< std::endl;
+      blocksize_p = std::max (blocksize_p, 1);
+      nofBlocks_p = 0;
+    } else {
+      nofBlocks_p = (nofSamples + blocksize_p - 1) / blocksize_p;
+    }
+
+    buffers_p.resize (std::max (nofBuffers, 1));
+    bufferStatus_p.assign (buffers_p.size(), false);
+    for (unsigned int n=0; n<buffers_p.size(); ++n) {
+      buffers_p[n].resize (size_t(nofDipoles_p)*blocksize_p);
+    }
+
+    pthread_mutex_init (&mutex_p, NULL);
+    pthread_cond_init (&blockRead_p, NULL);
+    pthread_cond_init (&bufferReleased_p, NULL);
+
+    /* Without the I/O thread the blocks are read by next() */
+    if (nofBlocks_p > 0) {
+      if (pthread_create (&thread_p, NULL, ioThread, this) == 0) {
+	threadRunning_p = true;
+      } else {
+	std::cerr << "[TBB_BlockIterator] Failed to start I/O thread;"
+		  << " reading without prefetching." << std::endl;
+      }
+    }
+  }
+
+  // ============================================================================
+  //
+  //  Destruction
+  //
+  // ============================================================================
+
+  TBB_BlockIterator::~TBB_BlockIterator ()
+  {
+    if (threadRunning_p) {
+      pthread_mutex_lock (&mutex_p);
+      stop_p = true;
+      pthread_cond_signal (&bufferReleased_p);
+      pthread_mutex_unlock (&mutex_p);
+      pthread_join (thread_p, NULL);
+    }
+
+    pthread_cond_destroy (&bufferReleased_p);
+    pthread_cond_destroy (&blockRead_p);
+    pthread_mutex_destroy (&mutex_p);
+  }
+
+  // ============================================================================
+  //
+  //  Methods
+  //
+  // ============================================================================
+
+  //_____________________________________________________________________________
+  //                                                                      summary
+
+  /*!
+    \param os -- Output stream to which the summary is written.
+  */
+  void TBB_BlockIterator::summary (std::ostream &os)
+  {
+    os << "[TBB_BlockIterator] Summary of internal parameters." << std::endl;
+    os << "-- nof. dipoles ............ : " << nofDipoles_p   << std::endl;
+    os << "-- Block size [samples] .... : " << blocksize_p    << std::endl;
+    os << "-- nof. blocks ............. : " << nofBlocks_p    << std::endl;
+    os << "-- nof. buffers ............ : " << buffers_p.size() << std::endl;
+    os << "-- Current block ........... : " << currentBlock_p << std::endl;
+    os << "-- Prefetching ............. : " << threadRunning_p << std::endl;
+  }
+
+  //_____________________________________________________________________________
+  //                                                                         next
+
+  /*!
+    Releases the buffer holding the current block to the I/O thread and waits
+    until the next block has been read.
+
+    \return status -- Returns \e false once the end of the time axis has been
+            reached, or if reading the data of the block failed; in the
+            latter case block() is still smaller than nofBlocks().
+  */
+  bool TBB_BlockIterator::next ()
+  {
+    int slot;
+    bool status;
+
+    pthread_mutex_lock (&mutex_p);
+
+    if (currentBlock_p >= 0) {
+      nofReleased_p = currentBlock_p+1;
+      pthread_cond_signal (&bufferReleased_p);
+    }
+
+    if (currentBlock_p+1 >= nofBlocks_p) {
+      currentBlock_p = nofBlocks_p;
+      pthread_mutex_unlock (&mutex_p);
+      return false;
+    }
+
+    ++currentBlock_p;
+    slot = currentBlock_p % buffers_p.size();
+
+    if (threadRunning_p) {
+      while (nofRead_p <= currentBlock_p) {
+	pthread_cond_wait (&blockRead_p, &mutex_p);
+      }
+      status = bufferStatus_p[slot];
+      pthread_mutex_unlock (&mutex_p);
+    } else {
+      pthread_mutex_unlock (&mutex_p);
+      std::vector<int> start (nofDipoles_p);
+      for (unsigned int n=0; n<nofDipoles_p; ++n) {
+	start[n] = currentBlock_p*blocksize_p - offset_p[n];
+      }
+      status = timeseries_p.readData (&(buffers_p[slot][0]), start, blocksize_p);
+    }
+
+    return status;
+  }
+
+  //_____________________________________________________________________________
+  //                                                                   readBlocks
+
+  void TBB_BlockIterator::readBlocks ()
+  {
+    int nofBuffers = buffers_p.size();
+    std::vector<int> start (nofDipoles_p);
+
+    pthread_mutex_lock (&mutex_p);
+
+    while (!stop_p && nofRead_p < nofBlocks_p) {
+      /* Wait for the caller to release the oldest buffer */
+      while (!stop_p && nofRead_p-nofReleased_p >= nofBuffers) {
+	pthread_cond_wait (&bufferReleased_p, &mutex_p);
+      }
+      if (stop_p) {
+	break;
+      }
+
+      int block = nofRead_p;
+      int slot  = block % nofBuffers;
+      pthread_mutex_unlock (&mutex_p);
+
+      for (unsigned int n=0; n<nofDipoles_p; ++n) {
+	start[n] = block*blocksize_p - offset_p[n];
+      }
+      bool status = timeseries_p.readData (&(buffers_p[slot][0]), start, blocksize_p);
+
+      pthread_mutex_lock (&mutex_p);
+      bufferStatus_p[slot] = status;
+      ++nofRead_p;
+      pthread_cond_signal (&blockRead_p);
+    }
+
+    pthread_mutex_unlock (&mutex_p);
+  }
+
+  //_____________________________________________________________________________
+  //                                                                     ioThread
+
+  /*!
+    \param iterator -- The TBB_BlockIterator object the thread is reading for.
+  */
+  void * TBB_BlockIterator::ioThread (void *iterator)
+  {
+    static_cast<TBB_BlockIterator*>(iterator)->readBlocks();
+    return NULL;
+  }
+
+} // Namespace DAL -- end
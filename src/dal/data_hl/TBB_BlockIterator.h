@@ -0,0 +1,238 @@
+/***************************************************************************
+ *   Copyright (C) 2026                                                    *
+ *   agent <agent@local>                                                   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef TBB_BLOCKITERATOR_H
+#define TBB_BLOCKITERATOR_H
+
+#include <pthread.h>
+#include <vector>
+
+#include <data_hl/TBB_Timeseries.h>
+
+namespace DAL {  // Namespace DAL -- begin
+
+  /*!
+    \class TBB_BlockIterator
+
+    \ingroup DAL
+    \ingroup data_hl
+
+    \brief Iterate over the aligned time axis of a TBB time-series in blocks
+
+    \author agent
+
+    \date 2026/10/16
+
+    \test tTBB_BlockIterator.cc
+
+    <h3>Prerequisite</h3>
+
+    <ul type="square">
+      <li>DAL::TBB_Timeseries
+    </ul>
+
+    <h3>Synopsis</h3>
+
+    The iterator walks the time axis of the dipoles selected in a
+    TBB_Timeseries in blocks of a fixed number of samples. The time axis is
+    that of the reference antenna: sample \e s of the block corresponds to
+    sample <tt>s-offset[n]</tt> of the dataset of dipole \e n, where the
+    offsets are the ones returned by TBB_Timeseries::sample_offset. Samples
+    for which a dipole has no data are set to zero.
+
+    While the caller works on the current block, a background thread reads the
+    following blocks into a small pool of buffers (two buffers give double
+    buffering, three triple buffering, etc.), so reading from disk overlaps
+    with the processing of the data. A buffer is re-used once the caller has
+    moved on to the next block, i.e. the data of a block are only valid until
+    the next call of next().
+
+    As the HDF5 library is not thread-safe, the TBB_Timeseries object (and any
+    other object accessing HDF5 files) must not be used by the caller as long
+    as the iterator exists.
+
+    <h3>Example(s)</h3>
+
+    \code
+    DAL::TBB_Timeseries ts (filename);
+    DAL::TBB_BlockIterator block (ts, 65536, 3);
+
+    while (block.next()) {
+      for (unsigned int dipole=0; dipole<block.nofDipoles(); ++dipole) {
+        float const *data = block.data (dipole);
+        // process block.blocksize() samples of data
+      }
+    }
+    \endcode
+  */
+  class TBB_BlockIterator {
+
+    //! The time-series the data are read from
+    TBB_Timeseries &timeseries_p;
+    //! Number of selected dipoles
+    unsigned int nofDipoles_p;
+    //! Number of samples per block
+    int blocksize_p;
+    //! Number of blocks covering the aligned time axis
+    int nofBlocks_p;
+    //! Offset of each dipole w.r.t. the reference antenna [samples]
+    std::vector<int> offset_p;
+    //! Pool of buffers, each holding [dipole][sample] data of a block
+    std::vector<std::vector<float> > buffers_p;
+    //! Status of the read operation for the block in each buffer
+    std::vector<bool> bufferStatus_p;
+    //! The current block; -1 before the first call of next()
+    int currentBlock_p;
+    //! Number of blocks read by the I/O thread so far
+    int nofRead_p;
+    //! Number of blocks released by the caller so far
+    int nofReleased_p;
+    //! Stop the I/O thread
+    bool stop_p;
+    //! The I/O thread
+    pthread_t thread_p;
+    //! Is the I/O thread running?
+    bool threadRunning_p;
+    //! Protects the counters
+    pthread_mutex_t mutex_p;
+    //! Signalled when a block was read
+    pthread_cond_t blockRead_p;
+    //! Signalled when a buffer was released
+    pthread_cond_t bufferReleased_p;
+
+  public:
+
+    // === Construction =========================================================
+
+    //! Iterate with explicit offsets and length of the aligned time axis
+    TBB_BlockIterator (TBB_Timeseries &timeseries,
+		       std::vector<int> const &offset,
+		       unsigned int const &nofSamples,
+		       int const &blocksize,
+		       int const &nofBuffers=3);
+
+#ifdef DAL_WITH_CASA
+    //! Iterate over the time axis aligned to the antenna starting last
+    TBB_BlockIterator (TBB_Timeseries &timeseries,
+		       int const &blocksize,
+		       int const &nofBuffers=3);
+#endif
+
+    // === Destruction ==========================================================
+
+    //! Destructor
+    ~TBB_BlockIterator ();
+
+    // === Parameter access =====================================================
+
+    //! Get the number of selected dipoles
+    inline unsigned int nofDipoles () const {
+      return nofDipoles_p;
+    }
+
+    //! Get the number of samples per block
+    inline int blocksize () const {
+      return blocksize_p;
+    }
+
+    //! Get the number of blocks covering the aligned time axis
+    inline int nofBlocks () const {
+      return nofBlocks_p;
+    }
+
+    //! Get the number of buffers in the pool
+    inline int nofBuffers () const {
+      return buffers_p.size();
+    }
+
+    //! Get the number of the current block
+    inline int block () const {
+      return currentBlock_p;
+    }
+
+    //! Get the first sample of the current block on the aligned time axis
+    inline long long blockStart () const {
+      return (long long)(currentBlock_p)*blocksize_p;
+    }
+
+    //! Get the offsets of the dipoles w.r.t. the reference antenna
+    inline std::vector<int> offset () const {
+      return offset_p;
+    }
+
+    /*!
+      \brief Get the name of the class
+
+      \return className -- The name of the class, TBB_BlockIterator.
+    */
+    inline std::string className () const {
+      return "TBB_BlockIterator";
+    }
+
+    //! Provide a summary of the object's internal parameters and status
+    inline void summary () {
+      summary (std::cout);
+    }
+
+    //! Provide a summary of the object's internal parameters and status
+    void summary (std::ostream &os);
+
+    // === Methods ==============================================================
+
+    //! Advance to the next block
+    bool next ();
+
+    /*!
+      \brief Get the data of the current block
+
+      \return data -- [dipole][blocksize] Samples of the selected dipoles;
+              valid until the next call of next().
+    */
+    inline float const * data () const {
+      return &(buffers_p[currentBlock_p % buffers_p.size()][0]);
+    }
+
+    /*!
+      \brief Get the data of one of the dipoles in the current block
+
+      \param dipole -- Index of the dipole within the selection
+
+      \return data -- [blocksize] Samples of the dipole; valid until the next
+              call of next().
+    */
+    inline float const * data (unsigned int const &dipole) const {
+      return data() + size_t(dipole)*blocksize_p;
+    }
+
+  private:
+
+    //! Set up the buffers and start the I/O thread
+    void init (int const &nofBuffers,
+	       unsigned int const &nofSamples);
+    //! Main loop of the I/O thread
+    void readBlocks ();
+    //! Entry point of the I/O thread
+    static void * ioThread (void *iterator);
+
+  }; // Class TBB_BlockIterator -- end
+
+} // Namespace DAL -- end
+
+#endif /* TBB_BLOCKITERATOR_H */
@@ -19,6 +19,13 @@
  ***************************************************************************/
 
 #include <data_hl/TBB_DipoleDataset.h>
+#include <core/HDF5Dataset.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
 using std::cerr;
 using std::cout;
@@ -125,6 +132,8 @@ namespace DAL {  // Namespace DAL -- begin
   {
     herr_t h5error;
 
+    unmapData ();
+
     if (datatype_p>0 && H5Iis_valid(datatype_p)) {
       h5error    = H5Tclose (datatype_p);
       datatype_p = 0;
@@ -135,6 +144,12 @@ namespace DAL {  // Namespace DAL -- begin
       dataspace_p = 0;
     }
 
+    if (memspace_p > 0 && H5Iis_valid(memspace_p)) {
+      h5error        = H5Sclose (memspace_p);
+      memspace_p     = 0;
+      memspaceSize_p = 0;
+    }
+
     if (location_p > 0 && H5Iis_valid(location_p)) {
       h5error    = H5Dclose (location_p);
       location_p = 0;
@@ -171,6 +186,13 @@ namespace DAL {  // Namespace DAL -- begin
     location_p  = other.location_p;
     datatype_p  = other.datatype_p;
     dataspace_p = other.dataspace_p;
+    /* The memory space and the mapping are created on the first read */
+    memspace_p     = -1;
+    memspaceSize_p = 0;
+    mapAddress_p   = NULL;
+    mapLength_p    = 0;
+    mappedData_p   = NULL;
+    mapAttempted_p = false;
 
     open (other.location_p);
   }
@@ -190,49 +212,14 @@ namespace DAL {  // Namespace DAL -- begin
     dataspace_p = -1;
     location_p  = -1;
     itsShape     = std::vector<hsize_t>();
+    memspace_p     = -1;
+    memspaceSize_p = 0;
+    mapAddress_p   = NULL;
+    mapLength_p    = 0;
+    mappedData_p   = NULL;
+    mapAttempted_p = false;
   }
 
-  //_____________________________________________________________________________
-  //                                                                         init
-  
-  /*!
-    \param filename -- HDF5 file within which the dataset in question is
-           contained
-    \param dataset  -- Name of the dataset which this object is to encapsulate.
-  */
-  void TBB_DipoleDataset::init (std::string const &filename,
-                                std::string const &dataset)
-  {
-    hid_t file_id  = 0;
-    herr_t h5error = 0;
-
-    // Initialize internal variables
-    location_p = 0;
-
-    // open the file
-    file_id = H5Fopen (filename.c_str(),
-                       H5F_ACC_RDONLY,
-                       H5P_DEFAULT);
-
-    // if opening of file was successfull, try to open dataset
-    if (file_id > 0) {
-      open (file_id,
-	    dataset);
-    }
-    else {
-      cerr << "[TBB_DipoleDataset::init] Error opening HDF5 file "
-	   << filename
-	   << " !"
-	   << endl;
-    }
-    
-    // release the global file handle and clear the error stack
-    if (file_id > 0) {
-      h5error = H5Fclose (file_id);
-      h5error = H5Eclear1 ();
-    }
-  }
-  
   //_____________________________________________________________________________
   //                                                                setAttributes
 
@@ -275,36 +262,24 @@ namespace DAL {  // Namespace DAL -- begin
   {
     bool status (true);
     bool absolutePath (false);
-    herr_t h5error;
-    std::string filename;
     std::string dataset;
-    hid_t fileID;
     IO_Mode flags = IO_Mode();
     
-    // Get name of file and dataset ________________________
+    // Get name of the dataset _____________________________
     
-    status  = DAL::h5get_filename (filename, location);
-    status *= DAL::h5get_name (dataset, location, absolutePath);
+    status = DAL::h5get_name (dataset, location, absolutePath);
 
     if (status) {
 
       h5get_flags(flags, location);
 
-      if (flags.flags() & IO_Mode::ReadOnly) {
-        fileID = H5Fopen (filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
-      }
-      else {
-        fileID = H5Fopen (filename.c_str(), H5F_ACC_RDWR, H5P_DEFAULT);
-
-        /* If opening the the file failed, this might have been due to wrong
-           access permissions; check if the file can be opened as read-only. */
-        if (fileID<0) { fileID = H5Fopen (filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
-        }
-      }
-        // open the dataset
+      /* Use the file the location belongs to, rather than reopening it by
+	 name, such that its access properties and driver are kept */
+      hid_t fileID = H5Iget_file_id (location);
+      // open the dataset
       status = open (fileID,dataset,flags);
       // release file handler
-      h5error = H5Fclose (fileID);
+      HDF5Object::close (fileID);
     }
     
     return status;
@@ -485,6 +460,20 @@ namespace DAL {  // Namespace DAL -- begin
     return status;
   }
   
+  //_____________________________________________________________________________
+  //                                                                        close
+  
+  /*!
+    Releases the HDF5 handles held for the dataset, as well as the memory
+    mapping of its samples, and resets the internal parameters to the state
+    of a default constructed object.
+  */
+  void TBB_DipoleDataset::close ()
+  {
+    destroy ();
+    init ();
+  }
+  
   //_____________________________________________________________________________
   //                                                                 openEmbedded
   
@@ -720,6 +709,69 @@ namespace DAL {  // Namespace DAL -- begin
   //_____________________________________________________________________________
   //                                                                     readData
 
+  /*!
+    \param start      -- Number of the sample at which to start reading
+    \param nofSamples -- Number of samples to read, starting from the position
+           given by <tt>start</tt>.
+    \retval data       -- [nofSamples] Array with the raw ADC samples
+            representing the electric field strength as function of time.
+
+    \return status -- Status of the operation; returns <tt>false</tt> in case
+            an error was encountered.
+  */
+  bool TBB_DipoleDataset::readData (int const &start,
+				    int const &nofSamples,
+				    short *data)
+  {
+    return readSamples (start, nofSamples, data, H5T_NATIVE_SHORT, sizeof(short));
+  }
+
+  //_____________________________________________________________________________
+  //                                                                     readData
+
+  /*!
+    The conversion of the samples to floating point values is done by the HDF5
+    library while reading, so no intermediate buffer is required.
+
+    \param start      -- Number of the sample at which to start reading
+    \param nofSamples -- Number of samples to read, starting from the position
+           given by <tt>start</tt>.
+    \retval data       -- [nofSamples] Array with the raw ADC samples
+            representing the electric field strength as function of time.
+
+    \return status -- Status of the operation; returns <tt>false</tt> in case
+            an error was encountered.
+  */
+  bool TBB_DipoleDataset::readData (int const &start,
+				    int const &nofSamples,
+				    float *data)
+  {
+    return readSamples (start, nofSamples, data, H5T_NATIVE_FLOAT, sizeof(float));
+  }
+
+  //_____________________________________________________________________________
+  //                                                                     readData
+
+  /*!
+    \param start      -- Number of the sample at which to start reading
+    \param nofSamples -- Number of samples to read, starting from the position
+           given by <tt>start</tt>.
+    \retval data       -- [nofSamples] Array with the raw ADC samples
+            representing the electric field strength as function of time.
+
+    \return status -- Status of the operation; returns <tt>false</tt> in case
+            an error was encountered.
+  */
+  bool TBB_DipoleDataset::readData (int const &start,
+				    int const &nofSamples,
+				    double *data)
+  {
+    return readSamples (start, nofSamples, data, H5T_NATIVE_DOUBLE, sizeof(double));
+  }
+
+  //_____________________________________________________________________________
+  //                                                                  readSamples
+
   /*!
     Basically we need to be able to deal with three different cases:
       a) all of the requested data are outside the valid range
@@ -728,156 +780,282 @@ namespace DAL {  // Namespace DAL -- begin
     If parts of the requested data are outside the valid range of points which 
     can be requested from the file we need to 1) shift the position of the first
     data point requested from the file and then 2) adjust the number of
-    datapoints to be requested from the file.
+    datapoints to be requested from the file. Array elements for which there
+    are no data are set to zero.
+
+    The dataspace of the dataset and the memory space are kept between calls,
+    so reading consecutive blocks of the same length does not create any new
+    HDF5 objects; the dataspace is only queried again if the requested block
+    extends beyond the shape of the dataset known so far.
 
     \param start      -- Number of the sample at which to start reading
     \param nofSamples -- Number of samples to read, starting from the position
            given by <tt>start</tt>.
     \retval data       -- [nofSamples] Array with the raw ADC samples
             representing the electric field strength as function of time.
+    \param memtype    -- HDF5 datatype of the array elements in memory
+    \param typeSize   -- Size of an array element in memory [Bytes]
 
     \return status -- Status of the operation; returns <tt>false</tt> in case
             an error was encountered.
   */
-  bool TBB_DipoleDataset::readData (int const &start,
-				    int const &nofSamples,
-				    short *data)
+  bool TBB_DipoleDataset::readSamples (int const &start,
+				       int const &nofSamples,
+				       void *data,
+				       hid_t const &memtype,
+				       size_t const &typeSize)
   {
-    bool status (true);
+    herr_t h5error;
 
-    //______________________________________________________
-    // Set up the logic for secure access to the underlying data
+    if (location_p <= 0) {
+      cerr << "[TBB_DipoleDataset::readData]"
+	   << " Unable to read with connection to dataset object!"
+	   << endl;
+      return false;
+    }
 
-    int dataStart  = 0;
-    int dataEnd    = start+nofSamples-1;
-    int dataLength = 0;
-    int dataOffset = 0;
-//     short *dataBuffer;
-    
-    if (start<0) {
-      if (dataEnd<0) {
-	return false;
-      } // end -- (dataEnd<0) 
-      else {
-	dataStart = 0;
-	/* Shift the position of the first data point requested from the file */
-	dataOffset = -start;
-	/* Adjust the number of datapoints to be requested from the file */
-	dataLength = nofSamples-dataOffset;
-	/* Initialize the array elements which will not be used for actual data */
-      }
-    } else {
-      dataStart  = start;
-      dataOffset = 0;
-      dataLength = nofSamples;
+    if (nofSamples < 1) {
+      return false;
     }
 
-//     dataBuffer = new short[dataLength];
-//     dataBuffer = &data[dataOffset];
+    // Zero out the data array (note zeros can thus be either real or unread samples)
+    memset (data, 0, nofSamples*typeSize);
 
-    /* Start accessing the data within the HDF5 file */
-    
-    if (location_p > 0) {
-      int rank          = 0;
-      herr_t h5error    = 0;
-      hid_t dataspaceID = H5Dget_space(location_p);
-      
+    /* Refresh the dataspace, if the requested block extends beyond the known
+       shape of the dataset -- the dataset might have been extended since */
+
+    if (dataspace_p <= 0 || itsShape.size() != 1
+	|| hsize_t(start+nofSamples) > itsShape[0]) {
+      hid_t dataspaceID = H5Dget_space (location_p);
       if (dataspaceID < 0) {
 	cerr << "[TBB_DipoleDataset::readData]"
 	     << " Error retrieving filespace of dataset!" << endl;
 	return false;
       }
-      
-      /* Retrieve the rank of the dataspace asssociated with the dataset */
-      
-      rank = H5Sget_simple_extent_ndims(dataspaceID);
-      
-      if (rank < 0) {
+      if (H5Sget_simple_extent_ndims (dataspaceID) != 1) {
 	cerr << "[TBB_DipoleDataset::readData]"
-	     << " Error retrieving rank of dataspace!" << endl;
+	     << " Dataspace of dataset is not 1-dimensional!" << endl;
+	H5Sclose (dataspaceID);
 	return false;
       }
-      
-      /* Retrieve the dimension of the dataspace, i.e. the number of samples */
-      
-      hsize_t shape[1];
-      h5error = H5Sget_simple_extent_dims (dataspaceID,
-					   shape,
-					   NULL);
-      if (h5error < 0) {
-	cerr << "[TBB_DipoleDataset::readData]"
-	     << " Error retrieving dataspace dimension!" << endl;
-	return false;
+      if (dataspace_p > 0 && H5Iis_valid(dataspace_p)) {
+	h5error = H5Sclose (dataspace_p);
       }
-      else {
-	shape[0] = dataLength;
+      dataspace_p = dataspaceID;
+      itsShape.resize(1);
+      h5error = H5Sget_simple_extent_dims (dataspace_p, &itsShape[0], NULL);
+    }
+
+    //______________________________________________________
+    // Set up the logic for secure access to the underlying data
+
+    hsize_t dataStart  = start<0 ? 0 : start;
+    hsize_t dataOffset = start<0 ? -start : 0;
+    hsize_t dataEnd    = std::min<hsize_t> (start+nofSamples, itsShape[0]);
+
+    if (start+nofSamples <= 0 || dataStart >= dataEnd) {
+      return false;
+    }
+
+    hsize_t dataLength = dataEnd-dataStart;
+
+    /* Set up memory space to retrieve the data read from the file */
+
+    if (memspace_p <= 0 || memspaceSize_p != nofSamples) {
+      hsize_t shape[1] = { hsize_t(nofSamples) };
+      /* Change the extent of the existing memory space in place */
+      if (memspace_p > 0 && H5Iis_valid(memspace_p)
+	  && H5Sset_extent_simple (memspace_p, 1, shape, NULL) < 0) {
+	h5error    = H5Sclose (memspace_p);
+	memspace_p = -1;
       }
-      
-      /* Set up memory space to retrieve the data read from the file */
-      
-      hid_t memspaceID = H5Screate_simple (rank,
-					   shape,
-					   shape);
-      hsize_t offset[1];
-      
-      if (dataspaceID < 0) {
+      if (memspace_p <= 0 || !H5Iis_valid(memspace_p)) {
+	memspace_p = H5Screate_simple (1, shape, NULL);
+      }
+      memspaceSize_p = nofSamples;
+      if (memspace_p < 0) {
 	cerr << "[TBB_DipoleDataset::readData]"
 	     << " Error creating memory space for reading in data!"
 	     << endl;
+	memspaceSize_p = 0;
 	return false;
       }
-      else {
-	offset[0] = dataStart;
-      }
-      
-      /* Select the hyperslab through the data volume */
-      h5error = H5Sselect_hyperslab (dataspaceID,
+    }
+
+    /* Select the hyperslab through the data volume and the part of the
+       array to which the data are written */
+
+    h5error = H5Sselect_hyperslab (dataspace_p,
+				   H5S_SELECT_SET,
+				   &dataStart,
+				   NULL,
+				   &dataLength,
+				   NULL);
+    if (h5error >= 0) {
+      h5error = H5Sselect_hyperslab (memspace_p,
 				     H5S_SELECT_SET,
-				     offset,
+				     &dataOffset,
 				     NULL,
-				     shape,
+				     &dataLength,
 				     NULL);
-      
-      if (h5error < 0) {
-	cerr << "[TBB_DipoleDataset::readData]"
-	     << " Error selecting hyperslab through the data!"
-	     << endl;
-	return false;
-      }
-      
-      // Zero out the data array (note zeros can thus be either real or unread samples)
-	    for (int n(0); n<nofSamples; ++n) {
-	      data[n] = 0;
-	    }
-
-      // Retrieve the actual data from the file ...
-      h5error = H5Dread (location_p,
-			 H5T_NATIVE_SHORT,
-			 memspaceID,
-			 dataspaceID,
-			 H5P_DEFAULT,
-			 data);
-      // ... and indicate if there was an error during that procedure
-      if (h5error < 0) {
-	cerr << "[TBB_DipoleDataset::readData]"
-	     << " Error reading data from file into buffer!"
-	     << endl;
-	status = false;
-      }
-      /* release HDF5 handlers */
-      h5error = H5Sclose (dataspaceID);
-      h5error = H5Sclose (memspaceID);
     }
-    else {
+    if (h5error < 0) {
       cerr << "[TBB_DipoleDataset::readData]"
-	   << " Unable to read with connection to dataset object!"
+	   << " Error selecting hyperslab through the data!"
 	   << endl;
-      status = false;
-    } // END  ::  if (location_p > 0)
-    
-    return status;
+      return false;
+    }
+
+    // Retrieve the actual data from the file ...
+    h5error = H5Dread (location_p,
+		       memtype,
+		       memspace_p,
+		       dataspace_p,
+		       H5P_DEFAULT,
+		       data);
+    // ... and indicate if there was an error during that procedure
+    if (h5error < 0) {
+      cerr << "[TBB_DipoleDataset::readData]"
+	   << " Error reading data from file into buffer!"
+	   << endl;
+      return false;
+    }
+
+    return true;
   }
   
+  //_____________________________________________________________________________
+  //                                                                      mapData
+
+  /*!
+    The samples can only be mapped if the dataset is stored contiguously -- and
+    hence without any filters --, if its storage has been allocated, if the
+    samples are stored as \e short in the byte order of the machine and if the
+    file is accessed through the default (sec2) driver.
+
+    \return status -- Returns \e true if the samples are mapped into memory;
+            \e false if the layout of the dataset does not permit this, in
+            which case dataView() reads the data through the HDF5 library.
+  */
+  bool TBB_DipoleDataset::mapData ()
+  {
+    mapAttempted_p = true;
+
+    if (isMapped()) {
+      return true;
+    }
+    if (location_p <= 0 || itsShape.size() != 1 || itsShape[0] == 0) {
+      return false;
+    }
+
+    /* Check the layout and datatype of the dataset */
+
+    hid_t plist         = H5Dget_create_plist (location_p);
+    H5D_layout_t layout = H5Pget_layout (plist);
+    H5Pclose (plist);
+
+    if (layout != H5D_CONTIGUOUS || H5Tequal (datatype_p, H5T_NATIVE_SHORT) <= 0) {
+      return false;
+    }
+
+    haddr_t address = HDF5Dataset::offset (location_p);
+    if (address == HADDR_UNDEF) {
+      return false;
+    }
+
+    /* Check the driver through which the file is accessed */
+
+    hid_t fileID = H5Iget_file_id (location_p);
+    hid_t fapl   = H5Fget_access_plist (fileID);
+    hid_t driver = H5Pget_driver (fapl);
+    H5Pclose (fapl);
+    H5Fclose (fileID);
+
+    std::string filename;
+    if (driver != H5FD_SEC2 || !DAL::h5get_filename (filename, location_p)) {
+      return false;
+    }
+
+    /* Map the pages holding the samples; the offset of the mapping has to be
+       a multiple of the page size. */
+
+    int fd = ::open (filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+      return false;
+    }
+
+    off_t pageStart = address & ~off_t(sysconf(_SC_PAGESIZE)-1);
+    mapLength_p     = address - pageStart + itsShape[0]*sizeof(short);
+    mapAddress_p    = mmap (NULL, mapLength_p, PROT_READ, MAP_SHARED, fd, pageStart);
+    ::close (fd);
+
+    if (mapAddress_p == MAP_FAILED) {
+      cerr << "[TBB_DipoleDataset::mapData] Failed to map " << filename
+	   << " into memory!" << endl;
+      mapAddress_p = NULL;
+      mapLength_p  = 0;
+      return false;
+    }
+
+    mappedData_p = (short const *)((char *)mapAddress_p + (address - pageStart));
+
+    return true;
+  }
+
+  //_____________________________________________________________________________
+  //                                                                    unmapData
+
+  void TBB_DipoleDataset::unmapData ()
+  {
+    if (mapAddress_p != NULL) {
+      munmap (mapAddress_p, mapLength_p);
+    }
+    mapAddress_p   = NULL;
+    mapLength_p    = 0;
+    mappedData_p   = NULL;
+    mapAttempted_p = false;
+  }
+
+  //_____________________________________________________________________________
+  //                                                                     dataView
+
+  /*!
+    On the first call the samples of the dataset are mapped into memory, if
+    the layout of the dataset permits (see mapData()). Pointers into the mapped
+    file remain valid until unmapData() is called or the object is destroyed.
+
+    \param start      -- Number of the sample at which to start reading
+    \param nofSamples -- Number of samples to access, starting from the
+           position given by <tt>start</tt>.
+    \param buffer     -- [nofSamples] Buffer into which the samples are read,
+           if they cannot be accessed directly in the mapped file; ranges
+           extending beyond the dataset are also read into the buffer,
+           with the missing samples set to zero.
+
+    \return data -- Pointer to the first of the requested samples, either in
+            the mapped file or in <tt>buffer</tt>; \e NULL in case of an
+            error.
+  */
+  short const * TBB_DipoleDataset::dataView (int const &start,
+					     int const &nofSamples,
+					     short *buffer)
+  {
+    if (!mapAttempted_p) {
+      mapData ();
+    }
+
+    if (isMapped() && start >= 0 && nofSamples >= 0
+	&& hsize_t(start)+nofSamples <= itsShape[0]) {
+      return mappedData_p+start;
+    }
+
+    if (readData (start, nofSamples, buffer)) {
+      return buffer;
+    } else {
+      return NULL;
+    }
+  }
+
   // ============================================================================
   //
   //  Methods using casacore
@@ -1132,43 +1310,24 @@ namespace DAL {  // Namespace DAL -- begin
   casa::Vector<double> TBB_DipoleDataset::readData (int const &start,
 						    int const &nofSamples)
   {
-    if (location_p > 0) {
-      bool status   = true;
-      short *buffer = new short [nofSamples];
-      
-      //______________________________________________________________
-      // Retrieve the data from the file
-      
-      status = readData (start,
-		   nofSamples,
-		   buffer);
-      
-      //______________________________________________________________
-      // Copy the data from the buffer into the vector returned by
-      // this function
-      
+    if (location_p > 0 && nofSamples > 0) {
+      bool deleteIt;
+      casa::Vector<double> data (nofSamples);
+      double *storage = data.getStorage (deleteIt);
+
+      /* Retrieve the data from the file directly into the vector */
+      bool status = readData (start,
+			      nofSamples,
+			      storage);
+
+      data.putStorage (storage, deleteIt);
+
       if (status) {
-	casa::Vector<double> data (nofSamples);
-	// copy values to returned vector
-	for (int sample(0); sample<nofSamples; sample++) {
-	  data(sample) = double(buffer[sample]);
-	}
-	// release allocated memory
-	delete [] buffer;
-	// return data
 	return data;
       }
-      else {
-	// release allocated memory
-	delete [] buffer;
-	// return data
-	return casa::Vector<double> (1,0);
-      }
-      
-    }
-    else {
-      return casa::Vector<double> (1,0);
     }
+
+    return casa::Vector<double> (1,0);
   }
   
 #endif
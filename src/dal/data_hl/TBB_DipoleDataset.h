@@ -64,6 +64,13 @@ namespace DAL {  // Namespace DAL -- begin
 
     \image html TBB_DipoleDataset.png
 
+    For random access to the samples -- e.g. when beamforming over a large
+    event -- dataView() avoids the overhead of the HDF5 library: if the samples
+    are stored contiguously, unfiltered and in the native byte order, the
+    region of the file holding them is mapped into memory and the returned
+    pointer points directly into the mapping. For chunked or compressed
+    datasets the samples are read into the buffer provided by the caller.
+
     <h3>Example(s)</h3>
 
     <ul>
@@ -75,6 +82,11 @@ namespace DAL {  // Namespace DAL -- begin
     // Summaru of the internal properties
     dataset.summary();
     \endcode
+    <li>Access a block of samples through a read-only view:
+    \code
+    std::vector<short> buffer (blocksize);
+    short const *data = dataset.dataView (start, blocksize, &buffer[0]);
+    \endcode
     <li>Create a new object for a specific dipole dataset embedded within a TBB
     time-series dataset:
     \code
@@ -97,6 +109,18 @@ namespace DAL {  // Namespace DAL -- begin
     hid_t dataspace_p;
     //! Shape of the dataset
     std::vector<hsize_t> itsShape;
+    //! Memory space used by readData(), kept for subsequent reads
+    hid_t memspace_p;
+    //! Number of samples in the memory space
+    int memspaceSize_p;
+    //! Start of the memory-mapped region of the file
+    void *mapAddress_p;
+    //! Length of the memory-mapped region [Bytes]
+    size_t mapLength_p;
+    //! First sample of the dataset within the memory-mapped region
+    short const *mappedData_p;
+    //! Has mapping the samples into memory already been attempted?
+    bool mapAttempted_p;
     
   public:
 
@@ -175,6 +199,12 @@ namespace DAL {  // Namespace DAL -- begin
 	       uint const &rcuID,
 	       std::vector<hsize_t> const &shape,
 	       hid_t const &datatype=H5T_NATIVE_SHORT);
+    //! Close the dataset; it can be opened again by one of the open() methods
+    void close ();
+    //! Is the dataset open?
+    inline bool isOpen () const {
+      return location_p > 0;
+    }
     //! Get the unique channel/dipole identifier
     int dipoleNumber ();
     //! Get the unique channel/dipole identifier
@@ -191,6 +221,27 @@ namespace DAL {  // Namespace DAL -- begin
     bool readData (int const &start,
 		   int const &nofSamples,
 		   short *data);
+    //! Get a number of data values as recorded for this dipole
+    bool readData (int const &start,
+		   int const &nofSamples,
+		   float *data);
+    //! Get a number of data values as recorded for this dipole
+    bool readData (int const &start,
+		   int const &nofSamples,
+		   double *data);
+    
+    //! Map the samples of the dataset into memory, if the layout permits
+    bool mapData ();
+    //! Release the memory-mapped samples
+    void unmapData ();
+    //! Are the samples of the dataset mapped into memory?
+    inline bool isMapped () const {
+      return mappedData_p != NULL;
+    }
+    //! Get read-only access to a number of data values, without copying if possible
+    short const * dataView (int const &start,
+			    int const &nofSamples,
+			    short *buffer);
     
     //! Get a number of data values as recorded for this dipole
     /*     bool readData (int const &start, */
@@ -229,13 +280,16 @@ namespace DAL {  // Namespace DAL -- begin
     void setAttributes ();
     //! Initialize the object's internal parameters
     void init ();
-    //! Initialize the internal dataspace
-    void init (std::string const &filename,
-	       std::string const &dataset);
     //! Unconditional copying
     void copy (TBB_DipoleDataset const &other);
     //! Unconditional deletion
     void destroy(void);
+    //! Read a number of samples, converted to the memory datatype
+    bool readSamples (int const &start,
+		      int const &nofSamples,
+		      void *data,
+		      hid_t const &memtype,
+		      size_t const &typeSize);
     
   };
   
@@ -18,6 +18,7 @@
  *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
  ***************************************************************************/
 
+#include <algorithm>
 #include <data_hl/TBB_StationGroup.h>
 
 using std::cout;
@@ -42,6 +43,7 @@ namespace DAL {  // Namespace DAL -- begin
   {
     location_p             = 0;
     nofTriggeredAntennas_p = 0;
+    maxOpenDatasets_p      = TBB_STATIONGROUP_MAX_OPEN_DATASETS;
     datasets_p.clear();    
     selectedDatasets_p.clear();
   }
@@ -59,6 +61,7 @@ namespace DAL {  // Namespace DAL -- begin
                                       std::string const &group,
                                       IO_Mode const &flags)
   {
+    maxOpenDatasets_p = TBB_STATIONGROUP_MAX_OPEN_DATASETS;
     open (location, group, flags);
   }
 
@@ -70,6 +73,7 @@ namespace DAL {  // Namespace DAL -- begin
               IO_Mode const &flags)
   {
     std::string name = getName (stationID);
+    maxOpenDatasets_p = TBB_STATIONGROUP_MAX_OPEN_DATASETS;
     open (location, name, flags);
   }
   
@@ -81,6 +85,7 @@ namespace DAL {  // Namespace DAL -- begin
   */
   TBB_StationGroup::TBB_StationGroup (hid_t const &groupID)
   {
+    maxOpenDatasets_p = TBB_STATIONGROUP_MAX_OPEN_DATASETS;
     open (groupID);
   }
   
@@ -105,6 +110,8 @@ namespace DAL {  // Namespace DAL -- begin
   {
     herr_t h5error;
     H5I_type_t object_type = H5Iget_type(location_p);
+    // release the dipole datasets opened on access
+    closeDipoleDatasets ();
     // release HDF5 object
     if (object_type == H5I_GROUP && H5Iis_valid(location_p)) {
       h5error = H5Gclose(location_p);
@@ -145,7 +152,8 @@ namespace DAL {  // Namespace DAL -- begin
   */
   void TBB_StationGroup::copy (TBB_StationGroup const &other)
   {
-    location_p  = other.location_p;
+    location_p        = other.location_p;
+    maxOpenDatasets_p = other.maxOpenDatasets_p;
 
     open (other.location_p);
   }
@@ -183,36 +191,24 @@ namespace DAL {  // Namespace DAL -- begin
   {
     bool status (true);
     bool absolutePath (false);
-    herr_t h5error;
-    std::string filename;
     std::string dataset;
-    hid_t fileID;
     IO_Mode flags = IO_Mode();
     
-    // Get name of file and dataset ________________________
+    // Get name of the dataset _____________________________
     
-    status  = DAL::h5get_filename (filename, location);
-    status *= DAL::h5get_name (dataset, location, absolutePath);
+    status = DAL::h5get_name (dataset, location, absolutePath);
 
     if (status) {
 
       h5get_flags(flags, location);
 
-      if (flags.flags() & IO_Mode::ReadOnly) {
-        fileID = H5Fopen (filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
-      }
-      else {
-        fileID = H5Fopen (filename.c_str(), H5F_ACC_RDWR, H5P_DEFAULT);
-
-        /* If opening the the file failed, this might have been due to wrong
-           access permissions; check if the file can be opened as read-only. */
-        if (fileID<0) { fileID = H5Fopen (filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
-        }
-      }
-        // open the dataset
+      /* Use the file the location belongs to, rather than reopening it by
+	 name, such that its access properties and driver are kept */
+      hid_t fileID = H5Iget_file_id (location);
+      // open the dataset
       status = open (fileID,dataset,flags);
       // release file handler
-      h5error = H5Fclose (fileID);
+      HDF5Object::close (fileID);
     }
     
     return status;
@@ -240,6 +236,7 @@ namespace DAL {  // Namespace DAL -- begin
     /* Internal setup */
     setAttributes();
     nofTriggeredAntennas_p = 0;
+    flags_p                = flags;
     
     if (H5Lexists (location, name.c_str(), H5P_DEFAULT)) {
       location_p = H5Gopen (location,
@@ -314,34 +311,35 @@ namespace DAL {  // Namespace DAL -- begin
   //_____________________________________________________________________________
   //                                                                 openEmbedded
   
-  bool TBB_StationGroup::openEmbedded (IO_Mode const &flags)
+  /*!
+    The embedded dipole datasets only are registered here; they are opened on
+    first access by openDipoleDataset(), using the I/O mode flags stored in
+    \e flags_p by open().
+
+    \return status -- Status of the operation; returns <tt>false</tt> in case
+            an error was encountered.
+  */
+  bool TBB_StationGroup::openEmbedded (IO_Mode const & /*flags*/)
   {
     bool status = true;
 
     if (H5Iis_valid(location_p)) {
-      std::set<std::string> groups;
       std::set<std::string> datasets;
       std::set<std::string>::iterator it;
 
-      h5get_names (groups,location_p,H5G_GROUP);
       h5get_names (datasets,location_p,H5G_DATASET);
 
-      // Open station calibration group ____________________
-
-      // Open station trigger group ________________________
-
-      it = groups.find(TBB_StationTrigger::getName());
-
-      stationTrigger_p = TBB_StationTrigger (location_p,
-					     TBB_StationTrigger::getName(),
-					     flags);
+      /* The station trigger group is opened by stationTrigger(), the dipole
+	 datasets by openDipoleDataset(); here only the links are recorded. */
 
-      // Open dipole datasets ______________________________
+      // Register dipole datasets __________________________
 
       if (datasets.size() > 0) {
+	closeDipoleDatasets();
+	selectedDatasets_p.clear();
 	datasets_p.clear();
 	for (it=datasets.begin(); it!=datasets.end(); ++it) {
-	  datasets_p[*it] = TBB_DipoleDataset(location_p,*it,flags);
+	  datasets_p[*it];
 	}
       } else {
 	status = false;
@@ -359,6 +357,103 @@ namespace DAL {  // Namespace DAL -- begin
     return status;
   }
 
+  //_____________________________________________________________________________
+  //                                                            openDipoleDataset
+  
+  /*!
+    \param dataset -- Iterator on the map with the dipole datasets, pointing to
+           the dataset to be opened.
+
+    \return status -- Status of the operation; returns <tt>false</tt> in case
+            the dataset could not be opened.
+  */
+  bool TBB_StationGroup::openDipoleDataset (iterDipoleDataset const &dataset)
+  {
+    std::list<std::string>::iterator it;
+
+    /* If the dataset already is open, mark it as most recently used */
+    if (dataset->second.isOpen()) {
+      it = std::find (openDatasets_p.begin(), openDatasets_p.end(), dataset->first);
+      if (it != openDatasets_p.end() && it != openDatasets_p.begin()) {
+	openDatasets_p.splice (openDatasets_p.begin(), openDatasets_p, it);
+      }
+      return true;
+    }
+
+    if (!H5Iis_valid(location_p)) {
+      return false;
+    }
+
+    /* Close the least recently used datasets to stay within the limit */
+    while (maxOpenDatasets_p > 0 && openDatasets_p.size() >= maxOpenDatasets_p) {
+      datasets_p[openDatasets_p.back()].close();
+      openDatasets_p.pop_back();
+    }
+
+    if (!dataset->second.open (location_p, dataset->first, flags_p)) {
+      dataset->second.close();
+      return false;
+    }
+
+    openDatasets_p.push_front (dataset->first);
+
+    return true;
+  }
+
+  //_____________________________________________________________________________
+  //                                                          closeDipoleDatasets
+  
+  void TBB_StationGroup::closeDipoleDatasets ()
+  {
+    std::list<std::string>::iterator it;
+    iterDipoleDataset dataset;
+
+    for (it=openDatasets_p.begin(); it!=openDatasets_p.end(); ++it) {
+      dataset = datasets_p.find(*it);
+      if (dataset != datasets_p.end()) {
+	dataset->second.close();
+      }
+    }
+
+    openDatasets_p.clear();
+  }
+
+  //_____________________________________________________________________________
+  //                                                           setMaxOpenDatasets
+  
+  /*!
+    \param nofDatasets -- Maximum number of dipole datasets open at the same
+           time; 0 removes the limit. Datasets exceeding a lowered limit are
+	   closed right away, least recently used first.
+  */
+  void TBB_StationGroup::setMaxOpenDatasets (unsigned int const &nofDatasets)
+  {
+    maxOpenDatasets_p = nofDatasets;
+
+    while (maxOpenDatasets_p > 0 && openDatasets_p.size() > maxOpenDatasets_p) {
+      datasets_p[openDatasets_p.back()].close();
+      openDatasets_p.pop_back();
+    }
+  }
+
+  //_____________________________________________________________________________
+  //                                                               stationTrigger
+  
+  /*!
+    \return trigger -- The station trigger group; if the group could not be
+            opened, the returned object is not connected to the file.
+  */
+  TBB_StationTrigger & TBB_StationGroup::stationTrigger ()
+  {
+    if (!stationTrigger_p.hasValidID() && H5Iis_valid(location_p)) {
+      stationTrigger_p.open (location_p,
+			     TBB_StationTrigger::getName(),
+			     flags_p);
+    }
+
+    return stationTrigger_p;
+  }
+
   //_____________________________________________________________________________
   //                                                                      getName
   
@@ -548,6 +643,8 @@ namespace DAL {  // Namespace DAL -- begin
       //
       os << "-- Group name ............. : " << group_name(true)        << endl;
       os << "-- nof. dipole datasets ... : " << nofDipoleDatasets()     << endl;
+      os << "-- Open dipole datasets ... : " << nofOpenDatasets()
+	 << " (max. " << maxOpenDatasets() << ")"                        << endl;
       os << "-- Station position (Value) : " << stationPositionValue    << endl;
       os << "-- Station position (Unit)  : " << stationPositionUnit     << endl;
       os << "-- Station position (Frame) : " << stationPositionFrame    << endl;
@@ -619,6 +716,7 @@ namespace DAL {  // Namespace DAL -- begin
     casa::Vector<casa::MPosition> position (selectedDatasets_p.size());
 
     for (it=selectedDatasets_p.begin(); it!=selectedDatasets_p.end(); ++it) {
+      openDipoleDataset (it->second);
       position(n) = (it->second)->second.antenna_position();
       ++n;
     }
@@ -630,6 +728,10 @@ namespace DAL {  // Namespace DAL -- begin
   //_____________________________________________________________________________
   //                                                                  dipoleNames
   
+  /*!
+    \return names -- The names of the dipole datasets, taken from their links
+            within the group, such that no dataset needs to be opened.
+  */
   std::vector<std::string> TBB_StationGroup::dipoleNames ()
   {
     std::vector<std::string> names (datasets_p.size());
@@ -637,7 +739,7 @@ namespace DAL {  // Namespace DAL -- begin
     unsigned int n (0);
 
     for (it=datasets_p.begin(); it!=datasets_p.end(); ++it) {
-      names[n] = it->second.dipoleName();
+      names[n] = it->first;
       ++n;
     }
 
@@ -653,6 +755,7 @@ namespace DAL {  // Namespace DAL -- begin
     std::map<std::string,iterDipoleDataset>::iterator it;
 
     for (it=selectedDatasets_p.begin(); it!=selectedDatasets_p.end(); ++it) {
+      openDipoleDataset (it->second);
       numbers.push_back((it->second)->second.dipoleNumber());
     }
 
@@ -664,7 +767,9 @@ namespace DAL {  // Namespace DAL -- begin
   
   /*!
     \return dataset_ids -- Vector with a list of the identifiers to the
-            HDF5 dataset objects within this station group.
+            HDF5 dataset objects within this station group. All datasets are
+	    opened; with more datasets than maxOpenDatasets(), the identifiers
+	    of the datasets closed again in the process no longer are valid.
   */
 #ifdef DAL_WITH_CASA
   casa::Vector<hid_t> TBB_StationGroup::datasetIDs ()
@@ -674,6 +779,7 @@ namespace DAL {  // Namespace DAL -- begin
     casa::Vector<hid_t> id (datasets_p.size());
 
     for (it=datasets_p.begin(); it!=datasets_p.end(); ++it) {
+      openDipoleDataset (it);
       id(n) = it->second.locationID();
       ++n;
     }
@@ -688,6 +794,7 @@ namespace DAL {  // Namespace DAL -- begin
     std::vector<hid_t> id (datasets_p.size());
 
     for (it=datasets_p.begin(); it!=datasets_p.end(); ++it) {
+      openDipoleDataset (it);
       id[n] = it->second.locationID();
       ++n;
     }
@@ -751,6 +858,7 @@ namespace DAL {  // Namespace DAL -- begin
     /* Iterate over the selected dipoles */
     for (it=selectedDatasets_p.begin(); it!=selectedDatasets_p.end(); ++it) {
       /* Retrieve dipole data */
+      openDipoleDataset (it->second);
       tmp = (it->second)->second.readData(start(n),nofSamples);
       /* Copy the data to the returned array */
       data.column(n) = tmp;
@@ -823,6 +931,7 @@ namespace DAL {  // Namespace DAL -- begin
     uint n (0);
 
     for (it=datasets_p.begin(); it!=datasets_p.end(); ++it) {
+      openDipoleDataset (it);
       it->second.getAttribute("ANTENNA_POSITION_VALUE",tmp);
       positionValues.row(n) = tmp;
       ++n;
@@ -847,6 +956,7 @@ namespace DAL {  // Namespace DAL -- begin
     uint n (0);
 
     for (it=datasets_p.begin(); it!=datasets_p.end(); ++it) {
+      openDipoleDataset (it);
       it->second.getAttribute("ANTENNA_POSITION_UNIT",tmp);
       antennaPositionUnits.row(n) = tmp;
       ++n;
@@ -867,6 +977,7 @@ namespace DAL {  // Namespace DAL -- begin
     freq.resize (datasets_p.size());
 
     for (it=datasets_p.begin(); it!=datasets_p.end(); ++it) {
+      status *= openDipoleDataset (it);
       status *= it->second.sample_frequency(freq(n));
       ++n;
     }
@@ -959,7 +1070,8 @@ namespace DAL {  // Namespace DAL -- begin
       uint n (0);
       
       for (it=datasets_p.begin(); it!=datasets_p.end(); ++it) {
-	name = it->second.dipoleName();
+	openDipoleDataset (it);
+	name = it->first;
 	// retrieve the attributes for the dipole data-set as record
 	it->second.getAttributes(recordDipole);
 	// ... and add it to the existing record
@@ -23,6 +23,7 @@
 
 // Standard library header files
 #include <iostream>
+#include <list>
 #include <map>
 #include <string>
 
@@ -38,6 +39,10 @@
 
 namespace DAL {   // Namespace DAL -- begin
 
+  //! Default for the maximum number of dipole datasets open at the same time;
+  //! matches the 96 receiver units of a full LOFAR station
+#define TBB_STATIONGROUP_MAX_OPEN_DATASETS 96
+
   /*!
     \class TBB_StationGroup
 
@@ -61,6 +66,16 @@ namespace DAL {   // Namespace DAL -- begin
       <li>DAL::TBB_DipoleDataset
     </ul>
 
+    <h3>Synopsis</h3>
+
+    Opening a station group only opens the HDF5 group itself and collects the
+    names of the dipole datasets linked into it; selecting dipoles works on
+    these names alone. A dipole dataset is opened on first access to its
+    attributes or data, and at most maxOpenDatasets() of them are kept open
+    at the same time -- when the limit is reached, the dataset which has not
+    been accessed for the longest time is closed. The station trigger group
+    likewise is opened by the first call to stationTrigger().
+
     <h3>Example(s)</h3>
 
     <ol>
@@ -112,6 +127,12 @@ namespace DAL {   // Namespace DAL -- begin
     std::map<std::string,TBB_DipoleDataset> datasets_p;
     //! Selected dipoles
     std::map<std::string,iterDipoleDataset> selectedDatasets_p;
+    //! I/O mode flags used when opening the embedded structures
+    IO_Mode flags_p;
+    //! Names of the open dipole datasets, most recently used first
+    std::list<std::string> openDatasets_p;
+    //! Maximum number of dipole datasets open at the same time
+    unsigned int maxOpenDatasets_p;
     
   public:
     
@@ -166,6 +187,22 @@ namespace DAL {   // Namespace DAL -- begin
     inline uint nofTriggeredAntennas () const {
       return nofTriggeredAntennas_p;
     }
+
+    //! Get the station trigger group, opening it if required
+    TBB_StationTrigger & stationTrigger ();
+
+    //! Get the maximum number of dipole datasets open at the same time
+    inline unsigned int maxOpenDatasets () const {
+      return maxOpenDatasets_p;
+    }
+
+    //! Set the maximum number of dipole datasets open at the same time
+    void setMaxOpenDatasets (unsigned int const &nofDatasets);
+
+    //! Get the number of dipole datasets currently open
+    inline unsigned int nofOpenDatasets () const {
+      return openDatasets_p.size();
+    }
     
     /*!
       \brief Get the name of the class
@@ -196,6 +233,12 @@ namespace DAL {   // Namespace DAL -- begin
     bool openDipoleDataset (unsigned int const &rspID,
 			    unsigned int const &rcuID,
 			    bool const &create=true);
+
+    //! Open a dipole dataset on first access
+    bool openDipoleDataset (iterDipoleDataset const &dataset);
+
+    //! Close all dipole datasets currently open
+    void closeDipoleDatasets ();
     
     /*!
       \brief Get the number of dipole datasets within this station group
@@ -240,7 +283,8 @@ namespace DAL {   // Namespace DAL -- begin
     result.clear();
 	  
 	  for (it=selectedDatasets_p.begin(); it!=selectedDatasets_p.end(); ++it) {
-	    if (it->second->second.getAttribute(name,tmp) == false)
+	    if (!openDipoleDataset(it->second) ||
+		it->second->second.getAttribute(name,tmp) == false)
       {
         status = false;
       }
@@ -269,6 +313,7 @@ namespace DAL {   // Namespace DAL -- begin
 	  result.resize(selectedDatasets_p.size());
 	  
 	  for (it=selectedDatasets_p.begin(); it!=selectedDatasets_p.end(); ++it) {
+	    openDipoleDataset(it->second);
 	    it->second->second.getAttribute(name,tmp);
 	    result(n) = tmp;
 	    ++n;
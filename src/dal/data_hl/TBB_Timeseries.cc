@@ -20,6 +20,8 @@
 
 #include "TBB_Timeseries.h"
 
+#include <algorithm>
+
 using std::cout;
 using std::endl;
 
@@ -39,6 +41,9 @@ namespace DAL {  // Namespace DAL -- begin
     data file is provided, no inspection of the data structure is carried out.
   */
   TBB_Timeseries::TBB_Timeseries ()
+    : maxOpenDatasets_p(TBB_STATIONGROUP_MAX_OPEN_DATASETS),
+      attributeCacheValid_p(false),
+      accessProfile_p(HDF5AccessProfile::defaultProfile())
   {
     location_p = -1;
     stationGroups_p.clear();
@@ -52,6 +57,9 @@ namespace DAL {  // Namespace DAL -- begin
            it will be created.
   */
   TBB_Timeseries::TBB_Timeseries (std::string const &filename)
+    : maxOpenDatasets_p(TBB_STATIONGROUP_MAX_OPEN_DATASETS),
+      attributeCacheValid_p(false),
+      accessProfile_p(HDF5AccessProfile::defaultProfile())
   {
     open (0,filename,true);
   }
@@ -62,8 +70,14 @@ namespace DAL {  // Namespace DAL -- begin
   /*!
     \param filename -- Name of the data file;
     \param flags  -- I/O mode flags.
+    \param profile -- File access settings.
   */
-  TBB_Timeseries::TBB_Timeseries (std::string const &filename, IO_Mode const &flags)
+  TBB_Timeseries::TBB_Timeseries (std::string const &filename,
+				  IO_Mode const &flags,
+				  HDF5AccessProfile const &profile)
+    : maxOpenDatasets_p(TBB_STATIONGROUP_MAX_OPEN_DATASETS),
+      attributeCacheValid_p(false),
+      accessProfile_p(profile)
   {
     open (0,filename,flags);
   }
@@ -71,7 +85,16 @@ namespace DAL {  // Namespace DAL -- begin
   //_____________________________________________________________________________
   //                                                               TBB_Timeseries
 
-  TBB_Timeseries::TBB_Timeseries (CommonAttributes const &attributes)
+  /*!
+    \param attributes -- LOFAR common attributes, from which the name of the
+           data file is taken.
+    \param profile    -- File access settings.
+  */
+  TBB_Timeseries::TBB_Timeseries (CommonAttributes const &attributes,
+				  HDF5AccessProfile const &profile)
+    : maxOpenDatasets_p(TBB_STATIONGROUP_MAX_OPEN_DATASETS),
+      attributeCacheValid_p(false),
+      accessProfile_p(profile)
   {
     CommonAttributes attr = attributes;
     // open the new dataset
@@ -138,6 +161,9 @@ namespace DAL {  // Namespace DAL -- begin
   void TBB_Timeseries::copy (TBB_Timeseries const &other)
   {
     location_p           = -1;
+    maxOpenDatasets_p    = other.maxOpenDatasets_p;
+    attributeCacheValid_p = false;
+    accessProfile_p      = other.accessProfile_p;
     std::string filename = other.filename_p;
     open (0,filename,false);
   }
@@ -194,6 +220,8 @@ namespace DAL {  // Namespace DAL -- begin
     os << "-- Location ID .......... : " << locationID()              << endl;
     os << "-- nof. station groups .. : " << stationGroups_p.size()    << endl;
     os << "-- nof. selected datasets : " << selectedDatasets_p.size() << endl;
+    os << "-- max. open datasets ... : " << maxOpenDatasets_p         << endl;
+    os << "-- Cached attributes .... : " << attributeValues_p.size()+attributeStrings_p.size() << endl;
 
     if (location_p > 0) {
 //       CommonAttributes attr = commonAttributes();
@@ -260,11 +288,11 @@ namespace DAL {  // Namespace DAL -- begin
       // and open as HDF5 file
       if ( (flags.flags() & IO_Mode::ReadOnly) ) {
         // Open read-only
-        location_p = H5Fopen (name.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+        location_p = accessProfile_p.openFile (name, H5F_ACC_RDONLY);
       }
       else {
         // Open read-write
-        location_p = H5Fopen (name.c_str(), H5F_ACC_RDWR, H5P_DEFAULT);
+        location_p = accessProfile_p.openFile (name, H5F_ACC_RDWR);
       }
     } else {
       infile.close();
@@ -277,10 +305,7 @@ namespace DAL {  // Namespace DAL -- begin
       /* If failed to open file, check if we are supposed to create one */
       if ( (flags.flags() & IO_Mode::Create) ||
           (flags.flags() & IO_Mode::OpenOrCreate) ) {
-        location_p = H5Fcreate (name.c_str(),
-            H5F_ACC_TRUNC,
-            H5P_DEFAULT,
-            H5P_DEFAULT);
+        location_p = accessProfile_p.createFile (name, H5F_ACC_TRUNC);
         /* Write the common attributes attached to the root group */
         CommonAttributes attr;
         attr.h5write(location_p);
@@ -366,9 +391,16 @@ namespace DAL {  // Namespace DAL -- begin
 
     if (groupnames.size() > 0) {
       std::set<std::string>::iterator it;
+      selectedDatasets_p.clear();
+      selectedStations_p.clear();
+      stationGroups_p.clear();
+      clearAttributeCache();
+      /* Open the station groups in place; this only registers the links to
+	 the dipole datasets, which are opened on first access. */
       for (it=groupnames.begin(); it!=groupnames.end(); ++it) {
-	stationGroups_p[*it] = DAL::TBB_StationGroup (location_p,
-						      *it, flags);
+	TBB_StationGroup &group = stationGroups_p[*it];
+	group.setMaxOpenDatasets (maxOpenDatasets_p);
+	group.open (location_p, *it, flags);
       }
     } else {
       throw IOError("DAL error wile iterating through station groups.");
@@ -582,6 +614,7 @@ namespace DAL {  // Namespace DAL -- begin
     std::map<std::string,iterDipoleDataset>::iterator it;
 
     selectedDatasets_p.clear();
+    selectedStations_p.clear();
 
     for (iterStation=stationGroups_p.begin();
 	 iterStation!=stationGroups_p.end();
@@ -593,12 +626,290 @@ namespace DAL {  // Namespace DAL -- begin
       /* Add the elements from the selection for the station */
       for (it=tmp.begin(); it!=tmp.end(); ++it) {
 	selectedDatasets_p[it->first] = it->second;
+	selectedStations_p[it->first] = iterStation;
       }
     }
 
     return status;
   }
   
+  //_____________________________________________________________________________
+  //                                                            openDipoleDataset
+
+  /*!
+    \param name -- Name of the selected dipole dataset.
+
+    \return status -- Status of the operation; returns <tt>false</tt> if
+            the dipole is not selected or its dataset could not be opened.
+  */
+  bool TBB_Timeseries::openDipoleDataset (std::string const &name)
+  {
+    std::map<std::string,iterDipoleDataset>::iterator dataset;
+    std::map<std::string,iterStationGroup>::iterator station;
+
+    dataset = selectedDatasets_p.find(name);
+    station = selectedStations_p.find(name);
+
+    if (dataset == selectedDatasets_p.end() || station == selectedStations_p.end()) {
+      return false;
+    }
+
+    return station->second->second.openDipoleDataset (dataset->second);
+  }
+
+  //_____________________________________________________________________________
+  //                                                           setMaxOpenDatasets
+
+  /*!
+    \param nofDatasets -- Maximum number of dipole datasets open at the same
+           time, applied to each of the station groups; 0 removes the limit.
+  */
+  void TBB_Timeseries::setMaxOpenDatasets (unsigned int const &nofDatasets)
+  {
+    std::map<std::string,TBB_StationGroup>::iterator it;
+
+    maxOpenDatasets_p = nofDatasets;
+
+    for (it=stationGroups_p.begin(); it!=stationGroups_p.end(); ++it) {
+      it->second.setMaxOpenDatasets (nofDatasets);
+    }
+  }
+
+  // ============================================================================
+  //
+  //  Attribute cache
+  //
+  // ============================================================================
+
+  //! Destination of the attributes of a single dipole read into the cache
+  struct TBB_Timeseries_cacheEntry {
+    //! Name of the dipole
+    std::string dipole;
+    //! Cached numerical attributes, [attribute][dipole]
+    std::map<std::string,std::map<std::string,double> > *values;
+    //! Cached string attributes, [attribute][dipole]
+    std::map<std::string,std::map<std::string,std::string> > *strings;
+  };
+
+  //_____________________________________________________________________________
+  //                                                TBB_Timeseries_cacheAttribute
+
+  /*!
+    Operator function for H5Aiterate_by_name, storing the value of a single
+    attribute of a dipole dataset in the cache; attributes holding more than a
+    single value are skipped.
+
+    \param location -- Identifier of the dipole dataset.
+    \param name     -- Name of the attribute.
+    \param info     -- Attribute information; not used.
+    \param opdata   -- The TBB_Timeseries_cacheEntry to fill.
+
+    \return status -- Always 0, such that the iteration continues.
+  */
+  static herr_t TBB_Timeseries_cacheAttribute (hid_t location,
+					       const char *name,
+					       const H5A_info_t * /*info*/,
+					       void *opdata)
+  {
+    TBB_Timeseries_cacheEntry *entry = static_cast<TBB_Timeseries_cacheEntry*>(opdata);
+    hid_t attribute = H5Aopen (location, name, H5P_DEFAULT);
+
+    if (attribute < 0) {
+      return 0;
+    }
+
+    hid_t datatype  = H5Aget_type (attribute);
+    hid_t dataspace = H5Aget_space (attribute);
+
+    if (H5Sget_simple_extent_npoints (dataspace) == 1) {
+      switch (H5Tget_class (datatype)) {
+      case H5T_INTEGER:
+      case H5T_FLOAT:
+	{
+	  double value;
+	  if (H5Aread (attribute, H5T_NATIVE_DOUBLE, &value) >= 0) {
+	    (*entry->values)[name][entry->dipole] = value;
+	  }
+	}
+	break;
+      case H5T_STRING:
+	{
+	  hid_t memtype = H5Tcopy (H5T_C_S1);
+	  if (H5Tis_variable_str (datatype) > 0) {
+	    char *buffer = NULL;
+	    H5Tset_size (memtype, H5T_VARIABLE);
+	    if (H5Aread (attribute, memtype, &buffer) >= 0 && buffer != NULL) {
+	      (*entry->strings)[name][entry->dipole] = buffer;
+	      H5Dvlen_reclaim (memtype, dataspace, H5P_DEFAULT, &buffer);
+	    }
+	  } else {
+	    size_t size = H5Tget_size (datatype);
+	    std::vector<char> buffer (size+1, '\0');
+	    H5Tset_size (memtype, size);
+	    if (H5Aread (attribute, memtype, &buffer[0]) >= 0) {
+	      (*entry->strings)[name][entry->dipole] = &buffer[0];
+	    }
+	  }
+	  H5Tclose (memtype);
+	}
+	break;
+      default:
+	break;
+      }
+    }
+
+    H5Sclose (dataspace);
+    H5Tclose (datatype);
+    H5Aclose (attribute);
+
+    return 0;
+  }
+
+  //_____________________________________________________________________________
+  //                                                          clearAttributeCache
+
+  void TBB_Timeseries::clearAttributeCache ()
+  {
+    attributeValues_p.clear();
+    attributeStrings_p.clear();
+    attributeCacheValid_p = false;
+  }
+
+  //_____________________________________________________________________________
+  //                                                           fillAttributeCache
+
+  /*!
+    The attributes of all dipoles -- not only the selected ones -- are read,
+    such that the cache remains valid when the selection changes. The dipole
+    datasets are visited by name, without keeping them open.
+
+    \return status -- Status of the operation; returns <tt>false</tt> if the
+            object is not connected to a file.
+  */
+  bool TBB_Timeseries::fillAttributeCache ()
+  {
+    if (attributeCacheValid_p) {
+      return true;
+    }
+
+    if (location_p < 1) {
+      return false;
+    }
+
+    std::map<std::string,TBB_StationGroup>::iterator station;
+    std::vector<std::string> dipoles;
+    TBB_Timeseries_cacheEntry entry;
+
+    entry.values  = &attributeValues_p;
+    entry.strings = &attributeStrings_p;
+
+    for (station=stationGroups_p.begin(); station!=stationGroups_p.end(); ++station) {
+      hid_t groupID = station->second.locationID();
+      if (groupID < 1) {
+	continue;
+      }
+      dipoles = station->second.dipoleNames();
+      for (uint n(0); n<dipoles.size(); ++n) {
+	entry.dipole = dipoles[n];
+	H5Aiterate_by_name (groupID,
+			    dipoles[n].c_str(),
+			    H5_INDEX_NAME,
+			    H5_ITER_NATIVE,
+			    NULL,
+			    TBB_Timeseries_cacheAttribute,
+			    &entry,
+			    H5P_DEFAULT);
+      }
+    }
+
+    attributeCacheValid_p = true;
+
+    return true;
+  }
+
+  //_____________________________________________________________________________
+  //                                                                 cachedValues
+
+  /*!
+    \param cache   -- Cache holding the attribute, [attribute][dipole].
+    \param name    -- Name of the attribute.
+    \retval values -- Values of the attribute, in the order of the selected
+           dipoles; left unchanged if the method fails.
+
+    \return status -- Returns <tt>false</tt> if the attribute is not in the
+            cache for each of the selected dipoles.
+  */
+  template <class T, class V>
+  bool TBB_Timeseries::cachedValues (std::map<std::string,std::map<std::string,V> > const &cache,
+				     std::string const &name,
+				     std::vector<T> &values)
+  {
+    if (!fillAttributeCache()) {
+      return false;
+    }
+
+    typename std::map<std::string,std::map<std::string,V> >::const_iterator column;
+    typename std::map<std::string,V>::const_iterator value;
+    std::map<std::string,iterDipoleDataset>::iterator it;
+    std::vector<T> tmp;
+
+    column = cache.find(name);
+
+    if (column == cache.end()) {
+      return false;
+    }
+
+    tmp.reserve (selectedDatasets_p.size());
+
+    for (it=selectedDatasets_p.begin(); it!=selectedDatasets_p.end(); ++it) {
+      value = column->second.find(it->first);
+      if (value == column->second.end()) {
+	return false;
+      }
+      tmp.push_back (static_cast<T>(value->second));
+    }
+
+    values = tmp;
+
+    return true;
+  }
+
+  //_____________________________________________________________________________
+  //                                                         readCachedAttributes
+
+  bool TBB_Timeseries::readCachedAttributes (std::string const &name,
+					     std::vector<uint> &values)
+  {
+    return cachedValues (attributeValues_p, name, values);
+  }
+
+  //_____________________________________________________________________________
+  //                                                         readCachedAttributes
+
+  bool TBB_Timeseries::readCachedAttributes (std::string const &name,
+					     std::vector<int> &values)
+  {
+    return cachedValues (attributeValues_p, name, values);
+  }
+
+  //_____________________________________________________________________________
+  //                                                         readCachedAttributes
+
+  bool TBB_Timeseries::readCachedAttributes (std::string const &name,
+					     std::vector<double> &values)
+  {
+    return cachedValues (attributeValues_p, name, values);
+  }
+
+  //_____________________________________________________________________________
+  //                                                         readCachedAttributes
+
+  bool TBB_Timeseries::readCachedAttributes (std::string const &name,
+					     std::vector<std::string> &values)
+  {
+    return cachedValues (attributeStrings_p, name, values);
+  }
+  
   // ============================================================================
   //
   //  Access to attributes attached to the station groups
@@ -903,7 +1214,7 @@ namespace DAL {  // Namespace DAL -- begin
 
     for (pos_it=pos.begin(); pos_it!=pos.end(); ++pos_it) {
       ds_it = selectedDatasets_p.find(pos_it->first);
-      if (ds_it != selectedDatasets_p.end())
+      if (ds_it != selectedDatasets_p.end() && openDipoleDataset (ds_it->first))
       {
         if ((ds_it->second)->second.set_antenna_position(pos_it->second) == false)
         {
@@ -916,6 +1227,9 @@ namespace DAL {  // Namespace DAL -- begin
       }
     }
 
+    /* The written values no longer match the cached ones */
+    clearAttributeCache();
+
     return status;
   }
 
@@ -1081,7 +1395,7 @@ namespace DAL {  // Namespace DAL -- begin
 
     for (delay_it=delay.begin(); delay_it!=delay.end(); ++delay_it) {
       ds_it = selectedDatasets_p.find(delay_it->first);
-      if (ds_it != selectedDatasets_p.end())
+      if (ds_it != selectedDatasets_p.end() && openDipoleDataset (ds_it->first))
       {
         if ((ds_it->second)->second.set_cable_delay(delay_it->second) == false)
         {
@@ -1094,6 +1408,9 @@ namespace DAL {  // Namespace DAL -- begin
       }
     }
 
+    /* The written values no longer match the cached ones */
+    clearAttributeCache();
+
     return status;
   }
 
@@ -1139,7 +1456,7 @@ namespace DAL {  // Namespace DAL -- begin
 
     for (delay_it=delay.begin(); delay_it!=delay.end(); ++delay_it) {
       ds_it = selectedDatasets_p.find(delay_it->first);
-      if (ds_it != selectedDatasets_p.end())
+      if (ds_it != selectedDatasets_p.end() && openDipoleDataset (ds_it->first))
       {
         if ((ds_it->second)->second.set_dipole_calibration_delay(delay_it->second) == false)
         {
@@ -1152,6 +1469,9 @@ namespace DAL {  // Namespace DAL -- begin
       }
     }
 
+    /* The written values no longer match the cached ones */
+    clearAttributeCache();
+
     return status;
   }
 
@@ -1184,7 +1504,7 @@ namespace DAL {  // Namespace DAL -- begin
     std::vector<int> offset (nofDipoles);
 
     for (uint n(0); n<nofDipoles; n++) {
-      offset[n] = (valTime[n]-refTime) / clock.getValue("Hz") + valSample[n]-refSample;
+      offset[n] = (int(valTime[n])-refTime) * clock.getValue("Hz") + valSample[n]-refSample;
     }
 
     return offset;
@@ -1263,6 +1583,142 @@ namespace DAL {  // Namespace DAL -- begin
   //
   // ============================================================================
 
+  //_____________________________________________________________________________
+  //                                                                    readBlock
+
+  /*!
+    The data of the selected dipoles are read one dipole after the other
+    directly into the buffer, without any intermediate copies; each dipole
+    dataset keeps its dataspace and memory space handles, such that reading
+    consecutive blocks of the same size does not create any new HDF5 objects.
+    Samples outside the range recorded for a dipole are set to zero; this
+    includes dipoles for which the whole block lies outside that range.
+
+    \retval data      -- [dipole][nofSamples] Buffer for the raw ADC samples of
+           the selected dipoles, in the order of selectedDipoles(); must hold
+           at least nofSelectedDatasets()*nofSamples elements.
+    \param start      -- [dipole] Number of the sample at which to start
+           reading, per dipole.
+    \param nofSamples -- Number of samples to read per dipole.
+
+    \return status -- Status of the operation; returns <tt>false</tt> if the
+            number of start positions does not match the selection or if
+            reading the data of one of the dipoles failed.
+  */
+  template <class T>
+  bool TBB_Timeseries::readBlock (T *data,
+				  std::vector<int> const &start,
+				  int const &nofSamples)
+  {
+    if (start.size() != selectedDatasets_p.size()) {
+      std::cerr << "[TBB_Timeseries::readData]"
+		<< " Wrong length of vector with start positions!"
+		<< std::endl;
+      std::cerr << " -- size(selection) = " << selectedDatasets_p.size() << std::endl;
+      std::cerr << " -- size(start)     = " << start.size()              << std::endl;
+      return false;
+    }
+
+    bool status (true);
+    uint n (0);
+    std::map<std::string,iterDipoleDataset>::iterator it;
+
+    /* Iterate over the selected dipoles */
+    for (it=selectedDatasets_p.begin(); it!=selectedDatasets_p.end(); ++it, ++n) {
+      TBB_DipoleDataset &dataset = (it->second)->second;
+      T *dipoleData              = data+size_t(n)*nofSamples;
+      if (!openDipoleDataset (it->first)) {
+	std::fill (dipoleData, dipoleData+nofSamples, T(0));
+	status = false;
+	continue;
+      }
+      std::vector<hsize_t> shape = dataset.shape();
+      /* A dipole without any data in the requested range is not an error */
+      if (shape.size() == 1 && nofSamples > 0
+	  && (start[n]+nofSamples <= 0 || hsize_t(std::max(start[n],0)) >= shape[0])) {
+	std::fill (dipoleData, dipoleData+nofSamples, T(0));
+      } else if (!dataset.readData (start[n], nofSamples, dipoleData)) {
+	status = false;
+      }
+    }
+
+    return status;
+  }
+
+  //_____________________________________________________________________________
+  //                                                                     readData
+
+  /*!
+    \retval data      -- [dipole][nofSamples] Buffer for the raw ADC samples of
+           the selected dipoles.
+    \param start      -- Number of the sample at which to start reading.
+    \param nofSamples -- Number of samples to read per dipole.
+  */
+  bool TBB_Timeseries::readData (short *data,
+				 int const &start,
+				 int const &nofSamples)
+  {
+    return readBlock (data,
+		      std::vector<int> (selectedDatasets_p.size(),start),
+		      nofSamples);
+  }
+
+  //_____________________________________________________________________________
+  //                                                                     readData
+
+  /*!
+    \retval data      -- [dipole][nofSamples] Buffer for the raw ADC samples of
+           the selected dipoles.
+    \param start      -- [dipole] Number of the sample at which to start
+           reading, per dipole.
+    \param nofSamples -- Number of samples to read per dipole.
+  */
+  bool TBB_Timeseries::readData (short *data,
+				 std::vector<int> const &start,
+				 int const &nofSamples)
+  {
+    return readBlock (data,
+		      start,
+		      nofSamples);
+  }
+
+  //_____________________________________________________________________________
+  //                                                                     readData
+
+  /*!
+    \retval data      -- [dipole][nofSamples] Buffer for the raw ADC samples of
+           the selected dipoles.
+    \param start      -- Number of the sample at which to start reading.
+    \param nofSamples -- Number of samples to read per dipole.
+  */
+  bool TBB_Timeseries::readData (float *data,
+				 int const &start,
+				 int const &nofSamples)
+  {
+    return readBlock (data,
+		      std::vector<int> (selectedDatasets_p.size(),start),
+		      nofSamples);
+  }
+
+  //_____________________________________________________________________________
+  //                                                                     readData
+
+  /*!
+    \retval data      -- [dipole][nofSamples] Buffer for the raw ADC samples of
+           the selected dipoles.
+    \param start      -- [dipole] Number of the sample at which to start
+           reading, per dipole.
+    \param nofSamples -- Number of samples to read per dipole.
+  */
+  bool TBB_Timeseries::readData (float *data,
+				 std::vector<int> const &start,
+				 int const &nofSamples)
+  {
+    return readBlock (data,
+		      start,
+		      nofSamples);
+  }
+
 #ifdef DAL_WITH_CASA
 
   //_____________________________________________________________________________
@@ -1291,6 +1747,9 @@ namespace DAL {  // Namespace DAL -- begin
   //                                                                     readData
   
   /*!
+    As the columns of the matrix are stored contiguously, the data of the
+    dipoles are read directly into the storage of the matrix.
+
     \retval data -- [nofSamples,dipole] Array of raw ADC samples representing
             the electric field strength as function of time.
     \param start      -- Number of the sample at which to start reading; w.r.t.
@@ -1328,20 +1787,15 @@ namespace DAL {  // Namespace DAL -- begin
     
     // Retrieve data from file _____________________________
     
-    bool status (true);
-    uint n (0);
-    casa::Vector<double> tmp (nofSamples);
-    std::map<std::string,iterDipoleDataset>::iterator it;
-    
-    /* Iterate over the selected dipoles */
-    for (it=selectedDatasets_p.begin(); it!=selectedDatasets_p.end(); ++it) {
-      /* Retrieve dipole data */
-      tmp = (it->second)->second.readData(start(n),nofSamples);
-      /* Copy the data to the returned array */
-      data.column(n) = tmp;
-      /* Increment data array column counter */
-      ++n;
-    }
+    bool deleteIt;
+    double *storage = data.getStorage (deleteIt);
+    std::vector<int> startPositions (start.begin(), start.end());
+
+    bool status = readBlock (storage,
+			     startPositions,
+			     nofSamples);
+
+    data.putStorage (storage, deleteIt);
 
     // Feedback ____________________________________________
 
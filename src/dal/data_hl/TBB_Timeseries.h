@@ -159,6 +159,14 @@ namespace DAL {  // Namespace DAL -- begin
       additional values almost certainly will not be used (at least not for a
       long time).
     </ul>
+
+    The attributes holding a single value per dipole -- e.g. TIME,
+    SAMPLE_NUMBER, DATA_LENGTH or SAMPLE_FREQUENCY_VALUE -- are read for all
+    dipoles in a single pass over the file, the first time one of them is
+    requested through getAttributes(); subsequent requests, also after a
+    change of the dipole selection, are served from memory. The cache is
+    cleared by the set_* methods; after writing attributes through other
+    means, call clearAttributeCache().
     
     <h3>Example(s)</h3>
 
@@ -168,6 +176,12 @@ namespace DAL {  // Namespace DAL -- begin
       // Get the values of DATA_LENGTH for all present datasets
       std::vector<uint> dataength = ts.data_length ();
       \endcode
+      <li>Read a block of samples for all selected dipoles into a single
+      buffer, organized as [dipole][sample]:
+      \code
+      std::vector<float> data (ts.nofSelectedDatasets()*blocksize);
+      ts.readData (&data[0], start, blocksize);
+      \endcode
     </ol>
     
   */
@@ -175,6 +189,8 @@ namespace DAL {  // Namespace DAL -- begin
     
     //! Typedef for the iterator on the map holding the TBB_DipoleDataset
     typedef std::map<std::string,TBB_DipoleDataset>::iterator iterDipoleDataset;
+    //! Typedef for the iterator on the map holding the TBB_StationGroup
+    typedef std::map<std::string,TBB_StationGroup>::iterator iterStationGroup;
     
   protected:
     
@@ -186,6 +202,18 @@ namespace DAL {  // Namespace DAL -- begin
     std::map<std::string,TBB_StationGroup> stationGroups_p;
     //! Selected dipoles
     std::map<std::string,iterDipoleDataset> selectedDatasets_p;
+    //! Station groups holding the selected dipoles
+    std::map<std::string,iterStationGroup> selectedStations_p;
+    //! Maximum number of dipole datasets open at the same time per station
+    unsigned int maxOpenDatasets_p;
+    //! Has the cache of the dipole attributes been filled?
+    bool attributeCacheValid_p;
+    //! Cached numerical dipole attributes, [attribute][dipole]
+    std::map<std::string,std::map<std::string,double> > attributeValues_p;
+    //! Cached string dipole attributes, [attribute][dipole]
+    std::map<std::string,std::map<std::string,std::string> > attributeStrings_p;
+    //! File access settings used when opening the file
+    HDF5AccessProfile accessProfile_p;
     
   public:
     
@@ -196,9 +224,12 @@ namespace DAL {  // Namespace DAL -- begin
     //! Open or create file
     TBB_Timeseries (std::string const &filename);
     //! Open file with IO_Mode flags
-    TBB_Timeseries (std::string const &filename, IO_Mode const &flags);
+    TBB_Timeseries (std::string const &filename,
+		    IO_Mode const &flags,
+		    HDF5AccessProfile const &profile=HDF5AccessProfile::defaultProfile());
     //! Create a new dataset from LOFAR common attributes
-    TBB_Timeseries (CommonAttributes const &attributes);
+    TBB_Timeseries (CommonAttributes const &attributes,
+		    HDF5AccessProfile const &profile=HDF5AccessProfile::defaultProfile());
     //! Copy constructor
     TBB_Timeseries (TBB_Timeseries const &other);
     
@@ -226,6 +257,22 @@ namespace DAL {  // Namespace DAL -- begin
     inline std::string filename () const {
       return filename_p;
     }
+
+    //! Get the file access settings used when opening the file
+    inline HDF5AccessProfile accessProfile () const {
+      return accessProfile_p;
+    }
+
+    //! Get the maximum number of dipole datasets open at the same time per station
+    inline unsigned int maxOpenDatasets () const {
+      return maxOpenDatasets_p;
+    }
+
+    //! Set the maximum number of dipole datasets open at the same time per station
+    void setMaxOpenDatasets (unsigned int const &nofDatasets);
+
+    //! Discard the cached values of the dipole attributes
+    void clearAttributeCache ();
     
     /*!
       \brief Get the name of the class
@@ -369,6 +416,11 @@ namespace DAL {  // Namespace DAL -- begin
       std::vector<T> tmp;
       std::map<std::string,TBB_StationGroup>::iterator it;
 
+      // Serve the values from the attribute cache, if possible
+      if (readCachedAttributes (attr, out)) {
+        return true;
+      }
+
       // Resize output vector
       out.resize(nofDipoles);
 
@@ -419,6 +471,23 @@ namespace DAL {  // Namespace DAL -- begin
     //! Get the Nyquist zone for the A/D conversion
     std::vector<uint> nyquist_zone ();
 
+    //! Retrieve a block of ADC values for all selected dipoles
+    bool readData (short *data,
+		   int const &start,
+		   int const &nofSamples);
+    //! Retrieve a block of ADC values for all selected dipoles
+    bool readData (short *data,
+		   std::vector<int> const &start,
+		   int const &nofSamples);
+    //! Retrieve a block of ADC values for all selected dipoles
+    bool readData (float *data,
+		   int const &start,
+		   int const &nofSamples);
+    //! Retrieve a block of ADC values for all selected dipoles
+    bool readData (float *data,
+		   std::vector<int> const &start,
+		   int const &nofSamples);
+
 #ifdef DAL_WITH_CASA
     //! Retrieve a block of ADC values per dipole
     bool readData (casa::Matrix<double> &data,
@@ -450,6 +519,38 @@ namespace DAL {  // Namespace DAL -- begin
     bool openStationGroups (IO_Mode const &flags=IO_Mode(IO_Mode::OpenOrCreate));
     //! Set local map used for book-keeping on selected dipole datasets
     bool setSelectedDatasets ();
+    //! Open a selected dipole dataset on first access
+    bool openDipoleDataset (std::string const &name);
+    //! Read the single-valued attributes of all dipoles into the cache
+    bool fillAttributeCache ();
+    //! Get the cached values of an attribute for the selected dipoles
+    template <class T, class V>
+      bool cachedValues (std::map<std::string,std::map<std::string,V> > const &cache,
+			 std::string const &name,
+			 std::vector<T> &values);
+    //! Attributes of types not held in the cache are read from the datasets
+    template <class T>
+      bool readCachedAttributes (std::string const &name,
+				 std::vector<T> &values) {
+      return false;
+    }
+    //! Get the cached values of an attribute for the selected dipoles
+    bool readCachedAttributes (std::string const &name,
+			       std::vector<uint> &values);
+    //! Get the cached values of an attribute for the selected dipoles
+    bool readCachedAttributes (std::string const &name,
+			       std::vector<int> &values);
+    //! Get the cached values of an attribute for the selected dipoles
+    bool readCachedAttributes (std::string const &name,
+			       std::vector<double> &values);
+    //! Get the cached values of an attribute for the selected dipoles
+    bool readCachedAttributes (std::string const &name,
+			       std::vector<std::string> &values);
+    //! Read a block of samples for all selected dipoles into a single buffer
+    template <class T>
+      bool readBlock (T *data,
+		      std::vector<int> const &start,
+		      int const &nofSamples);
     //! Unconditional copying
     void copy (TBB_Timeseries const &other);
     //! Unconditional deletion
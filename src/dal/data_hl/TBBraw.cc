@@ -40,9 +40,11 @@ namespace DAL {  // Namespace DAL -- begin
   //_____________________________________________________________________________
   //                                                                       TBBraw
   
-  TBBraw::TBBraw (CommonAttributes const &commonAttributes)
+  TBBraw::TBBraw (CommonAttributes const &commonAttributes,
+		  HDF5AccessProfile const &profile)
   {
     init();
+    accessProfile_p     = profile;
     itsFilename         = commonAttributes.filename();
     itsCommonAttributes = commonAttributes;
   }
@@ -56,9 +58,11 @@ namespace DAL {  // Namespace DAL -- begin
 		  string const &observation_id,
 		  string const &observationMode,
 		  string const &telescope,
-      string const &antenna_set)
+      string const &antenna_set,
+		  HDF5AccessProfile const &profile)
   {
     init();
+    accessProfile_p = profile;
     open_file (filename,
 	       observer,
 	       project,
@@ -91,21 +95,24 @@ namespace DAL {  // Namespace DAL -- begin
     fixTimes_p           = 2;
     nofDiscardedHeader_p = 0;
     nofProcessed_p       = 0;
+    writeBufferFrames_p  = TBB_WRITE_BUFFER_FRAMES;
+    nofWrites_p          = 0;
+    storagePolicy_p      = HDF5StoragePolicy();
+    creationProperties_p = -1;
+    accessProfile_p      = HDF5AccessProfile::defaultProfile();
+    oddSecond_p          = false;
+    nofPipelineFailed_p  = 0;
+    workers_p.clear();
+    pthread_mutex_init (&hdf5Mutex_p, NULL);
 
     //initialize the buffers
-    int i;
-    stationBuf = new stationBufElem [MAX_NO_STATIONS];
-    for (i=0; i<MAX_NO_STATIONS; i++)
+    stationBuf.clear();
+    dipoleBuf.clear();
+    for (int i=0; i<256; i++)
       {
-        stationBuf[i].ID =0;
-        stationBuf[i].group = NULL;
-      };
-    dipoleBuf = new dipoleBufElem [MAX_NO_DIPOLES];
-    for (i=0; i<MAX_NO_DIPOLES; i++)
-      {
-        dipoleBuf[i].ID = 0;
-        dipoleBuf[i].array = NULL;
+        stationIndex_p[i] = NULL;
       };
+    dipoleIndex_p.clear();
     
   }
 
@@ -165,7 +172,8 @@ namespace DAL {  // Namespace DAL -- begin
             destroy();
             init();
           };
-        dataset_p = new dalDataset( filename.c_str(), "HDF5" );
+        dataset_p = new dalDataset( filename.c_str(), "HDF5",
+                                    IO_Mode(IO_Mode::Open), accessProfile_p );
 	/* Set the attributes attached to the root group of the file. */
         if (dataset_p != NULL) {
 	  hid_t groupID = dataset_p->getId();
@@ -188,30 +196,37 @@ namespace DAL {  // Namespace DAL -- begin
   
   void TBBraw::destroy()
   {
-    int i;
-    for (i=0; i<MAX_NO_DIPOLES; i++)
-      {
-        if ( dipoleBuf[i].array != NULL )
-          {
-            dipoleBuf[i].array->close();
-            delete dipoleBuf[i].array;
-          };
+    unsigned int i;
+    /* Process the frames still queued in the pipeline and write out whatever
+       is still waiting in the staging buffers */
+    stopPipeline();
+    flush();
+    for (i=0; i<dipoleBuf.size(); i++)
+      {
+        dipoleBuf[i]->array->close();
+        delete dipoleBuf[i]->array;
+        delete dipoleBuf[i];
       };
-    for (i=0; i<MAX_NO_STATIONS; i++)
+    for (i=0; i<stationBuf.size(); i++)
       {
-        if ( stationBuf[i].group != NULL )
-          {
-            stationBuf[i].group->close();
-            delete stationBuf[i].group;
-          };
+        stationBuf[i]->group->close();
+        delete stationBuf[i]->group;
+        delete stationBuf[i];
       };
+    dipoleBuf.clear();
+    stationBuf.clear();
+    dipoleIndex_p.clear();
     if (dataset_p != NULL)
       {
         delete dataset_p;
         dataset_p=NULL;
       };
-    delete [] stationBuf;
-    delete [] dipoleBuf;
+    if (creationProperties_p >= 0)
+      {
+        H5Pclose (creationProperties_p);
+        creationProperties_p = -1;
+      };
+    pthread_mutex_destroy (&hdf5Mutex_p);
   }
   
   // ============================================================================
@@ -242,58 +257,202 @@ namespace DAL {  // Namespace DAL -- begin
     nofProcessed_p++;
     headerp = (TBB_Header*)inbuff;
 
-    if ( bigendian_p != bigEndian )
+    if (!workers_p.empty())
       {
-        swapbytes( (char *)&(headerp->seqnr), 4 );
-        swapbytes( (char *)&(headerp->time), 4 );
-        swapbytes( (char *)&(headerp->sample_nr), 4 );
-        swapbytes( (char *)&(headerp->n_samples_per_frame), 2);
-        swapbytes( (char *)&(headerp->n_freq_bands), 2 );
-        swapbytes( (char *)&(headerp->spare), 2 );
-        swapbytes( (char *)&(headerp->crc), 2 );
+        /* Route the frame to the worker handling its dipole; station, RSP and
+           RCU are single bytes, so they can be used before swapping. */
+        unsigned int dipoleKey = (headerp->stationid << 16) | (headerp->rspid << 8) | headerp->rcuid;
+        pipelineWorker *worker = workers_p[dipoleKey % workers_p.size()];
+        unsigned int nofSlots  = worker->bigEndian.size();
+        
+        pthread_mutex_lock (&(worker->mutex));
+        while (worker->head - worker->tail >= nofSlots)
+          {
+            pthread_cond_wait (&(worker->notFull), &(worker->mutex));
+          };
+        /* A slot holds a frame of maximum size; whether the frame is long
+           enough for the samples it announces is checked by the worker */
+        unsigned int slot = worker->head % nofSlots;
+        int length        = (datalen < TBB_FRAME_SIZE) ? datalen : TBB_FRAME_SIZE;
+        memcpy (&(worker->frames[slot*TBB_FRAME_SIZE]), inbuff, length);
+        worker->bigEndian[slot]   = bigEndian;
+        worker->frameLength[slot] = length;
+        worker->head++;
+        pthread_cond_signal (&(worker->notEmpty));
+        pthread_mutex_unlock (&(worker->mutex));
+        return true;
       };
 
-    if (do_headerCRC_p && !checkHeaderCRC(headerp))
+    if (!decodeHeader(headerp, bigEndian, oddSecond_p, nofDiscardedHeader_p))
       {
-        nofDiscardedHeader_p++;
         return false;
       };
 
-    if (headerp->n_freq_bands != 0)
+    dipoleBufElem *dipole = dipoleIndex_p.find(headerp->stationid,
+                                                headerp->rspid,
+                                                headerp->rcuid);
+    if (dipole == NULL)
       {
-        cerr << "TBBraw::processTBBrawBlock: Can only process raw(=transient) data!" << endl;
+        pthread_mutex_lock (&hdf5Mutex_p);
+        dipole = createNewDipole(headerp);
+        pthread_mutex_unlock (&hdf5Mutex_p);
+      };
+    if (dipole == NULL)
+      {
+        cerr << "TBBraw::processTBBrawBlock: Failed to get Dipole!" << endl;
         return false;
       };
 
-    if (fixTimes_p==2)
+    if (!addDataToDipole( *dipole, inbuff, datalen, bigEndian))
       {
-        fixDateNew(headerp);
+        return false;
       }
-    else if (fixTimes_p==1)
+
+    return true;
+  };
+
+  //_____________________________________________________________________________
+  //                                                                        flush
+  
+  bool TBBraw::flush ()
+  {
+    bool status = true;
+    
+    /* The workers must not touch the staging buffers while we write them */
+    drainPipeline();
+    
+    for (unsigned int i=0; i<dipoleBuf.size(); i++)
       {
-        fixDateOld(headerp);
+        dipoleBufElem &dipole = *dipoleBuf[i];
+        if (!flushDipole(dipole))
+          {
+            status = false;
+          };
+        /* Drop the space reserved in advance by the geometric growth */
+        if ((dipole.datalength > 0) &&
+            (dipole.dimensions[0] > dipole.datalength))
+          {
+            dipole.dimensions[0] = dipole.datalength;
+            pthread_mutex_lock (&hdf5Mutex_p);
+            if (!dipole.array->resize(dipole.dimensions))
+              {
+                status = false;
+              };
+            pthread_mutex_unlock (&hdf5Mutex_p);
+          };
       };
-
-    int index = getDipoleIndex(headerp);
-    if ((index<0) || (index>=MAX_NO_DIPOLES))
+    
+    return status;
+  }
+  
+  //_____________________________________________________________________________
+  //                                                                startPipeline
+  
+  bool TBBraw::startPipeline (int nofWorkers)
+  {
+    if (!workers_p.empty())
       {
-        cerr << "TBBraw::processTBBrawBlock: Failed to get Dipole Index!" << endl;
+        cerr << "TBBraw::startPipeline: Pipeline is already running!" << endl;
         return false;
       };
-
-    if (!addDataToDipole( index, inbuff, datalen, bigEndian))
+    if (nofWorkers < 1)
       {
+        cerr << "TBBraw::startPipeline: Need at least one worker thread!" << endl;
         return false;
-      }
-
+      };
+    
+    for (int i=0; i<nofWorkers; i++)
+      {
+        pipelineWorker *worker = new pipelineWorker;
+        worker->owner = this;
+        worker->frames.resize(TBB_PIPELINE_QUEUE_FRAMES*TBB_FRAME_SIZE);
+        worker->bigEndian.assign(TBB_PIPELINE_QUEUE_FRAMES, 0);
+        worker->frameLength.assign(TBB_PIPELINE_QUEUE_FRAMES, 0);
+        worker->head = worker->tail = 0;
+        worker->stop = false;
+        worker->oddSecond = false;
+        worker->nofDiscardedHeader = 0;
+        worker->nofFailed = 0;
+        pthread_mutex_init (&(worker->mutex), NULL);
+        pthread_cond_init (&(worker->notEmpty), NULL);
+        pthread_cond_init (&(worker->notFull), NULL);
+        if (pthread_create(&(worker->thread), NULL, pipelineThread, worker) != 0)
+          {
+            cerr << "TBBraw::startPipeline: Failed to start worker thread " << i << endl;
+            pthread_cond_destroy (&(worker->notFull));
+            pthread_cond_destroy (&(worker->notEmpty));
+            pthread_mutex_destroy (&(worker->mutex));
+            delete worker;
+            stopPipeline();
+            return false;
+          };
+        workers_p.push_back(worker);
+      };
+    
     return true;
-  };
-
+  }
+  
+  //_____________________________________________________________________________
+  //                                                                 stopPipeline
+  
+  bool TBBraw::stopPipeline ()
+  {
+    unsigned int i;
+    int nofFailed = 0;
+    
+    for (i=0; i<workers_p.size(); i++)
+      {
+        pthread_mutex_lock (&(workers_p[i]->mutex));
+        workers_p[i]->stop = true;
+        pthread_cond_signal (&(workers_p[i]->notEmpty));
+        pthread_mutex_unlock (&(workers_p[i]->mutex));
+      };
+    for (i=0; i<workers_p.size(); i++)
+      {
+        pthread_join (workers_p[i]->thread, NULL);
+        nofDiscardedHeader_p += workers_p[i]->nofDiscardedHeader;
+        nofFailed            += workers_p[i]->nofFailed;
+        pthread_cond_destroy (&(workers_p[i]->notFull));
+        pthread_cond_destroy (&(workers_p[i]->notEmpty));
+        pthread_mutex_destroy (&(workers_p[i]->mutex));
+        delete workers_p[i];
+      };
+    workers_p.clear();
+    nofPipelineFailed_p += nofFailed;
+    
+    return (nofFailed == 0);
+  }
+  
+  //_____________________________________________________________________________
+  //                                                             setStoragePolicy
+  
+  void TBBraw::setStoragePolicy (HDF5StoragePolicy const &policy)
+  {
+    pthread_mutex_lock (&hdf5Mutex_p);
+    storagePolicy_p = policy;
+    if (creationProperties_p >= 0)
+      {
+        H5Pclose (creationProperties_p);
+        creationProperties_p = -1;
+      };
+    pthread_mutex_unlock (&hdf5Mutex_p);
+  }
+  
   //_____________________________________________________________________________
   //                                                                      summary
   
   void TBBraw::summary (std::ostream &os)
   {
+    int nofDiscarded = nofDiscardedHeader_p;
+    int nofFailed    = nofPipelineFailed_p;
+    for (unsigned int i=0; i<workers_p.size(); i++)
+      {
+        pthread_mutex_lock (&(workers_p[i]->mutex));
+        nofDiscarded += workers_p[i]->nofDiscardedHeader;
+        nofFailed    += workers_p[i]->nofFailed;
+        pthread_mutex_unlock (&(workers_p[i]->mutex));
+      };
+    
     os << "[TBB_Timeseries] Summary of internal parameters"              << endl;
     // Basic properties and parameters
     os << "-- Is the system big-endian ..... : " << bigendian_p          << endl;
@@ -302,9 +461,20 @@ namespace DAL {  // Namespace DAL -- begin
     os << "-- Fix broken time-stamps ....... : " << fixTimes_p           << endl;
     // Processing statistics
     os << "-- nof. processed data blocks ... : " << nofProcessed_p       << endl;
-    os << "-- nof. blocks with broken header : " << nofDiscardedHeader_p << endl;
+    os << "-- nof. blocks with broken header : " << nofDiscarded         << endl;
     os << "-- nof. blocks written to file .. : "
-       << (nofProcessed_p-nofDiscardedHeader_p) << endl;
+       << (nofProcessed_p-nofDiscarded) << endl;
+    os << "-- Write buffer size [frames] ... : " << writeBufferFrames_p  << endl;
+    os << "-- Chunk size [samples] ......... : " << storagePolicy_p.chunkSize() << endl;
+    os << "-- Compression .................. : "
+       << HDF5StoragePolicy::compressionName(storagePolicy_p.compression())
+       << (storagePolicy_p.shuffle() ? " (shuffled)" : "")              << endl;
+    os << "-- Chunk cache [Bytes] .......... : " << accessProfile_p.chunkCacheBytes() << endl;
+    os << "-- File driver .................. : "
+       << HDF5AccessProfile::driverName(accessProfile_p.driver())       << endl;
+    os << "-- nof. array write operations .. : " << nofWrites_p          << endl;
+    os << "-- nof. pipeline worker threads . : " << workers_p.size()     << endl;
+    os << "-- nof. blocks failed in pipeline : " << nofFailed            << endl;
   }
 
   // ============================================================================
@@ -313,6 +483,143 @@ namespace DAL {  // Namespace DAL -- begin
   //
   // ============================================================================
 
+  //_____________________________________________________________________________
+  //                                                                 decodeHeader
+  
+  bool TBBraw::decodeHeader (TBB_Header *headerp,
+			     bool bigEndian,
+			     bool &oddSecond,
+			     int &nofDiscarded)
+  {
+    if ( bigendian_p != bigEndian )
+      {
+        swapbytes( (char *)&(headerp->seqnr), 4 );
+        swapbytes( (char *)&(headerp->time), 4 );
+        swapbytes( (char *)&(headerp->sample_nr), 4 );
+        swapbytes( (char *)&(headerp->n_samples_per_frame), 2);
+        swapbytes( (char *)&(headerp->n_freq_bands), 2 );
+        swapbytes( (char *)&(headerp->spare), 2 );
+        swapbytes( (char *)&(headerp->crc), 2 );
+      };
+
+    if (do_headerCRC_p && !checkHeaderCRC(headerp))
+      {
+        nofDiscarded++;
+        return false;
+      };
+
+    if (headerp->n_freq_bands != 0)
+      {
+        cerr << "TBBraw::processTBBrawBlock: Can only process raw(=transient) data!" << endl;
+        return false;
+      };
+
+    if (fixTimes_p==2)
+      {
+        fixDateNew(headerp);
+      }
+    else if (fixTimes_p==1)
+      {
+        fixDateOld(headerp, oddSecond);
+      };
+    
+    return true;
+  }
+  
+  //_____________________________________________________________________________
+  //                                                               pipelineThread
+  
+  void * TBBraw::pipelineThread (void *worker)
+  {
+    pipelineWorker *w = static_cast<pipelineWorker*>(worker);
+    w->owner->runPipelineWorker(w);
+    return NULL;
+  }
+  
+  //_____________________________________________________________________________
+  //                                                            runPipelineWorker
+  
+  void TBBraw::runPipelineWorker (pipelineWorker *worker)
+  {
+    unsigned int nofSlots = worker->bigEndian.size();
+    int nofDiscarded, nofFailed;
+    dipoleBufElem *dipole;
+    
+    pthread_mutex_lock (&(worker->mutex));
+    while (true)
+      {
+        while ((worker->head == worker->tail) && !worker->stop)
+          {
+            pthread_cond_wait (&(worker->notEmpty), &(worker->mutex));
+          };
+        if (worker->head == worker->tail)
+          {
+            break;
+          };
+        unsigned int slot = worker->tail % nofSlots;
+        pthread_mutex_unlock (&(worker->mutex));
+        
+        /* The slot is ours until tail is advanced */
+        char *frame         = &(worker->frames[slot*TBB_FRAME_SIZE]);
+        bool bigEndian      = worker->bigEndian[slot];
+        int length          = worker->frameLength[slot];
+        TBB_Header *headerp = (TBB_Header*)frame;
+        nofDiscarded = nofFailed = 0;
+        if (decodeHeader(headerp, bigEndian, worker->oddSecond, nofDiscarded))
+          {
+            /* Look the dipole up in our own index first, so the shared one
+               only has to be locked for dipoles new to this worker */
+            dipole = worker->dipoleIndex.find(headerp->stationid, headerp->rspid, headerp->rcuid);
+            if (dipole == NULL)
+              {
+                pthread_mutex_lock (&hdf5Mutex_p);
+                dipole = getDipole(headerp);
+                pthread_mutex_unlock (&hdf5Mutex_p);
+                if (dipole != NULL)
+                  {
+                    worker->dipoleIndex.insert(headerp->stationid, headerp->rspid, headerp->rcuid, dipole);
+                  };
+              };
+            if (dipole == NULL)
+              {
+                cerr << "TBBraw::runPipelineWorker: Failed to get Dipole!" << endl;
+                nofFailed++;
+              }
+            else if (!addDataToDipole(*dipole, frame, length, bigEndian))
+              {
+                nofFailed++;
+              };
+          }
+        else if (nofDiscarded == 0)
+          {
+            nofFailed++;
+          };
+        
+        pthread_mutex_lock (&(worker->mutex));
+        worker->nofDiscardedHeader += nofDiscarded;
+        worker->nofFailed          += nofFailed;
+        worker->tail++;
+        pthread_cond_broadcast (&(worker->notFull));
+      };
+    pthread_mutex_unlock (&(worker->mutex));
+  }
+  
+  //_____________________________________________________________________________
+  //                                                                drainPipeline
+  
+  void TBBraw::drainPipeline ()
+  {
+    for (unsigned int i=0; i<workers_p.size(); i++)
+      {
+        pthread_mutex_lock (&(workers_p[i]->mutex));
+        while (workers_p[i]->head != workers_p[i]->tail)
+          {
+            pthread_cond_wait (&(workers_p[i]->notFull), &(workers_p[i]->mutex));
+          };
+        pthread_mutex_unlock (&(workers_p[i]->mutex));
+      };
+  }
+  
   //_____________________________________________________________________________
   //                                                               checkHeaderCRC
   
@@ -335,9 +642,9 @@ namespace DAL {  // Namespace DAL -- begin
   //_____________________________________________________________________________
   //                                                                   fixDateOld
   
-  void TBBraw::fixDateOld(TBB_Header *headerp)
+  void TBBraw::fixDateOld(TBB_Header *headerp,
+			  bool &oddSecond)
   {
-    static bool oddSecond = false;
     if (headerp->sample_freq == 200)
       {
         if ((headerp->time%2)!=0)
@@ -397,26 +704,15 @@ namespace DAL {  // Namespace DAL -- begin
   };
 
   //_____________________________________________________________________________
-  //                                                               getDipoleIndex
+  //                                                                    getDipole
   
-  int TBBraw::getDipoleIndex(TBB_Header *headerp)
+  TBBraw::dipoleBufElem * TBBraw::getDipole(TBB_Header *headerp)
   {
-    int i, dipoleIndex=-1;
-    unsigned int dipoleID;
-
-    dipoleID = headerp->stationid*1000000 + headerp->rspid*1000 + headerp->rcuid;
-    
-    for (i=0; i<MAX_NO_DIPOLES; i++) {
-      if ( dipoleBuf[i].ID == dipoleID) {
-	dipoleIndex=i;
-	break;
-      };
-      if (dipoleBuf[i].array == NULL) {
-	break;
-      };
-    }
-    if (dipoleIndex != -1) {
-      return dipoleIndex;
+    dipoleBufElem *dipole = dipoleIndex_p.find(headerp->stationid,
+                                                headerp->rspid,
+                                                headerp->rcuid);
+    if (dipole != NULL) {
+      return dipole;
     }
     else {
       return createNewDipole(headerp);
@@ -426,67 +722,52 @@ namespace DAL {  // Namespace DAL -- begin
   //_____________________________________________________________________________
   //                                                              createNewDipole
   
-  int TBBraw::createNewDipole(TBB_Header *headerp)
+  TBBraw::dipoleBufElem * TBBraw::createNewDipole(TBB_Header *headerp)
   {
-    int i            = 0;
-    int stationIndex = -1;
-    int numDipole  = -1;
-    unsigned int stationID, dipoleID;
-    
-    // find the corresponding staion index
-    stationID = headerp->stationid;
-    for (i=0; i<MAX_NO_STATIONS; i++)
-      {
-        if ( stationBuf[i].ID == stationID)
-          {
-            stationIndex=i;
-            break;
-          };
-        if (stationBuf[i].group == NULL)
-          {
-            break;
-          };
-      }
-    if (stationIndex == -1)
-      {
-        stationIndex = createNewStation(headerp);
-      };
-    if (stationIndex == -1)
-      {
-        cerr << "TBBraw::createNewDipole: createNewStation() returned -1!" << endl;
-        return -1;
-      };
-    // find an empty dipole index
-    for (numDipole=0; numDipole<MAX_NO_DIPOLES; numDipole++)
+    // find the corresponding station
+    stationBufElem *station = stationIndex_p[headerp->stationid];
+    if (station == NULL)
       {
-        if (dipoleBuf[numDipole].array == NULL)
-          {
-            break;
-          };
+        station = createNewStation(headerp);
       };
-    if (numDipole == MAX_NO_DIPOLES)
+    if (station == NULL)
       {
-        cerr << "TBBraw::createNewDipole: Buffer \"dipoleBuf\" is full, cannot create new dipole!" <<endl;
-        return -1;
+        cerr << "TBBraw::createNewDipole: createNewStation() returned NULL!" << endl;
+        return NULL;
       };
     
-    // Now we have the station and dipole index -> create the dipole
+    // Now we have the station -> create the dipole
     
     std::vector<int> firstdims(1,0);
-    std::vector<int> cdims(1,CHUNK_SIZE);
     short nodata[0];
     
+    // the filters are the same for all dipoles; only check them once
+    if (creationProperties_p < 0)
+      {
+        creationProperties_p = storagePolicy_p.datasetCreationProperties();
+      };
+    
     char newDipoleIDstr[10];
     sprintf(newDipoleIDstr, "%03d%03d%03d", headerp->stationid, headerp->rspid, headerp->rcuid);
-    dipoleBuf[numDipole].array =  //see next line
-      stationBuf[stationIndex].group->createShortArray( newDipoleIDstr, firstdims, nodata, cdims );
+    dalArray *array = station->group->createShortArray( newDipoleIDstr, firstdims, nodata,
+                                                        storagePolicy_p.chunkDimensions(),
+                                                        (creationProperties_p < 0) ? H5P_DEFAULT : creationProperties_p );
+    if (array == NULL)
+      {
+        cerr << "TBBraw::createNewDipole: Failed to create array " << newDipoleIDstr << endl;
+        return NULL;
+      };
 
-    dipoleID = headerp->stationid*1000000 + headerp->rspid*1000 + headerp->rcuid;
-    dipoleBuf[numDipole].ID = dipoleID;
-    dipoleBuf[numDipole].dimensions.resize(1);
-    dipoleBuf[numDipole].dimensions[0] = 1;
-    dipoleBuf[numDipole].starttime = headerp->time;
-    dipoleBuf[numDipole].startsamplenum = headerp->sample_nr;
+    dipoleBufElem *dipole = new dipoleBufElem;
+    dipole->array = array;
+    dipole->ID = headerp->stationid*1000000 + headerp->rspid*1000 + headerp->rcuid;
+    dipole->dimensions.resize(1);
+    dipole->dimensions[0] = 1;
+    dipole->starttime = headerp->time;
+    dipole->startsamplenum = headerp->sample_nr;
+    dipole->datalength = 0;
+    dipole->bufferOffset = 0;
+    dipole->bufferLength = 0;
 
     unsigned int sid                 = headerp->stationid;
     unsigned int rsp                 = headerp->rspid;
@@ -497,74 +778,68 @@ namespace DAL {  // Namespace DAL -- begin
     std::vector<double> antenna_position_value (3, 0.0);
     std::vector<string> antenna_position_unit  (3, "m");
 
-    dipoleBuf[numDipole].array->setAttribute ("STATION_ID", &sid );
-    dipoleBuf[numDipole].array->setAttribute ("RSP_ID",     &rsp );
-    dipoleBuf[numDipole].array->setAttribute ("RCU_ID",     &rcu );
-    dipoleBuf[numDipole].array->setAttribute ("TIME",
-						&(dipoleBuf[numDipole].starttime) );
-    dipoleBuf[numDipole].array->setAttribute ("SAMPLE_NUMBER",
-						&(dipoleBuf[numDipole].startsamplenum) );
-    dipoleBuf[numDipole].array->setAttribute ("SAMPLES_PER_FRAME",
-						&samples_per_frame );
-    dipoleBuf[numDipole].array->setAttribute ("ANTENNA_POSITION_VALUE",
-						antenna_position_value );
-    dipoleBuf[numDipole].array->setAttribute ("ANTENNA_POSITION_UNIT",
-						antenna_position_unit );
-    dipoleBuf[numDipole].array->setAttribute( "ANTENNA_POSITION_FRAME",
-						std::vector<string>(1,"ITRF") );
-    dipoleBuf[numDipole].array->setAttribute ("ANTENNA_ORIENTATION_VALUE",
-						antenna_position_value);
-    dipoleBuf[numDipole].array->setAttribute ("ANTENNA_ORIENTATION_UNIT",
-						antenna_position_unit );
-    dipoleBuf[numDipole].array->setAttribute( "ANTENNA_ORIENTATION_FRAME",
-						std::vector<string>(1,"ITRF") );
-    dipoleBuf[numDipole].array->setAttribute( "FEED",
-						std::vector<string>(1,"UNDEFINED") );
-    dipoleBuf[numDipole].array->setAttribute( "NYQUIST_ZONE",
+    dipole->array->setAttribute ("STATION_ID", &sid );
+    dipole->array->setAttribute ("RSP_ID",     &rsp );
+    dipole->array->setAttribute ("RCU_ID",     &rcu );
+    dipole->array->setAttribute ("TIME",
+                                 &(dipole->starttime) );
+    dipole->array->setAttribute ("SAMPLE_NUMBER",
+                                 &(dipole->startsamplenum) );
+    dipole->array->setAttribute ("SAMPLES_PER_FRAME",
+                                 &samples_per_frame );
+    dipole->array->setAttribute ("ANTENNA_POSITION_VALUE",
+                                 antenna_position_value );
+    dipole->array->setAttribute ("ANTENNA_POSITION_UNIT",
+                                 antenna_position_unit );
+    dipole->array->setAttribute( "ANTENNA_POSITION_FRAME",
+                                 std::vector<string>(1,"ITRF") );
+    dipole->array->setAttribute ("ANTENNA_ORIENTATION_VALUE",
+                                 antenna_position_value);
+    dipole->array->setAttribute ("ANTENNA_ORIENTATION_UNIT",
+                                 antenna_position_unit );
+    dipole->array->setAttribute( "ANTENNA_ORIENTATION_FRAME",
+                                 std::vector<string>(1,"ITRF") );
+    dipole->array->setAttribute( "FEED",
+                                 std::vector<string>(1,"UNDEFINED") );
+    dipole->array->setAttribute( "NYQUIST_ZONE",
         &nyquist_zone );
-    dipoleBuf[numDipole].array->setAttribute( "SAMPLE_FREQUENCY_VALUE", &sf, 1 );
-    dipoleBuf[numDipole].array->setAttribute( "SAMPLE_FREQUENCY_UNIT",
+    dipole->array->setAttribute( "SAMPLE_FREQUENCY_VALUE", &sf, 1 );
+    dipole->array->setAttribute( "SAMPLE_FREQUENCY_UNIT",
         std::vector<string>(1,"MHz") );
 #ifdef DAL_DEBUGGING_MESSAGES
     /* Feedback */
     cout << "CREATED New dipole group: " << newDipoleIDstr << endl;
 #endif
 
-    return numDipole;
+    dipoleBuf.push_back(dipole);
+    dipoleIndex_p.insert(headerp->stationid, headerp->rspid, headerp->rcuid, dipole);
+
+    return dipole;
   };
 
   //_____________________________________________________________________________
   //                                                             createNewStation
 
-  int TBBraw::createNewStation(TBB_Header *headerp)
+  TBBraw::stationBufElem * TBBraw::createNewStation(TBB_Header *headerp)
   {
-    int stationIndex;
-
     if (dataset_p == NULL) {
       cerr << "TBBraw::createNewStation: \"dataset_p == NULL\" Not attached to a file!" <<endl;
-      return -1;
+      return NULL;
     };
     
-    // find an empty station index
-    for (stationIndex=0; stationIndex<MAX_NO_STATIONS; stationIndex++)
-      {
-        if (stationBuf[stationIndex].group == NULL)
-          {
-            break;
-          };
-      };
-    if (stationIndex == MAX_NO_STATIONS)
+    // create the station group
+    char newStationIDstr[16];
+    sprintf( newStationIDstr, "Station%03d", headerp->stationid );
+    dalGroup *group = dataset_p->createGroup( newStationIDstr );
+    if (group == NULL)
       {
-        cerr << "TBBraw::createNewStation: Buffer \"dipoleBuf\" is full, cannot create new dipole!" <<endl;
-        return -1;
+        cerr << "TBBraw::createNewStation: Failed to create group " << newStationIDstr << endl;
+        return NULL;
       };
     
-    // We got our stationIndex -> create the station group
-    char newStationIDstr[10];
-    sprintf( newStationIDstr, "Station%03d", headerp->stationid );
-    stationBuf[stationIndex].group = dataset_p->createGroup( newStationIDstr );
-    
-    stationBuf[stationIndex].ID = headerp->stationid;
+    stationBufElem *station = new stationBufElem;
+    station->ID    = headerp->stationid;
+    station->group = group;
     
     std::vector<string> observationMode        (1, "Transient");
     std::vector<string> triggerType            (1, "UNDEFINED");
@@ -578,38 +853,39 @@ namespace DAL {  // Namespace DAL -- begin
     std::vector<string> beam_direction_frame (1, "AZEL");
     
     // Add attributes to "Station" group
-    stationBuf[stationIndex].group->setAttribute( "STATION_POSITION_VALUE",
-						  stationPositionValue);
-    stationBuf[stationIndex].group->setAttribute( "STATION_POSITION_UNIT",
-						  station_position_unit);
-    stationBuf[stationIndex].group->setAttribute( "STATION_POSITION_FRAME",
-						  station_position_frame );
-    stationBuf[stationIndex].group->setAttribute( "BEAM_DIRECTION_VALUE",
-						  beam_direction_value, 2 );
-    stationBuf[stationIndex].group->setAttribute( "BEAM_DIRECTION_UNIT",
-						  beamDirectionUnit);
-    stationBuf[stationIndex].group->setAttribute( "BEAM_DIRECTION_FRAME",
-						  beam_direction_frame );
-    stationBuf[stationIndex].group->setAttribute( "TRIGGER_TYPE",
-						  triggerType );
-    stationBuf[stationIndex].group->setAttribute( "TRIGGER_OFFSET",
-						  triggerOffset );
-    stationBuf[stationIndex].group->setAttribute( "TRIGGERED_ANTENNAS",
-						  triggeredAntennas);
-    stationBuf[stationIndex].group->setAttribute( "OBSERVATION_MODE",
-						  observationMode );
-    return stationIndex;
+    station->group->setAttribute( "STATION_POSITION_VALUE",
+                                  stationPositionValue);
+    station->group->setAttribute( "STATION_POSITION_UNIT",
+                                  station_position_unit);
+    station->group->setAttribute( "STATION_POSITION_FRAME",
+                                  station_position_frame );
+    station->group->setAttribute( "BEAM_DIRECTION_VALUE",
+                                  beam_direction_value, 2 );
+    station->group->setAttribute( "BEAM_DIRECTION_UNIT",
+                                  beamDirectionUnit);
+    station->group->setAttribute( "BEAM_DIRECTION_FRAME",
+                                  beam_direction_frame );
+    station->group->setAttribute( "TRIGGER_TYPE",
+                                  triggerType );
+    station->group->setAttribute( "TRIGGER_OFFSET",
+                                  triggerOffset );
+    station->group->setAttribute( "TRIGGERED_ANTENNAS",
+                                  triggeredAntennas);
+    station->group->setAttribute( "OBSERVATION_MODE",
+                                  observationMode );
+    stationBuf.push_back(station);
+    stationIndex_p[headerp->stationid] = station;
+    return station;
   };
   
   //_____________________________________________________________________________
   //                                                              addDataToDipole
   
-  bool TBBraw::addDataToDipole (int index,
+  bool TBBraw::addDataToDipole (dipoleBufElem &dipole,
 				char *buffer,
 				int bufflen,
 				bool bigEndian)
   {
-    int i;
     TBB_Header *headerp = (TBB_Header*)buffer;
     if (bufflen < (int)(headerp->n_samples_per_frame*sizeof(short)+sizeof(TBB_Header)))
       {
@@ -626,40 +902,51 @@ namespace DAL {  // Namespace DAL -- begin
     
     if ( bigendian_p != bigEndian )
       {
-        for ( i=0; i < headerp->n_samples_per_frame; i++ )
-          {
-            swapbytes( (char *)&(sdata[i]), 2 );
-          };
+        swapbytes16( sdata, headerp->n_samples_per_frame );
       };
 
     //calculate the writeOffset from time of first block and this block
-    int writeOffset= (headerp->sample_nr-dipoleBuf[index].startsamplenum)+
-                     ((headerp->time-dipoleBuf[index].starttime)*headerp->sample_freq*1000000);
+    int writeOffset= (headerp->sample_nr-dipole.startsamplenum)+
+                     ((headerp->time-dipole.starttime)*headerp->sample_freq*1000000);
 #ifdef DAL_DEBUGGING_MESSAGES
     uint sid, rsp, rcu;
-    dipoleBuf[index].array->getAttribute( attribute_name(STATION_ID), sid );
-    dipoleBuf[index].array->getAttribute( attribute_name(RSP_ID), rsp );
-    dipoleBuf[index].array->getAttribute( attribute_name(RCU_ID), rcu );
+    dipole.array->getAttribute( attribute_name(STATION_ID), sid );
+    dipole.array->getAttribute( attribute_name(RSP_ID), rsp );
+    dipole.array->getAttribute( attribute_name(RCU_ID), rcu );
     std::cout << "Station: " << sid << " RSP: " << rsp << " RCU: " << rcu
               << " Sequence-Nr: " << headerp->seqnr << endl;
-    std::cout << " starttime:"<< headerp->time-dipoleBuf[index].starttime << " startsamplenum:" << headerp->sample_nr-dipoleBuf[index].startsamplenum
+    std::cout << " starttime:"<< headerp->time-dipole.starttime << " startsamplenum:" << headerp->sample_nr-dipole.startsamplenum
               << " writeOffset:" << writeOffset << endl;
 #endif
     //only write data if this block comes after the first block
     // (don't extend the array to the front)
     if (writeOffset >= 0)
       {
-        //extend array if neccessary.
-        if ((writeOffset+ headerp->n_samples_per_frame)> dipoleBuf[index].dimensions[0])
+        int nofSamples = headerp->n_samples_per_frame;
+        //write out the buffered run if this block does not continue it
+        if ((dipole.bufferLength > 0) &&
+            ((writeOffset != dipole.bufferOffset+dipole.bufferLength) ||
+             (dipole.bufferLength+nofSamples > (int)dipole.writeBuffer.size())))
           {
-#ifdef DAL_DEBUGGING_MESSAGES
-            cout << "extending array to:" << writeOffset+ headerp->n_samples_per_frame
-                 << " from:" << dipoleBuf[index].dimensions[0] << endl;
-#endif
-            dipoleBuf[index].dimensions[0] = writeOffset+ headerp->n_samples_per_frame;
-            dipoleBuf[index].array->extend(dipoleBuf[index].dimensions);
+            if (!flushDipole(dipole))
+              {
+                return false;
+              };
+          };
+        if (dipole.bufferLength == 0)
+          {
+            dipole.bufferOffset = writeOffset;
+            if ((int)dipole.writeBuffer.size() < writeBufferFrames_p*nofSamples)
+              {
+                dipole.writeBuffer.resize(writeBufferFrames_p*nofSamples);
+              };
+          };
+        memcpy(&(dipole.writeBuffer[dipole.bufferLength]), sdata, nofSamples*sizeof(short));
+        dipole.bufferLength += nofSamples;
+        if (dipole.bufferLength >= writeBufferFrames_p*nofSamples)
+          {
+            return flushDipole(dipole);
           };
-        dipoleBuf[index].array->write(writeOffset, sdata, headerp->n_samples_per_frame );
 #ifdef DAL_DEBUGGING_MESSAGES
       }
     else
@@ -678,4 +965,49 @@ namespace DAL {  // Namespace DAL -- begin
     return true;
   };
 
+  //_____________________________________________________________________________
+  //                                                                  flushDipole
+  
+  bool TBBraw::flushDipole (dipoleBufElem &dipole)
+  {
+    if (dipole.bufferLength == 0)
+      {
+        return true;
+      };
+    
+    //extend array if neccessary; grow geometrically (up to a maximum step), so
+    // we do not have to extend the array for every block we write
+    int endOffset = dipole.bufferOffset + dipole.bufferLength;
+    bool extend   = (endOffset > dipole.dimensions[0]);
+    if (extend)
+      {
+        int growth = std::min(dipole.dimensions[0], TBB_MAX_EXTEND_SAMPLES);
+        dipole.dimensions[0] = std::max(endOffset, dipole.dimensions[0]+growth);
+#ifdef DAL_DEBUGGING_MESSAGES
+        cout << "extending array to:" << dipole.dimensions[0]
+             << " for data up to:" << endOffset << endl;
+#endif
+      };
+    
+    pthread_mutex_lock (&hdf5Mutex_p);
+    if (extend && !dipole.array->extend(dipole.dimensions))
+      {
+        pthread_mutex_unlock (&hdf5Mutex_p);
+        cerr << "TBBraw::flushDipole: Failed to extend array!" << endl;
+        return false;
+      };
+    bool status = dipole.array->write(dipole.bufferOffset,
+                                      &(dipole.writeBuffer[0]),
+                                      dipole.bufferLength);
+    nofWrites_p++;
+    pthread_mutex_unlock (&hdf5Mutex_p);
+    if (endOffset > dipole.datalength)
+      {
+        dipole.datalength = endOffset;
+      };
+    dipole.bufferLength = 0;
+    
+    return status;
+  };
+
 } // Namespace DAL -- end
@@ -27,6 +27,7 @@
 #include <string>
 #include <vector>
 #include <errno.h>
+#include <pthread.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/socket.h>
@@ -45,6 +46,8 @@ using std::vector;
 // DAL header files
 #include <core/dalCommon.h>
 #include <core/dalDataset.h>
+#include <core/HDF5StoragePolicy.h>
+#include <core/HDF5AccessProfile.h>
 #include <data_common/CommonAttributes.h>
 
 namespace DAL {  // Namespace DAL -- begin
@@ -61,7 +64,7 @@ namespace DAL {  // Namespace DAL -- begin
     
     \date 2009/01/07
     
-    \test tTBBraw.cpp
+    \test tTBBraw.cc
     
     <h3>Prerequisite</h3>
     
@@ -73,6 +76,14 @@ namespace DAL {  // Namespace DAL -- begin
     The data frames need to be read in by an application (or derived class) from
     a file or an UDP-port.
 
+    By default the frames are processed on the thread calling
+    processTBBrawBlock(). After startPipeline() the calling thread only routes
+    the frames -- keyed on station, RSP and RCU -- to a number of worker
+    threads, each of which owns a disjoint set of dipoles: the workers do the
+    byte-swapping, CRC checking and time-stamp fixing and collect the data of
+    their dipoles. All calls into the HDF5 library are serialized through a
+    single mutex, so this is safe with HDF5 builds that are not thread-safe.
+
     <i>Future enhancements:</i>
     - Suport for handling of TBB sub-band data needs to be added.
     - Support for big-endian systems is still untested.
@@ -84,8 +95,9 @@ namespace DAL {  // Namespace DAL -- begin
     
     //!some internal definitions
 #define TBB_FRAME_SIZE 2140
-#define MAX_NO_STATIONS 50
-#define MAX_NO_DIPOLES 1000
+#define TBB_WRITE_BUFFER_FRAMES 64
+#define TBB_MAX_EXTEND_SAMPLES 16777216
+#define TBB_PIPELINE_QUEUE_FRAMES 1024
     
   private:
     // ----------------------------------------------------------- Private Data
@@ -108,16 +120,16 @@ namespace DAL {  // Namespace DAL -- begin
     int nofDiscardedHeader_p;
     //! am I big endian?
     bool bigendian_p;
-    //! buffer for the stations
-    struct stationBufElem
-    {
-      //! ID of the station
-      unsigned int ID;
-      //! pointer to the corresponding group
-      dalGroup * group;
-    };
-    struct stationBufElem *stationBuf;
-    
+    //! number of frames collected per dipole before writing them to file
+    int writeBufferFrames_p;
+    //! number of write operations on the dipole arrays
+    int nofWrites_p;
+    //! chunking and compression of the dipole arrays
+    HDF5StoragePolicy storagePolicy_p;
+    //! dataset creation property list made from storagePolicy_p (-1 if not yet created)
+    hid_t creationProperties_p;
+    //! file access settings used when creating the output file
+    HDF5AccessProfile accessProfile_p;
     //! buffer for the dipoles
     struct dipoleBufElem
     {
@@ -131,8 +143,119 @@ namespace DAL {  // Namespace DAL -- begin
 	(used to calculate array offsets).
       */
       unsigned int starttime, startsamplenum;
+      //! number of samples actually written to the array
+      int datalength;
+      //! staging buffer collecting contiguous frames before writing them
+      std::vector<short> writeBuffer;
+      //! array offset of the first sample in the staging buffer
+      int bufferOffset;
+      //! number of samples waiting in the staging buffer
+      int bufferLength;
+    };
+    //! all dipoles, in the order they were created
+    std::vector<dipoleBufElem*> dipoleBuf;
+    
+    //! buffer for the stations
+    struct stationBufElem
+    {
+      //! ID of the station
+      unsigned int ID;
+      //! pointer to the corresponding group
+      dalGroup * group;
+    };
+    //! all stations, in the order they were created
+    std::vector<stationBufElem*> stationBuf;
+    //! the stations, indexed by station ID (NULL if not yet created)
+    stationBufElem *stationIndex_p[256];
+    
+    /*!
+      \brief Direct-mapped index of dipoles, keyed on station, RSP and RCU
+      
+      The entries of a station are only allocated once the first dipole of that
+      station shows up, and only up to the highest RSP seen (256 entries per
+      RSP), so a full array of stations needs a few kByte per station.
+    */
+    class DipoleMap
+    {
+      //! dipoles per station ID, indexed by <tt>rspid*256+rcuid</tt>
+      std::vector<dipoleBufElem*> dipoles_p[256];
+    public:
+      //! Get the dipole, or NULL if it is not in the map
+      inline dipoleBufElem * find (unsigned char stationid,
+                                   unsigned char rspid,
+                                   unsigned char rcuid) const
+      {
+        std::vector<dipoleBufElem*> const &station = dipoles_p[stationid];
+        unsigned int key = (rspid << 8) | rcuid;
+        return (key < station.size()) ? station[key] : NULL;
+      }
+      //! Add a dipole to the map
+      inline void insert (unsigned char stationid,
+                          unsigned char rspid,
+                          unsigned char rcuid,
+                          dipoleBufElem *dipole)
+      {
+        std::vector<dipoleBufElem*> &station = dipoles_p[stationid];
+        unsigned int key = (rspid << 8) | rcuid;
+        if (key >= station.size())
+          {
+            station.resize((rspid+1) << 8, NULL);
+          };
+        station[key] = dipole;
+      }
+      //! Remove all entries from the map
+      inline void clear ()
+      {
+        for (int i=0; i<256; i++)
+          {
+            dipoles_p[i].clear();
+          };
+      }
     };
-    struct dipoleBufElem *dipoleBuf;
+    //! index of all dipoles
+    DipoleMap dipoleIndex_p;
+    
+    //! state of the time-stamp fixing (old style) for the serial mode
+    bool oddSecond_p;
+    
+    //! worker thread of the processing pipeline, with its queue of frames
+    struct pipelineWorker
+    {
+      //! the object the worker is processing frames for
+      TBBraw *owner;
+      //! the thread itself
+      pthread_t thread;
+      //! protects the queue
+      pthread_mutex_t mutex;
+      //! signalled when frames were added to the queue
+      pthread_cond_t notEmpty;
+      //! signalled when frames were taken out of the queue
+      pthread_cond_t notFull;
+      //! storage for the queued frames
+      std::vector<char> frames;
+      //! byte order of the queued frames
+      std::vector<char> bigEndian;
+      //! number of valid bytes in each of the queued frames
+      std::vector<int> frameLength;
+      //! number of frames queued (head) and processed (tail) so far
+      unsigned int head, tail;
+      //! stop once the queue is empty
+      bool stop;
+      //! the dipoles handled by this worker
+      DipoleMap dipoleIndex;
+      //! state of the time-stamp fixing (old style)
+      bool oddSecond;
+      //! number of frames discarded because of a broken header
+      int nofDiscardedHeader;
+      //! number of frames that could not be processed for other reasons
+      int nofFailed;
+    };
+    //! the workers of the processing pipeline; empty in serial mode
+    std::vector<pipelineWorker*> workers_p;
+    //! number of frames the (stopped) pipeline workers failed to process
+    int nofPipelineFailed_p;
+    //! serializes all calls into the HDF5 library
+    pthread_mutex_t hdf5Mutex_p;
     
   protected:
     
@@ -186,8 +309,11 @@ namespace DAL {  // Namespace DAL -- begin
 
       \param commonAttributes -- LOFAR common attribute attached to the root
              group of the file.
+      \param profile          -- File access settings used when creating the
+             file.
     */
-    TBBraw (CommonAttributes const &commonAttributes);
+    TBBraw (CommonAttributes const &commonAttributes,
+	    HDF5AccessProfile const &profile=HDF5AccessProfile::defaultProfile());
     
     /*!
       \brief Argumented Constructor
@@ -199,6 +325,8 @@ namespace DAL {  // Namespace DAL -- begin
       \param filterSelection -- Filter (frequency-width) selection of the
              observation
       \param telescope -- name of the telescope (usually "LOFAR")
+      \param antenna_set -- name of the antenna set
+      \param profile   -- file access settings used when creating the file
     */
     TBBraw (std::string const &filename,
 	    string const &observer="UNDEFINED",
@@ -206,7 +334,8 @@ namespace DAL {  // Namespace DAL -- begin
 	    string const &observation_id="UNDEFINED",
 	    string const &filterSelection="UNDEFINED",
 	    string const &telescope="LOFAR",
-      string const &antenna_set="UNDEFINED");
+      string const &antenna_set="UNDEFINED",
+	    HDF5AccessProfile const &profile=HDF5AccessProfile::defaultProfile());
 
     // === Destruction ==========================================================
     
@@ -256,6 +385,51 @@ namespace DAL {  // Namespace DAL -- begin
     {
       fixTimes_p=fixlevel;
     };
+
+    /*!
+      \brief Set the size of the per-dipole write buffer
+      
+      \param nofFrames -- Number of contiguous frames collected for a dipole
+             before they are written to the file in one go; a value of 1
+             writes every frame as soon as it has been processed.
+    */
+    inline void setWriteBufferSize (const int nofFrames=TBB_WRITE_BUFFER_FRAMES)
+    {
+      writeBufferFrames_p = (nofFrames>0) ? nofFrames : 1;
+    };
+    
+    //! Get the chunking and compression of the dipole arrays
+    inline HDF5StoragePolicy storagePolicy () const {
+      return storagePolicy_p;
+    };
+    
+    /*!
+      \brief Set the chunking and compression of the dipole arrays
+      
+      \param policy -- Storage policy; applies to the dipole arrays created
+             after this call, so it should be set before processing any data.
+    */
+    void setStoragePolicy (HDF5StoragePolicy const &policy);
+    
+    //! Get the file access settings used when creating the output file
+    inline HDF5AccessProfile accessProfile () const {
+      return accessProfile_p;
+    };
+    
+    /*!
+      \brief Set the file access settings used when creating the output file
+      
+      \param profile -- Access profile; applies to the file opened after this
+             call, so it has to be set before open_file().
+    */
+    inline void setAccessProfile (HDF5AccessProfile const &profile) {
+      accessProfile_p = profile;
+    };
+    
+    //! Get the number of worker threads of the processing pipeline
+    inline int nofPipelineWorkers () const {
+      return workers_p.size();
+    };
     
     //! Get the LOFAR common attributes attached to the root level of the file
     inline CommonAttributes commonAttributes () const {
@@ -322,6 +496,44 @@ namespace DAL {  // Namespace DAL -- begin
     bool processTBBrawBlock (char *inbuff,
 			     int datalen,
 			     bool bigEndian=false);
+
+    /*!
+      \brief Write all buffered data to the output file
+      
+      \return <tt>true</tt> if successful
+      
+      Frames handed to processTBBrawBlock() are collected per dipole and only
+      written once a contiguous run is complete; this writes out whatever is
+      still buffered and sets the shape of the dipole arrays to the amount of
+      data actually written. Called automatically when the object is destroyed.
+    */
+    bool flush ();
+
+    /*!
+      \brief Process the frames in a pipeline of worker threads
+      
+      \param nofWorkers -- Number of worker threads
+      
+      \return <tt>true</tt> if the workers were started
+      
+      From now on processTBBrawBlock() only copies the frame into the queue of
+      the worker handling its dipole and returns immediately; it blocks if that
+      queue is full. The return value of processTBBrawBlock() then only tells
+      whether the frame was accepted; frames which are discarded by the workers
+      are counted in the summary(). Only one thread may call
+      processTBBrawBlock() at a time.
+    */
+    bool startPipeline (int nofWorkers=2);
+
+    /*!
+      \brief Process all queued frames and stop the worker threads
+      
+      \return <tt>true</tt> if all frames were processed successfully
+      
+      Afterwards processTBBrawBlock() processes the frames on the calling thread
+      again. Called automatically when the object is destroyed.
+    */
+    bool stopPipeline ();
     
     //! Provide a summary of the internal status and processing statistics
     inline void summary () {
@@ -377,8 +589,10 @@ namespace DAL {  // Namespace DAL -- begin
       \brief fix old-style broken time-stamps
       
       \param headerp -- pointer to the frame header
+      \param oddSecond -- state of the fixing, kept per stream of frames
     */
-    void fixDateOld(TBB_Header *headerp);
+    void fixDateOld(TBB_Header *headerp,
+		    bool &oddSecond);
     
     /*!
       \brief fix new-style broken time-stamps
@@ -388,46 +602,79 @@ namespace DAL {  // Namespace DAL -- begin
     void fixDateNew(TBB_Header *headerp);
     
     /*!
-      \brief get the index of the dipole in the dipole buffer
+      \brief get the dipole a frame belongs to, creating it if neccessary
+      
+      \param headerp -- pointer to the frame header
+      
+      \return pointer to the dipole, or NULL if an error occured
+    */
+    dipoleBufElem * getDipole(TBB_Header *headerp);
+
+    /*!
+      \brief Decode the header of a frame (byte order, CRC, time-stamps)
       
       \param headerp -- pointer to the frame header
+      \param bigEndian -- set to true if the data is in big endian byte order
+      \param oddSecond -- state of the time-stamp fixing (old style)
+      \retval nofDiscarded -- incremented if the header CRC is broken
       
-      \return index of the dipole, or -1 if an error occured
+      \return <tt>true</tt> if the frame can be added to the file
     */
-    int getDipoleIndex(TBB_Header *headerp);
+    bool decodeHeader (TBB_Header *headerp,
+		       bool bigEndian,
+		       bool &oddSecond,
+		       int &nofDiscarded);
+
+    //! Main loop of a worker thread of the processing pipeline
+    void runPipelineWorker (pipelineWorker *worker);
+
+    //! Start routine of the worker threads (calls runPipelineWorker())
+    static void * pipelineThread (void *worker);
+
+    //! Wait until all workers of the pipeline have emptied their queues
+    void drainPipeline ();
     
     /*!
-      \brief Create a new dipole array and return the its index
+      \brief Create a new dipole array and add it to the dipole buffer
       
       \param headerp -- pointer to the frame header
       
-      \return index of the new dipole, or -1 if an error occured
+      \return pointer to the new dipole, or NULL if an error occured
     */
-    int createNewDipole(TBB_Header *headerp);
+    dipoleBufElem * createNewDipole(TBB_Header *headerp);
     
     /*!
-      \brief Create a new station group and return the its index
+      \brief Create a new station group and add it to the station buffer
       
       \param headerp -- pointer to the frame header
       
-      \return index of the new station, or -1 if an error occured
+      \return pointer to the new station, or NULL if an error occured
     */
-    int createNewStation(TBB_Header *headerp);
+    stationBufElem * createNewStation(TBB_Header *headerp);
     
     /*!
       \brief Process one block of data and add it's contents to the output file
       
-      \param index  -- index of the entry in dipoleBuf to add the data to
+      \param dipole  -- the dipole to add the data to
       \param buffer  -- pointer to the TBB data-frame (incl. header etc.)
       \param datalen -- length (number of bytes) of the data in inbuff
       \param bigEndian -- set to true if the data is in big endian byte order
       
       \return <tt>true</tt> if successful
     */
-    bool addDataToDipole (int index,
+    bool addDataToDipole (dipoleBufElem &dipole,
 			  char *buffer,
 			  int bufflen,
 			  bool bigEndian=false);
+
+    /*!
+      \brief Write the staging buffer of a dipole to its array
+      
+      \param dipole  -- the dipole to write out
+      
+      \return <tt>true</tt> if successful
+    */
+    bool flushDipole (dipoleBufElem &dipole);
     
   }; // class TBBraw -- end
   
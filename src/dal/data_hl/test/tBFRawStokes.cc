@@ -0,0 +1,368 @@
+/***************************************************************************
+ *   Copyright (C) 2026                                                    *
+ *   agent <agent@local>                                                   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include <sys/time.h>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include <data_hl/BFRawStokes.h>
+
+using std::cout;
+using std::cerr;
+using std::endl;
+
+// -----------------------------------------------------------------------------
+
+/*!
+  \file tBFRawStokes.cc
+
+  \ingroup DAL
+  \ingroup data_hl
+
+  \brief Test and benchmark the Stokes kernels for BF raw samples
+
+  \author agent
+
+  \date 2026/10/16
+
+  The kernels DAL::stokesI and DAL::stokesIQUV are compared with the scalar
+  reference DAL::stokesReference, first for correctness, then for speed on data
+  the size of a subband of a BF raw data block; the intensity loop used by
+  bf2h5 so far serves as the baseline for Stokes I.
+
+  <h3>Examples</h3>
+
+  Calling the test program without any further command-line parameters only
+  runs the tests; the benchmark is run in addition when requested, optionally
+  with the number of subbands to process:
+  \verbatim
+  tBFRawStokes --benchmark 10000
+  \endverbatim
+*/
+
+//! Number of samples per subband in a block of BF raw data
+#define TEST_SUBBAND_SAMPLES 16384
+//! Downsampling factor used in the benchmark
+#define TEST_DOWNSAMPLE_FACTOR 16
+
+//_______________________________________________________________________________
+//                                                             reference_intensity
+
+/*!
+  \brief Original computation of the downsampled total intensity in bf2h5
+*/
+void reference_intensity (BFRawFormat::Sample const *input_data,
+			  uint32_t nofOutputSamples,
+			  unsigned int downsampleFactor,
+			  float *output_data)
+{
+  uint32_t xx_intensity(0), yy_intensity(0);
+  uint64_t start(0);
+
+  for (uint32_t count = 0; count < nofOutputSamples; ++count) {
+    output_data[count] = 0;
+    for (uint64_t idx = start; idx < (start + downsampleFactor); ++idx) {
+      xx_intensity = (uint32_t)(real(input_data[ idx ].xx) * real(input_data[ idx ].xx) +
+				imag(input_data[ idx ].xx) * imag(input_data[ idx ].xx) );
+      yy_intensity = (uint32_t)(real(input_data[ idx ].yy) * real(input_data[ idx ].yy) +
+				imag(input_data[ idx ].yy) * imag(input_data[ idx ].yy) );
+      output_data[count] += (float)xx_intensity + (float)yy_intensity;
+    }
+    start += downsampleFactor;
+  }
+}
+
+//_______________________________________________________________________________
+//                                                                         seconds
+
+//! Wall-clock time in seconds
+double seconds ()
+{
+  struct timeval tv;
+  gettimeofday (&tv, NULL);
+  return tv.tv_sec + 1e-6*tv.tv_usec;
+}
+
+//_______________________________________________________________________________
+//                                                                     fillSamples
+
+/*!
+  \brief Fill the samples with random values
+
+  \param samples -- Samples to fill
+  \param range   -- Values are drawn from <tt>[-range,range)</tt>
+*/
+void fillSamples (std::vector<BFRawFormat::Sample> &samples,
+		  int range)
+{
+  for (unsigned int n=0; n<samples.size(); n++) {
+    samples[n].xx = std::complex<int16_t> (rand() % (2*range) - range, rand() % (2*range) - range);
+    samples[n].yy = std::complex<int16_t> (rand() % (2*range) - range, rand() % (2*range) - range);
+  }
+}
+
+//_______________________________________________________________________________
+//                                                                         compare
+
+/*!
+  \brief Compare the output of a kernel with the reference
+
+  The kernels sum in single precision, so a relative deviation of the order of
+  the float resolution times the downsampling factor w.r.t. Stokes I is
+  accepted.
+
+  \return nofDifferences -- Number of samples differing from the reference
+*/
+int compare (std::vector<float> const &result,
+	     std::vector<float> const &reference,
+	     std::vector<float> const &I,
+	     unsigned int downsampleFactor)
+{
+  int nofDifferences (0);
+  for (unsigned int n=0; n<result.size(); n++) {
+    double tolerance = 1e-6 * (downsampleFactor+4) * (I[n]+1);
+    if (fabs (result[n]-reference[n]) > tolerance) {
+      nofDifferences++;
+    }
+  }
+  return nofDifferences;
+}
+
+//_______________________________________________________________________________
+//                                                                     test_stokes
+
+/*!
+  \brief Compare DAL::stokesI and DAL::stokesIQUV with the reference
+
+  \return nofFailedTests -- The number of failed tests encountered within this
+          function
+*/
+int test_stokes ()
+{
+  cout << "\n[tBFRawStokes::test_stokes]\n" << endl;
+
+  int nofFailedTests (0);
+  char const *names[4] = { "I", "Q", "U", "V" };
+
+  cout << "-- Selected kernel = " << DAL::stokesKernel() << endl;
+
+  cout << "[1] Downsampling factors 1 to 40, 64 and 256 at all offsets ..." << endl;
+  srand (42);
+  for (unsigned int factor=1; factor<=256; factor++) {
+    if (factor > 40 && factor != 64 && factor != 256) {
+      continue;
+    }
+    for (unsigned int offset=0; offset<4; offset++) {
+      uint64_t nofOutput = (factor == 1) ? 37 : 3 + offset;
+      std::vector<BFRawFormat::Sample> samples (nofOutput*factor+offset);
+      std::vector<std::vector<float> > result (4, std::vector<float> (nofOutput, -1));
+      std::vector<std::vector<float> > reference (4, std::vector<float> (nofOutput));
+      std::vector<float> intensity (nofOutput, -1);
+
+      fillSamples (samples, 2048);
+      DAL::stokesReference (&samples[offset], nofOutput, factor,
+			    &reference[0][0], &reference[1][0], &reference[2][0], &reference[3][0]);
+      DAL::stokesIQUV (&samples[offset], nofOutput, factor,
+		       &result[0][0], &result[1][0], &result[2][0], &result[3][0]);
+      DAL::stokesI (&samples[offset], nofOutput, factor, &intensity[0]);
+
+      for (int p=0; p<4; p++) {
+	if (compare (result[p], reference[p], reference[0], factor) > 0) {
+	  cerr << "-- Mismatch of Stokes " << names[p] << " for factor " << factor
+	       << " at offset " << offset << endl;
+	  nofFailedTests++;
+	}
+      }
+      if (compare (intensity, reference[0], reference[0], factor) > 0) {
+	cerr << "-- Mismatch of Stokes I only for factor " << factor
+	     << " at offset " << offset << endl;
+	nofFailedTests++;
+      }
+    }
+  }
+
+  cout << "[2] Full range of the 16-bit samples ..." << endl;
+  {
+    unsigned int factors[3] = { 1, 3, 16 };
+    for (int f=0; f<3; f++) {
+      uint64_t nofOutput = 64;
+      std::vector<BFRawFormat::Sample> samples (nofOutput*factors[f]);
+      std::vector<std::vector<float> > result (4, std::vector<float> (nofOutput));
+      std::vector<std::vector<float> > reference (4, std::vector<float> (nofOutput));
+
+      fillSamples (samples, 32768);
+      samples[0].xx = samples[0].yy = std::complex<int16_t> (-32768, -32768);
+      DAL::stokesReference (&samples[0], nofOutput, factors[f],
+			    &reference[0][0], &reference[1][0], &reference[2][0], &reference[3][0]);
+      DAL::stokesIQUV (&samples[0], nofOutput, factors[f],
+		       &result[0][0], &result[1][0], &result[2][0], &result[3][0]);
+      for (int p=0; p<4; p++) {
+	if (compare (result[p], reference[p], reference[0], factors[f]) > 0) {
+	  cerr << "-- Mismatch of Stokes " << names[p] << " for factor " << factors[f] << endl;
+	  nofFailedTests++;
+	}
+      }
+    }
+  }
+
+  cout << "[3] Known polarization states ..." << endl;
+  {
+    /* X only, Y only, X = Y, X = iY; expected (I,Q,U,V) in units of |X|^2 */
+    std::complex<int16_t> X[4] = { std::complex<int16_t>(3,4), std::complex<int16_t>(0,0),
+				   std::complex<int16_t>(3,4), std::complex<int16_t>(-4,3) };
+    std::complex<int16_t> Y[4] = { std::complex<int16_t>(0,0), std::complex<int16_t>(3,4),
+				   std::complex<int16_t>(3,4), std::complex<int16_t>(3,4) };
+    float expected[4][4] = { {1,1,0,0}, {1,-1,0,0}, {2,0,2,0}, {2,0,0,-2} };
+    for (int s=0; s<4; s++) {
+      std::vector<BFRawFormat::Sample> samples (1);
+      float stokes[4];
+      samples[0].xx = X[s];
+      samples[0].yy = Y[s];
+      DAL::stokesIQUV (&samples[0], 1, 1, &stokes[0], &stokes[1], &stokes[2], &stokes[3]);
+      for (int p=0; p<4; p++) {
+	if (stokes[p] != 25*expected[s][p]) {
+	  cerr << "-- Wrong Stokes " << names[p] << " for state " << s << " : "
+	       << stokes[p] << " instead of " << 25*expected[s][p] << endl;
+	  nofFailedTests++;
+	}
+      }
+    }
+  }
+
+  cout << "[4] Stokes I against the original intensity of bf2h5 ..." << endl;
+  {
+    uint32_t nofOutput = TEST_SUBBAND_SAMPLES/TEST_DOWNSAMPLE_FACTOR;
+    std::vector<BFRawFormat::Sample> samples (TEST_SUBBAND_SAMPLES);
+    std::vector<float> intensity (nofOutput);
+    std::vector<float> reference (nofOutput);
+
+    fillSamples (samples, 2048);
+    reference_intensity (&samples[0], nofOutput, TEST_DOWNSAMPLE_FACTOR, &reference[0]);
+    DAL::stokesI (&samples[0], nofOutput, TEST_DOWNSAMPLE_FACTOR, &intensity[0]);
+
+    if (compare (intensity, reference, reference, TEST_DOWNSAMPLE_FACTOR) > 0) {
+      cerr << "-- Stokes I differs from the original intensity" << endl;
+      nofFailedTests++;
+    }
+  }
+
+  return nofFailedTests;
+}
+
+//_______________________________________________________________________________
+//                                                                       benchmark
+
+/*!
+  \brief Compare the speed of the kernels with the original code
+
+  \param nofIterations -- Number of subbands to process
+*/
+void benchmark (int nofIterations)
+{
+  cout << "\n[tBFRawStokes::benchmark]\n" << endl;
+
+  double start, original, scalar, kernelI, kernelIQUV;
+  uint32_t nofOutput = TEST_SUBBAND_SAMPLES/TEST_DOWNSAMPLE_FACTOR;
+  std::vector<BFRawFormat::Sample> samples (TEST_SUBBAND_SAMPLES);
+  std::vector<std::vector<float> > stokes (4, std::vector<float> (nofOutput));
+  std::vector<float> reference (nofOutput);
+
+  fillSamples (samples, 2048);
+
+  cout << "[1] " << nofIterations << " subbands of " << TEST_SUBBAND_SAMPLES
+       << " samples, downsampled by " << TEST_DOWNSAMPLE_FACTOR << " ..." << endl;
+
+  start = seconds();
+  for (int n=0; n<nofIterations; n++) {
+    reference_intensity (&samples[0], nofOutput, TEST_DOWNSAMPLE_FACTOR, &reference[0]);
+  }
+  original = seconds()-start;
+
+  start = seconds();
+  for (int n=0; n<nofIterations; n++) {
+    DAL::stokesReference (&samples[0], nofOutput, TEST_DOWNSAMPLE_FACTOR,
+			  &stokes[0][0], &stokes[1][0], &stokes[2][0], &stokes[3][0]);
+  }
+  scalar = seconds()-start;
+
+  start = seconds();
+  for (int n=0; n<nofIterations; n++) {
+    DAL::stokesI (&samples[0], nofOutput, TEST_DOWNSAMPLE_FACTOR, &stokes[0][0]);
+  }
+  kernelI = seconds()-start;
+
+  start = seconds();
+  for (int n=0; n<nofIterations; n++) {
+    DAL::stokesIQUV (&samples[0], nofOutput, TEST_DOWNSAMPLE_FACTOR,
+		     &stokes[0][0], &stokes[1][0], &stokes[2][0], &stokes[3][0]);
+  }
+  kernelIQUV = seconds()-start;
+
+  double nofSamples = 1e-6 * nofIterations * TEST_SUBBAND_SAMPLES;
+  cout << "-- original I      : " << nofSamples/original   << " Msamples/s" << endl;
+  cout << "-- reference IQUV  : " << nofSamples/scalar     << " Msamples/s" << endl;
+  cout << "-- " << DAL::stokesKernel() << " I"
+       << std::string(14-DAL::stokesKernel().size(),' ')
+       << ": " << nofSamples/kernelI    << " Msamples/s" << endl;
+  cout << "-- " << DAL::stokesKernel() << " IQUV"
+       << std::string(11-DAL::stokesKernel().size(),' ')
+       << ": " << nofSamples/kernelIQUV << " Msamples/s" << endl;
+  cout << "-- speed-up I      : " << original/kernelI << endl;
+}
+
+//_______________________________________________________________________________
+//                                                                            main
+
+/*!
+  \brief Main routine of the test program
+
+  \param argc -- Number of command line arguments
+  \param argv -- Command line arguments; <tt>--benchmark</tt> runs the
+         benchmark as well, optionally followed by the number of iterations
+
+  \return nofFailedTests -- The number of failed tests encountered within and
+          identified by this test program.
+*/
+int main (int argc,
+	  char *argv[])
+{
+  int nofFailedTests (0);
+  bool haveBenchmark (false);
+  int nofIterations (10000);
+
+  if (argc > 1 && strcmp (argv[1], "--benchmark") == 0) {
+    haveBenchmark = true;
+    if (argc > 2) {
+      nofIterations = atoi (argv[2]);
+    }
+  }
+
+  // Test the kernels against the reference implementation
+  nofFailedTests += test_stokes ();
+  // Compare the speed of the kernels and the original implementation
+  if (haveBenchmark) {
+    benchmark (nofIterations);
+  }
+
+  return nofFailedTests;
+}
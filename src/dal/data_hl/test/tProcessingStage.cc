@@ -0,0 +1,375 @@
+/***************************************************************************
+ *   Copyright (C) 2026                                                    *
+ *   agent <agent@local>                                                   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <data_hl/ProcessingStage.h>
+
+using std::cout;
+using std::cerr;
+using std::endl;
+
+// -----------------------------------------------------------------------------
+
+/*!
+  \file tProcessingStage.cc
+
+  \ingroup DAL
+  \ingroup data_hl
+
+  \brief Test the streaming processing stages
+
+  \author agent
+
+  \date 2026/10/16
+
+  Each stage is checked against a direct computation on the complete stream,
+  and is fed the stream in blocks of varying length, to verify that the state
+  carried over between the blocks makes the result independent of the way the
+  stream is split up.
+*/
+
+//! Number of channels of the test data
+#define TEST_NOF_CHANNELS 16
+//! Number of time samples of the test data
+#define TEST_NOF_TIMES 1000
+
+//_______________________________________________________________________________
+//                                                                      fillRandom
+
+//! Fill the data with random values in [0,1)
+void fillRandom (std::vector<float> &data)
+{
+  for (unsigned int n=0; n<data.size(); n++) {
+    data[n] = float(rand()) / RAND_MAX;
+  }
+}
+
+//_______________________________________________________________________________
+//                                                                     runBlockwise
+
+/*!
+  \brief Feed the stream to a stage in blocks of random length
+
+  \return output -- The concatenated output of the stage
+*/
+std::vector<float> runBlockwise (DAL::ProcessingStage<float> &stage,
+				 std::vector<float> const &input,
+				 unsigned int maxBlock)
+{
+  unsigned int nofChannels = stage.nofChannels();
+  uint64_t nofTimes        = input.size() / nofChannels;
+  std::vector<float> output;
+
+  for (uint64_t t=0; t<nofTimes;) {
+    uint64_t block = std::min<uint64_t> (rand() % maxBlock, nofTimes - t);
+    std::vector<float> result (stage.nofOutputTimes(block) * stage.nofOutputChannels() + 1);
+    uint64_t nofOutput = stage.process (&input[t*nofChannels], block, &result[0]);
+    output.insert (output.end(), result.begin(), result.begin() + nofOutput * stage.nofOutputChannels());
+    t += block;
+  }
+
+  return output;
+}
+
+//_______________________________________________________________________________
+//                                                                  test_averaging
+
+/*!
+  \brief Test DAL::AveragingStage
+
+  \return nofFailedTests -- The number of failed tests encountered within this
+          function
+*/
+int test_averaging ()
+{
+  cout << "\n[tProcessingStage::test_averaging]\n" << endl;
+
+  int nofFailedTests (0);
+  unsigned int timeFactor (7);
+  unsigned int channelFactor (3);
+  std::vector<float> input (TEST_NOF_TIMES*TEST_NOF_CHANNELS);
+
+  fillRandom (input);
+
+  cout << "[1] Average 7 samples and 3 channels in blocks of random length ..." << endl;
+  {
+    DAL::AveragingStage<float> stage (TEST_NOF_CHANNELS, timeFactor, channelFactor);
+    std::vector<float> output = runBlockwise (stage, input, 20);
+    unsigned int nofOutChannels = TEST_NOF_CHANNELS/channelFactor;
+
+    if (output.size() != (TEST_NOF_TIMES/timeFactor) * nofOutChannels) {
+      cerr << "-- Wrong number of output samples: " << output.size() << endl;
+      nofFailedTests++;
+    } else {
+      int nofDifferences (0);
+      for (unsigned int t=0; t<TEST_NOF_TIMES/timeFactor; t++) {
+	for (unsigned int c=0; c<nofOutChannels; c++) {
+	  double sum (0);
+	  for (unsigned int i=0; i<timeFactor; i++) {
+	    for (unsigned int j=0; j<channelFactor; j++) {
+	      sum += input[(t*timeFactor+i)*TEST_NOF_CHANNELS + c*channelFactor+j];
+	    }
+	  }
+	  if (fabs (output[t*nofOutChannels+c] - sum/(timeFactor*channelFactor)) > 1e-5) {
+	    nofDifferences++;
+	  }
+	}
+      }
+      if (nofDifferences) {
+	cerr << "-- " << nofDifferences << " averages differ from the reference" << endl;
+	nofFailedTests++;
+      }
+    }
+  }
+
+  return nofFailedTests;
+}
+
+//_______________________________________________________________________________
+//                                                               test_dedispersion
+
+/*!
+  \brief Test DAL::DedispersionStage
+
+  A pulse dispersed according to the delays of the stage has to come out at the
+  same time sample in all channels.
+
+  \return nofFailedTests -- The number of failed tests encountered within this
+          function
+*/
+int test_dedispersion ()
+{
+  cout << "\n[tProcessingStage::test_dedispersion]\n" << endl;
+
+  int nofFailedTests (0);
+  std::vector<double> frequencies (TEST_NOF_CHANNELS);
+  double sampleTime (1e-3);
+  double dm (3);
+  unsigned int pulseTime (100);
+
+  for (unsigned int c=0; c<TEST_NOF_CHANNELS; c++) {
+    frequencies[c] = 120e6 + c*0.5e6;
+  }
+
+  cout << "[1] Dispersion delays ..." << endl;
+  {
+    DAL::DedispersionStage<float> stage (frequencies, sampleTime, dm);
+    double expected = DAL_DISPERSION_CONSTANT*dm*(1/(120.0*120.0) - 1/(127.5*127.5));
+
+    cout << "-- Maximum delay = " << stage.maxDelay() << " samples" << endl;
+    if (fabs (DAL::dispersionDelay (dm, 120e6, 127.5e6) - expected) > 1e-9
+	|| stage.maxDelay() != (unsigned int)floor (expected/sampleTime + 0.5)
+	|| stage.delay(TEST_NOF_CHANNELS-1) != 0) {
+      cerr << "-- Wrong dispersion delays" << endl;
+      nofFailedTests++;
+    }
+  }
+
+  cout << "[2] Dedisperse a pulse in blocks of random length ..." << endl;
+  {
+    DAL::DedispersionStage<float> stage (frequencies, sampleTime, dm);
+    std::vector<float> input (TEST_NOF_TIMES*TEST_NOF_CHANNELS, 0);
+
+    for (unsigned int c=0; c<TEST_NOF_CHANNELS; c++) {
+      input[(pulseTime + stage.delay(c))*TEST_NOF_CHANNELS + c] = 1;
+    }
+
+    std::vector<float> output = runBlockwise (stage, input, 50);
+    unsigned int arrival = pulseTime + stage.maxDelay();
+    int nofDifferences (0);
+
+    if (output.size() != input.size()) {
+      cerr << "-- Wrong number of output samples: " << output.size() << endl;
+      nofFailedTests++;
+    } else {
+      for (unsigned int t=0; t<TEST_NOF_TIMES; t++) {
+	for (unsigned int c=0; c<TEST_NOF_CHANNELS; c++) {
+	  float expected = (t == arrival) ? 1 : 0;
+	  if (output[t*TEST_NOF_CHANNELS+c] != expected) {
+	    nofDifferences++;
+	  }
+	}
+      }
+      if (nofDifferences) {
+	cerr << "-- Pulse not aligned in " << nofDifferences << " samples" << endl;
+	nofFailedTests++;
+      }
+    }
+  }
+
+  cout << "[3] Pass the stream through for zero dispersion measure ..." << endl;
+  {
+    DAL::DedispersionStage<float> stage (frequencies, sampleTime, 0);
+    std::vector<float> input (TEST_NOF_TIMES*TEST_NOF_CHANNELS);
+
+    for (unsigned int n=0; n<input.size(); n++) {
+      input[n] = n;
+    }
+
+    std::vector<float> output = runBlockwise (stage, input, 50);
+
+    if (stage.maxDelay() != 0 || output != input) {
+      cerr << "-- Stream modified without any delay" << endl;
+      nofFailedTests++;
+    }
+  }
+
+  return nofFailedTests;
+}
+
+//_______________________________________________________________________________
+//                                                                   test_bandpass
+
+/*!
+  \brief Test DAL::BandpassStage
+
+  \return nofFailedTests -- The number of failed tests encountered within this
+          function
+*/
+int test_bandpass ()
+{
+  cout << "\n[tProcessingStage::test_bandpass]\n" << endl;
+
+  int nofFailedTests (0);
+  std::vector<float> input (TEST_NOF_TIMES*TEST_NOF_CHANNELS);
+  std::vector<float> output (input.size());
+
+  fillRandom (input);
+  for (unsigned int t=0; t<TEST_NOF_TIMES; t++) {
+    for (unsigned int c=0; c<TEST_NOF_CHANNELS; c++) {
+      input[t*TEST_NOF_CHANNELS+c] = 100*(c+1) + (c+1)*input[t*TEST_NOF_CHANNELS+c];
+    }
+  }
+
+  cout << "[1] Normalize a single block ..." << endl;
+  {
+    DAL::BandpassStage<float> stage (TEST_NOF_CHANNELS);
+    stage.process (&input[0], TEST_NOF_TIMES, &output[0]);
+
+    for (unsigned int c=0; c<TEST_NOF_CHANNELS; c++) {
+      double sum (0), sum2 (0);
+      for (unsigned int t=0; t<TEST_NOF_TIMES; t++) {
+	sum  += output[t*TEST_NOF_CHANNELS+c];
+	sum2 += output[t*TEST_NOF_CHANNELS+c]*output[t*TEST_NOF_CHANNELS+c];
+      }
+      double mean = sum/TEST_NOF_TIMES;
+      double rms  = sqrt (sum2/TEST_NOF_TIMES - mean*mean);
+      if (fabs (mean) > 1e-3 || fabs (rms-1) > 1e-3) {
+	cerr << "-- Channel " << c << " not normalized: mean " << mean
+	     << ", rms " << rms << endl;
+	nofFailedTests++;
+      }
+    }
+  }
+
+  return nofFailedTests;
+}
+
+//_______________________________________________________________________________
+//                                                                      test_chain
+
+/*!
+  \brief Test DAL::ProcessingChain
+
+  \return nofFailedTests -- The number of failed tests encountered within this
+          function
+*/
+int test_chain ()
+{
+  cout << "\n[tProcessingStage::test_chain]\n" << endl;
+
+  int nofFailedTests (0);
+  std::vector<double> frequencies (TEST_NOF_CHANNELS);
+  std::vector<float> input (TEST_NOF_TIMES*TEST_NOF_CHANNELS);
+
+  fillRandom (input);
+  for (unsigned int c=0; c<TEST_NOF_CHANNELS; c++) {
+    frequencies[c] = 120e6 + c*0.5e6;
+  }
+
+  cout << "[1] Compare a chain with the separate stages ..." << endl;
+  {
+    DAL::ProcessingChain<float> chain (TEST_NOF_CHANNELS);
+    DAL::DedispersionStage<float> dedispersion (frequencies, 1e-3, 10);
+    DAL::AveragingStage<float> averaging (TEST_NOF_CHANNELS, 4, 2);
+
+    if (!chain.add (new DAL::DedispersionStage<float> (frequencies, 1e-3, 10))
+	|| !chain.add (new DAL::AveragingStage<float> (TEST_NOF_CHANNELS, 4, 2))) {
+      cerr << "-- Failed to add the stages" << endl;
+      nofFailedTests++;
+    }
+    if (chain.add (new DAL::BandpassStage<float> (TEST_NOF_CHANNELS))) {
+      cerr << "-- Stage with the wrong number of channels was accepted" << endl;
+      nofFailedTests++;
+    }
+
+    std::vector<float> dedispersed (input.size());
+    std::vector<float> reference (averaging.nofOutputTimes(TEST_NOF_TIMES) * averaging.nofOutputChannels());
+    dedispersion.process (&input[0], TEST_NOF_TIMES, &dedispersed[0]);
+    averaging.process (&dedispersed[0], TEST_NOF_TIMES, &reference[0]);
+
+    uint64_t nofTimes (0);
+    float const *result = chain.process (&input[0], TEST_NOF_TIMES, nofTimes);
+
+    if (chain.nofStages() != 2
+	|| chain.nofOutputChannels() != TEST_NOF_CHANNELS/2
+	|| nofTimes*chain.nofOutputChannels() != reference.size()) {
+      cerr << "-- Wrong shape of the result" << endl;
+      nofFailedTests++;
+    } else {
+      for (unsigned int n=0; n<reference.size(); n++) {
+	if (result[n] != reference[n]) {
+	  cerr << "-- Result differs from the separate stages" << endl;
+	  nofFailedTests++;
+	  break;
+	}
+      }
+    }
+  }
+
+  return nofFailedTests;
+}
+
+//_______________________________________________________________________________
+//                                                                            main
+
+/*!
+  \brief Main routine of the test program
+
+  \return nofFailedTests -- The number of failed tests encountered within and
+          identified by this test program.
+*/
+int main ()
+{
+  int nofFailedTests (0);
+
+  srand (42);
+
+  nofFailedTests += test_averaging ();
+  nofFailedTests += test_dedispersion ();
+  nofFailedTests += test_bandpass ();
+  nofFailedTests += test_chain ();
+
+  return nofFailedTests;
+}
@@ -0,0 +1,213 @@
+/***************************************************************************
+ *   Copyright (C) 2026                                                    *
+ *   agent <agent@local>                                                   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include <data_hl/TBBraw.h>
+#include <data_hl/TBB_BlockIterator.h>
+
+// Namespace usage
+using std::cerr;
+using std::cout;
+using std::endl;
+using DAL::TBB_BlockIterator;
+using DAL::TBB_Timeseries;
+
+/*!
+  \file tTBB_BlockIterator.cc
+
+  \ingroup DAL
+  \ingroup data_hl
+
+  \brief A collection of test routines for the DAL::TBB_BlockIterator class
+
+  \author agent
+
+  \date 2026/10/16
+
+  The test file is written by TBBraw: the dipoles start recording one frame
+  after the other, and every sample holds the number of the frame it was
+  recorded in, so the expected value of each sample on the aligned time axis
+  is known.
+*/
+
+//! Number of samples in a single transient data frame
+#define TEST_SAMPLES_PER_FRAME 1024
+//! Number of dipoles in the test file
+#define TEST_NOF_DIPOLES 3
+//! Number of frames recorded per dipole
+#define TEST_NOF_FRAMES 20
+
+//! Layout of the header of a TBB data frame, as sent by the boards
+struct TestFrameHeader
+{
+  unsigned char stationid;
+  unsigned char rspid;
+  unsigned char rcuid;
+  unsigned char sample_freq;
+  uint32_t seqnr;
+  int32_t time;
+  uint32_t sample_nr;
+  uint16_t n_samples_per_frame;
+  uint16_t n_freq_bands;
+  char bandsel[64];
+  int16_t spare;
+  uint16_t crc;
+};
+
+//_______________________________________________________________________________
+//                                                                     createFile
+
+/*!
+  \brief Write the test file; dipole \e n records frames \e n to
+         <tt>n+TEST_NOF_FRAMES-1</tt>
+
+  \param filename -- Name of the file to write
+*/
+void createFile (std::string const &filename)
+{
+  char buffer[TBB_FRAME_SIZE];
+
+  remove (filename.c_str());
+
+  DAL::TBBraw tbb (filename);
+  tbb.doHeaderCRC (false);
+  tbb.setFixTimes (0);
+
+  for (int frameNr=0; frameNr<TEST_NOF_FRAMES+TEST_NOF_DIPOLES; frameNr++) {
+    for (int rcu=0; rcu<TEST_NOF_DIPOLES; rcu++) {
+      if (frameNr < rcu || frameNr >= rcu+TEST_NOF_FRAMES) {
+	continue;
+      }
+      memset (buffer, 0, TBB_FRAME_SIZE);
+      TestFrameHeader *header     = (TestFrameHeader*)buffer;
+      header->stationid           = 1;
+      header->rcuid               = rcu;
+      header->sample_freq         = 200;
+      header->seqnr               = frameNr;
+      header->time                = 1000000000;
+      header->sample_nr           = frameNr*TEST_SAMPLES_PER_FRAME;
+      header->n_samples_per_frame = TEST_SAMPLES_PER_FRAME;
+      short *samples = (short*)(buffer+sizeof(TestFrameHeader));
+      for (int n=0; n<TEST_SAMPLES_PER_FRAME; n++) {
+	samples[n] = frameNr;
+      }
+      tbb.processTBBrawBlock (buffer, TBB_FRAME_SIZE);
+    }
+  }
+}
+
+//_______________________________________________________________________________
+//                                                                 test_iteration
+
+/*!
+  \brief Iterate over the aligned time axis with various block sizes and
+         numbers of buffers
+
+  \param filename -- Name of the test file
+
+  \return nofFailedTests -- The number of failed tests encountered within this
+          function.
+*/
+int test_iteration (std::string const &filename)
+{
+  cout << "\n[tTBB_BlockIterator::test_iteration]\n" << endl;
+
+  int nofFailedTests (0);
+  TBB_Timeseries ts (filename);
+  int refAntenna (TEST_NOF_DIPOLES-1);
+  unsigned int nofSamples (TEST_NOF_FRAMES*TEST_SAMPLES_PER_FRAME);
+  int blocksizes[3] = { 1000, 4096, 65536 };
+  int nofBuffers[3] = { 1, 2, 3 };
+
+  /* The last dipole starts recording last and is the reference antenna */
+  std::vector<int> offset (TEST_NOF_DIPOLES);
+  for (int n=0; n<TEST_NOF_DIPOLES; n++) {
+    offset[n] = (n-refAntenna)*TEST_SAMPLES_PER_FRAME;
+  }
+
+  for (int b=0; b<3; b++) {
+    cout << "[" << b+1 << "] Block size " << blocksizes[b] << ", "
+	 << nofBuffers[b] << " buffer(s) ..." << endl;
+
+    TBB_BlockIterator block (ts, offset, nofSamples, blocksizes[b], nofBuffers[b]);
+    block.summary();
+
+    int nofBlocks (0);
+    while (block.next()) {
+      ++nofBlocks;
+      for (unsigned int dipole=0; dipole<block.nofDipoles(); dipole++) {
+	float const *data = block.data(dipole);
+	for (int n=0; n<block.blocksize(); n++) {
+	  long long sample = block.blockStart()+n;
+	  int frameNr      = sample/TEST_SAMPLES_PER_FRAME + refAntenna;
+	  float expected   = (sample >= nofSamples
+			      || frameNr >= int(dipole)+TEST_NOF_FRAMES) ? 0 : frameNr;
+	  if (data[n] != expected) {
+	    cerr << "-- Wrong value in block " << block.block() << ", dipole "
+		 << dipole << ", sample " << n << " : " << data[n]
+		 << " instead of " << expected << endl;
+	    nofFailedTests++;
+	    break;
+	  }
+	}
+      }
+    }
+
+    if (nofBlocks != block.nofBlocks() || block.block() != block.nofBlocks()) {
+      cerr << "-- Iterated over " << nofBlocks << " of " << block.nofBlocks()
+	   << " blocks" << endl;
+      nofFailedTests++;
+    }
+  }
+
+  cout << "[4] Stop iterating half-way ..." << endl;
+  {
+    TBB_BlockIterator block (ts, offset, nofSamples, 1024, 3);
+    for (int n=0; n<block.nofBlocks()/2; n++) {
+      block.next();
+    }
+  }
+
+  cout << "[5] Reject wrong number of offsets ..." << endl;
+  {
+    TBB_BlockIterator block (ts, std::vector<int>(1,0), nofSamples, 1024);
+    if (block.nofBlocks() != 0 || block.next()) {
+      cerr << "-- Accepted wrong number of offsets" << endl;
+      nofFailedTests++;
+    }
+  }
+
+  return nofFailedTests;
+}
+
+//_______________________________________________________________________________
+//                                                                           main
+
+int main ()
+{
+  int nofFailedTests (0);
+  std::string filename ("tTBB_BlockIterator.h5");
+
+  // Write the test file
+  createFile (filename);
+  // Test iterating over the blocks of data
+  nofFailedTests += test_iteration (filename);
+
+  return nofFailedTests;
+}
@@ -79,6 +79,83 @@ int test_constructors (hid_t const &fileID)
   return nofFailedTests;
 }
 
+//_______________________________________________________________________________
+//                                                                  test_dataView
+
+/*!
+  \brief Test read-only access to the samples through dataView()
+
+  \param fileID          -- HDF5 object identifier for the file.
+  \return nofFailedTests -- The number of failed tests encountered within this
+          function.
+*/
+int test_dataView (hid_t const &fileID)
+{
+  cout << "\n[tTBB_DipoleDataset::test_dataView]\n" << endl;
+
+  int nofFailedTests = 0;
+  hsize_t nofSamples = 100000;
+  hsize_t chunk      = 4096;
+  int blocksize      = 1024;
+  std::string names[2] = { "Contiguous", "Chunked" };
+  std::vector<short> samples (nofSamples);
+  std::vector<short> buffer (blocksize);
+
+  for (hsize_t n=0; n<nofSamples; ++n) {
+    samples[n] = short(n%4096)-2048;
+  }
+
+  /* Write the same samples into a contiguous and a compressed dataset */
+  for (int n=0; n<2; ++n) {
+    hid_t dataspace = H5Screate_simple (1, &nofSamples, NULL);
+    hid_t plist     = H5Pcreate (H5P_DATASET_CREATE);
+    if (n == 1) {
+      H5Pset_chunk (plist, 1, &chunk);
+      H5Pset_deflate (plist, 1);
+    }
+    hid_t dataset = H5Dcreate (fileID, names[n].c_str(), H5T_NATIVE_SHORT,
+			       dataspace, H5P_DEFAULT, plist, H5P_DEFAULT);
+    H5Dwrite (dataset, H5T_NATIVE_SHORT, H5S_ALL, H5S_ALL, H5P_DEFAULT, &samples[0]);
+    H5Dclose (dataset);
+    H5Pclose (plist);
+    H5Sclose (dataspace);
+  }
+  H5Fflush (fileID, H5F_SCOPE_GLOBAL);
+
+  for (int n=0; n<2; ++n) {
+    cout << "[" << n+1 << "] Random access to the " << names[n]
+	 << " dataset ..." << endl;
+    TBB_DipoleDataset dataset (fileID, names[n]);
+    int starts[5] = { 0, 12345, int(nofSamples)-blocksize, -10, int(nofSamples)-10 };
+
+    for (int k=0; k<5; ++k) {
+      short const *data = dataset.dataView (starts[k], blocksize, &buffer[0]);
+      if (data == NULL) {
+	cerr << "-- No data for start " << starts[k] << endl;
+	nofFailedTests++;
+	continue;
+      }
+      for (int s=0; s<blocksize; ++s) {
+	int sample     = starts[k]+s;
+	short expected = (sample<0 || sample>=int(nofSamples)) ? 0 : samples[sample];
+	if (data[s] != expected) {
+	  cerr << "-- Wrong value for start " << starts[k] << ", sample " << s << endl;
+	  nofFailedTests++;
+	  break;
+	}
+      }
+    }
+
+    cout << "-- Samples mapped into memory = " << dataset.isMapped() << endl;
+    if (dataset.isMapped() != (n == 0)) {
+      cerr << "-- Only the contiguous dataset should be mapped" << endl;
+      nofFailedTests++;
+    }
+  }
+
+  return nofFailedTests;
+}
+
 //_______________________________________________________________________________
 //                                                              test_constructors
 
@@ -450,6 +527,8 @@ int main (int argc, char *argv[])
     
     // Test for the constructor(s)
     nofFailedTests += test_constructors (fileID);
+    // Test read-only access to the data
+    nofFailedTests += test_dataView (fileID);
     
     if (haveDataset) {
       // Test for the constructor(s)
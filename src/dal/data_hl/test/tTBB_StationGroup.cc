@@ -36,6 +36,7 @@
 using std::cerr;
 using std::cout;
 using std::endl;
+using DAL::TBB_DipoleDataset;
 using DAL::TBB_StationGroup;
 
 /*!
@@ -138,6 +139,295 @@ int test_constructors ()
   return nofFailedTests;
 }
 
+//_______________________________________________________________________________
+//                                                               test_lazyOpening
+
+/*!
+  \brief Test opening of the dipole datasets on first access
+
+  \return nofFailedTests -- The number of failed tests.
+*/
+int test_lazyOpening ()
+{
+  cout << "\n[tTBB_StationGroup::test_lazyOpening]\n" << endl;
+
+  int nofFailedTests (0);
+  hid_t fileID;
+  hid_t groupID;
+  herr_t h5error;
+  unsigned int stationID (1);
+  unsigned int nofDipoles (5);
+  std::string filename ("tTBB_StationGroup_lazy.h5");
+  std::string groupname = TBB_StationGroup::getName (stationID);
+  std::vector<hsize_t> shape (1,1024);
+
+  // Create HDF5 file with a station group and its dipoles _
+
+  fileID = H5Fcreate (filename.c_str(),
+		      H5F_ACC_TRUNC,
+		      H5P_DEFAULT,
+		      H5P_DEFAULT);
+  
+  if (fileID < 0) {
+    std::cerr << "ERROR : Failed to open/create file." << endl;
+    return -1;
+  }
+
+  groupID = H5Gcreate (fileID,
+		       groupname.c_str(),
+		       H5P_DEFAULT,
+		       H5P_DEFAULT,
+		       H5P_DEFAULT);
+
+  for (unsigned int rcu(0); rcu<nofDipoles; ++rcu) {
+    std::string name = TBB_DipoleDataset::dipoleName (stationID, 0, rcu);
+    hid_t spaceID    = H5Screate_simple (1, &shape[0], NULL);
+    hid_t datasetID  = H5Dcreate (groupID,
+				  name.c_str(),
+				  H5T_NATIVE_SHORT,
+				  spaceID,
+				  H5P_DEFAULT,
+				  H5P_DEFAULT,
+				  H5P_DEFAULT);
+    DAL::HDF5Attribute::write (datasetID, "RCU_ID", rcu);
+    h5error = H5Dclose (datasetID);
+    if (h5error >= 0) {
+      h5error = H5Sclose (spaceID);
+    }
+    if (h5error < 0) {
+      std::cerr << "ERROR : Failed to create dipole dataset " << name << endl;
+      H5Fclose (fileID);
+      return -1;
+    }
+  }
+
+  h5error = H5Gclose (groupID);
+
+  if (h5error < 0) {
+    std::cerr << "ERROR : Failed to create station group." << endl;
+    H5Fclose (fileID);
+    return -1;
+  }
+
+  cout << "[1] Opening the station group ..." << endl;
+  try {
+    TBB_StationGroup group (fileID, groupname);
+    //
+    cout << "-- nof. dipole datasets = " << group.nofDipoleDatasets() << endl;
+    cout << "-- nof. open datasets   = " << group.nofOpenDatasets()   << endl;
+    //
+    if (group.nofDipoleDatasets() != nofDipoles || group.nofOpenDatasets() != 0) {
+      nofFailedTests++;
+    }
+  }
+  catch (std::string message) {
+    cerr << message << endl;
+    nofFailedTests++;
+  }
+
+  cout << "[2] Selecting dipoles by name ..." << endl;
+  try {
+    TBB_StationGroup group (fileID, groupname);
+    std::vector<std::string> names = group.dipoleNames();
+    std::set<std::string> selection;
+    //
+    if (names.size() == nofDipoles) {
+      selection.insert (names[1]);
+      selection.insert (names[3]);
+    }
+    group.selectDipoles (selection);
+    //
+    cout << "-- Dipole names       = " << names                   << endl;
+    cout << "-- Selected dipoles   = " << group.selectedDipoles() << endl;
+    cout << "-- nof. open datasets = " << group.nofOpenDatasets() << endl;
+    //
+    if (group.nofSelectedDatasets() != 2 || group.nofOpenDatasets() != 0) {
+      nofFailedTests++;
+    }
+  }
+  catch (std::string message) {
+    cerr << message << endl;
+    nofFailedTests++;
+  }
+
+  cout << "[3] Limiting the number of open datasets ..." << endl;
+  try {
+    TBB_StationGroup group (fileID, groupname);
+    std::vector<uint> rcu;
+    //
+    group.setMaxOpenDatasets (2);
+    group.getAttributes ("RCU_ID", rcu);
+    //
+    cout << "-- RCU_ID               = " << rcu                     << endl;
+    cout << "-- max. open datasets   = " << group.maxOpenDatasets() << endl;
+    cout << "-- nof. open datasets   = " << group.nofOpenDatasets() << endl;
+    //
+    if (rcu.size() != nofDipoles || rcu[nofDipoles-1] != nofDipoles-1
+	|| group.nofOpenDatasets() != 2) {
+      nofFailedTests++;
+    }
+  }
+  catch (std::string message) {
+    cerr << message << endl;
+    nofFailedTests++;
+  }
+
+  // release HDF5 object identifiers _______________________
+
+  h5error = H5Fclose (fileID);
+
+  if (h5error < 0) {
+    std::cerr << "ERROR : Failed to close file." << endl;
+    nofFailedTests++;
+  }
+  
+  return nofFailedTests;
+}
+
+//_______________________________________________________________________________
+//                                                                      test_copy
+
+/*!
+  \brief Test copying a station group of a file opened with the core driver
+
+  The file only exists in memory, such that a copy can only be set up from the
+  file handle of the original object, not by reopening the file by name.
+
+  \return nofFailedTests -- The number of failed tests.
+*/
+int test_copy ()
+{
+  cout << "\n[tTBB_StationGroup::test_copy]\n" << endl;
+
+  int nofFailedTests (0);
+  hid_t fileID;
+  hid_t groupID;
+  hid_t accessID;
+  herr_t h5error;
+  unsigned int stationID (1);
+  unsigned int nofDipoles (3);
+  std::string filename ("tTBB_StationGroup_core.h5");
+  std::string groupname = TBB_StationGroup::getName (stationID);
+  std::vector<hsize_t> shape (1,1024);
+
+  // Create in-memory HDF5 file with a station group _______
+
+  accessID = H5Pcreate (H5P_FILE_ACCESS);
+  H5Pset_fapl_core (accessID, 1024*1024, 0);
+  fileID = H5Fcreate (filename.c_str(),
+		      H5F_ACC_TRUNC,
+		      H5P_DEFAULT,
+		      accessID);
+  H5Pclose (accessID);
+
+  if (fileID < 0) {
+    std::cerr << "ERROR : Failed to create file." << endl;
+    return -1;
+  }
+
+  groupID = H5Gcreate (fileID,
+		       groupname.c_str(),
+		       H5P_DEFAULT,
+		       H5P_DEFAULT,
+		       H5P_DEFAULT);
+
+  for (unsigned int rcu(0); rcu<nofDipoles; ++rcu) {
+    std::string name = TBB_DipoleDataset::dipoleName (stationID, 0, rcu);
+    hid_t spaceID    = H5Screate_simple (1, &shape[0], NULL);
+    hid_t datasetID  = H5Dcreate (groupID,
+				  name.c_str(),
+				  H5T_NATIVE_SHORT,
+				  spaceID,
+				  H5P_DEFAULT,
+				  H5P_DEFAULT,
+				  H5P_DEFAULT);
+    DAL::HDF5Attribute::write (datasetID, "RCU_ID", rcu);
+    H5Dclose (datasetID);
+    H5Sclose (spaceID);
+  }
+
+  h5error = H5Gclose (groupID);
+
+  if (h5error < 0) {
+    std::cerr << "ERROR : Failed to create station group." << endl;
+    H5Fclose (fileID);
+    return -1;
+  }
+
+  cout << "[1] Construction from the group identifier ..." << endl;
+  try {
+    TBB_StationGroup group (fileID, groupname);
+    TBB_StationGroup groupFromID (group.locationID());
+    std::vector<uint> rcu;
+    //
+    groupFromID.getAttributes ("RCU_ID", rcu);
+    //
+    cout << "-- nof. dipole datasets = " << groupFromID.nofDipoleDatasets() << endl;
+    cout << "-- RCU_ID               = " << rcu                             << endl;
+    //
+    if (groupFromID.nofDipoleDatasets() != nofDipoles
+	|| rcu.size() != nofDipoles || rcu[nofDipoles-1] != nofDipoles-1) {
+      nofFailedTests++;
+    }
+  }
+  catch (std::string message) {
+    cerr << message << endl;
+    nofFailedTests++;
+  }
+
+  cout << "[2] Testing copy operator ..." << endl;
+  try {
+    TBB_StationGroup group (fileID, groupname);
+    TBB_StationGroup groupCopy;
+    //
+    groupCopy = group;
+    //
+    cout << "-- nof. dipole datasets = " << groupCopy.nofDipoleDatasets() << endl;
+    //
+    if (groupCopy.nofDipoleDatasets() != nofDipoles) {
+      nofFailedTests++;
+    }
+  }
+  catch (std::string message) {
+    cerr << message << endl;
+    nofFailedTests++;
+  }
+
+  cout << "[3] Testing copy operator of a dipole dataset ..." << endl;
+  try {
+    std::string name = TBB_DipoleDataset::dipoleName (stationID, 0, 1);
+    hid_t stationGroupID = H5Gopen (fileID, groupname.c_str(), H5P_DEFAULT);
+    TBB_DipoleDataset dipole (stationGroupID, name);
+    TBB_DipoleDataset dipoleCopy;
+    uint rcu (0);
+    //
+    dipoleCopy = dipole;
+    dipoleCopy.getAttribute ("RCU_ID", rcu);
+    //
+    cout << "-- RCU_ID               = " << rcu << endl;
+    //
+    if (rcu != 1) {
+      nofFailedTests++;
+    }
+    H5Gclose (stationGroupID);
+  }
+  catch (std::string message) {
+    cerr << message << endl;
+    nofFailedTests++;
+  }
+
+  // release HDF5 object identifiers _______________________
+
+  h5error = H5Fclose (fileID);
+
+  if (h5error < 0) {
+    std::cerr << "ERROR : Failed to close file." << endl;
+    nofFailedTests++;
+  }
+  
+  return nofFailedTests;
+}
+
 //_______________________________________________________________________________
 //                                                              test_constructors
 
@@ -742,6 +1032,8 @@ int main (int argc,
   // Run the tests
 
   nofFailedTests += test_constructors ();
+  nofFailedTests += test_lazyOpening ();
+  nofFailedTests += test_copy ();
 
   if (haveDataset) {
     // Test for the constructor(s)
@@ -31,6 +31,8 @@
 using std::cerr;
 using std::cout;
 using std::endl;
+using DAL::IO_Mode;
+using DAL::TBB_DipoleDataset;
 using DAL::TBB_Timeseries;
 
 /*!
@@ -142,6 +144,60 @@ int test_construction (std::string const &filename)
   return nofFailedTests;
 }
 
+//_______________________________________________________________________________
+//                                                               directAttributes
+
+/*!
+  \brief Read an attribute of the selected dipoles straight from the datasets
+
+  The dipole datasets are opened one by one, bypassing the attribute cache of
+  the TBB_Timeseries object.
+
+  \param ts     -- TBB_Timeseries object providing the dipole selection.
+  \param name   -- Name of the attribute.
+  \param values -- Values of the attribute, ordered as the selected dipoles.
+
+  \return status -- Returns \e false if the attribute could not be read from
+          one of the datasets.
+*/
+template <class T>
+bool directAttributes (TBB_Timeseries &ts,
+		       std::string const &name,
+		       std::vector<T> &values)
+{
+  bool status (true);
+  std::set<std::string> stations = ts.stationGroupNames();
+  std::set<std::string> dipoles  = ts.selectedDipoles();
+  std::set<std::string>::iterator station;
+  std::set<std::string>::iterator dipole;
+  std::map<std::string,T> direct;
+  T value;
+
+  for (station=stations.begin(); station!=stations.end(); ++station) {
+    hid_t groupID = H5Gopen (ts.locationID(), station->c_str(), H5P_DEFAULT);
+    for (dipole=dipoles.begin(); dipole!=dipoles.end(); ++dipole) {
+      if (H5Lexists (groupID, dipole->c_str(), H5P_DEFAULT) > 0) {
+	TBB_DipoleDataset dataset (groupID, *dipole, IO_Mode(IO_Mode::Open));
+	if (dataset.getAttribute (name, value)) {
+	  direct[*dipole] = value;
+	}
+      }
+    }
+    H5Gclose (groupID);
+  }
+
+  values.clear();
+  for (dipole=dipoles.begin(); dipole!=dipoles.end(); ++dipole) {
+    if (direct.find(*dipole) == direct.end()) {
+      status = false;
+    } else {
+      values.push_back (direct[*dipole]);
+    }
+  }
+
+  return status;
+}
+
 //_______________________________________________________________________________
 //                                                                test_attributes
 
@@ -221,6 +277,71 @@ int test_attributes (std::string const &filename)
   }
 #endif
 
+  std::cout << "[3] Cached attributes of the dipole datasets ..." << endl;
+  try {
+    std::vector<uint> timeCached   = ts.time();
+    std::vector<uint> sampleCached = ts.sample_number();
+    std::vector<uint> timeDirect;
+    std::vector<uint> sampleDirect;
+    //
+    if (!directAttributes (ts, "TIME", timeDirect)
+	|| !directAttributes (ts, "SAMPLE_NUMBER", sampleDirect)) {
+      std::cerr << "-- Failed to read the attributes from the datasets" << endl;
+      nofFailedTests++;
+    }
+    //
+    cout << "-- TIME          = " << timeCached   << endl;
+    cout << "-- SAMPLE_NUMBER = " << sampleCached << endl;
+    //
+    if (timeCached.size() != ts.nofSelectedDatasets()
+	|| timeCached != timeDirect
+	|| sampleCached != sampleDirect) {
+      std::cerr << "-- Cached values do not match the attributes" << endl;
+      nofFailedTests++;
+    }
+  }
+  catch (std::string message) {
+    std::cerr << message << endl;
+    nofFailedTests++;
+  }
+
+#ifdef DAL_WITH_CASA
+  std::cout << "[4] Cache invalidated by set_cable_delay() ..." << endl;
+  try {
+    std::vector<double> delayOld = ts.cable_delay();
+    std::vector<std::string> unit = ts.cable_delay_unit();
+    std::set<std::string> dipoles = ts.selectedDipoles();
+    std::set<std::string>::iterator it;
+    std::map<std::string,casa::Quantity> delay;
+    std::vector<double> delayCached;
+    std::vector<double> delayDirect;
+    unsigned int n (0);
+    //
+    for (it=dipoles.begin(); it!=dipoles.end(); ++it, ++n) {
+      delay[*it] = casa::Quantity (delayOld[n]+1, unit[n]);
+    }
+    ts.set_cable_delay (delay);
+    delayCached = ts.cable_delay();
+    directAttributes (ts, "CABLE_DELAY_VALUE", delayDirect);
+    //
+    cout << "-- CABLE_DELAY_VALUE = " << delayCached << endl;
+    //
+    if (delayCached != delayDirect || delayCached == delayOld) {
+      std::cerr << "-- Cached values not updated after writing" << endl;
+      nofFailedTests++;
+    }
+    /* Restore the original values */
+    for (it=dipoles.begin(), n=0; it!=dipoles.end(); ++it, ++n) {
+      delay[*it] = casa::Quantity (delayOld[n], unit[n]);
+    }
+    ts.set_cable_delay (delay);
+  }
+  catch (std::string message) {
+    std::cerr << message << endl;
+    nofFailedTests++;
+  }
+#endif
+
   return nofFailedTests;
 }
 
@@ -308,6 +429,84 @@ int test_methods (std::string const &filename)
   return nofFailedTests;
 }
 
+//_______________________________________________________________________________
+//                                                                 test_readBlock
+
+/*!
+  \brief Test reading blocks of data for all selected dipoles into one buffer
+
+  \param filename -- Name of the HDF5 file used for testing
+
+  \return nofFailedTests -- The number of failed tests.
+*/
+int test_readBlock (std::string const &filename)
+{
+  cout << "\n[tTBB_Timeseries::test_readBlock]\n" << endl;
+
+  int nofFailedTests = 0;
+  int nofSamples     = 1024;
+  TBB_Timeseries ts (filename);
+  uint nofDipoles    = ts.nofSelectedDatasets();
+  std::vector<short> dataShort (nofDipoles*nofSamples);
+  std::vector<float> dataFloat (nofDipoles*nofSamples);
+
+  cout << "[1] Read consecutive blocks as short and float ..." << endl;
+  for (int start=0; start<4*nofSamples; start+=nofSamples) {
+    if (!ts.readData (&dataShort[0], start, nofSamples) ||
+	!ts.readData (&dataFloat[0], start, nofSamples)) {
+      cerr << "-- Failed to read block starting at " << start << endl;
+      ++nofFailedTests;
+    }
+    for (uint n=0; n<dataShort.size(); ++n) {
+      if (float(dataShort[n]) != dataFloat[n]) {
+	cerr << "-- Mismatch between short and float data at dipole "
+	     << n/nofSamples << ", sample " << n%nofSamples << endl;
+	++nofFailedTests;
+	break;
+      }
+    }
+  }
+
+  cout << "[2] Read block with individual start positions ..." << endl;
+  {
+    std::vector<int> start (nofDipoles);
+    for (uint n=0; n<nofDipoles; ++n) {
+      start[n] = n;
+    }
+    if (!ts.readData (&dataFloat[0], start, nofSamples)) {
+      cerr << "-- Failed to read block" << endl;
+      ++nofFailedTests;
+    }
+    /* The wrong number of start positions has to be rejected */
+    start.push_back (0);
+    if (ts.readData (&dataFloat[0], start, nofSamples)) {
+      cerr << "-- Accepted wrong number of start positions" << endl;
+      ++nofFailedTests;
+    }
+  }
+
+  cout << "[3] Read block partially before the start of the data ..." << endl;
+  {
+    int offset = 100;
+    std::vector<short> reference (dataShort);
+    ts.readData (&reference[0], 0, nofSamples);
+    ts.readData (&dataShort[0], -offset, nofSamples);
+    for (uint dipole=0; dipole<nofDipoles; ++dipole) {
+      short *data = &dataShort[dipole*nofSamples];
+      short *ref  = &reference[dipole*nofSamples];
+      for (int n=0; n<nofSamples; ++n) {
+	if (data[n] != (n<offset ? 0 : ref[n-offset])) {
+	  cerr << "-- Wrong value at dipole " << dipole << ", sample " << n << endl;
+	  ++nofFailedTests;
+	  break;
+	}
+      }
+    }
+  }
+
+  return nofFailedTests;
+}
+
 //_______________________________________________________________________________
 //                                                                      test_data
 
@@ -431,6 +630,8 @@ int main (int argc,
     nofFailedTests += test_parameters (filename);
     // Test test various methods provided by the class
     nofFailedTests += test_methods (filename);
+    // Test reading blocks of data for all selected dipoles
+    nofFailedTests += test_readBlock (filename);
 #ifdef DAL_WITH_CASACORE
     // Test access to the data stored within the dipole datasets
     nofFailedTests += test_data (filename);
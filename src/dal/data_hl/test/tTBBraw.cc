@@ -0,0 +1,465 @@
+/***************************************************************************
+ *   Copyright (C) 2026                                                    *
+ *   agent <agent@local>                                                   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include <data_hl/TBBraw.h>
+
+// Namespace usage
+using std::endl;
+using DAL::TBBraw;
+
+/*!
+  \file tTBBraw.cc
+
+  \ingroup DAL
+  \ingroup data_hl
+
+  \brief A collection of test routines for the DAL::TBBraw class
+
+  \author agent
+
+  \date 2026/10/16
+*/
+
+//! Number of samples in a single transient data frame
+#define TEST_SAMPLES_PER_FRAME 1024
+
+//! Layout of the header of a TBB data frame, as sent by the boards
+struct TestFrameHeader
+{
+  unsigned char stationid;
+  unsigned char rspid;
+  unsigned char rcuid;
+  unsigned char sample_freq;
+  uint32_t seqnr;
+  int32_t time;
+  uint32_t sample_nr;
+  uint16_t n_samples_per_frame;
+  uint16_t n_freq_bands;
+  char bandsel[64];
+  int16_t spare;
+  uint16_t crc;
+};
+
+//_______________________________________________________________________________
+//                                                                    createFrame
+
+/*!
+  \brief Fill a buffer with a synthetic transient data frame
+
+  \param buffer   -- Buffer of (at least) TBB_FRAME_SIZE bytes
+  \param rcu      -- RCU number of the dipole
+  \param frameNr  -- Position of the frame in the data stream; the samples in
+         the frame are all set to this value.
+  \param station  -- Station number of the dipole
+  \param rsp      -- RSP number of the dipole
+*/
+void createFrame (char *buffer,
+		  unsigned char rcu,
+		  int frameNr,
+		  unsigned char station=1,
+		  unsigned char rsp=0)
+{
+  memset (buffer, 0, TBB_FRAME_SIZE);
+
+  TestFrameHeader *header     = (TestFrameHeader*)buffer;
+  header->stationid           = station;
+  header->rspid               = rsp;
+  header->rcuid               = rcu;
+  header->sample_freq         = 200;
+  header->seqnr               = frameNr;
+  header->time                = 1000000000;
+  header->sample_nr           = frameNr*TEST_SAMPLES_PER_FRAME;
+  header->n_samples_per_frame = TEST_SAMPLES_PER_FRAME;
+  header->n_freq_bands        = 0;
+
+  short *samples = (short*)(buffer+sizeof(TestFrameHeader));
+  for (int n=0; n<TEST_SAMPLES_PER_FRAME; n++) {
+    samples[n] = frameNr;
+  }
+}
+
+//_______________________________________________________________________________
+//                                                                      checkFile
+
+/*!
+  \brief Check the datasets of the two dipoles written by feedFrames()
+
+  \param filename  -- Name of the output file
+  \param nofFrames -- Number of frames fed per dipole
+
+  \return nofFailedTests -- The number of failed tests encountered within this
+          function.
+*/
+int checkFile (std::string const &filename,
+	       int nofFrames)
+{
+  int nofFailedTests (0);
+  hid_t fileID = H5Fopen (filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+  std::string names[2] = { "Station001/001000000", "Station001/001000001" };
+
+  for (int n=0; n<2; n++) {
+    hid_t datasetID  = H5Dopen (fileID, names[n].c_str(), H5P_DEFAULT);
+    hid_t dataspace  = H5Dget_space (datasetID);
+    hsize_t shape[1] = { 0 };
+    H5Sget_simple_extent_dims (dataspace, shape, NULL);
+
+    if (shape[0] != hsize_t(nofFrames*TEST_SAMPLES_PER_FRAME)) {
+      std::cerr << "-- Wrong shape of " << names[n] << " : " << shape[0] << endl;
+      nofFailedTests++;
+    } else {
+      std::vector<short> data (shape[0]);
+      H5Dread (datasetID, H5T_NATIVE_SHORT, H5S_ALL, H5S_ALL, H5P_DEFAULT, &data[0]);
+      for (int frameNr=0; frameNr<nofFrames; frameNr++) {
+        if (data[frameNr*TEST_SAMPLES_PER_FRAME] != frameNr ||
+            data[(frameNr+1)*TEST_SAMPLES_PER_FRAME-1] != frameNr) {
+          std::cerr << "-- Wrong data in " << names[n] << " frame " << frameNr << endl;
+          nofFailedTests++;
+        }
+      }
+    }
+
+    H5Sclose (dataspace);
+    H5Dclose (datasetID);
+  }
+
+  H5Fclose (fileID);
+
+  return nofFailedTests;
+}
+
+//_______________________________________________________________________________
+//                                                                     feedFrames
+
+/*!
+  \brief Feed frames of two dipoles into a TBBraw object
+
+  Frames of two dipoles are fed interleaved, including a gap in the stream of
+  the first dipole, which is filled by a frame arriving late.
+
+  \param tbb       -- Object to feed the frames to
+  \param nofFrames -- Number of frames per dipole
+
+  \return nofFailedTests -- The number of frames which were not accepted
+*/
+int feedFrames (TBBraw &tbb,
+		int nofFrames)
+{
+  int nofFailedTests (0);
+  char buffer[TBB_FRAME_SIZE];
+
+  for (int frameNr=0; frameNr<nofFrames; frameNr++) {
+    /* Leave a gap in the data of the first dipole ... */
+    if (frameNr != 12) {
+      createFrame (buffer, 0, frameNr);
+      if (!tbb.processTBBrawBlock (buffer, TBB_FRAME_SIZE)) {
+	std::cerr << "-- Failed to process frame " << frameNr << endl;
+	nofFailedTests++;
+      }
+    }
+    createFrame (buffer, 1, frameNr);
+    tbb.processTBBrawBlock (buffer, TBB_FRAME_SIZE);
+  }
+  /* ... and fill it in afterwards */
+  createFrame (buffer, 0, 12);
+  tbb.processTBBrawBlock (buffer, TBB_FRAME_SIZE);
+
+  return nofFailedTests;
+}
+
+//_______________________________________________________________________________
+//                                                              test_constructors
+
+/*!
+  \brief Test constructors for a new TBBraw object
+
+  \return nofFailedTests -- The number of failed tests encountered within this
+          function.
+*/
+int test_constructors ()
+{
+  std::cout << "\n[tTBBraw::test_constructors]\n" << endl;
+
+  int nofFailedTests (0);
+
+  std::cout << "[1] Testing default constructor ..." << endl;
+  try {
+    TBBraw tbb;
+    //
+    tbb.summary();
+  } catch (std::string message) {
+    std::cerr << message << std::endl;
+    nofFailedTests++;
+  }
+
+  return nofFailedTests;
+}
+
+//_______________________________________________________________________________
+//                                                                test_processing
+
+/*!
+  \brief Test processing of data frames into an output file
+
+  Frames of two dipoles are fed interleaved into the TBBraw object, including a
+  gap in the stream and a frame arriving late, which forces the write buffer
+  of the dipole to be written out before it is full.
+
+  \return nofFailedTests -- The number of failed tests encountered within this
+          function.
+*/
+int test_processing ()
+{
+  std::cout << "\n[tTBBraw::test_processing]\n" << endl;
+
+  int nofFailedTests (0);
+  std::string filename ("tTBBraw.h5");
+  int nofFrames (25);
+
+  remove (filename.c_str());
+
+  std::cout << "[1] Processing frames of two dipoles ..." << endl;
+  try {
+    TBBraw tbb (filename);
+    tbb.doHeaderCRC (false);
+    tbb.setFixTimes (0);
+    tbb.setWriteBufferSize (8);
+
+    nofFailedTests += feedFrames (tbb, nofFrames);
+
+    tbb.summary();
+  } catch (std::string message) {
+    std::cerr << message << std::endl;
+    nofFailedTests++;
+  }
+
+  std::cout << "[2] Checking contents of the output file ..." << endl;
+  nofFailedTests += checkFile (filename, nofFrames);
+
+  return nofFailedTests;
+}
+
+//_______________________________________________________________________________
+//                                                                  test_pipeline
+
+/*!
+  \brief Test processing of data frames by a pipeline of worker threads
+
+  \return nofFailedTests -- The number of failed tests encountered within this
+          function.
+*/
+int test_pipeline ()
+{
+  std::cout << "\n[tTBBraw::test_pipeline]\n" << endl;
+
+  int nofFailedTests (0);
+  std::string filename ("tTBBraw_pipeline.h5");
+  int nofFrames (25);
+
+  remove (filename.c_str());
+
+  std::cout << "[1] Processing frames with three worker threads ..." << endl;
+  try {
+    TBBraw tbb (filename);
+    tbb.doHeaderCRC (false);
+    tbb.setFixTimes (0);
+    tbb.setWriteBufferSize (8);
+    if (!tbb.startPipeline (3) || tbb.nofPipelineWorkers() != 3) {
+      std::cerr << "-- Failed to start the pipeline" << endl;
+      nofFailedTests++;
+    }
+
+    nofFailedTests += feedFrames (tbb, nofFrames);
+
+    if (!tbb.stopPipeline()) {
+      std::cerr << "-- Frames failed in the pipeline" << endl;
+      nofFailedTests++;
+    }
+    tbb.summary();
+  } catch (std::string message) {
+    std::cerr << message << std::endl;
+    nofFailedTests++;
+  }
+
+  std::cout << "[2] Checking contents of the output file ..." << endl;
+  nofFailedTests += checkFile (filename, nofFrames);
+
+  return nofFailedTests;
+}
+
+//_______________________________________________________________________________
+//                                                           test_storagePolicy
+
+/*!
+  \brief Test writing compressed dipole datasets
+
+  \return nofFailedTests -- The number of failed tests encountered within this
+          function.
+*/
+int test_storagePolicy ()
+{
+  std::cout << "\n[tTBBraw::test_storagePolicy]\n" << endl;
+
+  int nofFailedTests (0);
+  std::string filename ("tTBBraw_compact.h5");
+  int nofFrames (25);
+
+  remove (filename.c_str());
+
+  std::cout << "[1] Processing frames with the \"compact\" storage preset ..." << endl;
+  try {
+    TBBraw tbb (filename);
+    tbb.doHeaderCRC (false);
+    tbb.setFixTimes (0);
+    tbb.setWriteBufferSize (8);
+
+    DAL::HDF5StoragePolicy policy;
+    policy.setPreset ("compact");
+    policy.setChunkSize (4096);
+    tbb.setStoragePolicy (policy);
+
+    nofFailedTests += feedFrames (tbb, nofFrames);
+
+    tbb.summary();
+  } catch (std::string message) {
+    std::cerr << message << std::endl;
+    nofFailedTests++;
+  }
+
+  std::cout << "[2] Checking contents of the output file ..." << endl;
+  nofFailedTests += checkFile (filename, nofFrames);
+
+  std::cout << "[3] Checking the filters of the datasets ..." << endl;
+  {
+    hid_t fileID    = H5Fopen (filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+    hid_t datasetID = H5Dopen (fileID, "Station001/001000000", H5P_DEFAULT);
+    hid_t plist     = H5Dget_create_plist (datasetID);
+    hsize_t chunk[1] = { 0 };
+    H5Pget_chunk (plist, 1, chunk);
+    if (H5Pget_nfilters (plist) != 2 || chunk[0] != 4096) {
+      std::cerr << "-- Wrong storage layout: " << H5Pget_nfilters (plist)
+		<< " filters, chunks of " << chunk[0] << endl;
+      nofFailedTests++;
+    }
+    H5Pclose (plist);
+    H5Dclose (datasetID);
+    H5Fclose (fileID);
+  }
+
+  return nofFailedTests;
+}
+
+//_______________________________________________________________________________
+//                                                               test_manyDipoles
+
+/*!
+  \brief Test processing of data frames from more than 50 stations and 1000 dipoles
+
+  \return nofFailedTests -- The number of failed tests encountered within this
+          function.
+*/
+int test_manyDipoles ()
+{
+  std::cout << "\n[tTBBraw::test_manyDipoles]\n" << endl;
+
+  int nofFailedTests (0);
+  std::string filename ("tTBBraw_many.h5");
+  int nofStations (60);
+  int nofRSPs (3);
+  int nofRCUs (8);
+  char buffer[TBB_FRAME_SIZE];
+
+  remove (filename.c_str());
+
+  std::cout << "[1] Processing frames of " << nofStations*nofRSPs*nofRCUs
+	    << " dipoles ..." << endl;
+  try {
+    TBBraw tbb (filename);
+    tbb.doHeaderCRC (false);
+    tbb.setFixTimes (0);
+
+    for (int frameNr=0; frameNr<2; frameNr++) {
+      for (int station=0; station<nofStations; station++) {
+	for (int rsp=0; rsp<nofRSPs; rsp++) {
+	  for (int rcu=0; rcu<nofRCUs; rcu++) {
+	    createFrame (buffer, rcu, frameNr, 100+station, 10*rsp);
+	    if (!tbb.processTBBrawBlock (buffer, TBB_FRAME_SIZE)) {
+	      nofFailedTests++;
+	    }
+	  }
+	}
+      }
+    }
+    if (nofFailedTests > 0) {
+      std::cerr << "-- Failed to process " << nofFailedTests << " frames" << endl;
+    }
+  } catch (std::string message) {
+    std::cerr << message << std::endl;
+    nofFailedTests++;
+  }
+
+  std::cout << "[2] Checking contents of the output file ..." << endl;
+  {
+    hid_t fileID = H5Fopen (filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+    hsize_t nofGroups (0);
+    H5Gget_num_objs (fileID, &nofGroups);
+    if (nofGroups != hsize_t(nofStations)) {
+      std::cerr << "-- Wrong number of station groups : " << nofGroups << endl;
+      nofFailedTests++;
+    }
+    /* Check the last dipole of the last station */
+    char name[32];
+    sprintf (name, "Station%03d/%03d%03d%03d", 100+nofStations-1, 100+nofStations-1,
+	     10*(nofRSPs-1), nofRCUs-1);
+    hid_t datasetID  = H5Dopen (fileID, name, H5P_DEFAULT);
+    hid_t dataspace  = H5Dget_space (datasetID);
+    hsize_t shape[1] = { 0 };
+    H5Sget_simple_extent_dims (dataspace, shape, NULL);
+    if (shape[0] != hsize_t(2*TEST_SAMPLES_PER_FRAME)) {
+      std::cerr << "-- Wrong shape of " << name << " : " << shape[0] << endl;
+      nofFailedTests++;
+    }
+    H5Sclose (dataspace);
+    H5Dclose (datasetID);
+    H5Fclose (fileID);
+  }
+
+  return nofFailedTests;
+}
+
+//_______________________________________________________________________________
+//                                                                           main
+
+int main ()
+{
+  int nofFailedTests (0);
+
+  // Test for the constructor(s)
+  nofFailedTests += test_constructors ();
+  // Test processing of data frames
+  nofFailedTests += test_processing ();
+  // Test processing of data frames by worker threads
+  nofFailedTests += test_pipeline ();
+  // Test writing compressed datasets
+  nofFailedTests += test_storagePolicy ();
+  // Test processing of data frames of many stations and dipoles
+  nofFailedTests += test_manyDipoles ();
+
+  return nofFailedTests;
+}
@@ -0,0 +1,142 @@
+/***************************************************************************
+ *   Copyright (C) 2026                                                    *
+ *   agent <agent@local>                                                   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+/*!
+  \file pydal_ProcessingStage.cc
+
+  \ingroup DAL
+  \ingroup pydal
+
+  \brief Python bindings for the DAL::ProcessingChain class
+
+  \author agent
+
+  The chain is exported for single precision data, as written by bf2h5. Blocks
+  are passed as 2-dimensional arrays <tt>[time][channel]</tt>, and are
+  converted to \e float32 if necessary:
+
+  \code
+  chain = pydal.ProcessingChain (nofChannels)
+  chain.addDedispersion (frequencies, sampleTime, 26.8)
+  chain.addAveraging (16, 1)
+  for block in blocks:
+      result = chain.process (block)
+  \endcode
+*/
+
+// DAL headers
+#include "pydal.h"
+#include <data_hl/ProcessingStage.h>
+
+typedef DAL::ProcessingChain<float> ProcessingChain;
+
+// ==============================================================================
+//
+//                                                     Additional Python wrappers
+//
+// ==============================================================================
+
+//! Append a DAL::AveragingStage to the chain
+bool ProcessingChain_addAveraging (ProcessingChain &chain,
+				   unsigned int timeFactor,
+				   unsigned int channelFactor)
+{
+  return chain.add (new DAL::AveragingStage<float> (chain.nofOutputChannels(),
+						    timeFactor,
+						    channelFactor));
+}
+
+//! Append a DAL::DedispersionStage to the chain
+bool ProcessingChain_addDedispersion (ProcessingChain &chain,
+				      boost::python::object frequencies,
+				      double sampleTime,
+				      double dm)
+{
+  std::vector<double> freq (boost::python::len (frequencies));
+  for (unsigned int n = 0; n < freq.size(); ++n) {
+    freq[n] = boost::python::extract<double> (frequencies[n]);
+  }
+  return chain.add (new DAL::DedispersionStage<float> (freq, sampleTime, dm));
+}
+
+//! Append a DAL::BandpassStage to the chain
+bool ProcessingChain_addBandpass (ProcessingChain &chain)
+{
+  return chain.add (new DAL::BandpassStage<float> (chain.nofOutputChannels()));
+}
+
+//! Process the next block of the stream, <tt>[time][channel]</tt>
+boost::python::numeric::array ProcessingChain_process (ProcessingChain &chain,
+							boost::python::numeric::array data)
+{
+  num_util::check_rank (data, 2);
+  num_util::check_dim (data, 1, chain.nofChannels());
+
+  boost::python::numeric::array block = num_util::astype (data, PyArray_FLOAT);
+  /* The chain walks the block as [time][channel] in memory, so e.g. a
+     transposed or sliced array is processed through a C-ordered copy */
+  if (!num_util::iscontiguous (block)) {
+    block = num_util::clone (block);
+  }
+  uint64_t nofTimes;
+  float const *result = chain.process (reinterpret_cast<float *>(num_util::data (block)),
+				       num_util::get_dim (block, 0),
+				       nofTimes);
+
+  std::vector<int> dims (2);
+  dims[0] = nofTimes;
+  dims[1] = chain.nofOutputChannels();
+
+  return num_util::makeNum (const_cast<float *>(result), dims);
+}
+
+// ==============================================================================
+//
+//                                                      Wrapper for class methods
+//
+// ==============================================================================
+
+void export_ProcessingChain ()
+{
+  boost::python::def ("dispersionDelay", &DAL::dispersionDelay,
+		      "Delay in seconds of a dispersed signal at a frequency w.r.t. a reference frequency (both in Hz).");
+
+  boost::python::class_<ProcessingChain, boost::noncopyable>("ProcessingChain",
+							     boost::python::init<unsigned int>())
+    /* Access to internal parameters */
+    .def( "nofChannels", &ProcessingChain::nofChannels,
+	  "Get the number of channels of the input." )
+    .def( "nofOutputChannels", &ProcessingChain::nofOutputChannels,
+	  "Get the number of channels of the output." )
+    .def( "nofStages", &ProcessingChain::nofStages,
+	  "Get the number of stages." )
+    /* Methods */
+    .def( "addAveraging", &ProcessingChain_addAveraging,
+	  "Average over a number of time samples and channels." )
+    .def( "addDedispersion", &ProcessingChain_addDedispersion,
+	  "Dedisperse, given the channel frequencies in Hz, the sample time in s and the DM in pc/cm^3." )
+    .def( "addBandpass", &ProcessingChain_addBandpass,
+	  "Normalize each channel to zero mean and unit variance." )
+    .def( "process", &ProcessingChain_process,
+	  "Process the next [time][channel] block of the stream." )
+    .def( "reset", &ProcessingChain::reset,
+	  "Reset all stages, to start a new stream." )
+    ;
+}
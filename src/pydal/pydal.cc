@@ -98,5 +98,6 @@ BOOST_PYTHON_MODULE(pydal)
   export_TBB_StationGroup ();
   export_TBB_DipoleDataset ();  
   export_LOPES_EventFile ();
+  export_ProcessingChain ();
   
 }
@@ -145,6 +145,8 @@ void export_TBB_StationGroup();
 void export_TBB_DipoleDataset();
 //! Bindings for DAL::LOPES_EventFile
 void export_LOPES_EventFile();
+//! Bindings for DAL::ProcessingChain
+void export_ProcessingChain();
 
 #define PY_ARRAY_UNIQUE_SYMBOL PyArrayHandle
 #define NO_IMPORT_ARRAY